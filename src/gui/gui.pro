@@ -66,7 +66,8 @@ SOURCES += src/main.cpp \
     src/CancelActivationDialog.cpp \
     src/FailedLoginDialog.cpp \
     ../lib/shared/SerialKey.cpp \
-    src/LicenseManager.cpp
+    src/LicenseManager.cpp \
+    src/LogBuffer.cpp
 HEADERS += src/MainWindow.h \
     src/AboutDialog.h \
     src/ServerConfig.h \
@@ -115,7 +116,8 @@ HEADERS += src/MainWindow.h \
     src/FailedLoginDialog.h \
     ../lib/shared/EditionType.h \
     ../lib/shared/SerialKey.h \
-    src/LicenseManager.h
+    src/LicenseManager.h \
+    src/LogBuffer.h
 RESOURCES += res/Synergy.qrc
 RC_FILE = res/win/Synergy.rc
 macx { 
@@ -34,7 +34,7 @@ m_Enabled(false)
 	connect(m_Socket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(error(QAbstractSocket::SocketError)));
 
 	m_Reader = new IpcReader(m_Socket);
-	connect(m_Reader, SIGNAL(readLogLine(const QString&)), this, SLOT(handleReadLogLine(const QString&)));
+	connect(m_Reader, SIGNAL(readLogLines(const QStringList&)), this, SLOT(handleReadLogLines(const QStringList&)));
 }
 
 IpcClient::~IpcClient()
@@ -119,9 +119,9 @@ void IpcClient::sendCommand(const QString& command, ElevateMode const elevate)
 	stream.writeRawData(elevateBuf, 1);
 }
 
-void IpcClient::handleReadLogLine(const QString& text)
+void IpcClient::handleReadLogLines(const QStringList& lines)
 {
-	readLogLine(text);
+	readLogLines(lines);
 }
 
 // TODO: qt must have a built in way of converting int to bytes.
@@ -20,6 +20,7 @@
 
 #include <QObject>
 #include <QAbstractSocket>
+#include <QStringList>
 
 #include "ElevateMode.h"
 
@@ -48,10 +49,10 @@ private:
 private slots:
 	void connected();
 	void error(QAbstractSocket::SocketError error);
-	void handleReadLogLine(const QString& text);
+	void handleReadLogLines(const QStringList& lines);
 
 signals:
-	void readLogLine(const QString& text);
+	void readLogLines(const QStringList& lines);
 	void infoMessage(const QString& text);
 	void errorMessage(const QString& text);
 
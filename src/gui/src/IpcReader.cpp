@@ -22,6 +22,10 @@
 #include <iostream>
 #include <QMutex>
 #include <QByteArray>
+#include <QStringList>
+
+// message code followed by 4 byte length
+static const int kFrameHeaderSize = 8;
 
 IpcReader::IpcReader(QTcpSocket* socket) :
 m_Socket(socket)
@@ -45,69 +49,36 @@ void IpcReader::stop()
 void IpcReader::read()
 {
 	QMutexLocker locker(&m_Mutex);
-	std::cout << "ready read" << std::endl;
-
-	while (m_Socket->bytesAvailable()) {
-		std::cout << "bytes available" << std::endl;
-
-		char codeBuf[5];
-		readStream(codeBuf, 4);
-		codeBuf[4] = 0;
-		std::cout << "ipc read: " << codeBuf << std::endl;
-
-		if (memcmp(codeBuf, kIpcMsgLogLine, 4) == 0) {
-			std::cout << "reading log line" << std::endl;
 
-			char lenBuf[4];
-			readStream(lenBuf, 4);
-			int len = bytesToInt(lenBuf, 4);
+	// take everything the socket has, and parse as many whole frames as
+	// possible; a partial frame stays buffered until the next read.
+	m_Buffer.append(m_Socket->readAll());
 
-			char* data = new char[len];
-			readStream(data, len);
-			QString line = QString::fromUtf8(data, len);
-			delete[] data;
-
-			readLogLine(line);
-		}
-		else {
+	QStringList lines;
+	int pos = 0;
+	while (m_Buffer.size() - pos >= kFrameHeaderSize) {
+		const char* frame = m_Buffer.constData() + pos;
+		if (memcmp(frame, kIpcMsgLogLine, 4) != 0) {
 			std::cerr << "aborting, message invalid" << std::endl;
-			return;
+			m_Buffer.clear();
+			pos = 0;
+			break;
 		}
-	}
-
-	std::cout << "read done" << std::endl;
-}
-
-bool IpcReader::readStream(char* buffer, int length)
-{
-	std::cout << "reading stream" << std::endl;
 
-	int read = 0;
-	while (read < length) {
-		int ask = length - read;
-		if (m_Socket->bytesAvailable() < ask) {
-			std::cout << "buffer too short, waiting" << std::endl;
-			m_Socket->waitForReadyRead(-1);
+		int len = bytesToInt(frame + 4, 4);
+		if (m_Buffer.size() - pos - kFrameHeaderSize < len) {
+			break;
 		}
 
-		int got = m_Socket->read(buffer, ask);
-		read += got;
-
-		std::cout << "> ask=" << ask << " got=" << got
-			<< " read=" << read << std::endl;
+		lines.append(QString::fromUtf8(frame + kFrameHeaderSize, len));
+		pos += kFrameHeaderSize + len;
+	}
+	m_Buffer.remove(0, pos);
 
-		if (got == -1) {
-			std::cout << "socket ended, aborting" << std::endl;
-			return false;
-		}
-		else if (length - read > 0) {
-			std::cout << "more remains, seek to " << got << std::endl;
-			buffer += got;
-		}
+	if (!lines.isEmpty()) {
+		readLogLines(lines);
 	}
-	return true;
 }
-
 int IpcReader::bytesToInt(const char *buffer, int size)
 {
 	if (size == 1) {
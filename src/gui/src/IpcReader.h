@@ -20,6 +20,8 @@
 
 #include <QObject>
 #include <QMutex>
+#include <QByteArray>
+#include <QStringList>
 
 class QTcpSocket;
 
@@ -34,10 +36,9 @@ public:
 	void stop();
 
 signals:
-	void readLogLine(const QString& text);
+	void readLogLines(const QStringList& lines);
 
 private:
-	bool readStream(char* buffer, int length);
 	int bytesToInt(const char* buffer, int size);
 
 private slots:
@@ -46,4 +47,5 @@ private slots:
 private:
 	QTcpSocket* m_Socket;
 	QMutex m_Mutex;
+	QByteArray m_Buffer;
 };
@@ -0,0 +1,85 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LogBuffer.h"
+
+LogBuffer::LogBuffer(int maxLines, int flushInterval, QObject* parent) :
+	QObject(parent),
+	m_Ring(maxLines),
+	m_Head(0),
+	m_Count(0),
+	m_Dropped(0)
+{
+	m_Timer.setSingleShot(true);
+	m_Timer.setInterval(flushInterval);
+	connect(&m_Timer, SIGNAL(timeout()), this, SLOT(timeout()));
+}
+
+void LogBuffer::append(const QString& line)
+{
+	int capacity = m_Ring.size();
+	if (m_Count == capacity) {
+		// full, overwrite the oldest line
+		m_Ring[m_Head] = line;
+		m_Head = (m_Head + 1) % capacity;
+		m_Dropped++;
+	}
+	else {
+		m_Ring[(m_Head + m_Count) % capacity] = line;
+		m_Count++;
+	}
+
+	if (!m_Timer.isActive()) {
+		m_Timer.start();
+	}
+}
+
+void LogBuffer::flush()
+{
+	m_Timer.stop();
+	if (m_Count == 0) {
+		return;
+	}
+
+	QStringList lines;
+	lines.reserve(m_Count);
+	int capacity = m_Ring.size();
+	for (int i = 0; i < m_Count; i++) {
+		QString& line = m_Ring[(m_Head + i) % capacity];
+		lines.append(line);
+		line.clear();
+	}
+	m_Head = 0;
+	m_Count = 0;
+	m_Dropped = 0;
+
+	emit flushed(lines);
+}
+
+void LogBuffer::clear()
+{
+	m_Timer.stop();
+	m_Ring.fill(QString());
+	m_Head = 0;
+	m_Count = 0;
+	m_Dropped = 0;
+}
+
+void LogBuffer::timeout()
+{
+	flush();
+}
@@ -0,0 +1,60 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+
+//! Coalesces log lines for display
+/*!
+Log lines are collected in a fixed size ring and handed over in a single
+batch once per flush interval, so the log widget is updated at most once
+per tick regardless of how fast the core logs. When more lines than the
+ring holds arrive within one tick, the oldest are dropped; the widget
+would scroll them out of its own bounded history anyway.
+*/
+class LogBuffer : public QObject
+{
+	Q_OBJECT
+
+public:
+	LogBuffer(int maxLines, int flushInterval, QObject* parent = 0);
+
+	void append(const QString& line);
+	void flush();
+	void clear();
+
+	int maxLines() const { return m_Ring.size(); }
+	int pendingLines() const { return m_Count; }
+	int droppedLines() const { return m_Dropped; }
+
+signals:
+	void flushed(const QStringList& lines);
+
+private slots:
+	void timeout();
+
+private:
+	QVector<QString> m_Ring;
+	int m_Head;
+	int m_Count;
+	int m_Dropped;
+	QTimer m_Timer;
+};
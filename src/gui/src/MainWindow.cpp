@@ -68,6 +68,13 @@ static const char synergyConfigName[] = "synergy.conf";
 static const QString synergyConfigFilter(QObject::tr("Synergy Configurations (*.conf);;All files (*.*)"));
 #endif
 
+// the log widget keeps this many lines, and is refreshed at most once per
+// flush interval (ms) no matter how quickly the core logs.
+static const int kLogMaxLines = 10000;
+static const int kLogFlushInterval = 50;
+
+static const QRegExp kLogLineBreak("\r|\n|\r\n");
+
 static const char* synergyIconFiles[] =
 {
 	":/res/icons/16x16/synergy-disconnected.png",
@@ -88,6 +95,7 @@ MainWindow::MainWindow(QSettings& settings, AppConfig& appConfig,
 	m_pTrayIcon(NULL),
 	m_pTrayIconMenu(NULL),
 	m_AlreadyHidden(false),
+	m_LogBuffer(kLogMaxLines, kLogFlushInterval),
 	m_pMenuBar(NULL),
 	m_pMenuFile(NULL),
 	m_pMenuEdit(NULL),
@@ -106,6 +114,9 @@ MainWindow::MainWindow(QSettings& settings, AppConfig& appConfig,
 {
 	setupUi(this);
 
+	m_pLogOutput->setMaximumBlockCount(kLogMaxLines);
+	connect(&m_LogBuffer, SIGNAL(flushed(const QStringList&)), this, SLOT(flushLog(const QStringList&)));
+
 	createMenuBar();
 	loadSettings();
 	initConnections();
@@ -117,7 +128,7 @@ MainWindow::MainWindow(QSettings& settings, AppConfig& appConfig,
 
 #if defined(Q_OS_WIN)
 	// ipc must always be enabled, so that we can disable command when switching to desktop mode.
-	connect(&m_IpcClient, SIGNAL(readLogLine(const QString&)), this, SLOT(appendLogRaw(const QString&)));
+	connect(&m_IpcClient, SIGNAL(readLogLines(const QStringList&)), this, SLOT(appendLogLines(const QStringList&)));
 	connect(&m_IpcClient, SIGNAL(errorMessage(const QString&)), this, SLOT(appendLogError(const QString&)));
 	connect(&m_IpcClient, SIGNAL(infoMessage(const QString&)), this, SLOT(appendLogNote(const QString&)));
 	m_IpcClient.connectToHost();
@@ -371,14 +382,7 @@ void MainWindow::logOutput()
 {
 	if (m_pSynergy)
 	{
-		QString text(m_pSynergy->readAllStandardOutput());
-		foreach(QString line, text.split(QRegExp("\r|\n|\r\n")))
-		{
-			if (!line.isEmpty())
-			{
-				appendLogRaw(line);
-			}
-		}
+		appendLogRaw(m_pSynergy->readAllStandardOutput());
 	}
 }
 
@@ -418,14 +422,29 @@ void MainWindow::appendLogError(const QString& text)
 
 void MainWindow::appendLogRaw(const QString& text)
 {
-	foreach(QString line, text.split(QRegExp("\r|\n|\r\n"))) {
+	foreach(QString line, text.split(kLogLineBreak)) {
 		if (!line.isEmpty()) {
-			m_pLogOutput->append(line);
+			m_LogBuffer.append(line);
 			updateFromLogLine(line);
 		}
 	}
 }
 
+void MainWindow::appendLogLines(const QStringList& lines)
+{
+	foreach(const QString& text, lines) {
+		appendLogRaw(text);
+	}
+}
+
+void MainWindow::flushLog(const QStringList& lines)
+{
+	// one append per tick keeps layout and repaint cost independent of
+	// how many lines arrived; blocks past the maximum are dropped from
+	// the top by the widget itself.
+	m_pLogOutput->appendPlainText(lines.join("\n"));
+}
+
 void MainWindow::updateFromLogLine(const QString &line)
 {
 	// TODO: this code makes Andrew cry
@@ -466,6 +485,10 @@ void MainWindow::checkLicense(const QString &line)
 
 void MainWindow::checkFingerprint(const QString& line)
 {
+	if (!line.contains("server fingerprint: ")) {
+		return;
+	}
+
 	QRegExp fingerprintRegex(".*server fingerprint: ([A-F0-9:]+)");
 	if (!fingerprintRegex.exactMatch(line)) {
 		return;
@@ -547,6 +570,7 @@ void MainWindow::showEvent(QShowEvent* event)
 
 void MainWindow::clearLog()
 {
+	m_LogBuffer.clear();
 	m_pLogOutput->clear();
 }
 
@@ -635,7 +659,7 @@ void MainWindow::startSynergy()
 	}
 
 	// put a space between last log output and new instance.
-	if (!m_pLogOutput->toPlainText().isEmpty())
+	if (!m_pLogOutput->document()->isEmpty())
 		appendLogRaw("");
 
 	appendLogInfo("starting " + QString(synergyType() == synergyServer ? "server" : "client"));
@@ -804,6 +828,12 @@ bool MainWindow::serverArgs(QStringList& args, QString& app)
 #endif
 	args << "-c" << configFilename << "--address" << address();
 
+	// the internal configuration is written to a new temporary file
+	// each time so only cache one the user keeps
+	if (!m_pRadioInternalConfig->isChecked()) {
+		args << "--config-cache";
+	}
+
 	if (!appConfig().serialKey().isEmpty()) {
 		args << "--serial-key" << appConfig().serialKey();
 	}
@@ -32,6 +32,7 @@
 #include "AppConfig.h"
 #include "VersionChecker.h"
 #include "IpcClient.h"
+#include "LogBuffer.h"
 #include "Ipc.h"
 #include "ActivationDialog.h"
 
@@ -127,6 +128,7 @@ public slots:
 		void beginTrial(bool isExpiring);
 		void endTrial(bool isExpired);
 		void appendLogRaw(const QString& text);
+		void appendLogLines(const QStringList& lines);
 		void appendLogInfo(const QString& text);
 		void appendLogDebug(const QString& text);
 		void appendLogError(const QString& text);
@@ -147,6 +149,7 @@ public slots:
 		void stopSynergy();
 		void logOutput();
 		void logError();
+		void flushLog(const QStringList& lines);
 		void updateFound(const QString& version);
 		void bonjourInstallFinished();
 
@@ -207,6 +210,7 @@ public slots:
 		bool m_AlreadyHidden;
 		VersionChecker m_VersionChecker;
 		IpcClient m_IpcClient;
+		LogBuffer m_LogBuffer;
 		QMenuBar* m_pMenuBar;
 		QMenu* m_pMenuFile;
 		QMenu* m_pMenuEdit;
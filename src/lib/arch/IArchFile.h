@@ -20,6 +20,7 @@
 
 #include "common/IInterface.h"
 #include "common/stdstring.h"
+#include "common/stdvector.h"
 #include "base/String.h"
 
 //! Interface for architecture dependent file system operations
@@ -88,6 +89,51 @@ public:
 	virtual std::string	concatPath(
 							const std::string& prefix,
 							const std::string& suffix) = 0;
+
+	//! Test for directory
+	/*!
+	Returns true iff \c path names an existing directory.
+	*/
+	virtual bool		isDirectory(const std::string& path) = 0;
+
+	//! List directory
+	/*!
+	Replaces \c names with the names of the entries in the directory
+	\c path, not including "." and "..".  Returns false if the directory
+	can't be read.
+	*/
+	virtual bool		getDirectoryEntries(const std::string& path,
+							std::vector<std::string>& names) = 0;
+
+	//! Create directory
+	/*!
+	Creates the directory \c path.  Its parent must exist.  Returns true
+	if the directory was created or already exists.
+	*/
+	virtual bool		makeDirectory(const std::string& path) = 0;
+
+	//! Create new directory
+	/*!
+	Creates a directory with a unique name in the existing directory
+	\c parent and returns its path, or an empty string on failure.  The
+	directory is always a new one, never one that already existed.
+	*/
+	virtual std::string	makeTempDirectory(const std::string& parent) = 0;
+
+	//! Remove directory
+	/*!
+	Removes the empty directory \c path.  Returns true iff successful.
+	*/
+	virtual bool		removeDirectory(const std::string& path) = 0;
+
+	//! Move file or directory
+	/*!
+	Renames \c from to \c to, replacing \c to if it's a file.  The
+	rename is atomic when both are on the same file system.  Returns
+	true iff successful.
+	*/
+	virtual bool		movePath(const std::string& from,
+							const std::string& to) = 0;
 	
 	//@}
 	//! Set the user's profile directory
@@ -148,6 +148,13 @@ public:
 	//! Lock a mutex
 	virtual void		lockMutex(ArchMutex) = 0;
 
+	//! Try to lock a mutex
+	/*!
+	Locks the mutex and returns true if that can be done without
+	blocking, otherwise returns false.
+	*/
+	virtual bool		tryLockMutex(ArchMutex) = 0;
+
 	//! Unlock a mutex
 	virtual void		unlockMutex(ArchMutex) = 0;
 
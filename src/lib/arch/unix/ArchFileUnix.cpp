@@ -19,9 +19,13 @@
 #include "arch/unix/ArchFileUnix.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include <pwd.h>
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <errno.h>
 #include <cstring>
 
 //
@@ -150,6 +154,66 @@ ArchFileUnix::concatPath(const std::string& prefix,
 	return path;
 }
 
+bool
+ArchFileUnix::isDirectory(const std::string& path)
+{
+	struct stat info;
+	return (stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode));
+}
+
+bool
+ArchFileUnix::getDirectoryEntries(const std::string& path,
+				std::vector<std::string>& names)
+{
+	names.clear();
+	DIR* dir = opendir(path.c_str());
+	if (dir == NULL) {
+		return false;
+	}
+	struct dirent* entry;
+	while ((entry = readdir(dir)) != NULL) {
+		if (strcmp(entry->d_name, ".") != 0 &&
+			strcmp(entry->d_name, "..") != 0) {
+			names.push_back(entry->d_name);
+		}
+	}
+	closedir(dir);
+	return true;
+}
+
+bool
+ArchFileUnix::makeDirectory(const std::string& path)
+{
+	if (mkdir(path.c_str(), 0755) == 0) {
+		return true;
+	}
+	return (errno == EEXIST && isDirectory(path));
+}
+
+std::string
+ArchFileUnix::makeTempDirectory(const std::string& parent)
+{
+	std::string path = concatPath(parent, "XXXXXX");
+	std::vector<char> buffer(path.begin(), path.end());
+	buffer.push_back('\0');
+	if (mkdtemp(&buffer[0]) == NULL) {
+		return std::string();
+	}
+	return std::string(&buffer[0]);
+}
+
+bool
+ArchFileUnix::removeDirectory(const std::string& path)
+{
+	return (rmdir(path.c_str()) == 0);
+}
+
+bool
+ArchFileUnix::movePath(const std::string& from, const std::string& to)
+{
+	return (rename(from.c_str(), to.c_str()) == 0);
+}
+
 void
 ArchFileUnix::setProfileDirectory(const String& s)
 {
@@ -38,6 +38,14 @@ public:
 	virtual std::string	getProfileDirectory();
 	virtual std::string	concatPath(const std::string& prefix,
 							const std::string& suffix);
+	virtual bool		isDirectory(const std::string& path);
+	virtual bool		getDirectoryEntries(const std::string& path,
+							std::vector<std::string>& names);
+	virtual bool		makeDirectory(const std::string& path);
+	virtual std::string	makeTempDirectory(const std::string& parent);
+	virtual bool		removeDirectory(const std::string& path);
+	virtual bool		movePath(const std::string& from,
+							const std::string& to);
 	virtual void		setProfileDirectory(const String& s);
 	virtual void		setPluginDirectory(const String& s);
 
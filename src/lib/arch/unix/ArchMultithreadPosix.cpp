@@ -33,6 +33,7 @@
 #	endif
 #endif
 #include <cerrno>
+#include <sched.h>
 
 #define SIGWAKEUP SIGUSR1
 
@@ -317,6 +318,30 @@ ArchMultithreadPosix::lockMutex(ArchMutex mutex)
 	}
 }
 
+bool
+ArchMultithreadPosix::tryLockMutex(ArchMutex mutex)
+{
+	int status = pthread_mutex_trylock(&mutex->m_mutex);
+
+	switch (status) {
+	case 0:
+		// success
+		return true;
+
+	case EBUSY:
+		return false;
+
+	case EAGAIN:
+		assert(0 && "too many recursive locks");
+		break;
+
+	default:
+		assert(0 && "unexpected error");
+		break;
+	}
+	return false;
+}
+
 void
 ArchMultithreadPosix::unlockMutex(ArchMutex mutex)
 {
@@ -454,11 +479,29 @@ ArchMultithreadPosix::cancelThread(ArchThread thread)
 }
 
 void
-ArchMultithreadPosix::setPriorityOfThread(ArchThread thread, int /*n*/)
+ArchMultithreadPosix::setPriorityOfThread(ArchThread thread, int n)
 {
 	assert(thread != NULL);
 
-	// FIXME
+	// only boosting is supported.  that takes a real time policy, which
+	// unprivileged processes often aren't allowed, in which case the
+	// request is silently ignored.
+	if (n >= 0) {
+		return;
+	}
+
+	int policy;
+	struct sched_param param;
+	if (pthread_getschedparam(thread->m_thread, &policy, &param) != 0) {
+		return;
+	}
+	int minPriority = sched_get_priority_min(SCHED_RR);
+	int maxPriority = sched_get_priority_max(SCHED_RR);
+	param.sched_priority = minPriority - n - 1;
+	if (param.sched_priority > maxPriority) {
+		param.sched_priority = maxPriority;
+	}
+	pthread_setschedparam(thread->m_thread, SCHED_RR, &param);
 }
 
 void
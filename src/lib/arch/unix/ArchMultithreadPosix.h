@@ -65,6 +65,7 @@ public:
 	virtual ArchMutex	newMutex();
 	virtual void		closeMutex(ArchMutex);
 	virtual void		lockMutex(ArchMutex);
+	virtual bool		tryLockMutex(ArchMutex);
 	virtual void		unlockMutex(ArchMutex);
 	virtual ArchThread	newThread(ThreadFunc, void*);
 	virtual ArchThread	newCurrentThread();
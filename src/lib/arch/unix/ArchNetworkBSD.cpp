@@ -201,8 +201,10 @@ ArchNetworkBSD::listenOnSocket(ArchSocket s)
 {
 	assert(s != NULL);
 
-	// hardcoding backlog
-	if (listen(s->m_fd, 3) == -1) {
+	// use the system's maximum backlog.  a tiny backlog makes clients
+	// that connect at the same time (e.g. after a server restart) back
+	// off for seconds waiting for their SYN to be answered.
+	if (listen(s->m_fd, SOMAXCONN) == -1) {
 		throwError(errno);
 	}
 }
@@ -23,6 +23,7 @@
 #include <shlobj.h>
 #include <tchar.h>
 #include <string.h>
+#include <stdio.h>
 
 //
 // ArchFileWindows
@@ -190,6 +191,79 @@ ArchFileWindows::concatPath(const std::string& prefix,
 	return path;
 }
 
+bool
+ArchFileWindows::isDirectory(const std::string& path)
+{
+	DWORD attributes = GetFileAttributesA(path.c_str());
+	return (attributes != INVALID_FILE_ATTRIBUTES &&
+			(attributes & FILE_ATTRIBUTE_DIRECTORY) != 0);
+}
+
+bool
+ArchFileWindows::getDirectoryEntries(const std::string& path,
+				std::vector<std::string>& names)
+{
+	names.clear();
+	WIN32_FIND_DATAA data;
+	HANDLE find = FindFirstFileA(concatPath(path, "*").c_str(), &data);
+	if (find == INVALID_HANDLE_VALUE) {
+		return (GetLastError() == ERROR_FILE_NOT_FOUND);
+	}
+	do {
+		if (strcmp(data.cFileName, ".") != 0 &&
+			strcmp(data.cFileName, "..") != 0) {
+			names.push_back(data.cFileName);
+		}
+	} while (FindNextFileA(find, &data));
+	FindClose(find);
+	return true;
+}
+
+bool
+ArchFileWindows::makeDirectory(const std::string& path)
+{
+	if (CreateDirectoryA(path.c_str(), NULL)) {
+		return true;
+	}
+	return (GetLastError() == ERROR_ALREADY_EXISTS && isDirectory(path));
+}
+
+std::string
+ArchFileWindows::makeTempDirectory(const std::string& parent)
+{
+	static LONG s_count = 0;
+
+	// a name already in use may belong to another process so only
+	// accept a directory we created
+	DWORD pid = GetCurrentProcessId();
+	for (int i = 0; i < 100; ++i) {
+		char name[32];
+		sprintf(name, "%lu-%ld", (unsigned long)pid,
+							(long)InterlockedIncrement(&s_count));
+		std::string path = concatPath(parent, name);
+		if (CreateDirectoryA(path.c_str(), NULL)) {
+			return path;
+		}
+		if (GetLastError() != ERROR_ALREADY_EXISTS) {
+			break;
+		}
+	}
+	return std::string();
+}
+
+bool
+ArchFileWindows::removeDirectory(const std::string& path)
+{
+	return (RemoveDirectoryA(path.c_str()) != FALSE);
+}
+
+bool
+ArchFileWindows::movePath(const std::string& from, const std::string& to)
+{
+	return (MoveFileExA(from.c_str(), to.c_str(),
+				MOVEFILE_REPLACE_EXISTING) != FALSE);
+}
+
 void
 ArchFileWindows::setProfileDirectory(const String& s)
 {
@@ -285,6 +285,12 @@ ArchMultithreadWindows::lockMutex(ArchMutex mutex)
 	EnterCriticalSection(&mutex->m_mutex);
 }
 
+bool
+ArchMultithreadWindows::tryLockMutex(ArchMutex mutex)
+{
+	return (TryEnterCriticalSection(&mutex->m_mutex) != FALSE);
+}
+
 void
 ArchMultithreadWindows::unlockMutex(ArchMutex mutex)
 {
@@ -304,8 +304,9 @@ ArchNetworkWinsock::listenOnSocket(ArchSocket s)
 {
 	assert(s != NULL);
 
-	// hardcoding backlog
-	if (listen_winsock(s->m_socket, 3) == SOCKET_ERROR) {
+	// use the system's maximum backlog so many clients can connect
+	// at once
+	if (listen_winsock(s->m_socket, SOMAXCONN) == SOCKET_ERROR) {
 		throwError(getsockerror_winsock());
 	}
 }
@@ -49,6 +49,14 @@ public:
 		kDontFreeData		= 0x02	//!< Don't free data in deleteData
 	};
 
+	//! Dispatch priority class of an event type
+	enum EPriority {
+		kInputPriority,		//!< User input, dispatched first
+		kControlPriority,	//!< Everything else
+		kBulkPriority,		//!< Bulk data, dispatched last
+		kNumPriorities
+	};
+
 	Event();
 
 	//! Create \c Event with data (POD)
@@ -65,7 +65,12 @@ interrupt(Arch::ESignal, void* data)
 
 EventQueue::EventQueue() :
 	m_systemTarget(0),
+	m_mutex("EventQueue"),
 	m_nextType(Event::kLast),
+	m_dispatching(false),
+	m_dispatchThread(NULL),
+	m_runningJobTarget(NULL),
+	m_jobDone(new CondVar<bool>(&m_mutex, false)),
 	m_typesForClient(NULL),
 	m_typesForIStream(NULL),
 	m_typesForIpcClient(NULL),
@@ -89,7 +94,10 @@ EventQueue::EventQueue() :
 	m_readyMutex(new Mutex),
 	m_readyCondVar(new CondVar<bool>(m_readyMutex, false))
 {
-	m_mutex = ARCH->newMutex();
+	for (int i = 0; i < Event::kNumPriorities; ++i) {
+		m_skipped[i] = 0;
+	}
+
 	ARCH->setSignalHandler(Arch::kINTERRUPT, &interrupt, this);
 	ARCH->setSignalHandler(Arch::kTERMINATE, &interrupt, this);
 	m_buffer = new SimpleEventQueueBuffer;
@@ -98,12 +106,15 @@ EventQueue::EventQueue() :
 EventQueue::~EventQueue()
 {
 	delete m_buffer;
+	delete m_jobDone;
 	delete m_readyCondVar;
 	delete m_readyMutex;
+	if (m_dispatchThread != NULL) {
+		ARCH->closeThread(m_dispatchThread);
+	}
 	
 	ARCH->setSignalHandler(Arch::kINTERRUPT, NULL, NULL);
 	ARCH->setSignalHandler(Arch::kTERMINATE, NULL, NULL);
-	ARCH->closeMutex(m_mutex);
 }
 
 void
@@ -122,23 +133,130 @@ EventQueue::loop()
 		addEventToBuffer(event);
 		m_pending.pop();
 	}
+
+	{
+		Lock lock(&m_mutex, __FUNCTION__);
+		if (m_dispatchThread != NULL) {
+			ARCH->closeThread(m_dispatchThread);
+		}
+		m_dispatchThread = ARCH->newCurrentThread();
+	}
 	
 	Event event;
 	getEvent(event);
 	while (event.getType() != Event::kQuit) {
+		{
+			Lock lock(&m_mutex, __FUNCTION__);
+			m_dispatching = true;
+		}
 		dispatchEvent(event);
+		runDispatchEndJobs();
 		Event::deleteData(event);
 		getEvent(event);
 	}
 }
 
+void
+EventQueue::adoptDispatchEndJob(void* target, IEventJob* job)
+{
+	{
+		Lock lock(&m_mutex, __FUNCTION__);
+		// only work done by the handler being dispatched is deferred.
+		// other threads must not wait for that handler to return.
+		if (m_dispatching && isDispatchThread()) {
+			m_dispatchEndJobs.push_back(DispatchEndJob(target, job));
+			return;
+		}
+	}
+
+	job->run(Event(Event::kUnknown, target));
+	delete job;
+}
+
+void
+EventQueue::removeDispatchEndJobs(void* target)
+{
+	std::vector<IEventJob*> jobs;
+	{
+		Lock lock(&m_mutex, __FUNCTION__);
+		DispatchEndJobs::iterator index = m_dispatchEndJobs.begin();
+		while (index != m_dispatchEndJobs.end()) {
+			if (index->first == target) {
+				jobs.push_back(index->second);
+				index = m_dispatchEndJobs.erase(index);
+			}
+			else {
+				++index;
+			}
+		}
+
+		// a job for target may already have been taken by the
+		// dispatching thread.  wait for it to finish unless we're
+		// that job (or its thread).
+		if (m_runningJobTarget == target && !isDispatchThread()) {
+			while (m_runningJobTarget == target) {
+				m_jobDone->wait();
+			}
+		}
+	}
+
+	for (std::vector<IEventJob*>::iterator index = jobs.begin();
+							index != jobs.end(); ++index) {
+		delete *index;
+	}
+}
+
+void
+EventQueue::runDispatchEndJobs()
+{
+	// take jobs one at a time so a job may remove later ones (by
+	// deleting their target) or add new ones
+	for (;;) {
+		DispatchEndJob job;
+		{
+			Lock lock(&m_mutex, __FUNCTION__);
+			if (m_runningJobTarget != NULL) {
+				m_runningJobTarget = NULL;
+				m_jobDone->broadcast();
+			}
+			if (m_dispatchEndJobs.empty()) {
+				m_dispatching = false;
+				return;
+			}
+			job = m_dispatchEndJobs.front();
+			m_dispatchEndJobs.pop_front();
+			m_runningJobTarget = job.first;
+		}
+
+		job.second->run(Event(Event::kUnknown, job.first));
+		delete job.second;
+	}
+}
+
+bool
+EventQueue::isDispatchThread() const
+{
+	// note -- m_mutex must be locked on entry
+	if (m_dispatchThread == NULL) {
+		return false;
+	}
+	ArchThread thread = ARCH->newCurrentThread();
+	bool result = ARCH->isSameThread(thread, m_dispatchThread);
+	ARCH->closeThread(thread);
+	return result;
+}
+
 Event::Type
-EventQueue::registerTypeOnce(Event::Type& type, const char* name)
+EventQueue::registerTypeOnce(Event::Type& type, const char* name,
+				Event::EPriority priority)
 {
-	ArchMutexLock lock(m_mutex);
+	Lock lock(&m_mutex, __FUNCTION__);
 	if (type == Event::kUnknown) {
 		m_typeMap.insert(std::make_pair(m_nextType, name));
 		m_nameMap.insert(std::make_pair(name, m_nextType));
+		if (priority != Event::kControlPriority) {
+			m_priorityMap.insert(std::make_pair(m_nextType, priority));
+		}
 		LOG((CLOG_DEBUG1 "registered event type %s as %d", name, m_nextType));
 		type = m_nextType++;
 	}
@@ -175,7 +293,7 @@ EventQueue::getTypeName(Event::Type type)
 void
 EventQueue::adoptBuffer(IEventQueueBuffer* buffer)
 {
-	ArchMutexLock lock(m_mutex);
+	Lock lock(&m_mutex, __FUNCTION__);
 
 	LOG((CLOG_DEBUG "adopting new buffer"));
 
@@ -192,6 +310,10 @@ EventQueue::adoptBuffer(IEventQueueBuffer* buffer)
 	}
 	m_events.clear();
 	m_oldEventIDs.clear();
+	for (int i = 0; i < Event::kNumPriorities; ++i) {
+		m_ready[i].clear();
+		m_skipped[i] = 0;
+	}
 
 	// use new buffer
 	m_buffer = buffer;
@@ -248,8 +370,8 @@ retry:
 
 	case IEventQueueBuffer::kUser:
 		{
-			ArchMutexLock lock(m_mutex);
-			event = removeEvent(dataID);
+			Lock lock(&m_mutex, __FUNCTION__);
+			event = removeEvent(nextReadyEvent(dataID));
 			return true;
 		}
 
@@ -303,10 +425,16 @@ EventQueue::addEvent(const Event& event)
 void
 EventQueue::addEventToBuffer(const Event& event)
 {
-	ArchMutexLock lock(m_mutex);
+	Lock lock(&m_mutex, __FUNCTION__);
 	
 	// store the event's data locally
 	UInt32 eventID = saveEvent(event);
+
+	Event::EPriority priority = Event::kControlPriority;
+	PriorityMap::const_iterator index = m_priorityMap.find(event.getType());
+	if (index != m_priorityMap.end()) {
+		priority = index->second;
+	}
 	
 	// add it
 	if (!m_buffer->addEvent(eventID)) {
@@ -314,6 +442,53 @@ EventQueue::addEventToBuffer(const Event& event)
 		removeEvent(eventID);
 		Event::deleteData(event);
 	}
+	else {
+		m_ready[priority].push_back(eventID);
+	}
+}
+
+UInt32
+EventQueue::nextReadyEvent(UInt32 bufferedID)
+{
+	// note -- must have m_mutex locked on entry
+
+	// how many times a waiting event may be passed over for one of a
+	// higher priority.  this bounds the wait of lower priority events
+	// while a higher priority keeps the queue busy.
+	static const UInt32 s_maxSkips[Event::kNumPriorities] = { 0, 4, 16 };
+
+	// take the highest priority event unless a lower priority one has
+	// waited long enough
+	int chosen = -1;
+	for (int i = Event::kNumPriorities - 1; i > 0; --i) {
+		if (!m_ready[i].empty() && m_skipped[i] >= s_maxSkips[i]) {
+			chosen = i;
+			break;
+		}
+	}
+	for (int i = 0; chosen == -1 && i < Event::kNumPriorities; ++i) {
+		if (!m_ready[i].empty()) {
+			chosen = i;
+		}
+	}
+	if (chosen == -1) {
+		// every user event in the buffer is also in m_ready so this
+		// shouldn't happen
+		return bufferedID;
+	}
+
+	for (int i = 0; i < Event::kNumPriorities; ++i) {
+		if (i == chosen) {
+			m_skipped[i] = 0;
+		}
+		else if (!m_ready[i].empty()) {
+			++m_skipped[i];
+		}
+	}
+
+	UInt32 eventID = m_ready[chosen].front();
+	m_ready[chosen].pop_front();
+	return eventID;
 }
 
 EventQueueTimer*
@@ -325,7 +500,7 @@ EventQueue::newTimer(double duration, void* target)
 	if (target == NULL) {
 		target = timer;
 	}
-	ArchMutexLock lock(m_mutex);
+	Lock lock(&m_mutex, __FUNCTION__);
 	m_timers.insert(timer);
 	// initial duration is requested duration plus whatever's on
 	// the clock currently because the latter will be subtracted
@@ -344,7 +519,7 @@ EventQueue::newOneShotTimer(double duration, void* target)
 	if (target == NULL) {
 		target = timer;
 	}
-	ArchMutexLock lock(m_mutex);
+	Lock lock(&m_mutex, __FUNCTION__);
 	m_timers.insert(timer);
 	// initial duration is requested duration plus whatever's on
 	// the clock currently because the latter will be subtracted
@@ -357,7 +532,7 @@ EventQueue::newOneShotTimer(double duration, void* target)
 void
 EventQueue::deleteTimer(EventQueueTimer* timer)
 {
-	ArchMutexLock lock(m_mutex);
+	Lock lock(&m_mutex, __FUNCTION__);
 	for (TimerQueue::iterator index = m_timerQueue.begin();
 							index != m_timerQueue.end(); ++index) {
 		if (index->getTimer() == timer) {
@@ -375,7 +550,7 @@ EventQueue::deleteTimer(EventQueueTimer* timer)
 void
 EventQueue::adoptHandler(Event::Type type, void* target, IEventJob* handler)
 {
-	ArchMutexLock lock(m_mutex);
+	Lock lock(&m_mutex, __FUNCTION__);
 	IEventJob*& job = m_handlers[target][type];
 	delete job;
 	job = handler;
@@ -386,7 +561,7 @@ EventQueue::removeHandler(Event::Type type, void* target)
 {
 	IEventJob* handler = NULL;
 	{
-		ArchMutexLock lock(m_mutex);
+		Lock lock(&m_mutex, __FUNCTION__);
 		HandlerTable::iterator index = m_handlers.find(target);
 		if (index != m_handlers.end()) {
 			TypeHandlerTable& typeHandlers = index->second;
@@ -405,7 +580,7 @@ EventQueue::removeHandlers(void* target)
 {
 	std::vector<IEventJob*> handlers;
 	{
-		ArchMutexLock lock(m_mutex);
+		Lock lock(&m_mutex, __FUNCTION__);
 		HandlerTable::iterator index = m_handlers.find(target);
 		if (index != m_handlers.end()) {
 			// copy to handlers array and clear table for target
@@ -434,7 +609,7 @@ EventQueue::isEmpty() const
 IEventJob*
 EventQueue::getHandler(Event::Type type, void* target) const
 {
-	ArchMutexLock lock(m_mutex);
+	Lock lock(&m_mutex, __FUNCTION__);
 	HandlerTable::const_iterator index = m_handlers.find(target);
 	if (index != m_handlers.end()) {
 		const TypeHandlerTable& typeHandlers = index->second;
@@ -19,6 +19,7 @@
 #pragma once
 
 #include "mt/CondVar.h"
+#include "mt/Mutex.h"
 #include "arch/IArchMultithread.h"
 #include "base/IEventQueue.h"
 #include "base/Event.h"
@@ -28,8 +29,8 @@
 #include "common/stdset.h"
 
 #include <queue>
+#include <deque>
 
-class Mutex;
 
 //! Event queue
 /*!
@@ -56,8 +57,11 @@ public:
 							void* target, IEventJob* handler);
 	virtual void		removeHandler(Event::Type type, void* target);
 	virtual void		removeHandlers(void* target);
+	virtual void		adoptDispatchEndJob(void* target, IEventJob* job);
+	virtual void		removeDispatchEndJobs(void* target);
 	virtual Event::Type
-						registerTypeOnce(Event::Type& type, const char* name);
+						registerTypeOnce(Event::Type& type, const char* name,
+							Event::EPriority priority = Event::kControlPriority);
 	virtual bool		isEmpty() const;
 	virtual IEventJob*	getHandler(Event::Type type, void* target) const;
 	virtual const char*	getTypeName(Event::Type type);
@@ -72,6 +76,9 @@ private:
 	bool				hasTimerExpired(Event& event);
 	double				getNextTimerTimeout() const;
 	void				addEventToBuffer(const Event& event);
+	void				runDispatchEndJobs();
+	bool				isDispatchThread() const;
+	UInt32				nextReadyEvent(UInt32 bufferedID);
 	
 private:
 	class Timer {
@@ -108,19 +115,27 @@ private:
 	typedef std::vector<UInt32> EventIDList;
 	typedef std::map<Event::Type, const char*> TypeMap;
 	typedef std::map<String, Event::Type> NameMap;
+	typedef std::map<Event::Type, Event::EPriority> PriorityMap;
+	typedef std::deque<UInt32> ReadyQueue;
 	typedef std::map<Event::Type, IEventJob*> TypeHandlerTable;
 	typedef std::map<void*, TypeHandlerTable> HandlerTable;
+	typedef std::pair<void*, IEventJob*> DispatchEndJob;
+	typedef std::deque<DispatchEndJob> DispatchEndJobs;
 
 	int					m_systemTarget;
-	ArchMutex			m_mutex;
+	Mutex				m_mutex;
 
 	// registered events
 	Event::Type		m_nextType;
 	TypeMap			m_typeMap;
 	NameMap			m_nameMap;
 
-	// buffer of events
+	// buffer of events.  the buffer only says that a user event is
+	// ready; which one is taken from m_ready by priority.
 	IEventQueueBuffer*	m_buffer;
+	PriorityMap			m_priorityMap;
+	ReadyQueue			m_ready[Event::kNumPriorities];
+	UInt32				m_skipped[Event::kNumPriorities];
 
 	// saved events
 	EventTable			m_events;
@@ -135,6 +150,13 @@ private:
 	// event handlers
 	HandlerTable		m_handlers;
 
+	// jobs to run when the current dispatch ends
+	bool				m_dispatching;
+	ArchThread			m_dispatchThread;
+	DispatchEndJobs		m_dispatchEndJobs;
+	void*				m_runningJobTarget;
+	CondVar<bool>*		m_jobDone;
+
 public:
 	//
 	// Event type providers.
@@ -137,6 +137,7 @@ REGISTER_EVENT(Server, switchInDirection)
 REGISTER_EVENT(Server, keyboardBroadcast)
 REGISTER_EVENT(Server, lockCursorToScreen)
 REGISTER_EVENT(Server, screenSwitched)
+REGISTER_EVENT_PRIORITY(Server, clipboardPrefetch, kBulkPriority)
 
 //
 // ServerApp
@@ -150,25 +151,26 @@ REGISTER_EVENT(ServerApp, resetServer)
 // IKeyState
 //
 
-REGISTER_EVENT(IKeyState, keyDown)
-REGISTER_EVENT(IKeyState, keyUp)
-REGISTER_EVENT(IKeyState, keyRepeat)
+REGISTER_EVENT_PRIORITY(IKeyState, keyDown, kInputPriority)
+REGISTER_EVENT_PRIORITY(IKeyState, keyUp, kInputPriority)
+REGISTER_EVENT_PRIORITY(IKeyState, keyRepeat, kInputPriority)
 
 //
 // IPrimaryScreen
 //
 
-REGISTER_EVENT(IPrimaryScreen, buttonDown)
-REGISTER_EVENT(IPrimaryScreen, buttonUp)
-REGISTER_EVENT(IPrimaryScreen, motionOnPrimary)
-REGISTER_EVENT(IPrimaryScreen, motionOnSecondary)
-REGISTER_EVENT(IPrimaryScreen, wheel)
+REGISTER_EVENT_PRIORITY(IPrimaryScreen, buttonDown, kInputPriority)
+REGISTER_EVENT_PRIORITY(IPrimaryScreen, buttonUp, kInputPriority)
+REGISTER_EVENT_PRIORITY(IPrimaryScreen, motionOnPrimary, kInputPriority)
+REGISTER_EVENT_PRIORITY(IPrimaryScreen, motionOnSecondary, kInputPriority)
+REGISTER_EVENT_PRIORITY(IPrimaryScreen, wheel, kInputPriority)
 REGISTER_EVENT(IPrimaryScreen, screensaverActivated)
 REGISTER_EVENT(IPrimaryScreen, screensaverDeactivated)
-REGISTER_EVENT(IPrimaryScreen, hotKeyDown)
-REGISTER_EVENT(IPrimaryScreen, hotKeyUp)
+REGISTER_EVENT_PRIORITY(IPrimaryScreen, hotKeyDown, kInputPriority)
+REGISTER_EVENT_PRIORITY(IPrimaryScreen, hotKeyUp, kInputPriority)
 REGISTER_EVENT(IPrimaryScreen, fakeInputBegin)
 REGISTER_EVENT(IPrimaryScreen, fakeInputEnd)
+REGISTER_EVENT_PRIORITY(IPrimaryScreen, inputCaptured, kInputPriority)
 
 //
 // IScreen
@@ -192,12 +194,13 @@ REGISTER_EVENT(IpcServer, messageReceived)
 
 REGISTER_EVENT(Clipboard, clipboardGrabbed)
 REGISTER_EVENT(Clipboard, clipboardChanged)
-REGISTER_EVENT(Clipboard, clipboardSending)
+REGISTER_EVENT_PRIORITY(Clipboard, clipboardSending, kBulkPriority)
 
 //
 // File
 //
 
-REGISTER_EVENT(File, fileChunkSending)
+REGISTER_EVENT_PRIORITY(File, fileChunkSending, kBulkPriority)
 REGISTER_EVENT(File, fileRecieveCompleted)
 REGISTER_EVENT(File, keepAlive)
+REGISTER_EVENT_PRIORITY(File, fileSetChunkSending, kBulkPriority)
@@ -40,6 +40,14 @@ type_##Events::name_()													\
 	return getEvents()->registerTypeOnce(m_##name_, __FUNCTION__);			\
 }
 
+#define REGISTER_EVENT_PRIORITY(type_, name_, priority_)					\
+Event::Type															\
+type_##Events::name_()													\
+{																		\
+	return getEvents()->registerTypeOnce(m_##name_, __FUNCTION__,			\
+							Event::priority_);							\
+}
+
 class ClientEvents : public EventTypes {
 public:
 	ClientEvents() :
@@ -435,7 +443,8 @@ public:
 		m_switchInDirection(Event::kUnknown),
 		m_keyboardBroadcast(Event::kUnknown),
 		m_lockCursorToScreen(Event::kUnknown),
-		m_screenSwitched(Event::kUnknown) { }
+		m_screenSwitched(Event::kUnknown),
+		m_clipboardPrefetch(Event::kUnknown) { }
 
 	//! @name accessors
 	//@{
@@ -501,6 +510,15 @@ public:
 	*/
 	Event::Type		screenSwitched();
 
+	//! Get clipboard prefetch event type
+	/*!
+	Returns the clipboard prefetch event type.  The server sends this to
+	itself to send the clipboards to the screen it expects to switch to.
+	It's dispatched after pending input so reading the clipboards never
+	delays the cursor.
+	*/
+	Event::Type		clipboardPrefetch();
+
 	//@}
 		
 private:
@@ -512,6 +530,7 @@ private:
 	Event::Type		m_keyboardBroadcast;
 	Event::Type		m_lockCursorToScreen;
 	Event::Type		m_screenSwitched;
+	Event::Type		m_clipboardPrefetch;
 };
 
 class ServerAppEvents : public EventTypes {
@@ -576,7 +595,8 @@ public:
 		m_hotKeyDown(Event::kUnknown),
 		m_hotKeyUp(Event::kUnknown),
 		m_fakeInputBegin(Event::kUnknown),
-		m_fakeInputEnd(Event::kUnknown) { }
+		m_fakeInputEnd(Event::kUnknown),
+		m_inputCaptured(Event::kUnknown) { }
 
 	//! @name accessors
 	//@{
@@ -621,6 +641,9 @@ public:
 	//!  end of fake input event type
 	Event::Type		fakeInputEnd();
 
+	//!  input waiting on an InputCapture event type
+	Event::Type		inputCaptured();
+
 	//@}
 
 private:
@@ -635,6 +658,7 @@ private:
 	Event::Type		m_hotKeyUp;
 	Event::Type		m_fakeInputBegin;
 	Event::Type		m_fakeInputEnd;
+	Event::Type		m_inputCaptured;
 };
 
 class IScreenEvents : public EventTypes {
@@ -731,7 +755,8 @@ public:
 	FileEvents() :
 		m_fileChunkSending(Event::kUnknown),
 		m_fileRecieveCompleted(Event::kUnknown),
-		m_keepAlive(Event::kUnknown) { }
+		m_keepAlive(Event::kUnknown),
+		m_fileSetChunkSending(Event::kUnknown) { }
 
 	//! @name accessors
 	//@{
@@ -745,10 +770,14 @@ public:
 	//! Send a keep alive
 	Event::Type		keepAlive();
 
+	//! Sending a chunk of a file set
+	Event::Type		fileSetChunkSending();
+
 	//@}
 
 private:
 	Event::Type		m_fileChunkSending;
 	Event::Type		m_fileRecieveCompleted;
 	Event::Type		m_keepAlive;
+	Event::Type		m_fileSetChunkSending;
 };
@@ -168,15 +168,39 @@ public:
 	*/
 	virtual void		removeHandlers(void* target) = 0;
 
+	//! Run a job once the current event has been dispatched
+	/*!
+	Adopts \p job and runs it with a \c kUnknown event for \p target
+	when the handler for the event \c loop() is currently dispatching
+	returns.  This lets work produced while handling one event (such
+	as socket writes) be batched without delaying it any further.  If
+	no event is being dispatched, or the caller is not the thread
+	dispatching it, then \p job is run immediately.
+	*/
+	virtual void		adoptDispatchEndJob(void* target, IEventJob* job) = 0;
+
+	//! Remove jobs waiting for the end of the current dispatch
+	/*!
+	Deletes any jobs for \p target added by \c adoptDispatchEndJob()
+	that have not run yet.  If a job for \p target is running on the
+	dispatching thread then this waits for it to finish, so \p target
+	may be destroyed once this returns.
+	*/
+	virtual void		removeDispatchEndJobs(void* target) = 0;
+
 	//! Creates a new event type
 	/*!
 	If \p type contains \c kUnknown then it is set to a unique event
 	type id otherwise it is left alone.  The final value of \p type
-	is returned.
+	is returned.  Queued events of the type are dispatched ahead of
+	those with a lower \p priority, though lower priorities are never
+	starved.
 	*/
 	virtual Event::Type
 						registerTypeOnce(Event::Type& type,
-							const char* name) = 0;
+							const char* name,
+							Event::EPriority priority =
+								Event::kControlPriority) = 0;
 
 	//! Wait for event queue to become ready
 	/*!
@@ -21,6 +21,8 @@
 #include "client/ServerProxy.h"
 #include "synergy/Screen.h"
 #include "synergy/FileChunk.h"
+#include "synergy/FileSetChunk.h"
+#include "synergy/FileSetDropper.h"
 #include "synergy/DropHelper.h"
 #include "synergy/PacketStreamFilter.h"
 #include "synergy/ProtocolUtil.h"
@@ -49,6 +51,8 @@
 // Client
 //
 
+const double			Client::kConnectStagger = 0.25;
+
 Client::Client(
 		IEventQueue* events,
 		const String& name, const NetworkAddress& address,
@@ -58,6 +62,8 @@ Client::Client(
 	m_mock(false),
 	m_name(name),
 	m_serverAddress(address),
+	m_nextAttempt(0),
+	m_staggerTimer(NULL),
 	m_socketFactory(socketFactory),
 	m_screen(screen),
 	m_stream(NULL),
@@ -70,6 +76,7 @@ Client::Client(
 	m_events(events),
 	m_sendFileThread(NULL),
 	m_writeToDropDirThread(NULL),
+	m_fileSetDropper(NULL),
 	m_socket(NULL),
 	m_useSecureNetwork(args.m_enableCrypto),
 	m_args(args),
@@ -78,6 +85,10 @@ Client::Client(
 	assert(m_socketFactory != NULL);
 	assert(m_screen        != NULL);
 
+	m_fileSetDropper = new FileSetDropper(m_events, this, m_screen);
+
+	m_serverAddresses.push_back(address);
+
 	// register suspend/resume event handlers
 	m_events->adoptHandler(m_events->forIScreen().suspend(),
 							getEventTarget(),
@@ -113,15 +124,18 @@ Client::~Client()
 
 	cleanupTimer();
 	cleanupScreen();
-	cleanupConnecting();
+	cleanupAttempts();
 	cleanupConnection();
 	delete m_socketFactory;
+
+	// discard file sets not yet dropped
+	delete m_fileSetDropper;
 }
 
 void
 Client::connect()
 {
-	if (m_stream != NULL) {
+	if (m_stream != NULL || !m_attempts.empty()) {
 		return;
 	}
 	if (m_suspended) {
@@ -129,45 +143,18 @@ Client::connect()
 		return;
 	}
 
-	try {
-		// resolve the server hostname.  do this every time we connect
-		// in case we couldn't resolve the address earlier or the address
-		// has changed (which can happen frequently if this is a laptop
-		// being shuttled between various networks).  patch by Brent
-		// Priddy.
-		m_serverAddress.resolve();
-		
-		// m_serverAddress will be null if the hostname address is not reolved
-		if (m_serverAddress.getAddress() != NULL) {
-		  // to help users troubleshoot, show server host name (issue: 60)
-		  LOG((CLOG_NOTE "connecting to '%s': %s:%i", 
-		  m_serverAddress.getHostname().c_str(),
-		  ARCH->addrToString(m_serverAddress.getAddress()).c_str(),
-		  m_serverAddress.getPort()));
-		}
-
-		// create the socket
-		IDataSocket* socket = m_socketFactory->create(m_useSecureNetwork);
-		m_socket = dynamic_cast<TCPSocket*>(socket);
-
-		// filter socket messages, including a packetizing filter
-		m_stream = socket;
-		m_stream = new PacketStreamFilter(m_events, m_stream, true);
+	// race the servers in order, the first to say hello wins
+	LOG((CLOG_DEBUG1 "connecting to server"));
+	setupTimer();
+	m_nextAttempt  = 0;
+	m_attemptError = "";
+	startAttempt();
+}
 
-		// connect
-		LOG((CLOG_DEBUG1 "connecting to server"));
-		setupConnecting();
-		setupTimer();
-		socket->connect(m_serverAddress);
-	}
-	catch (XBase& e) {
-		cleanupTimer();
-		cleanupConnecting();
-		cleanupStream();
-		LOG((CLOG_DEBUG1 "connection failed"));
-		sendConnectionFailedEvent(e.what());
-		return;
-	}
+void
+Client::addServerAddress(const NetworkAddress& address)
+{
+	m_serverAddresses.push_back(address);
 }
 
 void
@@ -176,7 +163,7 @@ Client::disconnect(const char* msg)
 	m_connectOnResume = false;
 	cleanupTimer();
 	cleanupScreen();
-	cleanupConnecting();
+	cleanupAttempts();
 	cleanupConnection();
 	if (msg != NULL) {
 		sendConnectionFailedEvent(msg);
@@ -212,6 +199,12 @@ Client::getServerAddress() const
 	return m_serverAddress;
 }
 
+size_t
+Client::getNumServerAddresses() const
+{
+	return m_serverAddresses.size();
+}
+
 void*
 Client::getEventTarget() const
 {
@@ -247,6 +240,9 @@ Client::enter(SInt32 xAbs, SInt32 yAbs, UInt32, KeyModifierMask mask, bool)
 		StreamChunker::interruptFile();
 		m_sendFileThread = NULL;
 	}
+	if (m_server != NULL) {
+		m_server->interruptFiles();
+	}
 }
 
 bool
@@ -439,27 +435,100 @@ Client::sendFileChunk(const void* data)
 }
 
 void
-Client::setupConnecting()
+Client::startAttempt()
 {
-	assert(m_stream != NULL);
+	assert(m_timer != NULL);
+
+	while (m_nextAttempt < m_serverAddresses.size()) {
+		Attempt* attempt   = new Attempt;
+		attempt->m_address = m_serverAddresses[m_nextAttempt++];
+		attempt->m_stream  = NULL;
+		attempt->m_socket  = NULL;
+		try {
+			// resolve the server hostname.  do this every time we connect
+			// in case we couldn't resolve the address earlier or the address
+			// has changed (which can happen frequently if this is a laptop
+			// being shuttled between various networks).  patch by Brent
+			// Priddy.
+			attempt->m_address.resolve();
+
+			// the address will be null if the hostname is not resolved
+			if (attempt->m_address.getAddress() != NULL) {
+			  // to help users troubleshoot, show server host name (issue: 60)
+			  LOG((CLOG_NOTE "connecting to '%s': %s:%i", 
+			  attempt->m_address.getHostname().c_str(),
+			  ARCH->addrToString(attempt->m_address.getAddress()).c_str(),
+			  attempt->m_address.getPort()));
+			}
+
+			// create the socket
+			IDataSocket* socket = m_socketFactory->create(m_useSecureNetwork);
+			attempt->m_socket   = dynamic_cast<TCPSocket*>(socket);
+
+			// filter socket messages, including a packetizing filter
+			attempt->m_stream = new PacketStreamFilter(m_events, socket, true);
+			m_attempts.push_back(attempt);
+
+			// connect
+			void* target = attempt->m_stream->getEventTarget();
+			if (m_args.m_enableCrypto) {
+				m_events->adoptHandler(m_events->forIDataSocket().secureConnected(),
+							target,
+							new TMethodEventJob<Client>(this,
+								&Client::handleConnected, attempt));
+			}
+			else {
+				m_events->adoptHandler(m_events->forIDataSocket().connected(),
+							target,
+							new TMethodEventJob<Client>(this,
+								&Client::handleConnected, attempt));
+			}
+			m_events->adoptHandler(m_events->forIDataSocket().connectionFailed(),
+							target,
+							new TMethodEventJob<Client>(this,
+								&Client::handleConnectionFailed, attempt));
+			socket->connect(attempt->m_address);
+		}
+		catch (XBase& e) {
+			LOG((CLOG_DEBUG1 "connection failed: %s", e.what()));
+			m_attemptError = e.what();
+			cleanupAttempt(attempt);
+			continue;
+		}
 
-	if (m_args.m_enableCrypto) {
-		m_events->adoptHandler(m_events->forIDataSocket().secureConnected(),
-					m_stream->getEventTarget(),
-						new TMethodEventJob<Client>(this,
-								&Client::handleConnected));
+		// give this server a head start before racing the next one
+		if (m_nextAttempt < m_serverAddresses.size()) {
+			m_staggerTimer = m_events->newOneShotTimer(kConnectStagger, NULL);
+			m_events->adoptHandler(Event::kTimer, m_staggerTimer,
+							new TMethodEventJob<Client>(this,
+								&Client::handleConnectStagger));
+		}
+		return;
 	}
-	else {
-		m_events->adoptHandler(m_events->forIDataSocket().connected(),
-					m_stream->getEventTarget(),
-						new TMethodEventJob<Client>(this,
-								&Client::handleConnected));
+
+	// out of servers
+	if (m_attempts.empty()) {
+		cleanupTimer();
+		LOG((CLOG_DEBUG1 "connection failed"));
+		sendConnectionFailedEvent(m_attemptError.c_str());
 	}
+}
 
-	m_events->adoptHandler(m_events->forIDataSocket().connectionFailed(),
-							m_stream->getEventTarget(),
-							new TMethodEventJob<Client>(this,
-								&Client::handleConnectionFailed));
+void
+Client::failAttempt(void* vattempt, const char* msg)
+{
+	Attempt* attempt = static_cast<Attempt*>(vattempt);
+	LOG((CLOG_DEBUG1 "connection to %s:%i failed: %s",
+		attempt->m_address.getHostname().c_str(),
+		attempt->m_address.getPort(), msg));
+	m_attemptError = msg;
+	cleanupAttempt(attempt);
+
+	// try the next server now rather than waiting out its stagger
+	if (m_staggerTimer != NULL || m_attempts.empty()) {
+		cleanupStaggerTimer();
+		startAttempt();
+	}
 }
 
 void
@@ -471,10 +540,6 @@ Client::setupConnection()
 							m_stream->getEventTarget(),
 							new TMethodEventJob<Client>(this,
 								&Client::handleDisconnected));
-	m_events->adoptHandler(m_events->forIStream().inputReady(),
-							m_stream->getEventTarget(),
-							new TMethodEventJob<Client>(this,
-								&Client::handleHello));
 	m_events->adoptHandler(m_events->forIStream().outputError(),
 							m_stream->getEventTarget(),
 							new TMethodEventJob<Client>(this,
@@ -500,6 +565,7 @@ Client::setupScreen()
 
 	m_ready  = false;
 	m_server = new ServerProxy(this, m_stream, m_events);
+	m_server->setMotionSmoothing(m_args.m_smoothMotion);
 	m_events->adoptHandler(m_events->forIScreen().shapeChanged(),
 							getEventTarget(),
 							new TMethodEventJob<Client>(this,
@@ -522,13 +588,40 @@ Client::setupTimer()
 }
 
 void
-Client::cleanupConnecting()
+Client::cleanupAttempt(void* vattempt)
 {
-	if (m_stream != NULL) {
-		m_events->removeHandler(m_events->forIDataSocket().connected(),
-							m_stream->getEventTarget());
-		m_events->removeHandler(m_events->forIDataSocket().connectionFailed(),
-							m_stream->getEventTarget());
+	Attempt* attempt = static_cast<Attempt*>(vattempt);
+	if (attempt->m_stream != NULL) {
+		void* target = attempt->m_stream->getEventTarget();
+		m_events->removeHandler(m_events->forIDataSocket().connected(), target);
+		m_events->removeHandler(m_events->forIDataSocket().secureConnected(), target);
+		m_events->removeHandler(m_events->forIDataSocket().connectionFailed(), target);
+		m_events->removeHandler(m_events->forIStream().inputReady(), target);
+		m_events->removeHandler(m_events->forIStream().outputError(), target);
+		m_events->removeHandler(m_events->forIStream().inputShutdown(), target);
+		m_events->removeHandler(m_events->forISocket().disconnected(), target);
+		delete attempt->m_stream;
+	}
+	m_attempts.remove(attempt);
+	delete attempt;
+}
+
+void
+Client::cleanupAttempts()
+{
+	cleanupStaggerTimer();
+	while (!m_attempts.empty()) {
+		cleanupAttempt(m_attempts.front());
+	}
+}
+
+void
+Client::cleanupStaggerTimer()
+{
+	if (m_staggerTimer != NULL) {
+		m_events->removeHandler(Event::kTimer, m_staggerTimer);
+		m_events->deleteTimer(m_staggerTimer);
+		m_staggerTimer = NULL;
 	}
 }
 
@@ -584,34 +677,46 @@ Client::cleanupStream()
 {
 	delete m_stream;
 	m_stream = NULL;
+	m_socket = NULL;
 }
 
 void
-Client::handleConnected(const Event&, void*)
+Client::handleConnected(const Event&, void* vattempt)
 {
-	LOG((CLOG_DEBUG1 "connected;  wait for hello"));
-	cleanupConnecting();
-	setupConnection();
+	Attempt* attempt = static_cast<Attempt*>(vattempt);
+	LOG((CLOG_DEBUG1 "connected to %s:%i;  wait for hello",
+		attempt->m_address.getHostname().c_str(),
+		attempt->m_address.getPort()));
 
-	// reset clipboard state
-	for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
-		m_ownClipboard[id]  = false;
-		m_sentClipboard[id] = false;
-		m_timeClipboard[id] = 0;
-	}
+	void* target = attempt->m_stream->getEventTarget();
+	m_events->removeHandler(m_events->forIDataSocket().connected(), target);
+	m_events->removeHandler(m_events->forIDataSocket().secureConnected(), target);
+	m_events->removeHandler(m_events->forIDataSocket().connectionFailed(), target);
+	m_events->adoptHandler(m_events->forIStream().inputReady(),
+							target,
+							new TMethodEventJob<Client>(this,
+								&Client::handleHello, attempt));
+	m_events->adoptHandler(m_events->forIStream().outputError(),
+							target,
+							new TMethodEventJob<Client>(this,
+								&Client::handleAttemptClosed, attempt));
+	m_events->adoptHandler(m_events->forIStream().inputShutdown(),
+							target,
+							new TMethodEventJob<Client>(this,
+								&Client::handleAttemptClosed, attempt));
+	m_events->adoptHandler(m_events->forISocket().disconnected(),
+							target,
+							new TMethodEventJob<Client>(this,
+								&Client::handleAttemptClosed, attempt));
 }
 
 void
-Client::handleConnectionFailed(const Event& event, void*)
+Client::handleConnectionFailed(const Event& event, void* vattempt)
 {
 	IDataSocket::ConnectionFailedInfo* info =
 		static_cast<IDataSocket::ConnectionFailedInfo*>(event.getData());
 
-	cleanupTimer();
-	cleanupConnecting();
-	cleanupStream();
-	LOG((CLOG_DEBUG1 "connection failed"));
-	sendConnectionFailedEvent(info->m_what.c_str());
+	failAttempt(vattempt, info->m_what.c_str());
 	delete info;
 }
 
@@ -619,13 +724,18 @@ void
 Client::handleConnectTimeout(const Event&, void*)
 {
 	cleanupTimer();
-	cleanupConnecting();
-	cleanupConnection();
-	cleanupStream();
+	cleanupAttempts();
 	LOG((CLOG_DEBUG1 "connection timed out"));
 	sendConnectionFailedEvent("Timed out");
 }
 
+void
+Client::handleConnectStagger(const Event&, void*)
+{
+	cleanupStaggerTimer();
+	startAttempt();
+}
+
 void
 Client::handleOutputError(const Event&, void*)
 {
@@ -679,13 +789,12 @@ Client::handleClipboardGrabbed(const Event& event, void*)
 }
 
 void
-Client::handleHello(const Event&, void*)
+Client::handleHello(const Event&, void* vattempt)
 {
+	Attempt* attempt = static_cast<Attempt*>(vattempt);
 	SInt16 major, minor;
-	if (!ProtocolUtil::readf(m_stream, kMsgHello, &major, &minor)) {
-		sendConnectionFailedEvent("Protocol error from server, check encryption settings");
-		cleanupTimer();
-		cleanupConnection();
+	if (!ProtocolUtil::readf(attempt->m_stream, kMsgHello, &major, &minor)) {
+		failAttempt(attempt, "Protocol error from server, check encryption settings");
 		return;
 	}
 
@@ -693,12 +802,33 @@ Client::handleHello(const Event&, void*)
 	LOG((CLOG_DEBUG1 "got hello version %d.%d", major, minor));
 	if (major < kProtocolMajorVersion ||
 		(major == kProtocolMajorVersion && minor < kProtocolMinorVersion)) {
-		sendConnectionFailedEvent(XIncompatibleClient(major, minor).what());
-		cleanupTimer();
-		cleanupConnection();
+		failAttempt(attempt, XIncompatibleClient(major, minor).what());
 		return;
 	}
 
+	// this server wins.  take its stream and drop the others.
+	LOG((CLOG_DEBUG1 "using server %s:%i",
+		attempt->m_address.getHostname().c_str(),
+		attempt->m_address.getPort()));
+	m_stream           = attempt->m_stream;
+	m_socket           = attempt->m_socket;
+	m_serverAddress    = attempt->m_address;
+	attempt->m_stream  = NULL;
+	void* target       = m_stream->getEventTarget();
+	m_events->removeHandler(m_events->forIStream().inputReady(), target);
+	m_events->removeHandler(m_events->forIStream().outputError(), target);
+	m_events->removeHandler(m_events->forIStream().inputShutdown(), target);
+	m_events->removeHandler(m_events->forISocket().disconnected(), target);
+	cleanupAttempts();
+	setupConnection();
+
+	// reset clipboard state
+	for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
+		m_ownClipboard[id]  = false;
+		m_sentClipboard[id] = false;
+		m_timeClipboard[id] = 0;
+	}
+
 	// say hello back
 	LOG((CLOG_DEBUG1 "say hello version %d.%d", kProtocolMajorVersion, kProtocolMinorVersion));
 	ProtocolUtil::writef(m_stream, kMsgHelloBack,
@@ -718,6 +848,12 @@ Client::handleHello(const Event&, void*)
 	}
 }
 
+void
+Client::handleAttemptClosed(const Event&, void* vattempt)
+{
+	failAttempt(vattempt, "Disconnected before hello");
+}
+
 void
 Client::handleSuspend(const Event&, void*)
 {
@@ -754,6 +890,9 @@ Client::handleFileRecieveCompleted(const Event& event, void*)
 void
 Client::onFileRecieveCompleted()
 {
+	if (m_fileSetDropper->drop()) {
+		return;
+	}
 	if (isReceivedFileSizeValid()) {
 		m_writeToDropDirThread = new Thread(
 			new TMethodJob<Client>(
@@ -800,6 +939,12 @@ Client::isReceivedFileSizeValid()
 	return m_expectedFileSize == m_receivedFileData.size();
 }
 
+FileSetReceiver*
+Client::getReceivedFileSet() const
+{
+	return m_fileSetDropper->getReceived();
+}
+
 void
 Client::sendFileToServer(const char* filename)
 {
@@ -813,6 +958,28 @@ Client::sendFileToServer(const char* filename)
 			static_cast<void*>(const_cast<char*>(filename))));
 }
 
+bool
+Client::sendFilesToServer(const std::vector<String>& paths)
+{
+	if (m_server == NULL) {
+		return false;
+	}
+
+	m_server->sendFiles(paths);
+	return true;
+}
+
+void
+Client::fileSetChunkReceived(const FileSetChunk& chunk)
+{
+	if (!m_args.m_enableDragDrop) {
+		LOG((CLOG_DEBUG "drag drop not enabled, ignoring file set"));
+		return;
+	}
+
+	m_fileSetDropper->handle(chunk);
+}
+
 void
 Client::sendFileThread(void* filename)
 {
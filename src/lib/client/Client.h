@@ -27,6 +27,8 @@
 #include "net/NetworkAddress.h"
 #include "base/EventTypes.h"
 #include "mt/CondVar.h"
+#include "common/stdlist.h"
+#include "common/stdvector.h"
 
 class EventQueueTimer;
 namespace synergy { class Screen; }
@@ -37,6 +39,9 @@ namespace synergy { class IStream; }
 class IEventQueue;
 class Thread;
 class TCPSocket;
+class FileSetChunk;
+class FileSetReceiver;
+class FileSetDropper;
 
 //! Synergy client
 /*!
@@ -73,6 +78,15 @@ public:
 	*/
 	void				connect();
 
+	//! Add a standby server
+	/*!
+	Adds \p address to the servers to try, after those already
+	given.  Each connect() races the servers in order, starting the
+	next kConnectStagger seconds after the previous or as soon as it
+	fails, and keeps the first to say hello.
+	*/
+	void				addServerAddress(const NetworkAddress& address);
+
 	//! Disconnect
 	/*!
 	Disconnects from the server with an optional error message.
@@ -90,6 +104,16 @@ public:
 
 	//! Create a new thread and use it to send file to Server
 	void				sendFileToServer(const char* filename);
+
+	//! Send files to server
+	/*!
+	Sends \c paths, which may name files and directories, to the server
+	as a file set.  Returns false if not connected.
+	*/
+	bool				sendFilesToServer(const std::vector<String>& paths);
+
+	//! Received file set message from server
+	void				fileSetChunkReceived(const FileSetChunk& chunk);
 	
 	//! Send dragging file information back to server
 	void				sendDragInfo(UInt32 fileCount, String& info, size_t size);
@@ -118,6 +142,12 @@ public:
 	to connect) to.
 	*/
 	NetworkAddress		getServerAddress() const;
+
+	//! Get number of servers
+	/*!
+	Returns the number of servers the client tries when connecting.
+	*/
+	size_t				getNumServerAddresses() const;
 	
 	//! Return true if recieved file size is valid
 	bool				isReceivedFileSizeValid();
@@ -131,8 +161,17 @@ public:
 	//! Return drag file list
 	DragFileList		getDragFileList() { return m_dragFileList; }
 
+	//! Return received file set
+	/*!
+	Returns the last complete file set received from the server, or NULL.
+	*/
+	FileSetReceiver*	getReceivedFileSet() const;
+
 	//@}
 
+	//! Time between starting connections to successive servers
+	static const double	kConnectStagger;
+
 	// IScreen overrides
 	virtual void*		getEventTarget() const;
 	virtual bool		getClipboard(ClipboardID id, IClipboard*) const;
@@ -169,11 +208,14 @@ private:
 	void				sendFileChunk(const void* data);
 	void				sendFileThread(void*);
 	void				writeToDropDirThread(void*);
-	void				setupConnecting();
+	void				startAttempt();
+	void				failAttempt(void* attempt, const char* msg);
+	void				cleanupAttempt(void* attempt);
+	void				cleanupAttempts();
+	void				cleanupStaggerTimer();
 	void				setupConnection();
 	void				setupScreen();
 	void				setupTimer();
-	void				cleanupConnecting();
 	void				cleanupConnection();
 	void				cleanupScreen();
 	void				cleanupTimer();
@@ -181,11 +223,13 @@ private:
 	void				handleConnected(const Event&, void*);
 	void				handleConnectionFailed(const Event&, void*);
 	void				handleConnectTimeout(const Event&, void*);
+	void				handleConnectStagger(const Event&, void*);
 	void				handleOutputError(const Event&, void*);
 	void				handleDisconnected(const Event&, void*);
 	void				handleShapeChanged(const Event&, void*);
 	void				handleClipboardGrabbed(const Event&, void*);
 	void				handleHello(const Event&, void*);
+	void				handleAttemptClosed(const Event&, void*);
 	void				handleSuspend(const Event& event, void*);
 	void				handleResume(const Event& event, void*);
 	void				handleFileChunkSending(const Event&, void*);
@@ -198,8 +242,23 @@ public:
 	bool				m_mock;
 
 private:
+	// a connection to one of the servers racing the others
+	class Attempt {
+	public:
+		NetworkAddress		m_address;
+		synergy::IStream*	m_stream;
+		TCPSocket*			m_socket;
+	};
+	typedef std::vector<NetworkAddress> AddressList;
+	typedef std::list<Attempt*> AttemptList;
+
 	String				m_name;
 	NetworkAddress		m_serverAddress;
+	AddressList			m_serverAddresses;
+	AttemptList			m_attempts;
+	size_t				m_nextAttempt;
+	EventQueueTimer*	m_staggerTimer;
+	String				m_attemptError;
 	ISocketFactory*		m_socketFactory;
 	synergy::Screen*	m_screen;
 	synergy::IStream*	m_stream;
@@ -220,6 +279,7 @@ private:
 	String				m_dragFileExt;
 	Thread*				m_sendFileThread;
 	Thread*				m_writeToDropDirThread;
+	FileSetDropper*	m_fileSetDropper;
 	TCPSocket*			m_socket;
 	bool				m_useSecureNetwork;
 	ClientArgs			m_args;
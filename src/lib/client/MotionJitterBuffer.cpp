@@ -0,0 +1,170 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "client/MotionJitterBuffer.h"
+
+// arrivals further apart than this mean the mouse stopped, not jitter
+static const double		s_idleGap = 0.1;
+
+// arrivals more regular than this are delivered immediately
+static const double		s_cleanJitter = 0.002;
+
+// weight of the newest arrival in the running averages
+static const double		s_gain = 1.0 / 8.0;
+
+// limits on the pace of buffered motion
+static const double		s_minSpacing = 0.001;
+static const double		s_maxSpacing = 0.02;
+
+//
+// MotionJitterBuffer
+//
+
+const double			MotionJitterBuffer::kMaxDelay = 0.03;
+
+MotionJitterBuffer::MotionJitterBuffer(double maxDelay) :
+	m_maxDelay(maxDelay)
+{
+	reset();
+}
+
+bool
+MotionJitterBuffer::add(SInt32 x, SInt32 y, double now)
+{
+	// update the arrival statistics
+	if (m_lastArrival >= 0.0) {
+		double interval = now - m_lastArrival;
+		if (interval >= 0.0 && interval <= s_idleGap) {
+			if (m_interval == 0.0) {
+				m_interval = interval;
+			}
+			else {
+				double deviation = interval - m_interval;
+				if (deviation < 0.0) {
+					deviation = -deviation;
+				}
+				m_interval += s_gain * (interval - m_interval);
+				m_jitter   += s_gain * (deviation - m_jitter);
+			}
+		}
+	}
+	m_lastArrival = now;
+
+	// deliver now if nothing's waiting and either the link is clean or
+	// the motion isn't ahead of the pace
+	if (m_queue.empty() &&
+		(isClean() || now >= m_lastDelivery + getSpacing())) {
+		m_lastDelivery = now;
+		return true;
+	}
+
+	Motion motion;
+	motion.m_x       = x;
+	motion.m_y       = y;
+	motion.m_arrival = now;
+	m_queue.push_back(motion);
+	return false;
+}
+
+bool
+MotionJitterBuffer::next(double now, SInt32& x, SInt32& y)
+{
+	if (m_queue.empty()) {
+		return false;
+	}
+
+	// skip positions that can no longer be delivered within the
+	// latency ceiling, keeping the newest of them
+	while (m_queue.size() > 1 &&
+			m_queue[1].m_arrival + m_maxDelay <= now) {
+		m_queue.pop_front();
+	}
+
+	if (now < getDueTime()) {
+		return false;
+	}
+
+	x = m_queue.front().m_x;
+	y = m_queue.front().m_y;
+	m_queue.pop_front();
+	m_lastDelivery = now;
+	return true;
+}
+
+bool
+MotionJitterBuffer::flush(SInt32& x, SInt32& y)
+{
+	if (m_queue.empty()) {
+		return false;
+	}
+
+	x = m_queue.back().m_x;
+	y = m_queue.back().m_y;
+	m_queue.clear();
+	return true;
+}
+
+void
+MotionJitterBuffer::reset()
+{
+	m_queue.clear();
+	m_lastArrival  = -1.0;
+	m_lastDelivery = -1.0;
+	m_interval     = 0.0;
+	m_jitter       = 0.0;
+}
+
+double
+MotionJitterBuffer::getNextTime() const
+{
+	if (m_queue.empty()) {
+		return -1.0;
+	}
+	return getDueTime();
+}
+
+bool
+MotionJitterBuffer::isClean() const
+{
+	return (m_jitter <= s_cleanJitter);
+}
+
+double
+MotionJitterBuffer::getSpacing() const
+{
+	if (m_interval < s_minSpacing) {
+		return s_minSpacing;
+	}
+	if (m_interval > s_maxSpacing) {
+		return s_maxSpacing;
+	}
+	return m_interval;
+}
+
+double
+MotionJitterBuffer::getDueTime() const
+{
+	const Motion& head = m_queue.front();
+	double due = m_lastDelivery + getSpacing();
+	if (due < head.m_arrival) {
+		due = head.m_arrival;
+	}
+	if (due > head.m_arrival + m_maxDelay) {
+		due = head.m_arrival + m_maxDelay;
+	}
+	return due;
+}
@@ -0,0 +1,113 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/basic_types.h"
+#include "common/stddeque.h"
+
+//! Mouse motion jitter buffer
+/*!
+Smooths the delivery of absolute mouse motion received over a link
+that delivers it in bursts.  Arrivals are timestamped and their
+average spacing and jitter tracked.  While the link is clean motion is
+delivered as soon as it arrives.  When it's jittery, a burst is paced
+out at the average spacing instead of being injected at once, but no
+position is ever held longer than the latency ceiling;  positions
+that would be are dropped in favour of the newest overdue one.
+
+All times are in seconds.
+*/
+class MotionJitterBuffer {
+public:
+	//! Default latency ceiling
+	static const double	kMaxDelay;
+
+	MotionJitterBuffer(double maxDelay = kMaxDelay);
+
+	//! @name manipulators
+	//@{
+
+	//! Add motion
+	/*!
+	Records the arrival of position \c x,\c y at \c now.  Returns true
+	if the position should be delivered right away, false if it was
+	buffered for next().
+	*/
+	bool				add(SInt32 x, SInt32 y, double now);
+
+	//! Get due motion
+	/*!
+	Sets \c x,\c y to the next buffered position and returns true if
+	it's due for delivery at \c now, otherwise returns false.
+	*/
+	bool				next(double now, SInt32& x, SInt32& y);
+
+	//! Flush buffered motion
+	/*!
+	Empties the buffer.  Sets \c x,\c y to the newest buffered position
+	and returns true, or returns false if the buffer was empty.
+	*/
+	bool				flush(SInt32& x, SInt32& y);
+
+	//! Discard buffered motion and link statistics
+	void				reset();
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get time of next delivery
+	/*!
+	Returns when next() will next return a position, or a negative
+	value if the buffer is empty.
+	*/
+	double				getNextTime() const;
+
+	//! Test for a clean link
+	/*!
+	Returns true iff arrivals are regular enough to deliver immediately.
+	*/
+	bool				isClean() const;
+
+	//! Get average spacing of arrivals
+	double				getInterval() const { return m_interval; }
+
+	//! Get average deviation of arrival spacing
+	double				getJitter() const { return m_jitter; }
+
+	//@}
+
+private:
+	class Motion {
+	public:
+		SInt32			m_x, m_y;
+		double			m_arrival;
+	};
+	typedef std::deque<Motion> MotionQueue;
+
+	double				getSpacing() const;
+	double				getDueTime() const;
+
+private:
+	double				m_maxDelay;
+	MotionQueue			m_queue;
+	double				m_lastArrival;
+	double				m_lastDelivery;
+	double				m_interval;
+	double				m_jitter;
+};
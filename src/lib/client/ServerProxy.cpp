@@ -20,6 +20,7 @@
 
 #include "client/Client.h"
 #include "synergy/FileChunk.h"
+#include "synergy/FileSetChunk.h"
 #include "synergy/ClipboardChunk.h"
 #include "synergy/StreamChunker.h"
 #include "synergy/Clipboard.h"
@@ -27,6 +28,7 @@
 #include "synergy/option_types.h"
 #include "synergy/protocol_types.h"
 #include "io/IStream.h"
+#include "arch/Arch.h"
 #include "base/Log.h"
 #include "base/IEventQueue.h"
 #include "base/TMethodEventJob.h"
@@ -50,9 +52,13 @@ ServerProxy::ServerProxy(Client* client, synergy::IStream* stream, IEventQueue*
 	m_dyMouse(0),
 	m_ignoreMouse(false),
 	m_keepAliveAlarm(0.0),
-	m_keepAliveAlarmTimer(NULL),
+	m_heartbeatMonitor(HeartbeatMonitor::acquire(events)),
+	m_keepAliveAlarmPeer(NULL),
+	m_motionSmoothing(false),
+	m_motionTimer(NULL),
 	m_parser(&ServerProxy::parseHandshakeMessage),
-	m_events(events)
+	m_events(events),
+	m_fileSetSender(events, this)
 {
 	assert(m_client != NULL);
 	assert(m_stream != NULL);
@@ -72,13 +78,22 @@ ServerProxy::ServerProxy(Client* client, synergy::IStream* stream, IEventQueue*
 							new TMethodEventJob<ServerProxy>(this,
 								&ServerProxy::handleClipboardSendingEvent));
 
+	m_events->adoptHandler(m_events->forFile().fileSetChunkSending(),
+							this,
+							new TMethodEventJob<ServerProxy>(this,
+								&ServerProxy::handleFileSetSendingEvent));
+
 	// send heartbeat
 	setKeepAliveRate(kKeepAliveRate);
 }
 
 ServerProxy::~ServerProxy()
 {
+	cancelMotionTimer();
+	m_fileSetSender.interrupt();
+	m_events->removeHandler(m_events->forFile().fileSetChunkSending(), this);
 	setKeepAliveRate(-1.0);
+	m_heartbeatMonitor->release();
 	m_events->removeHandler(m_events->forIStream().inputReady(),
 							m_stream->getEventTarget());
 }
@@ -86,17 +101,9 @@ ServerProxy::~ServerProxy()
 void
 ServerProxy::resetKeepAliveAlarm()
 {
-	if (m_keepAliveAlarmTimer != NULL) {
-		m_events->removeHandler(Event::kTimer, m_keepAliveAlarmTimer);
-		m_events->deleteTimer(m_keepAliveAlarmTimer);
-		m_keepAliveAlarmTimer = NULL;
-	}
-	if (m_keepAliveAlarm > 0.0) {
-		m_keepAliveAlarmTimer =
-			m_events->newOneShotTimer(m_keepAliveAlarm, NULL);
-		m_events->adoptHandler(Event::kTimer, m_keepAliveAlarmTimer,
-							new TMethodEventJob<ServerProxy>(this,
-								&ServerProxy::handleKeepAliveAlarm));
+	// just note that we heard from the server
+	if (m_keepAliveAlarmPeer != NULL) {
+		m_keepAliveAlarmPeer->touch();
 	}
 }
 
@@ -104,15 +111,26 @@ void
 ServerProxy::setKeepAliveRate(double rate)
 {
 	m_keepAliveAlarm = rate * kKeepAlivesUntilDeath;
-	resetKeepAliveAlarm();
+
+	if (m_keepAliveAlarmPeer != NULL) {
+		m_heartbeatMonitor->remove(m_keepAliveAlarmPeer);
+		m_keepAliveAlarmPeer = NULL;
+	}
+	if (m_keepAliveAlarm > 0.0) {
+		m_keepAliveAlarmPeer = m_heartbeatMonitor->add(m_keepAliveAlarm, 0.0,
+							new TMethodEventJob<ServerProxy>(this,
+								&ServerProxy::handleKeepAliveAlarm),
+							NULL);
+	}
 }
 
 void
 ServerProxy::handleData(const Event&, void*)
 {
 	// handle messages until there are no more.  first read message code.
+	// messages are decoded in place when the stream has whole packets.
 	UInt8 code[4];
-	UInt32 n = m_stream->read(code, 4);
+	UInt32 n = ProtocolUtil::readCode(m_stream, code);
 	while (n != 0) {
 		// verify we got an entire code
 		if (n != 4) {
@@ -137,7 +155,7 @@ ServerProxy::handleData(const Event&, void*)
 		}
 
 		// next message
-		n = m_stream->read(code, 4);
+		n = ProtocolUtil::readCode(m_stream, code);
 	}
 
 	flushCompressedMouse();
@@ -273,6 +291,10 @@ ServerProxy::parseMessage(const UInt8* code)
 		grabClipboard();
 	}
 
+	else if (memcmp(code, kMsgCClipboardAck, 4) == 0) {
+		clipboardAck();
+	}
+
 	else if (memcmp(code, kMsgCScreenSaver, 4) == 0) {
 		screensaver();
 	}
@@ -300,6 +322,9 @@ ServerProxy::parseMessage(const UInt8* code)
 	else if (memcmp(code, kMsgDFileTransfer, 4) == 0) {
 		fileChunkReceived();
 	}
+	else if (memcmp(code, kMsgDFileSetTransfer, 4) == 0) {
+		fileSetChunkReceived();
+	}
 	else if (memcmp(code, kMsgDDragInfo, 4) == 0) {
 		dragInfoReceived();
 	}
@@ -360,8 +385,9 @@ ServerProxy::onGrabClipboard(ClipboardID id)
 void
 ServerProxy::onClipboardChanged(ClipboardID id, const IClipboard* clipboard)
 {
-	String data = IClipboard::marshall(clipboard);
-	LOG((CLOG_DEBUG "sending clipboard %d seqnum=%d", id, m_seqNum));
+	// send only what the server doesn't already have
+	String data = m_clipboardDelta[id].makeUpdate(clipboard);
+	LOG((CLOG_DEBUG "sending clipboard %d seqnum=%d size=%d", id, m_seqNum, data.size()));
 
 	StreamChunker::sendClipboard(data, data.size(), id, m_seqNum, m_events, this);
 }
@@ -371,7 +397,7 @@ ServerProxy::flushCompressedMouse()
 {
 	if (m_compressMouse) {
 		m_compressMouse = false;
-		m_client->mouseMove(m_xMouse, m_yMouse);
+		deliverMouseMove(m_xMouse, m_yMouse);
 	}
 	if (m_compressMouseRelative) {
 		m_compressMouseRelative = false;
@@ -381,6 +407,74 @@ ServerProxy::flushCompressedMouse()
 	}
 }
 
+void
+ServerProxy::flushMouse()
+{
+	flushCompressedMouse();
+	flushMotionBuffer();
+}
+
+void
+ServerProxy::flushMotionBuffer()
+{
+	cancelMotionTimer();
+
+	SInt32 x, y;
+	if (m_motionBuffer.flush(x, y)) {
+		m_client->mouseMove(x, y);
+	}
+}
+
+void
+ServerProxy::deliverMouseMove(SInt32 x, SInt32 y)
+{
+	if (!m_motionSmoothing || m_motionBuffer.add(x, y, ARCH->time())) {
+		m_client->mouseMove(x, y);
+	}
+	else if (m_motionTimer == NULL) {
+		scheduleMotionTimer();
+	}
+}
+
+void
+ServerProxy::scheduleMotionTimer()
+{
+	assert(m_motionTimer == NULL);
+
+	double delay = m_motionBuffer.getNextTime() - ARCH->time();
+	if (delay < 0.0) {
+		delay = 0.0;
+	}
+	m_motionTimer = m_events->newOneShotTimer(delay, NULL);
+	m_events->adoptHandler(Event::kTimer, m_motionTimer,
+							new TMethodEventJob<ServerProxy>(this,
+								&ServerProxy::handleMotionTimer));
+}
+
+void
+ServerProxy::cancelMotionTimer()
+{
+	if (m_motionTimer != NULL) {
+		m_events->removeHandler(Event::kTimer, m_motionTimer);
+		m_events->deleteTimer(m_motionTimer);
+		m_motionTimer = NULL;
+	}
+}
+
+void
+ServerProxy::handleMotionTimer(const Event&, void*)
+{
+	cancelMotionTimer();
+
+	SInt32 x, y;
+	while (m_motionBuffer.next(ARCH->time(), x, y)) {
+		m_client->mouseMove(x, y);
+	}
+	if (m_motionBuffer.getNextTime() >= 0.0) {
+		scheduleMotionTimer();
+	}
+}
+
 void
 ServerProxy::sendInfo(const ClientInfo& info)
 {
@@ -521,7 +615,10 @@ ServerProxy::enter()
 	ProtocolUtil::readf(m_stream, kMsgCEnter + 4, &x, &y, &seqNum, &mask);
 	LOG((CLOG_DEBUG1 "recv enter, %d,%d %d %04x", x, y, seqNum, mask));
 
-	// discard old compressed mouse motion, if any
+	// discard old compressed and buffered mouse motion, if any
+	SInt32 xMotion, yMotion;
+	cancelMotionTimer();
+	m_motionBuffer.flush(xMotion, yMotion);
 	m_compressMouse         = false;
 	m_compressMouseRelative = false;
 	m_dxMouse               = 0;
@@ -539,7 +636,7 @@ ServerProxy::leave()
 	LOG((CLOG_DEBUG1 "recv leave"));
 
 	// send last mouse motion
-	flushCompressedMouse();
+	flushMouse();
 
 	// forward
 	m_client->leave();
@@ -549,25 +646,58 @@ void
 ServerProxy::setClipboard()
 {
 	// parse
-	static String dataCached;
 	ClipboardID id;
 	UInt32 seq;
 	
-	int r = ClipboardChunk::assemble(m_stream, dataCached, id, seq);
+	int r = ClipboardChunk::assemble(m_stream, m_clipboardData, id, seq);
 
 	if (r == kStart) {
 		size_t size = ClipboardChunk::getExpectedSize();
 		LOG((CLOG_DEBUG "receiving clipboard %d size=%d", id, size));
 	}
 	else if (r == kFinish) {
-		LOG((CLOG_DEBUG "received clipboard %d size=%d", id, dataCached.size()));
-		
-		// forward
+		LOG((CLOG_DEBUG "received clipboard %d size=%d", id, m_clipboardData.size()));
+
+		// apply the update to what the server sent before
 		Clipboard clipboard;
-		clipboard.unmarshall(dataCached, 0);
-		m_client->setClipboard(id, &clipboard);
+		UInt32 version = 0;
+		bool applied = m_clipboardDelta[id].applyUpdate(m_clipboardData,
+							&clipboard, version);
+		m_clipboardData.clear();
+		ProtocolUtil::writef(m_stream, kMsgCClipboardAck,
+							id, version, applied ? 1 : 0);
+
+		// forward.  if we couldn't apply it the server will resend.
+		if (applied) {
+			m_client->setClipboard(id, &clipboard);
+			LOG((CLOG_INFO "clipboard was updated"));
+		}
+	}
+}
 
-		LOG((CLOG_INFO "clipboard was updated"));
+void
+ServerProxy::clipboardAck()
+{
+	// parse
+	ClipboardID id;
+	UInt32 version;
+	UInt8 applied;
+	if (!ProtocolUtil::readf(m_stream, kMsgCClipboardAck + 4,
+							&id, &version, &applied)) {
+		return;
+	}
+	LOG((CLOG_DEBUG2 "recv clipboard %d ack version=%d applied=%d", id, version, applied));
+
+	// ignore if id is out of range
+	if (id >= kClipboardEnd) {
+		return;
+	}
+
+	// resend everything if the server couldn't apply an update
+	if (!m_clipboardDelta[id].acknowledge(version, applied != 0)) {
+		String data = m_clipboardDelta[id].makeResync();
+		LOG((CLOG_DEBUG "resending clipboard %d seqnum=%d size=%d", id, m_seqNum, data.size()));
+		StreamChunker::sendClipboard(data, data.size(), id, m_seqNum, m_events, this);
 	}
 }
 
@@ -593,7 +723,7 @@ void
 ServerProxy::keyDown()
 {
 	// get mouse up to date
-	flushCompressedMouse();
+	flushMouse();
 
 	// parse
 	UInt16 id, mask, button;
@@ -616,7 +746,7 @@ void
 ServerProxy::keyRepeat()
 {
 	// get mouse up to date
-	flushCompressedMouse();
+	flushMouse();
 
 	// parse
 	UInt16 id, mask, count, button;
@@ -640,7 +770,7 @@ void
 ServerProxy::keyUp()
 {
 	// get mouse up to date
-	flushCompressedMouse();
+	flushMouse();
 
 	// parse
 	UInt16 id, mask, button;
@@ -663,7 +793,7 @@ void
 ServerProxy::mouseDown()
 {
 	// get mouse up to date
-	flushCompressedMouse();
+	flushMouse();
 
 	// parse
 	SInt8 id;
@@ -678,7 +808,7 @@ void
 ServerProxy::mouseUp()
 {
 	// get mouse up to date
-	flushCompressedMouse();
+	flushMouse();
 
 	// parse
 	SInt8 id;
@@ -718,7 +848,7 @@ ServerProxy::mouseMove()
 
 	// forward
 	if (!ignore) {
-		m_client->mouseMove(x, y);
+		deliverMouseMove(x, y);
 	}
 }
 
@@ -748,6 +878,7 @@ ServerProxy::mouseRelativeMove()
 
 	// forward
 	if (!ignore) {
+		flushMotionBuffer();
 		m_client->mouseRelativeMove(dx, dy);
 	}
 }
@@ -756,7 +887,7 @@ void
 ServerProxy::mouseWheel()
 {
 	// get mouse up to date
-	flushCompressedMouse();
+	flushMouse();
 
 	// parse
 	SInt16 xDelta, yDelta;
@@ -877,6 +1008,15 @@ ServerProxy::fileChunkReceived()
 	}
 }
 
+void
+ServerProxy::fileSetChunkReceived()
+{
+	FileSetChunk chunk;
+	if (chunk.read(m_stream)) {
+		m_client->fileSetChunkReceived(chunk);
+	}
+}
+
 void
 ServerProxy::dragInfoReceived()
 {
@@ -894,6 +1034,13 @@ ServerProxy::handleClipboardSendingEvent(const Event& event, void*)
 	ClipboardChunk::send(m_stream, event.getData());
 }
 
+void
+ServerProxy::handleFileSetSendingEvent(const Event& event, void*)
+{
+	static_cast<FileSetChunk*>(event.getDataObject())->send(m_stream);
+	m_fileSetSender.chunkSent();
+}
+
 void
 ServerProxy::fileChunkSending(UInt8 mark, char* data, size_t dataSize)
 {
@@ -906,3 +1053,24 @@ ServerProxy::sendDragInfo(UInt32 fileCount, const char* info, size_t size)
 	String data(info, size);
 	ProtocolUtil::writef(m_stream, kMsgDDragInfo, fileCount, &data);
 }
+
+void
+ServerProxy::sendFiles(const std::vector<String>& paths)
+{
+	m_fileSetSender.start(paths);
+}
+
+void
+ServerProxy::interruptFiles()
+{
+	m_fileSetSender.interrupt();
+}
+
+void
+ServerProxy::setMotionSmoothing(bool enabled)
+{
+	if (!enabled) {
+		flushMotionBuffer();
+	}
+	m_motionSmoothing = enabled;
+}
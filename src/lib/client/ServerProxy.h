@@ -18,18 +18,22 @@
 
 #pragma once
 
+#include "client/MotionJitterBuffer.h"
+#include "synergy/ClipboardDelta.h"
 #include "synergy/clipboard_types.h"
 #include "synergy/key_types.h"
+#include "synergy/HeartbeatMonitor.h"
+#include "synergy/FileSetSender.h"
 #include "base/Event.h"
 #include "base/Stopwatch.h"
 #include "base/String.h"
 
 class Client;
 class ClientInfo;
-class EventQueueTimer;
 class IClipboard;
 namespace synergy { class IStream; }
 class IEventQueue;
+class EventQueueTimer;
 
 //! Proxy for server
 /*!
@@ -59,6 +63,15 @@ public:
 
 	// sending dragging information to server
 	void				sendDragInfo(UInt32 fileCount, const char* info, size_t size);
+
+	// sending file set to server
+	void				sendFiles(const std::vector<String>& paths);
+
+	// stop sending file set to server
+	void				interruptFiles();
+
+	// smooth out bursty mouse motion
+	void				setMotionSmoothing(bool enabled);
 	
 #ifdef TEST_ENV
 	void				handleDataForTest() { handleData(Event(), NULL); }
@@ -73,6 +86,18 @@ private:
 	// if compressing mouse motion then send the last motion now
 	void				flushCompressedMouse();
 
+	// send compressed and buffered mouse motion now
+	void				flushMouse();
+
+	// send buffered mouse motion now
+	void				flushMotionBuffer();
+
+	// send mouse motion, through the jitter buffer if smoothing
+	void				deliverMouseMove(SInt32 x, SInt32 y);
+	void				scheduleMotionTimer();
+	void				cancelMotionTimer();
+	void				handleMotionTimer(const Event&, void*);
+
 	void				sendInfo(const ClientInfo&);
 
 	void				resetKeepAliveAlarm();
@@ -90,6 +115,7 @@ private:
 	void				enter();
 	void				leave();
 	void				setClipboard();
+	void				clipboardAck();
 	void				grabClipboard();
 	void				keyDown();
 	void				keyRepeat();
@@ -105,8 +131,10 @@ private:
 	void				queryInfo();
 	void				infoAcknowledgment();
 	void				fileChunkReceived();
+	void				fileSetChunkReceived();
 	void				dragInfoReceived();
 	void				handleClipboardSendingEvent(const Event&, void*);
+	void				handleFileSetSendingEvent(const Event&, void*);
 
 private:
 	typedef EResult (ServerProxy::*MessageParser)(const UInt8*);
@@ -126,8 +154,18 @@ private:
 	KeyModifierID		m_modifierTranslationTable[kKeyModifierIDLast];
 
 	double				m_keepAliveAlarm;
-	EventQueueTimer*	m_keepAliveAlarmTimer;
+	HeartbeatMonitor*	m_heartbeatMonitor;
+	HeartbeatMonitor::Peer*	m_keepAliveAlarmPeer;
+
+	bool				m_motionSmoothing;
+	MotionJitterBuffer	m_motionBuffer;
+	EventQueueTimer*	m_motionTimer;
 
 	MessageParser		m_parser;
 	IEventQueue*		m_events;
+	FileSetSender		m_fileSetSender;
+
+	// clipboard updates exchanged with the server
+	ClipboardDelta		m_clipboardDelta[kClipboardEnd];
+	String				m_clipboardData;
 };
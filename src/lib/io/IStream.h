@@ -86,6 +86,25 @@ public:
 	*/
 	virtual void		shutdownOutput() = 0;
 
+	//! Borrow the buffered frame
+	/*!
+	Framed streams receive data in whole frames (e.g. packets).  If a
+	complete frame is buffered this returns a pointer to its unread
+	bytes and sets \p size to their number, so it can be decoded in
+	place instead of with many small \c read() calls.  The memory stays
+	valid until the frame is released or the stream handles its next
+	input event.  Returns NULL if no frame is ready or the stream isn't
+	framed, in which case use \c read().
+	*/
+	virtual const UInt8*	lendFrame(UInt32& size) { size = 0; return NULL; }
+
+	//! Release the borrowed frame
+	/*!
+	Consumes the first \p n bytes of the frame returned by
+	\c lendFrame().  This is \c read(NULL, n) without the copy.
+	*/
+	virtual void		releaseFrame(UInt32 n) { read(NULL, n); }
+
 	//@}
 	//! @name accessors
 	//@{
@@ -80,6 +80,18 @@ StreamFilter::shutdownOutput()
 	getStream()->shutdownOutput();
 }
 
+const UInt8*
+StreamFilter::lendFrame(UInt32& size)
+{
+	return getStream()->lendFrame(size);
+}
+
+void
+StreamFilter::releaseFrame(UInt32 n)
+{
+	getStream()->releaseFrame(n);
+}
+
 void*
 StreamFilter::getEventTarget() const
 {
@@ -45,6 +45,8 @@ public:
 	virtual void		flush();
 	virtual void		shutdownInput();
 	virtual void		shutdownOutput();
+	virtual const UInt8*	lendFrame(UInt32& size);
+	virtual void		releaseFrame(UInt32 n);
 	virtual void*		getEventTarget() const;
 	virtual bool		isReady() const;
 	virtual UInt32		getSize() const;
@@ -22,6 +22,7 @@
 #include "ipc/IpcMessage.h"
 #include "ipc/Ipc.h"
 #include "ipc/IpcClientProxy.h"
+#include "mt/Lock.h"
 #include "mt/Thread.h"
 #include "arch/Arch.h"
 #include "arch/XArch.h"
@@ -39,7 +40,7 @@ enum EIpcLogOutputter {
 
 IpcLogOutputter::IpcLogOutputter(IpcServer& ipcServer, EIpcClientType clientType, bool useThread) :
 	m_ipcServer(ipcServer),
-	m_bufferMutex(ARCH->newMutex()),
+	m_bufferMutex("IpcLogOutputter"),
 	m_sending(false),
 	m_bufferThread(nullptr),
 	m_running(false),
@@ -64,8 +65,6 @@ IpcLogOutputter::~IpcLogOutputter()
 {
 	close();
 
-	ARCH->closeMutex(m_bufferMutex);
-
 	if (m_bufferThread != nullptr) {
 		m_bufferThread->cancel();
 		m_bufferThread->wait();
@@ -115,7 +114,7 @@ IpcLogOutputter::write(ELevel, const char* text)
 void
 IpcLogOutputter::appendBuffer(const String& text)
 {
-	ArchMutexLock lock(m_bufferMutex);
+	Lock lock(&m_bufferMutex, __FUNCTION__);
 
 	double elapsed = ARCH->time() - m_bufferRateStart;
 	if (elapsed < m_bufferRateTimeLimit) {
@@ -179,7 +178,7 @@ IpcLogOutputter::notifyBuffer()
 String
 IpcLogOutputter::getChunk(size_t count)
 {
-	ArchMutexLock lock(m_bufferMutex);
+	Lock lock(&m_bufferMutex, __FUNCTION__);
 
 	if (m_buffer.size() < count) {
 		count = m_buffer.size();
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include "mt/Mutex.h"
 #include "arch/Arch.h"
 #include "arch/IArchMultithread.h"
 #include "base/ILogOutputter.h"
@@ -100,7 +101,7 @@ private:
 
 	IpcServer&			m_ipcServer;
 	Buffer				m_buffer;
-	ArchMutex			m_bufferMutex;
+	Mutex				m_bufferMutex;
 	bool				m_sending;
 	Thread*				m_bufferThread;
 	bool				m_running;
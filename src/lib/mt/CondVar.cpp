@@ -81,7 +81,10 @@ CondVarBase::wait(Stopwatch& timer, double timeout) const
 bool
 CondVarBase::wait(double timeout) const
 {
-	return ARCH->waitCondVar(m_cond, m_mutex->m_mutex, timeout);
+	UInt32 depth = m_mutex->beginWait();
+	bool result  = ARCH->waitCondVar(m_cond, m_mutex->m_mutex, timeout);
+	m_mutex->endWait(depth);
+	return result;
 }
 
 Mutex*
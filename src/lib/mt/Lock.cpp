@@ -24,16 +24,16 @@
 // Lock
 //
 
-Lock::Lock(const Mutex* mutex) :
+Lock::Lock(const Mutex* mutex, const char* site) :
 	m_mutex(mutex)
 {
-	m_mutex->lock();
+	m_mutex->lock(site);
 }
 
-Lock::Lock(const CondVarBase* cv) :
+Lock::Lock(const CondVarBase* cv, const char* site) :
 	m_mutex(cv->getMutex())
 {
-	m_mutex->lock();
+	m_mutex->lock(site);
 }
 
 Lock::~Lock()
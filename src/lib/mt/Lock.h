@@ -33,9 +33,12 @@ exits (including by unwinding due to an exception).
 class Lock {
 public:
 	//! Lock the mutex \c mutex
-	Lock(const Mutex* mutex);
+	/*!
+	\c site names the caller when profiling, see Mutex::lock().
+	*/
+	Lock(const Mutex* mutex, const char* site = NULL);
 	//! Lock the condition variable \c cv
-	Lock(const CondVarBase* cv);
+	Lock(const CondVarBase* cv, const char* site = NULL);
 	//! Unlock the mutex or condition variable
 	~Lock();
 
@@ -18,18 +18,60 @@
 
 #include "mt/Mutex.h"
 
+#include "mt/MutexProfiler.h"
 #include "arch/Arch.h"
 
+#if defined(_MSC_VER)
+#	include <intrin.h>
+#endif
+
+// adaptive spinning follows the recent number of spins it took to get
+// the lock, bounded by this
+static const SInt32		s_maxSpins = 100;
+
+static
+void
+cpuRelax()
+{
+	// tell the cpu we're spinning so it can yield to a sibling thread
+#if defined(_MSC_VER)
+	_mm_pause();
+#elif defined(__i386__) || defined(__x86_64__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	__asm__ __volatile__("yield");
+#endif
+}
+
 //
 // Mutex
 //
 
-Mutex::Mutex()
+bool					Mutex::s_spinning = false;
+
+Mutex::Mutex() :
+	m_profile(NULL),
+	m_depth(0),
+	m_lockedAt(-1.0),
+	m_spinEstimate(0)
 {
 	m_mutex = ARCH->newMutex();
 }
 
-Mutex::Mutex(const Mutex&)
+Mutex::Mutex(const char* name) :
+	m_profile(MutexProfiler::getProfile(name)),
+	m_depth(0),
+	m_lockedAt(-1.0),
+	m_spinEstimate(0)
+{
+	m_mutex = ARCH->newMutex();
+}
+
+Mutex::Mutex(const Mutex& mutex) :
+	m_profile(mutex.m_profile),
+	m_depth(0),
+	m_lockedAt(-1.0),
+	m_spinEstimate(0)
 {
 	m_mutex = ARCH->newMutex();
 }
@@ -46,13 +88,115 @@ Mutex::operator=(const Mutex&)
 }
 
 void
-Mutex::lock() const
+Mutex::setSpinning(bool enabled)
+{
+	s_spinning = enabled;
+}
+
+void
+Mutex::lock(const char* site) const
 {
-	ARCH->lockMutex(m_mutex);
+	if (m_profile == NULL) {
+		ARCH->lockMutex(m_mutex);
+		return;
+	}
+
+	bool profiling = MutexProfiler::isEnabled();
+	if (!profiling && !s_spinning) {
+		ARCH->lockMutex(m_mutex);
+		++m_depth;
+		return;
+	}
+
+	double start   = profiling ? ARCH->time() : 0.0;
+	bool contended = false;
+	bool spun      = false;
+	if (!ARCH->tryLockMutex(m_mutex)) {
+		contended = true;
+		if (s_spinning) {
+			spun = lockSpinning();
+		}
+		else {
+			ARCH->lockMutex(m_mutex);
+		}
+	}
+
+	// time the hold from the outermost lock
+	double now = profiling ? ARCH->time() : -1.0;
+	if (m_depth++ == 0) {
+		m_lockedAt = now;
+	}
+	if (profiling) {
+		MutexProfiler::noteAcquired(m_profile, site,
+							now - start, contended, spun);
+	}
 }
 
 void
 Mutex::unlock() const
 {
+	if (m_profile != NULL && --m_depth == 0 && m_lockedAt >= 0.0) {
+		MutexProfiler::noteReleased(m_profile, ARCH->time() - m_lockedAt);
+		m_lockedAt = -1.0;
+	}
 	ARCH->unlockMutex(m_mutex);
 }
+
+bool
+Mutex::isSpinning()
+{
+	return s_spinning;
+}
+
+bool
+Mutex::lockSpinning() const
+{
+	// spin for up to about twice as long as it took recently then
+	// give up and block
+	SInt32 limit = (m_spinEstimate >> 2) + 10;
+	if (limit > s_maxSpins) {
+		limit = s_maxSpins;
+	}
+
+	SInt32 spins = 0;
+	bool locked  = false;
+	while (spins < limit && !locked) {
+		cpuRelax();
+		++spins;
+		locked = ARCH->tryLockMutex(m_mutex);
+	}
+	if (!locked) {
+		ARCH->lockMutex(m_mutex);
+	}
+
+	// we hold the lock so we can update the estimate.  it moves an
+	// eighth of the way toward this sample.
+	m_spinEstimate += spins - ((m_spinEstimate + 4) >> 3);
+	return locked;
+}
+
+UInt32
+Mutex::beginWait() const
+{
+	if (m_profile == NULL) {
+		return 0;
+	}
+	if (m_lockedAt >= 0.0) {
+		MutexProfiler::noteReleased(m_profile, ARCH->time() - m_lockedAt);
+	}
+
+	// other threads may lock while we wait so they must see it unlocked
+	UInt32 depth = m_depth;
+	m_depth      = 0;
+	m_lockedAt   = -1.0;
+	return depth;
+}
+
+void
+Mutex::endWait(UInt32 depth) const
+{
+	if (m_profile != NULL) {
+		m_depth    = depth;
+		m_lockedAt = MutexProfiler::isEnabled() ? ARCH->time() : -1.0;
+	}
+}
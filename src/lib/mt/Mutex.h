@@ -19,6 +19,9 @@
 #pragma once
 
 #include "arch/IArchMultithread.h"
+#include "common/basic_types.h"
+
+class MutexProfile;
 
 //! Mutual exclusion
 /*!
@@ -28,14 +31,23 @@ will block until the mutex is unlocked.  At that time, if any threads are
 blocked, exactly one waiting thread will acquire the lock and continue
 running.  A thread may not lock a mutex it already owns the lock on;  if
 it tries it will deadlock itself.
+
+A named mutex is profiled by MutexProfiler when that's enabled and, if
+spinning is enabled, spins briefly before blocking on a locked mutex.
+The spin adapts to how long the lock was recently held by others.
 */
 class Mutex {
 public:
 	Mutex();
-	//! Equivalent to default c'tor
+	//! Create a named mutex
+	/*!
+	Mutexes with the same name share profiling statistics.
+	*/
+	explicit Mutex(const char* name);
+	//! Equivalent to c'tor with the same name
 	/*!
-	Copy c'tor doesn't copy anything.  It just makes it possible to
-	copy objects that contain a mutex.
+	Copy c'tor doesn't copy anything but the name.  It just makes it
+	possible to copy objects that contain a mutex.
 	*/
 	Mutex(const Mutex&);
 	~Mutex();
@@ -50,6 +62,12 @@ public:
 	*/
 	Mutex&				operator=(const Mutex&);
 
+	//! Spin before blocking
+	/*!
+	Enables or disables spinning on every named mutex.
+	*/
+	static void			setSpinning(bool enabled);
+
 	//@}
 	//! @name accessors
 	//@{
@@ -58,11 +76,11 @@ public:
 	/*!
 	Locks the mutex, which must not have been previously locked by the
 	calling thread.  This blocks if the mutex is already locked by another
-	thread.
+	thread.  \c site names the caller when profiling.
 
 	(cancellation point)
 	*/
-	void				lock() const;
+	void				lock(const char* site = NULL) const;
 
 	//! Unlock the mutex
 	/*!
@@ -71,9 +89,30 @@ public:
 	*/
 	void				unlock() const;
 
+	//! Test if named mutexes spin
+	static bool			isSpinning();
+
 	//@}
 
 private:
 	friend class CondVarBase;
+
+	bool				lockSpinning() const;
+
+	// a condition variable wait releases the mutex without unlock().
+	// beginWait() returns the lock depth for endWait() to restore.
+	UInt32				beginWait() const;
+	void				endWait(UInt32 depth) const;
+
 	ArchMutex			m_mutex;
+	MutexProfile*		m_profile;
+
+	// only touched while locked
+	mutable UInt32		m_depth;
+	mutable double		m_lockedAt;
+
+	// in eighths of a spin so small changes aren't lost
+	mutable SInt32		m_spinEstimate;
+
+	static bool			s_spinning;
 };
@@ -0,0 +1,231 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mt/MutexProfiler.h"
+
+#include "arch/Arch.h"
+#include "base/Log.h"
+
+#include <algorithm>
+
+//
+// MutexProfile
+//
+
+class MutexProfile {
+public:
+	MutexProfile(const char* name) :
+		m_mutex(ARCH->newMutex())
+	{
+		m_stats.m_name = name;
+	}
+
+	ArchMutex			m_mutex;
+	MutexStats			m_stats;
+};
+
+typedef std::map<String, MutexProfile*> ProfileMap;
+
+// profiles are never destroyed because mutexes keep pointers to them.
+// the registry is created by the first named mutex, which is expected
+// to be created before any threads are started.
+static ArchMutex		s_profilesMutex = NULL;
+static ProfileMap*		s_profiles      = NULL;
+static volatile bool	s_enabled       = false;
+
+static
+bool
+longerWait(const MutexStats& a, const MutexStats& b)
+{
+	return (a.m_waitTime > b.m_waitTime);
+}
+
+//
+// MutexStats
+//
+
+MutexStats::Site::Site() :
+	m_acquisitions(0),
+	m_contended(0),
+	m_waitTime(0.0)
+{
+	// do nothing
+}
+
+MutexStats::MutexStats() :
+	m_acquisitions(0),
+	m_contended(0),
+	m_spun(0),
+	m_waitTime(0.0),
+	m_maxWait(0.0),
+	m_holdTime(0.0),
+	m_maxHold(0.0)
+{
+	// do nothing
+}
+
+//
+// MutexProfiler
+//
+
+void
+MutexProfiler::setEnabled(bool enabled)
+{
+	s_enabled = enabled;
+}
+
+void
+MutexProfiler::reset()
+{
+	if (s_profiles == NULL) {
+		return;
+	}
+
+	ArchMutexLock lock(s_profilesMutex);
+	for (ProfileMap::iterator i = s_profiles->begin();
+							i != s_profiles->end(); ++i) {
+		MutexProfile* profile = i->second;
+		ArchMutexLock profileLock(profile->m_mutex);
+		MutexStats empty;
+		empty.m_name     = profile->m_stats.m_name;
+		profile->m_stats = empty;
+	}
+}
+
+bool
+MutexProfiler::isEnabled()
+{
+	return s_enabled;
+}
+
+bool
+MutexProfiler::getStats(const String& name, MutexStats& stats)
+{
+	if (s_profiles == NULL) {
+		return false;
+	}
+
+	ArchMutexLock lock(s_profilesMutex);
+	ProfileMap::const_iterator i = s_profiles->find(name);
+	if (i == s_profiles->end()) {
+		return false;
+	}
+	ArchMutexLock profileLock(i->second->m_mutex);
+	stats = i->second->m_stats;
+	return true;
+}
+
+MutexProfiler::StatsList
+MutexProfiler::getAllStats()
+{
+	StatsList result;
+	if (s_profiles == NULL) {
+		return result;
+	}
+
+	{
+		ArchMutexLock lock(s_profilesMutex);
+		for (ProfileMap::const_iterator i = s_profiles->begin();
+							i != s_profiles->end(); ++i) {
+			ArchMutexLock profileLock(i->second->m_mutex);
+			result.push_back(i->second->m_stats);
+		}
+	}
+	std::stable_sort(result.begin(), result.end(), &longerWait);
+	return result;
+}
+
+String
+MutexProfiler::format()
+{
+	StatsList all = getAllStats();
+	String report = synergy::string::sprintf(
+							"lock contention for %d locks%s:",
+							static_cast<int>(all.size()),
+							s_enabled ? "" : " (profiling is off)");
+	for (StatsList::const_iterator i = all.begin(); i != all.end(); ++i) {
+		report += synergy::string::sprintf(
+			"\n  %s: %u acquired, %u contended, %u by spinning, "
+			"wait %.3fms max %.3fms, hold %.3fms max %.3fms",
+			i->m_name.c_str(), i->m_acquisitions, i->m_contended, i->m_spun,
+			1000.0 * i->m_waitTime, 1000.0 * i->m_maxWait,
+			1000.0 * i->m_holdTime, 1000.0 * i->m_maxHold);
+		for (MutexStats::SiteMap::const_iterator j = i->m_sites.begin();
+							j != i->m_sites.end(); ++j) {
+			report += synergy::string::sprintf(
+				"\n    %s: %u acquired, %u contended, wait %.3fms",
+				j->first.c_str(), j->second.m_acquisitions,
+				j->second.m_contended, 1000.0 * j->second.m_waitTime);
+		}
+	}
+	return report;
+}
+
+void
+MutexProfiler::log()
+{
+	LOG((CLOG_NOTE "%s", format().c_str()));
+}
+
+MutexProfile*
+MutexProfiler::getProfile(const char* name)
+{
+	if (s_profiles == NULL) {
+		s_profilesMutex = ARCH->newMutex();
+		s_profiles      = new ProfileMap;
+	}
+
+	ArchMutexLock lock(s_profilesMutex);
+	MutexProfile*& profile = (*s_profiles)[name];
+	if (profile == NULL) {
+		profile = new MutexProfile(name);
+	}
+	return profile;
+}
+
+void
+MutexProfiler::noteAcquired(MutexProfile* profile, const char* site,
+				double wait, bool contended, bool spun)
+{
+	ArchMutexLock lock(profile->m_mutex);
+	MutexStats& stats = profile->m_stats;
+	++stats.m_acquisitions;
+	stats.m_waitTime += wait;
+	stats.m_maxWait   = std::max(stats.m_maxWait, wait);
+	if (contended) {
+		++stats.m_contended;
+	}
+	if (spun) {
+		++stats.m_spun;
+	}
+
+	MutexStats::Site& siteStats = stats.m_sites[site != NULL ? site : "unknown"];
+	++siteStats.m_acquisitions;
+	siteStats.m_waitTime += wait;
+	if (contended) {
+		++siteStats.m_contended;
+	}
+}
+
+void
+MutexProfiler::noteReleased(MutexProfile* profile, double hold)
+{
+	ArchMutexLock lock(profile->m_mutex);
+	MutexStats& stats = profile->m_stats;
+	stats.m_holdTime += hold;
+	stats.m_maxHold   = std::max(stats.m_maxHold, hold);
+}
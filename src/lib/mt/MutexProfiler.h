@@ -0,0 +1,113 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/String.h"
+#include "common/basic_types.h"
+#include "common/stdmap.h"
+#include "common/stdvector.h"
+
+class MutexProfile;
+
+//! Contention statistics for a lock name
+class MutexStats {
+public:
+	//! Statistics for one acquisition site
+	class Site {
+	public:
+		Site();
+
+		UInt32			m_acquisitions;
+		UInt32			m_contended;
+		double			m_waitTime;
+	};
+	typedef std::map<String, Site> SiteMap;
+
+	MutexStats();
+
+	String				m_name;
+	UInt32				m_acquisitions;
+	UInt32				m_contended;
+	UInt32				m_spun;
+	double				m_waitTime;
+	double				m_maxWait;
+	double				m_holdTime;
+	double				m_maxHold;
+	SiteMap				m_sites;
+};
+
+//! Lock contention profiler
+/*!
+Collects wait time, hold time and acquisition sites for every named
+Mutex while enabled.  Mutexes with the same name share statistics so,
+for example, every instance of a class adds up under one name.
+
+An acquisition is contended if the mutex couldn't be locked at the
+first attempt.  Times are in seconds and a site is whatever the caller
+passed to Mutex::lock(), or "unknown".  Collecting costs two clock
+reads and a short lock per acquisition, so it's off by default.
+*/
+class MutexProfiler {
+public:
+	typedef std::vector<MutexStats> StatsList;
+
+	//! @name manipulators
+	//@{
+
+	//! Start or stop collecting
+	static void			setEnabled(bool enabled);
+
+	//! Clear the statistics of every lock
+	static void			reset();
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Test if collecting
+	static bool			isEnabled();
+
+	//! Get the statistics for a lock name
+	/*!
+	Returns false if no mutex of that name was ever created.
+	*/
+	static bool			getStats(const String& name, MutexStats&);
+
+	//! Get the statistics for every lock
+	/*!
+	Returns them longest total wait first.
+	*/
+	static StatsList	getAllStats();
+
+	//! Format a report
+	static String		format();
+
+	//! Write a report to the log
+	static void			log();
+
+	//@}
+
+private:
+	friend class Mutex;
+
+	static MutexProfile*
+						getProfile(const char* name);
+	static void			noteAcquired(MutexProfile*, const char* site,
+							double wait, bool contended, bool spun);
+	static void			noteReleased(MutexProfile*, double hold);
+};
@@ -0,0 +1,50 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "net/ArchSocketPoller.h"
+
+#include "mt/Thread.h"
+#include "arch/Arch.h"
+
+//
+// ArchSocketPoller
+//
+
+ArchSocketPoller::ArchSocketPoller()
+{
+	// do nothing
+}
+
+ArchSocketPoller::~ArchSocketPoller()
+{
+	// do nothing
+}
+
+int
+ArchSocketPoller::poll(PollEntries& entries, bool)
+{
+	if (entries.empty()) {
+		return 0;
+	}
+	return ARCH->pollSocket(&entries[0], (int)entries.size(), -1);
+}
+
+void
+ArchSocketPoller::unblock(Thread* serviceThread)
+{
+	serviceThread->unblockPollSocket();
+}
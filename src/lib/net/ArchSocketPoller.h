@@ -0,0 +1,35 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "net/ISocketPoller.h"
+
+//! Portable socket poller
+/*!
+A socket poller that uses \c ARCH->pollSocket().  This is the default
+poller and is available on every platform.
+*/
+class ArchSocketPoller : public ISocketPoller {
+public:
+	ArchSocketPoller();
+	virtual ~ArchSocketPoller();
+
+	// ISocketPoller overrides
+	virtual int			poll(PollEntries& entries, bool changed);
+	virtual void		unblock(Thread* serviceThread);
+};
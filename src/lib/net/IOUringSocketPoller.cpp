@@ -0,0 +1,493 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "net/IOUringSocketPoller.h"
+
+#include "arch/Arch.h"
+#include "arch/XArch.h"
+#include "base/Log.h"
+
+#if HAVE_LINUX_IO_URING
+
+#include "arch/unix/XArchUnix.h"
+
+#include <linux/io_uring.h>
+#include <linux/swab.h>
+#include <endian.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <cstring>
+
+// number of submission queue entries.  the completion queue is twice
+// this size and the kernel keeps overflowing completions for us.
+static const UInt32 kRingEntries = 256;
+
+// reserved tokens.  socket tokens start after these.
+static const unsigned long long kWakeToken   = 1;
+static const unsigned long long kRemoveToken = 2;
+static const unsigned long long kFirstToken  = 3;
+
+static
+int
+sysIOUringSetup(unsigned entries, struct io_uring_params* p)
+{
+	return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static
+int
+sysIOUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags)
+{
+	return (int)syscall(__NR_io_uring_enter, fd, toSubmit, minComplete,
+							flags, NULL, 0);
+}
+
+static
+__u32
+toPollMask(unsigned events)
+{
+#if __BYTE_ORDER == __BIG_ENDIAN
+	// the kernel swaps the half words of the 32-bit mask
+	return __swahw32(events);
+#else
+	return events;
+#endif
+}
+
+//
+// IOUringSocketPoller
+//
+
+IOUringSocketPoller::IOUringSocketPoller() :
+	m_ring(-1),
+	m_wakeFd(-1),
+	m_wakeArmed(false),
+	m_nextToken(kFirstToken),
+	m_pending(0),
+	m_sqRing(MAP_FAILED),
+	m_sqRingSize(0),
+	m_cqRing(MAP_FAILED),
+	m_cqRingSize(0),
+	m_sqes(MAP_FAILED),
+	m_sqesSize(0),
+	m_sqHead(NULL),
+	m_sqTail(NULL),
+	m_sqMask(NULL),
+	m_sqArray(NULL),
+	m_cqHead(NULL),
+	m_cqTail(NULL),
+	m_cqMask(NULL),
+	m_cqes(NULL)
+{
+	// do nothing
+}
+
+IOUringSocketPoller::~IOUringSocketPoller()
+{
+	cleanup();
+}
+
+IOUringSocketPoller*
+IOUringSocketPoller::create()
+{
+	IOUringSocketPoller* poller = new IOUringSocketPoller;
+	if (!poller->init(kRingEntries)) {
+		delete poller;
+		return NULL;
+	}
+	return poller;
+}
+
+bool
+IOUringSocketPoller::init(UInt32 entries)
+{
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+
+	m_ring = sysIOUringSetup(entries, &params);
+	if (m_ring == -1) {
+		LOG((CLOG_DEBUG "io_uring not available: %s", strerror(errno)));
+		return false;
+	}
+
+	// map the rings.  newer kernels share one mapping for both.
+	m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	m_cqRingSize = params.cq_off.cqes +
+					params.cq_entries * sizeof(struct io_uring_cqe);
+	bool singleMap = ((params.features & IORING_FEAT_SINGLE_MMAP) != 0);
+	if (singleMap && m_cqRingSize > m_sqRingSize) {
+		m_sqRingSize = m_cqRingSize;
+	}
+
+	m_sqRing = mmap(NULL, m_sqRingSize, PROT_READ | PROT_WRITE,
+					MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQ_RING);
+	if (m_sqRing == MAP_FAILED) {
+		LOG((CLOG_DEBUG "io_uring sq ring map failed: %s", strerror(errno)));
+		return false;
+	}
+
+	if (singleMap) {
+		m_cqRing     = m_sqRing;
+		m_cqRingSize = 0;
+	}
+	else {
+		m_cqRing = mmap(NULL, m_cqRingSize, PROT_READ | PROT_WRITE,
+					MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_CQ_RING);
+		if (m_cqRing == MAP_FAILED) {
+			LOG((CLOG_DEBUG "io_uring cq ring map failed: %s", strerror(errno)));
+			return false;
+		}
+	}
+
+	m_sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+	m_sqes     = mmap(NULL, m_sqesSize, PROT_READ | PROT_WRITE,
+					MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQES);
+	if (m_sqes == MAP_FAILED) {
+		LOG((CLOG_DEBUG "io_uring sqe map failed: %s", strerror(errno)));
+		return false;
+	}
+
+	char* sq   = static_cast<char*>(m_sqRing);
+	m_sqHead   = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+	m_sqTail   = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+	m_sqMask   = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+	m_sqArray  = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+	char* cq   = static_cast<char*>(m_cqRing);
+	m_cqHead   = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+	m_cqTail   = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+	m_cqMask   = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+	m_cqes     = cq + params.cq_off.cqes;
+
+	// the wake fd lets other threads break us out of io_uring_enter()
+	m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (m_wakeFd == -1) {
+		LOG((CLOG_DEBUG "io_uring wake fd failed: %s", strerror(errno)));
+		return false;
+	}
+	armWake();
+
+	LOG((CLOG_DEBUG "using io_uring socket poller"));
+	return true;
+}
+
+void
+IOUringSocketPoller::cleanup()
+{
+	for (ArmedMap::iterator i = m_armed.begin(); i != m_armed.end(); ++i) {
+		try {
+			ARCH->closeSocket(i->first);
+		}
+		catch (XArchNetwork&) {
+			// ignore
+		}
+	}
+	m_armed.clear();
+	m_tokens.clear();
+	m_index.clear();
+
+	if (m_sqes != MAP_FAILED) {
+		munmap(m_sqes, m_sqesSize);
+		m_sqes = MAP_FAILED;
+	}
+	if (m_cqRing != MAP_FAILED && m_cqRing != m_sqRing) {
+		munmap(m_cqRing, m_cqRingSize);
+	}
+	m_cqRing = MAP_FAILED;
+	if (m_sqRing != MAP_FAILED) {
+		munmap(m_sqRing, m_sqRingSize);
+		m_sqRing = MAP_FAILED;
+	}
+	if (m_wakeFd != -1) {
+		close(m_wakeFd);
+		m_wakeFd = -1;
+	}
+	if (m_ring != -1) {
+		close(m_ring);
+		m_ring = -1;
+	}
+}
+
+int
+IOUringSocketPoller::poll(PollEntries& entries, bool changed)
+{
+	if (changed) {
+		updateArmed(entries);
+	}
+
+	// nothing to wait for
+	if (entries.empty()) {
+		submitPending(false);
+		return 0;
+	}
+
+	// re-arm sockets that were reported last time.  their jobs have
+	// run since so the kernel checks their current state, which keeps
+	// the semantics level triggered.
+	for (ArmedMap::iterator i = m_armed.begin(); i != m_armed.end(); ++i) {
+		if (i->second.m_fired) {
+			arm(i->first, i->second);
+		}
+	}
+	if (!m_wakeArmed) {
+		armWake();
+	}
+
+	for (PollEntries::iterator i = entries.begin(); i != entries.end(); ++i) {
+		i->m_revents = 0;
+	}
+
+	// submit new requests and wait for at least one completion
+	submitPending(true);
+
+	// reap completions
+	int n = 0;
+	unsigned head = *m_cqHead;
+	unsigned tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+	struct io_uring_cqe* cqes = static_cast<struct io_uring_cqe*>(m_cqes);
+	for (; head != tail; ++head) {
+		const struct io_uring_cqe& cqe = cqes[head & *m_cqMask];
+
+		if (cqe.user_data == kWakeToken) {
+			// the unblock event was signalled.  drain the counter.
+			eventfd_t value;
+			eventfd_read(m_wakeFd, &value);
+			m_wakeArmed = false;
+			continue;
+		}
+
+		TokenMap::iterator t = m_tokens.find(cqe.user_data);
+		if (t == m_tokens.end()) {
+			// completion for a removed or replaced request
+			continue;
+		}
+		ArchSocket socket = t->second;
+		m_tokens.erase(t);
+
+		ArmedMap::iterator a = m_armed.find(socket);
+		IndexMap::iterator x = m_index.find(socket);
+		if (a == m_armed.end() || x == m_index.end()) {
+			continue;
+		}
+		a->second.m_fired = true;
+
+		IArchNetwork::PollEntry& pe = entries[x->second];
+		if (cqe.res < 0) {
+			pe.m_revents |= IArchNetwork::kPOLLNVAL;
+		}
+		else {
+			if ((cqe.res & POLLIN) != 0) {
+				pe.m_revents |= IArchNetwork::kPOLLIN;
+			}
+			if ((cqe.res & POLLOUT) != 0) {
+				pe.m_revents |= IArchNetwork::kPOLLOUT;
+			}
+			if ((cqe.res & POLLERR) != 0) {
+				pe.m_revents |= IArchNetwork::kPOLLERR;
+			}
+			if ((cqe.res & POLLNVAL) != 0) {
+				pe.m_revents |= IArchNetwork::kPOLLNVAL;
+			}
+		}
+		if (pe.m_revents != 0) {
+			++n;
+		}
+	}
+	__atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+
+	return n;
+}
+
+void
+IOUringSocketPoller::unblock(Thread*)
+{
+	eventfd_write(m_wakeFd, 1);
+}
+
+void
+IOUringSocketPoller::updateArmed(const PollEntries& entries)
+{
+	// index the new socket set
+	m_index.clear();
+	for (size_t i = 0; i < entries.size(); ++i) {
+		if (entries[i].m_socket != NULL) {
+			m_index[entries[i].m_socket] = i;
+		}
+	}
+
+	// drop requests for sockets that went away or want other events
+	for (ArmedMap::iterator i = m_armed.begin(); i != m_armed.end();) {
+		IndexMap::iterator x = m_index.find(i->first);
+		if (x == m_index.end() ||
+			entries[x->second].m_events != i->second.m_events) {
+			disarm(i++);
+		}
+		else {
+			++i;
+		}
+	}
+
+	// add requests for new sockets
+	for (IndexMap::iterator x = m_index.begin(); x != m_index.end(); ++x) {
+		if (m_armed.find(x->first) == m_armed.end()) {
+			// hold a reference so the socket can't be closed and its
+			// fd reused while the kernel still has our request
+			ArchSocket socket = ARCH->copySocket(x->first);
+			Armed& armed      = m_armed[socket];
+			armed.m_token     = 0;
+			armed.m_events    = entries[x->second].m_events;
+			armed.m_fired     = false;
+			arm(socket, armed);
+		}
+	}
+}
+
+void
+IOUringSocketPoller::arm(ArchSocket socket, Armed& armed)
+{
+	struct io_uring_sqe* sqe = static_cast<struct io_uring_sqe*>(getSqe());
+
+	unsigned events = 0;
+	if ((armed.m_events & IArchNetwork::kPOLLIN) != 0) {
+		events |= POLLIN;
+	}
+	if ((armed.m_events & IArchNetwork::kPOLLOUT) != 0) {
+		events |= POLLOUT;
+	}
+
+	armed.m_token = m_nextToken++;
+	armed.m_fired = false;
+	m_tokens[armed.m_token] = socket;
+
+	sqe->opcode        = IORING_OP_POLL_ADD;
+	sqe->fd            = socket->m_fd;
+	sqe->poll32_events = toPollMask(events);
+	sqe->user_data     = armed.m_token;
+}
+
+void
+IOUringSocketPoller::disarm(ArmedMap::iterator i)
+{
+	// a request that fired has already completed
+	if (!i->second.m_fired) {
+		struct io_uring_sqe* sqe = static_cast<struct io_uring_sqe*>(getSqe());
+		sqe->opcode    = IORING_OP_POLL_REMOVE;
+		sqe->fd        = -1;
+		sqe->addr      = i->second.m_token;
+		sqe->user_data = kRemoveToken;
+	}
+	m_tokens.erase(i->second.m_token);
+
+	try {
+		ARCH->closeSocket(i->first);
+	}
+	catch (XArchNetwork& e) {
+		LOG((CLOG_WARN "error closing socket: %s", e.what()));
+	}
+	m_armed.erase(i);
+}
+
+void
+IOUringSocketPoller::armWake()
+{
+	struct io_uring_sqe* sqe = static_cast<struct io_uring_sqe*>(getSqe());
+	sqe->opcode        = IORING_OP_POLL_ADD;
+	sqe->fd            = m_wakeFd;
+	sqe->poll32_events = toPollMask(POLLIN);
+	sqe->user_data     = kWakeToken;
+	m_wakeArmed        = true;
+}
+
+void*
+IOUringSocketPoller::getSqe()
+{
+	unsigned tail = *m_sqTail;
+	if (tail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE) > *m_sqMask) {
+		// queue is full.  hand what we have to the kernel.
+		submitPending(false);
+		tail = *m_sqTail;
+	}
+
+	unsigned index = tail & *m_sqMask;
+	struct io_uring_sqe* sqe = static_cast<struct io_uring_sqe*>(m_sqes) + index;
+	memset(sqe, 0, sizeof(*sqe));
+
+	m_sqArray[index] = index;
+	__atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+	++m_pending;
+	return sqe;
+}
+
+void
+IOUringSocketPoller::submitPending(bool wait)
+{
+	for (;;) {
+		unsigned flags = wait ? IORING_ENTER_GETEVENTS : 0;
+		int n = sysIOUringEnter(m_ring, m_pending, wait ? 1 : 0, flags);
+		if (n >= 0) {
+			m_pending -= (UInt32)n;
+			return;
+		}
+
+		int err = errno;
+		if (err == EINTR) {
+			// interrupted system call
+			ARCH->testCancelThread();
+			if (wait) {
+				return;
+			}
+		}
+		else if (err == EAGAIN || err == EBUSY) {
+			// the completion queue is backed up.  callers reap it.
+			return;
+		}
+		else {
+			throw XArchNetwork(new XArchEvalUnix(err));
+		}
+	}
+}
+
+#else // !HAVE_LINUX_IO_URING
+
+IOUringSocketPoller::~IOUringSocketPoller()
+{
+	// do nothing
+}
+
+IOUringSocketPoller*
+IOUringSocketPoller::create()
+{
+	return NULL;
+}
+
+int
+IOUringSocketPoller::poll(PollEntries&, bool)
+{
+	return 0;
+}
+
+void
+IOUringSocketPoller::unblock(Thread*)
+{
+	// do nothing
+}
+
+#endif
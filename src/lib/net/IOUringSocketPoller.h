@@ -0,0 +1,108 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "net/ISocketPoller.h"
+#include "common/basic_types.h"
+#include "common/stdmap.h"
+
+//! io_uring socket poller
+/*!
+A socket poller for Linux that keeps a poll request armed in an
+io_uring for each serviced socket.  Unlike pollSocket(), which hands
+the whole socket set to the kernel on every call, this only submits
+requests for sockets that were added, changed or became ready since the
+previous call, and a single \c io_uring_enter() both submits them and
+waits for completions.
+
+Poll requests are one-shot and re-armed after the socket's job has run,
+so readiness is level triggered just like \c poll().  Use create() to
+get an instance;  it returns NULL when the kernel (or the build) lacks
+io_uring support so the caller can fall back to ArchSocketPoller.
+*/
+class IOUringSocketPoller : public ISocketPoller {
+public:
+	virtual ~IOUringSocketPoller();
+
+	//! Create a poller
+	/*!
+	Returns a new poller or NULL if io_uring is not available.
+	*/
+	static IOUringSocketPoller*
+						create();
+
+	// ISocketPoller overrides
+	virtual int			poll(PollEntries& entries, bool changed);
+	virtual void		unblock(Thread* serviceThread);
+
+private:
+	IOUringSocketPoller();
+
+	bool				init(UInt32 entries);
+	void				cleanup();
+
+	// armed requests
+	class Armed {
+	public:
+		unsigned long long
+						m_token;
+		unsigned short	m_events;
+		bool			m_fired;
+	};
+	typedef std::map<ArchSocket, Armed> ArmedMap;
+	typedef std::map<unsigned long long, ArchSocket> TokenMap;
+	typedef std::map<ArchSocket, size_t> IndexMap;
+
+	void				updateArmed(const PollEntries&);
+	void				arm(ArchSocket, Armed&);
+	void				disarm(ArmedMap::iterator);
+	void				armWake();
+
+	// submission queue access
+	void*				getSqe();
+	void				submitPending(bool wait);
+
+private:
+	int					m_ring;
+	int					m_wakeFd;
+	bool				m_wakeArmed;
+	unsigned long long	m_nextToken;
+	UInt32				m_pending;
+
+	// mapped ring memory
+	void*				m_sqRing;
+	size_t				m_sqRingSize;
+	void*				m_cqRing;
+	size_t				m_cqRingSize;
+	void*				m_sqes;
+	size_t				m_sqesSize;
+
+	// pointers into the mapped rings
+	unsigned*			m_sqHead;
+	unsigned*			m_sqTail;
+	unsigned*			m_sqMask;
+	unsigned*			m_sqArray;
+	unsigned*			m_cqHead;
+	unsigned*			m_cqTail;
+	unsigned*			m_cqMask;
+	void*				m_cqes;
+
+	ArmedMap			m_armed;
+	TokenMap			m_tokens;
+	IndexMap			m_index;
+};
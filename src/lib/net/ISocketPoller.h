@@ -0,0 +1,60 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "arch/IArchNetwork.h"
+#include "common/IInterface.h"
+#include "common/stdvector.h"
+
+class Thread;
+
+//! Socket poller interface
+/*!
+A socket poller waits for readiness on the sockets serviced by a
+SocketMultiplexer.  Implementations may keep state between calls (for
+example, kernel side registrations) so the multiplexer tells the poller
+when the set of entries has changed.
+*/
+class ISocketPoller : public IInterface {
+public:
+	typedef std::vector<IArchNetwork::PollEntry> PollEntries;
+
+	//! @name manipulators
+	//@{
+
+	//! Wait for socket events
+	/*!
+	Block until at least one socket in \p entries is ready or until
+	unblock() is called, then fill in the \c m_revents member of each
+	entry.  \p changed is true if \p entries differs from the previous
+	call.  Returns the number of entries with events, 0 if unblocked.
+	If \p entries is empty this returns 0 without blocking.
+
+	(cancellation point)
+	*/
+	virtual int			poll(PollEntries& entries, bool changed) = 0;
+
+	//! Unblock poll()
+	/*!
+	Force a blocked poll() call in the \p serviceThread to return.  May
+	be called from any thread.
+	*/
+	virtual void		unblock(Thread* serviceThread) = 0;
+
+	//@}
+};
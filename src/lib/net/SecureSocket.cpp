@@ -53,12 +53,17 @@ struct Ssl {
 	SSL*		m_ssl;
 };
 
+bool SecureSocket::s_kernelTlsEnabled = true;
+
 SecureSocket::SecureSocket(
 		IEventQueue* events,
 		SocketMultiplexer* socketMultiplexer) :
 	TCPSocket(events, socketMultiplexer),
 	m_secureReady(false),
-	m_fatal(false)
+	m_fatal(false),
+	m_kernelTlsSend(false),
+	m_kernelTlsRecv(false),
+	m_writeRetrySize(0)
 {
 }
 
@@ -68,7 +73,10 @@ SecureSocket::SecureSocket(
 		ArchSocket socket) :
 	TCPSocket(events, socketMultiplexer, socket),
 	m_secureReady(false),
-	m_fatal(false)
+	m_fatal(false),
+	m_kernelTlsSend(false),
+	m_kernelTlsRecv(false),
+	m_writeRetrySize(0)
 {
 }
 
@@ -196,22 +204,25 @@ SecureSocket::doRead()
 TCPSocket::EJobResult
 SecureSocket::doWrite()
 {
-	static bool s_retry = false;
-	static int s_retrySize = 0;
-	static void* s_staticBuffer = NULL;
+	if (m_kernelTlsSend) {
+		// the kernel encrypts, so this is a plain socket write
+		return TCPSocket::doWrite();
+	}
 
 	// write data
 	int bufferSize = 0;
 	int bytesWrote = 0;
 	int status = 0;
 	
-	if (s_retry) {
-		bufferSize = s_retrySize;
+	// a retried SSL_write() must be given the same data again.  the
+	// output buffer only grows until data is discarded so the head of
+	// it is still that data (though maybe at a new address, which
+	// SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER allows).
+	if (m_writeRetrySize > 0) {
+		bufferSize = m_writeRetrySize;
 	}
 	else {
 		bufferSize = m_outputBuffer.getSize();
-		s_staticBuffer = malloc(bufferSize);
-		memcpy(s_staticBuffer, m_outputBuffer.peek(bufferSize), bufferSize);
 	}
 	
 	if (bufferSize == 0) {
@@ -219,19 +230,16 @@ SecureSocket::doWrite()
 	}
 
 	if (isSecureReady()) {
-		status = secureWrite(s_staticBuffer, bufferSize, bytesWrote);
+		const void* buffer = m_outputBuffer.peek(bufferSize);
+		status = secureWrite(buffer, bufferSize, bytesWrote);
 		if (status > 0) {
-			s_retry = false;
-			bufferSize = 0;
-			free(s_staticBuffer);
-			s_staticBuffer = NULL;
+			m_writeRetrySize = 0;
 		}
 		else if (status < 0) {
 			return kBreak;
 		}
 		else if (status == 0) {
-			s_retry = true;
-			s_retrySize = bufferSize;
+			m_writeRetrySize = bufferSize;
 			return kNew;
 		}
 	}
@@ -392,7 +400,20 @@ SecureSocket::initContext(bool server)
 
 	if (m_ssl->m_context == NULL) {
 		showError();
+		return;
+	}
+
+	// writes are retried from the output buffer, which may move
+	SSL_CTX_set_mode(m_ssl->m_context, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
+#if defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+	// let openssl hand the session keys to the kernel after the
+	// handshake.  it quietly keeps doing the crypto itself if the
+	// kernel or the negotiated cipher doesn't support it.
+	if (s_kernelTlsEnabled) {
+		SSL_CTX_set_options(m_ssl->m_context, SSL_OP_ENABLE_KTLS);
 	}
+#endif
 }
 
 void
@@ -438,6 +459,7 @@ SecureSocket::secureAccept(int socket)
 			showSecureCipherInfo();
 		}
 		showSecureConnectInfo();
+		checkKernelTls();
 		return 1;
 	}
 
@@ -503,6 +525,7 @@ SecureSocket::secureConnect(int socket)
 		showSecureCipherInfo();
 	}
 	showSecureConnectInfo();
+	checkKernelTls();
 	return 1;
 }
 
@@ -842,6 +865,39 @@ SecureSocket::showSecureConnectInfo()
 	return;
 }
 
+void
+SecureSocket::checkKernelTls()
+{
+	m_kernelTlsSend = false;
+	m_kernelTlsRecv = false;
+
+#if defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+	if ((SSL_get_options(m_ssl->m_ssl) & SSL_OP_ENABLE_KTLS) == 0) {
+		return;
+	}
+
+	// openssl reads through the kernel by itself once receive offload
+	// is active, but sends bypass it so we can write straight from
+	// the output buffer.
+	m_kernelTlsSend = (BIO_get_ktls_send(SSL_get_wbio(m_ssl->m_ssl)) != 0);
+	m_kernelTlsRecv = (BIO_get_ktls_recv(SSL_get_rbio(m_ssl->m_ssl)) != 0);
+	LOG((CLOG_DEBUG "kernel tls send %s, receive %s",
+		m_kernelTlsSend ? "on" : "off", m_kernelTlsRecv ? "on" : "off"));
+#endif
+}
+
+void
+SecureSocket::setKernelTlsEnabled(bool enabled)
+{
+	s_kernelTlsEnabled = enabled;
+}
+
+bool
+SecureSocket::isKernelTlsEnabled()
+{
+	return s_kernelTlsEnabled;
+}
+
 void
 SecureSocket::handleTCPConnected(const Event& event, void*)
 {
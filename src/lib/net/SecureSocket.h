@@ -57,6 +57,17 @@ public:
 	EJobResult			doWrite();
 	void				initSsl(bool server);
 	bool				loadCertificates(String& CertFile);
+	bool				isKernelTlsSend() const { return m_kernelTlsSend; }
+	bool				isKernelTlsRecv() const { return m_kernelTlsRecv; }
+
+	//! Enable kernel TLS offload
+	/*!
+	When enabled (the default) and supported by OpenSSL and the kernel,
+	sockets initialized afterwards hand their session keys to the kernel
+	once the handshake completes.  Sends then bypass OpenSSL entirely.
+	*/
+	static void			setKernelTlsEnabled(bool enabled);
+	static bool			isKernelTlsEnabled();
 
 private:
 	// SSL
@@ -85,6 +96,7 @@ private:
 	void				showSecureConnectInfo();
 	void				showSecureLibInfo();
 	void				showSecureCipherInfo();
+	void				checkKernelTls();
 	
 	void				handleTCPConnected(const Event& event, void*);
 
@@ -92,4 +104,9 @@ private:
 	Ssl*				m_ssl;
 	bool				m_secureReady;
 	bool				m_fatal;
+	bool				m_kernelTlsSend;
+	bool				m_kernelTlsRecv;
+	int					m_writeRetrySize;
+
+	static bool			s_kernelTlsEnabled;
 };
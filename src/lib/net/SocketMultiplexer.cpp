@@ -19,6 +19,8 @@
 #include "net/SocketMultiplexer.h"
 
 #include "net/ISocketMultiplexerJob.h"
+#include "net/ArchSocketPoller.h"
+#include "net/IOUringSocketPoller.h"
 #include "mt/CondVar.h"
 #include "mt/Lock.h"
 #include "mt/Mutex.h"
@@ -33,8 +35,10 @@
 // SocketMultiplexer
 //
 
-SocketMultiplexer::SocketMultiplexer() :
-	m_mutex(new Mutex),
+SocketMultiplexer::SocketMultiplexer(EPollBackend backend, int shards) :
+	m_mutex(new Mutex("SocketMultiplexer")),
+	m_poller(NULL),
+	m_backend(kPollBackend),
 	m_thread(NULL),
 	m_update(false),
 	m_jobsReady(new CondVar<bool>(m_mutex, false)),
@@ -49,6 +53,30 @@ SocketMultiplexer::SocketMultiplexer() :
 	// TODO: Remove this evilness
 	m_cursorMark = reinterpret_cast<ISocketMultiplexerJob*>(this);
 
+	if (shards > 1) {
+		m_shards.reserve(shards);
+		for (int i = 0; i < shards; ++i) {
+			m_shards.push_back(new SocketMultiplexer(backend));
+		}
+		m_backend = m_shards[0]->getBackend();
+		LOG((CLOG_DEBUG "socket multiplexer using %d threads", shards));
+		return;
+	}
+
+	// choose the poller, falling back to poll if io_uring is missing
+	if (backend == kIOUringBackend) {
+		m_poller = IOUringSocketPoller::create();
+		if (m_poller != NULL) {
+			m_backend = kIOUringBackend;
+		}
+		else {
+			LOG((CLOG_WARN "io_uring is not available, using poll"));
+		}
+	}
+	if (m_poller == NULL) {
+		m_poller = new ArchSocketPoller;
+	}
+
 	// start thread
 	m_thread = new Thread(new TMethodJob<SocketMultiplexer>(
 								this, &SocketMultiplexer::serviceThread));
@@ -56,10 +84,22 @@ SocketMultiplexer::SocketMultiplexer() :
 
 SocketMultiplexer::~SocketMultiplexer()
 {
+	if (!m_shards.empty()) {
+		for (Shards::iterator i = m_shards.begin(); i != m_shards.end(); ++i) {
+			delete *i;
+		}
+		delete m_jobsReady;
+		delete m_jobListLock;
+		delete m_jobListLockLocked;
+		delete m_mutex;
+		return;
+	}
+
 	m_thread->cancel();
-	m_thread->unblockPollSocket();
+	m_poller->unblock(m_thread);
 	m_thread->wait();
 	delete m_thread;
+	delete m_poller;
 	delete m_jobsReady;
 	delete m_jobListLock;
 	delete m_jobListLockLocked;
@@ -80,11 +120,16 @@ SocketMultiplexer::addSocket(ISocket* socket, ISocketMultiplexerJob* job)
 	assert(socket != NULL);
 	assert(job    != NULL);
 
+	if (!m_shards.empty()) {
+		getShard(socket)->addSocket(socket, job);
+		return;
+	}
+
 	// prevent other threads from locking the job list
 	lockJobListLock();
 
 	// break thread out of poll
-	m_thread->unblockPollSocket();
+	m_poller->unblock(m_thread);
 
 	// lock the job list
 	lockJobList();
@@ -117,11 +162,16 @@ SocketMultiplexer::removeSocket(ISocket* socket)
 {
 	assert(socket != NULL);
 
+	if (!m_shards.empty()) {
+		getShard(socket)->removeSocket(socket);
+		return;
+	}
+
 	// prevent other threads from locking the job list
 	lockJobListLock();
 
 	// break thread out of poll
-	m_thread->unblockPollSocket();
+	m_poller->unblock(m_thread);
 
 	// lock the job list
 	lockJobList();
@@ -154,7 +204,7 @@ SocketMultiplexer::serviceThread(void*)
 
 		// wait until there are jobs to handle
 		{
-			Lock lock(m_mutex);
+			Lock lock(m_mutex, __FUNCTION__);
 			while (!(bool)*m_jobsReady) {
 				m_jobsReady->wait();
 			}
@@ -165,6 +215,7 @@ SocketMultiplexer::serviceThread(void*)
 		lockJobList();
 
 		// collect poll entries
+		bool changed = m_update;
 		if (m_update) {
 			m_update = false;
 			pfds.clear();
@@ -193,12 +244,7 @@ SocketMultiplexer::serviceThread(void*)
 		int status;
 		try {
 			// check for status
-			if (!pfds.empty()) {
-				status = ARCH->pollSocket(&pfds[0], (int)pfds.size(), -1);
-			}
-			else {
-				status = 0;
-			}
+			status = m_poller->poll(pfds, changed);
 		}
 		catch (XArchNetwork& e) {
 			LOG((CLOG_WARN "error in socket multiplexer: %s", e.what()));
@@ -226,7 +272,7 @@ SocketMultiplexer::serviceThread(void*)
 
 					// save job, if different
 					if (newJob != job) {
-						Lock lock(m_mutex);
+						Lock lock(m_mutex, __FUNCTION__);
 						delete job;
 						*jobCursor = newJob;
 						m_update   = true;
@@ -258,17 +304,41 @@ SocketMultiplexer::serviceThread(void*)
 	}
 }
 
+SocketMultiplexer::EPollBackend
+SocketMultiplexer::getBackend() const
+{
+	return m_backend;
+}
+
+int
+SocketMultiplexer::getShards() const
+{
+	return m_shards.empty() ? 1 : static_cast<int>(m_shards.size());
+}
+
+SocketMultiplexer*
+SocketMultiplexer::getShard(ISocket* socket) const
+{
+	// sockets are heap objects so the low bits of the address carry
+	// little information.  mix the rest before picking a shard.
+	size_t hash = reinterpret_cast<size_t>(socket) >> 4;
+	hash ^= hash >> 7;
+	hash *= 2654435761u;
+	hash ^= hash >> 16;
+	return m_shards[hash % m_shards.size()];
+}
+
 SocketMultiplexer::JobCursor
 SocketMultiplexer::newCursor()
 {
-	Lock lock(m_mutex);
+	Lock lock(m_mutex, __FUNCTION__);
 	return m_socketJobs.insert(m_socketJobs.begin(), m_cursorMark);
 }
 
 SocketMultiplexer::JobCursor
 SocketMultiplexer::nextCursor(JobCursor cursor)
 {
-	Lock lock(m_mutex);
+	Lock lock(m_mutex, __FUNCTION__);
 	JobCursor j = m_socketJobs.end();
 	JobCursor i = cursor;
 	while (++i != m_socketJobs.end()) {
@@ -287,14 +357,14 @@ SocketMultiplexer::nextCursor(JobCursor cursor)
 void
 SocketMultiplexer::deleteCursor(JobCursor cursor)
 {
-	Lock lock(m_mutex);
+	Lock lock(m_mutex, __FUNCTION__);
 	m_socketJobs.erase(cursor);
 }
 
 void
 SocketMultiplexer::lockJobListLock()
 {
-	Lock lock(m_mutex);
+	Lock lock(m_mutex, __FUNCTION__);
 
 	// wait for the lock on the lock
 	while (*m_jobListLockLocked) {
@@ -309,7 +379,7 @@ SocketMultiplexer::lockJobListLock()
 void
 SocketMultiplexer::lockJobList()
 {
-	Lock lock(m_mutex);
+	Lock lock(m_mutex, __FUNCTION__);
 
 	// make sure we're the one that called lockJobListLock()
 	assert(*m_jobListLockLocker == Thread::getCurrentThread());
@@ -332,7 +402,7 @@ SocketMultiplexer::lockJobList()
 void
 SocketMultiplexer::unlockJobList()
 {
-	Lock lock(m_mutex);
+	Lock lock(m_mutex, __FUNCTION__);
 
 	// make sure we're the one that called lockJobList()
 	assert(*m_jobListLocker == Thread::getCurrentThread());
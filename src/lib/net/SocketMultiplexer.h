@@ -21,6 +21,7 @@
 #include "arch/IArchNetwork.h"
 #include "common/stdlist.h"
 #include "common/stdmap.h"
+#include "common/stdvector.h"
 
 template <class T>
 class CondVar;
@@ -28,6 +29,7 @@ class Mutex;
 class Thread;
 class ISocket;
 class ISocketMultiplexerJob;
+class ISocketPoller;
 
 //! Socket multiplexer
 /*!
@@ -35,7 +37,23 @@ A socket multiplexer services multiple sockets simultaneously.
 */
 class SocketMultiplexer {
 public:
-	SocketMultiplexer();
+	//! Readiness backend
+	enum EPollBackend {
+		kPollBackend,		//!< Use pollSocket() on the service thread
+		kIOUringBackend		//!< Use io_uring if the kernel supports it
+	};
+
+	//! Create a multiplexer
+	/*!
+	Creates a multiplexer that waits for socket events using \p backend.
+	If the backend is not available the poll backend is used instead.
+	If \p shards is more than one then sockets are spread over that
+	many service threads, each with its own poll set and job list, so
+	adding, removing or re-arming a socket only interrupts the sockets
+	on the same shard.  A socket always stays on one shard so its jobs
+	(and the events they send) keep their order.
+	*/
+	SocketMultiplexer(EPollBackend backend = kPollBackend, int shards = 1);
 	~SocketMultiplexer();
 
 	//! @name manipulators
@@ -49,6 +67,12 @@ public:
 	//! @name accessors
 	//@{
 
+	//! Get the backend in use
+	EPollBackend		getBackend() const;
+
+	//! Get the number of service threads
+	int					getShards() const;
+
 	// maybe belongs on ISocketMultiplexer
 	static SocketMultiplexer*
 						getInstance();
@@ -61,6 +85,10 @@ private:
 	typedef std::list<ISocketMultiplexerJob*> SocketJobs;
 	typedef SocketJobs::iterator JobCursor;
 	typedef std::map<ISocket*, JobCursor> SocketJobMap;
+	typedef std::vector<SocketMultiplexer*> Shards;
+
+	// get the shard that services \p socket
+	SocketMultiplexer*	getShard(ISocket* socket) const;
 
 	// service sockets.  the service thread will only access m_sockets
 	// and m_update while m_pollable and m_polling are true.  all other
@@ -96,6 +124,8 @@ private:
 
 private:
 	Mutex*				m_mutex;
+	ISocketPoller*		m_poller;
+	EPollBackend		m_backend;
 	Thread*				m_thread;
 	bool				m_update;
 	CondVar<bool>*		m_jobsReady;
@@ -108,4 +138,8 @@ private:
 	SocketJobMap		m_socketJobMap;
 	ISocketMultiplexerJob*
 						m_cursorMark;
+
+	// if not empty then this multiplexer only hands sockets out to
+	// these and has no service thread of its own
+	Shards				m_shards;
 };
@@ -28,6 +28,7 @@
 #include "base/Log.h"
 #include "base/IEventQueue.h"
 #include "base/IEventJob.h"
+#include "base/TMethodEventJob.h"
 
 #include <cstring>
 #include <cstdlib>
@@ -99,8 +100,10 @@ TCPSocket::close()
 {
 	// remove ourself from the multiplexer
 	setJob(NULL);
+	m_events->removeDispatchEndJobs(this);
 
 	Lock lock(&m_mutex);
+	m_writeDeferred = false;
 
 	// clear buffers and enter disconnected state
 	if (m_connected) {
@@ -175,17 +178,28 @@ TCPSocket::write(const void* buffer, UInt32 n)
 
 		// there's data to write
 		m_flushed = false;
+		if (wasEmpty) {
+			m_writeDeferred = true;
+		}
 	}
 
-	// make sure we're waiting to write
+	// make sure we're waiting to write.  if an event is being handled
+	// then wait until it's done so that everything written by it (a
+	// packet's length and payload, several messages) is sent together
+	// rather than as separate tiny segments.
 	if (wasEmpty) {
-		setJob(newJob());
+		m_events->adoptDispatchEndJob(this,
+							new TMethodEventJob<TCPSocket>(
+								this, &TCPSocket::handleDispatchEnd));
 	}
 }
 
 void
 TCPSocket::flush()
 {
+	// don't wait for the end of the dispatch we may be called from
+	armDeferredWrite();
+
 	Lock lock(&m_mutex);
 	while (m_flushed == false) {
 		m_flushed.wait();
@@ -304,6 +318,7 @@ TCPSocket::init()
 	m_connected = false;
 	m_readable  = false;
 	m_writable  = false;
+	m_writeDeferred = false;
 
 	try {
 		// turn off Nagle algorithm.  we send lots of very short messages
@@ -382,6 +397,26 @@ TCPSocket::doWrite()
 	return kRetry;
 }
 
+void
+TCPSocket::armDeferredWrite()
+{
+	{
+		Lock lock(&m_mutex);
+		if (!m_writeDeferred) {
+			return;
+		}
+		m_writeDeferred = false;
+	}
+
+	setJob(newJob());
+}
+
+void
+TCPSocket::handleDispatchEnd(const Event&, void*)
+{
+	armDeferredWrite();
+}
+
 void
 TCPSocket::setJob(ISocketMultiplexerJob* job)
 {
@@ -412,13 +447,15 @@ TCPSocket::newJob()
 								m_socket, m_readable, m_writable);
 	}
 	else {
-		if (!(m_readable || (m_writable && (m_outputBuffer.getSize() > 0)))) {
+		// writes held for the end of a dispatch are armed later
+		bool write = (m_writable && !m_writeDeferred &&
+							m_outputBuffer.getSize() > 0);
+		if (!(m_readable || write)) {
 			return NULL;
 		}
 		return new TSocketMultiplexerMethodJob<TCPSocket>(
 								this, &TCPSocket::serviceConnected,
-								m_socket, m_readable,
-								m_writable && (m_outputBuffer.getSize() > 0));
+								m_socket, m_readable, write);
 	}
 }
 
@@ -93,6 +93,9 @@ private:
 	void				onOutputShutdown();
 	void				onDisconnected();
 
+	void				armDeferredWrite();
+	void				handleDispatchEnd(const Event&, void*);
+
 	ISocketMultiplexerJob*
 						serviceConnecting(ISocketMultiplexerJob*,
 							bool, bool, bool);
@@ -113,4 +116,5 @@ private:
 	ArchSocket			m_socket;
 	CondVar<bool>		m_flushed;
 	SocketMultiplexer*	m_socketMultiplexer;
+	bool				m_writeDeferred;
 };
@@ -392,7 +392,7 @@ MSWindowsScreen::sendDragThread(void*)
 		LOG((CLOG_DEBUG "send dragging info to server: %s", draggingFilename.c_str()));
 		client->sendDragInfo(fileCount, draggingFilename, size);
 		LOG((CLOG_DEBUG "send dragging file to server"));
-		client->sendFileToServer(draggingFilename.c_str());
+		client->sendFilesToServer(std::vector<String>(1, draggingFilename));
 	}
 	
 	m_draggingStarted = false;
@@ -892,10 +892,7 @@ OSXScreen::leave()
 					dragFileList, info);
 				client->sendDragInfo(fileCount, info, info.size());
 				LOG((CLOG_DEBUG "send dragging file to server"));
-				
-				// TODO: what to do with multiple file or even
-				// a folder
-				client->sendFileToServer(fileList.c_str());
+				client->sendFilesToServer(std::vector<String>(1, fileList));
 			}
 		}
 		m_draggingStarted = false;
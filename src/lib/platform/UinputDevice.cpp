@@ -0,0 +1,243 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "platform/UinputDevice.h"
+
+#include "synergy/XScreen.h"
+#include "base/Log.h"
+
+#include <linux/input.h>
+#include <linux/uinput.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+// one wheel notch in synergy units
+static const SInt32		kWheelNotch = 120;
+
+static
+void
+setEvent(struct input_event& event, UInt16 type, UInt16 code, SInt32 value)
+{
+	memset(&event, 0, sizeof(event));
+	event.type  = type;
+	event.code  = code;
+	event.value = value;
+}
+
+//
+// UinputDevice
+//
+
+UinputDevice::UinputDevice(SInt32 width, SInt32 height, const char* path) :
+	m_fd(-1),
+	m_created(false),
+	m_width(width),
+	m_height(height),
+	m_x(0),
+	m_y(0),
+	m_wheelX(0),
+	m_wheelY(0)
+{
+	create(path);
+}
+
+UinputDevice::UinputDevice(int fd, SInt32 width, SInt32 height) :
+	m_fd(fd),
+	m_created(false),
+	m_width(width),
+	m_height(height),
+	m_x(0),
+	m_y(0),
+	m_wheelX(0),
+	m_wheelY(0)
+{
+	// do nothing
+}
+
+UinputDevice::~UinputDevice()
+{
+	if (m_created) {
+		ioctl(m_fd, UI_DEV_DESTROY);
+	}
+	if (m_fd != -1) {
+		close(m_fd);
+	}
+}
+
+void
+UinputDevice::create(const char* path)
+{
+	m_fd = open(path, O_WRONLY | O_NONBLOCK);
+	if (m_fd == -1) {
+		throw XScreenOpenFailure(String("cannot open ") + path +
+							": " + strerror(errno));
+	}
+
+	// keyboard keys and mouse buttons
+	bool ok = (ioctl(m_fd, UI_SET_EVBIT, EV_KEY) != -1);
+	for (int code = KEY_ESC; ok && code < KEY_MAX; ++code) {
+		if (code < BTN_MISC || (code >= BTN_LEFT && code <= BTN_TASK)) {
+			ok = (ioctl(m_fd, UI_SET_KEYBIT, code) != -1);
+		}
+	}
+
+	// absolute pointer, like a virtual machine tablet, plus wheels
+	ok = ok &&
+		ioctl(m_fd, UI_SET_EVBIT, EV_ABS) != -1 &&
+		ioctl(m_fd, UI_SET_ABSBIT, ABS_X) != -1 &&
+		ioctl(m_fd, UI_SET_ABSBIT, ABS_Y) != -1 &&
+		ioctl(m_fd, UI_SET_EVBIT, EV_REL) != -1 &&
+		ioctl(m_fd, UI_SET_RELBIT, REL_WHEEL) != -1 &&
+		ioctl(m_fd, UI_SET_RELBIT, REL_HWHEEL) != -1;
+#if defined(REL_WHEEL_HI_RES)
+	ok = ok &&
+		ioctl(m_fd, UI_SET_RELBIT, REL_WHEEL_HI_RES) != -1 &&
+		ioctl(m_fd, UI_SET_RELBIT, REL_HWHEEL_HI_RES) != -1;
+#endif
+
+	if (ok) {
+		struct uinput_user_dev dev;
+		memset(&dev, 0, sizeof(dev));
+		strncpy(dev.name, "synergy virtual input", UINPUT_MAX_NAME_SIZE - 1);
+		dev.id.bustype = BUS_VIRTUAL;
+		dev.id.version = 1;
+		dev.absmax[ABS_X] = m_width  - 1;
+		dev.absmax[ABS_Y] = m_height - 1;
+		ok = (write(m_fd, &dev, sizeof(dev)) == (ssize_t)sizeof(dev)) &&
+			ioctl(m_fd, UI_DEV_CREATE) != -1;
+	}
+
+	if (!ok) {
+		String error(strerror(errno));
+		close(m_fd);
+		m_fd = -1;
+		throw XScreenOpenFailure("cannot create uinput device: " + error);
+	}
+
+	m_created = true;
+	LOG((CLOG_DEBUG "created uinput device %s (%dx%d)", getSysName().c_str(), m_width, m_height));
+}
+
+void
+UinputDevice::key(UInt16 code, bool press)
+{
+	struct input_event events[2];
+	setEvent(events[0], EV_KEY, code, press ? 1 : 0);
+	setEvent(events[1], EV_SYN, SYN_REPORT, 0);
+	send(events, 2);
+}
+
+void
+UinputDevice::moveAbsolute(SInt32 x, SInt32 y)
+{
+	// clamp to the axis range
+	m_x = (x < 0) ? 0 : ((x >= m_width)  ? m_width  - 1 : x);
+	m_y = (y < 0) ? 0 : ((y >= m_height) ? m_height - 1 : y);
+
+	struct input_event events[3];
+	setEvent(events[0], EV_ABS, ABS_X, m_x);
+	setEvent(events[1], EV_ABS, ABS_Y, m_y);
+	setEvent(events[2], EV_SYN, SYN_REPORT, 0);
+	send(events, 3);
+}
+
+void
+UinputDevice::moveRelative(SInt32 dx, SInt32 dy)
+{
+	// the device's only relative axes are the wheels.  REL_X and REL_Y
+	// would make clients treat it as a mouse as well as a tablet, so
+	// relative motion is applied to the last absolute position.
+	moveAbsolute(m_x + dx, m_y + dy);
+}
+
+void
+UinputDevice::wheel(SInt32 xDelta, SInt32 yDelta)
+{
+	// legacy wheel events count whole notches, so carry the remainder
+	// of partial (high resolution) deltas over to the next call.
+	m_wheelX += xDelta;
+	m_wheelY += yDelta;
+	SInt32 notchesX = m_wheelX / kWheelNotch;
+	SInt32 notchesY = m_wheelY / kWheelNotch;
+	m_wheelX -= notchesX * kWheelNotch;
+	m_wheelY -= notchesY * kWheelNotch;
+
+	struct input_event events[5];
+	int count = 0;
+#if defined(REL_WHEEL_HI_RES)
+	if (yDelta != 0) {
+		setEvent(events[count++], EV_REL, REL_WHEEL_HI_RES, yDelta);
+	}
+	if (xDelta != 0) {
+		setEvent(events[count++], EV_REL, REL_HWHEEL_HI_RES, xDelta);
+	}
+#endif
+	if (notchesY != 0) {
+		setEvent(events[count++], EV_REL, REL_WHEEL, notchesY);
+	}
+	if (notchesX != 0) {
+		setEvent(events[count++], EV_REL, REL_HWHEEL, notchesX);
+	}
+	if (count == 0) {
+		return;
+	}
+	setEvent(events[count++], EV_SYN, SYN_REPORT, 0);
+	send(events, count);
+}
+
+void
+UinputDevice::getPosition(SInt32& x, SInt32& y) const
+{
+	x = m_x;
+	y = m_y;
+}
+
+void
+UinputDevice::getSize(SInt32& width, SInt32& height) const
+{
+	width  = m_width;
+	height = m_height;
+}
+
+String
+UinputDevice::getSysName() const
+{
+#if defined(UI_GET_SYSNAME)
+	if (m_created) {
+		char name[64];
+		int n = ioctl(m_fd, UI_GET_SYSNAME(sizeof(name)), name);
+		if (n > 0) {
+			name[sizeof(name) - 1] = '\0';
+			return name;
+		}
+	}
+#endif
+	return String();
+}
+
+void
+UinputDevice::send(struct input_event* events, int count)
+{
+	size_t size = count * sizeof(struct input_event);
+	ssize_t n   = write(m_fd, events, size);
+	if (n != (ssize_t)size) {
+		LOG((CLOG_WARN "failed to write uinput events: %s", n == -1 ? strerror(errno) : "short write"));
+	}
+}
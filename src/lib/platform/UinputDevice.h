@@ -0,0 +1,106 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/String.h"
+#include "common/basic_types.h"
+
+struct input_event;
+
+//! Linux uinput virtual input device
+/*!
+A virtual keyboard and absolute pointer created through \c /dev/uinput.
+Events written to it are injected by the kernel input layer, so they
+reach X11, Wayland compositors and the console alike without a round
+trip to a display server.  Each call writes its events and the
+terminating \c SYN_REPORT with a single \c write().
+*/
+class UinputDevice {
+public:
+	//! Create a device
+	/*!
+	Opens \p path and creates a virtual device whose absolute pointer
+	axes span a screen of \p width by \p height.  Throws
+	\c XScreenOpenFailure if uinput is unavailable.
+	*/
+	UinputDevice(SInt32 width, SInt32 height,
+							const char* path = "/dev/uinput");
+
+	//! Adopt a file descriptor
+	/*!
+	Writes events to \p fd without creating a device on it.  Useful
+	when \p fd is already a configured uinput device or is any other
+	sink for \c input_event records, e.g. a pipe in tests.
+	*/
+	UinputDevice(int fd, SInt32 width, SInt32 height);
+	~UinputDevice();
+
+	//! @name manipulators
+	//@{
+
+	//! Press or release a key or button
+	/*!
+	\p code is a Linux \c KEY_* or \c BTN_* code.
+	*/
+	void				key(UInt16 code, bool press);
+
+	//! Move pointer to absolute position
+	void				moveAbsolute(SInt32 x, SInt32 y);
+
+	//! Move pointer relative to its current position
+	void				moveRelative(SInt32 dx, SInt32 dy);
+
+	//! Scroll
+	/*!
+	Deltas are in synergy units of 120 per wheel notch.
+	*/
+	void				wheel(SInt32 xDelta, SInt32 yDelta);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get pointer position
+	void				getPosition(SInt32& x, SInt32& y) const;
+
+	//! Get screen size
+	void				getSize(SInt32& width, SInt32& height) const;
+
+	//! Get sysfs name
+	/*!
+	Returns the sysfs name of the created device (e.g. \c input12), or
+	an empty string if it is unknown.
+	*/
+	String				getSysName() const;
+
+	//@}
+
+private:
+	void				create(const char* path);
+	void				send(struct input_event* events, int count);
+
+private:
+	int					m_fd;
+	bool				m_created;
+	SInt32				m_width;
+	SInt32				m_height;
+	SInt32				m_x;
+	SInt32				m_y;
+	SInt32				m_wheelX;
+	SInt32				m_wheelY;
+};
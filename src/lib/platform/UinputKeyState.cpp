@@ -0,0 +1,266 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "platform/UinputKeyState.h"
+
+#include "platform/UinputDevice.h"
+#include "base/Log.h"
+
+#include <linux/input.h>
+
+struct KeycodeKeyID {
+public:
+	UInt16				m_keycode;
+	KeyID				m_id;			// unshifted, or numlock off on keypad
+	KeyID				m_shifted;		// shifted, or numlock on on keypad
+};
+
+// US layout.  letters are added separately.
+static const KeycodeKeyID s_keycodes[] = {
+	{ KEY_ESC,			kKeyEscape,			kKeyNone },
+	{ KEY_1,			'1',				'!' },
+	{ KEY_2,			'2',				'@' },
+	{ KEY_3,			'3',				'#' },
+	{ KEY_4,			'4',				'$' },
+	{ KEY_5,			'5',				'%' },
+	{ KEY_6,			'6',				'^' },
+	{ KEY_7,			'7',				'&' },
+	{ KEY_8,			'8',				'*' },
+	{ KEY_9,			'9',				'(' },
+	{ KEY_0,			'0',				')' },
+	{ KEY_MINUS,		'-',				'_' },
+	{ KEY_EQUAL,		'=',				'+' },
+	{ KEY_BACKSPACE,	kKeyBackSpace,		kKeyNone },
+	{ KEY_TAB,			kKeyTab,			kKeyLeftTab },
+	{ KEY_LEFTBRACE,	'[',				'{' },
+	{ KEY_RIGHTBRACE,	']',				'}' },
+	{ KEY_ENTER,		kKeyReturn,			kKeyNone },
+	{ KEY_LEFTCTRL,		kKeyControl_L,		kKeyNone },
+	{ KEY_SEMICOLON,	';',				':' },
+	{ KEY_APOSTROPHE,	'\'',				'"' },
+	{ KEY_GRAVE,		'`',				'~' },
+	{ KEY_LEFTSHIFT,	kKeyShift_L,		kKeyNone },
+	{ KEY_BACKSLASH,	'\\',				'|' },
+	{ KEY_COMMA,		',',				'<' },
+	{ KEY_DOT,			'.',				'>' },
+	{ KEY_SLASH,		'/',				'?' },
+	{ KEY_RIGHTSHIFT,	kKeyShift_R,		kKeyNone },
+	{ KEY_LEFTALT,		kKeyAlt_L,			kKeyNone },
+	{ KEY_SPACE,		' ',				kKeyNone },
+	{ KEY_CAPSLOCK,		kKeyCapsLock,		kKeyNone },
+	{ KEY_F1,			kKeyF1,				kKeyNone },
+	{ KEY_F2,			kKeyF2,				kKeyNone },
+	{ KEY_F3,			kKeyF3,				kKeyNone },
+	{ KEY_F4,			kKeyF4,				kKeyNone },
+	{ KEY_F5,			kKeyF5,				kKeyNone },
+	{ KEY_F6,			kKeyF6,				kKeyNone },
+	{ KEY_F7,			kKeyF7,				kKeyNone },
+	{ KEY_F8,			kKeyF8,				kKeyNone },
+	{ KEY_F9,			kKeyF9,				kKeyNone },
+	{ KEY_F10,			kKeyF10,			kKeyNone },
+	{ KEY_F11,			kKeyF11,			kKeyNone },
+	{ KEY_F12,			kKeyF12,			kKeyNone },
+	{ KEY_NUMLOCK,		kKeyNumLock,		kKeyNone },
+	{ KEY_SCROLLLOCK,	kKeyScrollLock,		kKeyNone },
+	{ KEY_KP7,			kKeyKP_Home,		kKeyKP_7 },
+	{ KEY_KP8,			kKeyKP_Up,			kKeyKP_8 },
+	{ KEY_KP9,			kKeyKP_PageUp,		kKeyKP_9 },
+	{ KEY_KP4,			kKeyKP_Left,		kKeyKP_4 },
+	{ KEY_KP5,			kKeyKP_Begin,		kKeyKP_5 },
+	{ KEY_KP6,			kKeyKP_Right,		kKeyKP_6 },
+	{ KEY_KP1,			kKeyKP_End,			kKeyKP_1 },
+	{ KEY_KP2,			kKeyKP_Down,		kKeyKP_2 },
+	{ KEY_KP3,			kKeyKP_PageDown,	kKeyKP_3 },
+	{ KEY_KP0,			kKeyKP_Insert,		kKeyKP_0 },
+	{ KEY_KPDOT,		kKeyKP_Delete,		kKeyKP_Decimal },
+	{ KEY_KPASTERISK,	kKeyKP_Multiply,	kKeyNone },
+	{ KEY_KPMINUS,		kKeyKP_Subtract,	kKeyNone },
+	{ KEY_KPPLUS,		kKeyKP_Add,			kKeyNone },
+	{ KEY_KPENTER,		kKeyKP_Enter,		kKeyNone },
+	{ KEY_KPSLASH,		kKeyKP_Divide,		kKeyNone },
+	{ KEY_RIGHTCTRL,	kKeyControl_R,		kKeyNone },
+	{ KEY_SYSRQ,		kKeyPrint,			kKeyNone },
+	{ KEY_RIGHTALT,		kKeyAlt_R,			kKeyNone },
+	{ KEY_HOME,			kKeyHome,			kKeyNone },
+	{ KEY_UP,			kKeyUp,				kKeyNone },
+	{ KEY_PAGEUP,		kKeyPageUp,			kKeyNone },
+	{ KEY_LEFT,			kKeyLeft,			kKeyNone },
+	{ KEY_RIGHT,		kKeyRight,			kKeyNone },
+	{ KEY_END,			kKeyEnd,			kKeyNone },
+	{ KEY_DOWN,			kKeyDown,			kKeyNone },
+	{ KEY_PAGEDOWN,		kKeyPageDown,		kKeyNone },
+	{ KEY_INSERT,		kKeyInsert,			kKeyNone },
+	{ KEY_DELETE,		kKeyDelete,			kKeyNone },
+	{ KEY_PAUSE,		kKeyPause,			kKeyNone },
+	{ KEY_LEFTMETA,		kKeySuper_L,		kKeyNone },
+	{ KEY_RIGHTMETA,	kKeySuper_R,		kKeyNone },
+	{ KEY_COMPOSE,		kKeyMenu,			kKeyNone },
+	{ KEY_MUTE,			kKeyAudioMute,		kKeyNone },
+	{ KEY_VOLUMEDOWN,	kKeyAudioDown,		kKeyNone },
+	{ KEY_VOLUMEUP,		kKeyAudioUp,		kKeyNone },
+	{ KEY_NEXTSONG,		kKeyAudioNext,		kKeyNone },
+	{ KEY_PREVIOUSSONG,	kKeyAudioPrev,		kKeyNone },
+	{ KEY_STOPCD,		kKeyAudioStop,		kKeyNone },
+	{ KEY_PLAYPAUSE,	kKeyAudioPlay,		kKeyNone }
+};
+
+// keycodes of the letters a to z
+static const UInt16 s_letters[] = {
+	KEY_A, KEY_B, KEY_C, KEY_D, KEY_E, KEY_F, KEY_G, KEY_H, KEY_I,
+	KEY_J, KEY_K, KEY_L, KEY_M, KEY_N, KEY_O, KEY_P, KEY_Q, KEY_R,
+	KEY_S, KEY_T, KEY_U, KEY_V, KEY_W, KEY_X, KEY_Y, KEY_Z
+};
+
+static
+bool
+isKeypad(UInt16 keycode)
+{
+	switch (keycode) {
+	case KEY_KP0: case KEY_KP1: case KEY_KP2: case KEY_KP3: case KEY_KP4:
+	case KEY_KP5: case KEY_KP6: case KEY_KP7: case KEY_KP8: case KEY_KP9:
+	case KEY_KPDOT:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+//
+// UinputKeyState
+//
+
+UinputKeyState::UinputKeyState(UinputDevice* device, IEventQueue* events) :
+	KeyState(events),
+	m_device(device)
+{
+	// do nothing
+}
+
+UinputKeyState::UinputKeyState(UinputDevice* device, IEventQueue* events,
+				synergy::KeyMap& keyMap) :
+	KeyState(events, keyMap),
+	m_device(device)
+{
+	// do nothing
+}
+
+UinputKeyState::~UinputKeyState()
+{
+	// do nothing
+}
+
+bool
+UinputKeyState::fakeCtrlAltDel()
+{
+	// pass keys through unchanged
+	return false;
+}
+
+KeyModifierMask
+UinputKeyState::pollActiveModifiers() const
+{
+	// nothing to poll, the modifiers are whatever we've synthesized
+	return getActiveModifiers();
+}
+
+SInt32
+UinputKeyState::pollActiveGroup() const
+{
+	return 0;
+}
+
+void
+UinputKeyState::pollPressedKeys(KeyButtonSet& pressedKeys) const
+{
+	pressedKeys.insert(m_pressed.begin(), m_pressed.end());
+}
+
+void
+UinputKeyState::getKeyMap(synergy::KeyMap& keyMap)
+{
+	synergy::KeyMap::KeyItem item;
+	item.m_group  = 0;
+	item.m_dead   = false;
+	item.m_client = 0;
+
+	for (size_t i = 0; i < sizeof(s_keycodes) / sizeof(s_keycodes[0]); ++i) {
+		const KeycodeKeyID& entry = s_keycodes[i];
+		bool keypad      = isKeypad(entry.m_keycode);
+		KeyModifierMask level1 = keypad ? KeyModifierNumLock : KeyModifierShift;
+
+		item.m_button    = static_cast<KeyButton>(entry.m_keycode);
+		item.m_sensitive = (entry.m_shifted != kKeyNone) ? level1 : 0;
+
+		item.m_id        = entry.m_id;
+		item.m_required  = 0;
+		synergy::KeyMap::initModifierKey(item);
+		keyMap.addKeyEntry(item);
+
+		if (entry.m_shifted != kKeyNone) {
+			item.m_id        = entry.m_shifted;
+			item.m_required  = level1;
+			item.m_generates = 0;
+			item.m_lock      = false;
+			keyMap.addKeyEntry(item);
+		}
+	}
+
+	// letters are sensitive to shift and caps lock, and either one
+	// produces the upper case letter
+	item.m_sensitive = KeyModifierShift | KeyModifierCapsLock;
+	item.m_generates = 0;
+	item.m_lock      = false;
+	for (size_t i = 0; i < sizeof(s_letters) / sizeof(s_letters[0]); ++i) {
+		item.m_button   = static_cast<KeyButton>(s_letters[i]);
+
+		item.m_id       = static_cast<KeyID>('a' + i);
+		item.m_required = 0;
+		keyMap.addKeyEntry(item);
+
+		item.m_id       = static_cast<KeyID>('A' + i);
+		item.m_required = KeyModifierShift;
+		keyMap.addKeyEntry(item);
+		item.m_required = KeyModifierCapsLock;
+		keyMap.addKeyEntry(item);
+	}
+}
+
+void
+UinputKeyState::fakeKey(const Keystroke& keystroke)
+{
+	switch (keystroke.m_type) {
+	case Keystroke::kButton: {
+		KeyButton button = keystroke.m_data.m_button.m_button;
+		bool press       = keystroke.m_data.m_button.m_press;
+		LOG((CLOG_DEBUG1 "  %03x (%08x) %s", button, keystroke.m_data.m_button.m_client, press ? "down" : "up"));
+		if (press) {
+			m_pressed.insert(button);
+		}
+		else {
+			m_pressed.erase(button);
+		}
+		m_device->key(static_cast<UInt16>(button), press);
+		break;
+	}
+
+	case Keystroke::kGroup:
+		// only one group
+		LOG((CLOG_DEBUG1 "  group %d ignored", keystroke.m_data.m_group.m_group));
+		break;
+	}
+}
@@ -0,0 +1,58 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "synergy/KeyState.h"
+
+class UinputDevice;
+class IEventQueue;
+
+//! Linux uinput key state
+/*!
+A key state that synthesizes keys on a \c UinputDevice.  Key buttons are
+Linux input keycodes.  The kernel has no notion of a keyboard layout, so
+the key map describes a US layout; compositors and the console then
+apply the user's layout to the injected keycodes as they would for a
+physical keyboard.
+*/
+class UinputKeyState : public KeyState {
+public:
+	UinputKeyState(UinputDevice* device, IEventQueue* events);
+	UinputKeyState(UinputDevice* device, IEventQueue* events,
+							synergy::KeyMap& keyMap);
+	virtual ~UinputKeyState();
+
+	// IKeyState overrides
+	virtual bool		fakeCtrlAltDel();
+	virtual KeyModifierMask
+						pollActiveModifiers() const;
+	virtual SInt32		pollActiveGroup() const;
+	virtual void		pollPressedKeys(KeyButtonSet& pressedKeys) const;
+
+protected:
+	// KeyState overrides
+	virtual void		getKeyMap(synergy::KeyMap& keyMap);
+	virtual void		fakeKey(const Keystroke& keystroke);
+
+private:
+	UinputDevice*		m_device;
+
+	// keys we've pressed on the device.  there's no way to read back
+	// the state of a uinput device, but we're its only writer.
+	KeyButtonSet		m_pressed;
+};
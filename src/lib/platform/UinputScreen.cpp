@@ -0,0 +1,290 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "platform/UinputScreen.h"
+
+#include "platform/UinputDevice.h"
+#include "platform/UinputKeyState.h"
+#include "base/Log.h"
+
+#include <linux/input.h>
+
+//
+// UinputScreen
+//
+
+UinputScreen::UinputScreen(UinputDevice* device, IEventQueue* events) :
+	PlatformScreen(events),
+	m_device(device),
+	m_keyState(NULL),
+	m_buttons(0)
+{
+	m_keyState = new UinputKeyState(m_device, events);
+
+	SInt32 w, h;
+	m_device->getSize(w, h);
+	LOG((CLOG_DEBUG "screen shape: 0,0 %dx%d (uinput)", w, h));
+}
+
+UinputScreen::~UinputScreen()
+{
+	delete m_keyState;
+	delete m_device;
+}
+
+void*
+UinputScreen::getEventTarget() const
+{
+	return const_cast<UinputScreen*>(this);
+}
+
+bool
+UinputScreen::getClipboard(ClipboardID, IClipboard*) const
+{
+	// no access to the display's clipboards
+	return false;
+}
+
+void
+UinputScreen::getShape(SInt32& x, SInt32& y, SInt32& w, SInt32& h) const
+{
+	x = 0;
+	y = 0;
+	m_device->getSize(w, h);
+}
+
+void
+UinputScreen::getCursorPos(SInt32& x, SInt32& y) const
+{
+	m_device->getPosition(x, y);
+}
+
+void
+UinputScreen::reconfigure(UInt32)
+{
+	// do nothing
+}
+
+void
+UinputScreen::warpCursor(SInt32 x, SInt32 y)
+{
+	m_device->moveAbsolute(x, y);
+}
+
+UInt32
+UinputScreen::registerHotKey(KeyID, KeyModifierMask)
+{
+	// hot keys need input capture, which a secondary screen doesn't do
+	return 0;
+}
+
+void
+UinputScreen::unregisterHotKey(UInt32)
+{
+	// do nothing
+}
+
+void
+UinputScreen::fakeInputBegin()
+{
+	// do nothing
+}
+
+void
+UinputScreen::fakeInputEnd()
+{
+	// do nothing
+}
+
+SInt32
+UinputScreen::getJumpZoneSize() const
+{
+	return 0;
+}
+
+bool
+UinputScreen::isAnyMouseButtonDown(UInt32& buttonID) const
+{
+	for (UInt32 id = kButtonLeft; id <= kButtonExtra0 + 1; ++id) {
+		if ((m_buttons & (1u << id)) != 0) {
+			buttonID = id;
+			return true;
+		}
+	}
+	return false;
+}
+
+void
+UinputScreen::getCursorCenter(SInt32& x, SInt32& y) const
+{
+	SInt32 w, h;
+	m_device->getSize(w, h);
+	x = w / 2;
+	y = h / 2;
+}
+
+void
+UinputScreen::fakeMouseButton(ButtonID id, bool press)
+{
+	UInt16 code;
+	switch (id) {
+	case kButtonLeft:
+		code = BTN_LEFT;
+		break;
+
+	case kButtonMiddle:
+		code = BTN_MIDDLE;
+		break;
+
+	case kButtonRight:
+		code = BTN_RIGHT;
+		break;
+
+	case kButtonExtra0:
+		code = BTN_SIDE;
+		break;
+
+	case kButtonExtra0 + 1:
+		code = BTN_EXTRA;
+		break;
+
+	default:
+		return;
+	}
+
+	if (press) {
+		m_buttons |= (1u << id);
+	}
+	else {
+		m_buttons &= ~(1u << id);
+	}
+	m_device->key(code, press);
+}
+
+void
+UinputScreen::fakeMouseMove(SInt32 x, SInt32 y)
+{
+	m_device->moveAbsolute(x, y);
+}
+
+void
+UinputScreen::fakeMouseRelativeMove(SInt32 dx, SInt32 dy) const
+{
+	m_device->moveRelative(dx, dy);
+}
+
+void
+UinputScreen::fakeMouseWheel(SInt32 xDelta, SInt32 yDelta) const
+{
+	m_device->wheel(xDelta, yDelta);
+}
+
+void
+UinputScreen::enable()
+{
+	// do nothing
+}
+
+void
+UinputScreen::disable()
+{
+	// do nothing
+}
+
+void
+UinputScreen::enter()
+{
+	// do nothing
+}
+
+bool
+UinputScreen::leave()
+{
+	return true;
+}
+
+bool
+UinputScreen::setClipboard(ClipboardID, const IClipboard*)
+{
+	return false;
+}
+
+void
+UinputScreen::checkClipboards()
+{
+	// do nothing
+}
+
+void
+UinputScreen::openScreensaver(bool)
+{
+	// do nothing
+}
+
+void
+UinputScreen::closeScreensaver()
+{
+	// do nothing
+}
+
+void
+UinputScreen::screensaver(bool)
+{
+	// do nothing
+}
+
+void
+UinputScreen::resetOptions()
+{
+	// do nothing
+}
+
+void
+UinputScreen::setOptions(const OptionsList&)
+{
+	// do nothing
+}
+
+void
+UinputScreen::setSequenceNumber(UInt32)
+{
+	// do nothing
+}
+
+bool
+UinputScreen::isPrimary() const
+{
+	return false;
+}
+
+void
+UinputScreen::handleSystemEvent(const Event&, void*)
+{
+	// no system events
+}
+
+void
+UinputScreen::updateButtons()
+{
+	// do nothing
+}
+
+IKeyState*
+UinputScreen::getKeyState() const
+{
+	return m_keyState;
+}
@@ -23,6 +23,7 @@
 #include "platform/XWindowsClipboardUTF8Converter.h"
 #include "platform/XWindowsClipboardHTMLConverter.h"
 #include "platform/XWindowsClipboardBMPConverter.h"
+#include "platform/XWindowsServerTime.h"
 #include "platform/XWindowsUtil.h"
 #include "mt/Thread.h"
 #include "arch/Arch.h"
@@ -39,15 +40,19 @@
 //
 
 XWindowsClipboard::XWindowsClipboard(Display* display,
-				Window window, ClipboardID id) :
+				Window window, ClipboardID id,
+				XWindowsServerTime* serverTime) :
 	m_display(display),
 	m_window(window),
 	m_id(id),
+	m_serverTime(serverTime),
 	m_open(false),
 	m_time(0),
 	m_owner(false),
 	m_timeOwned(0),
-	m_timeLost(0)
+	m_timeLost(0),
+	m_numConversions(0),
+	m_numPropertyWrites(0)
 {
 	// get some atoms
 	m_atomTargets         = XInternAtom(m_display, "TARGETS", False);
@@ -175,17 +180,33 @@ XWindowsClipboard::addSimpleRequest(Window requestor,
 		type = getTimestampData(data, &format);
 	}
 	else {
-		IXWindowsClipboardConverter* converter = getConverter(target);
-		if (converter != NULL) {
-			IClipboard::EFormat clipboardFormat = converter->getFormat();
-			if (m_added[clipboardFormat]) {
-				try {
-					data   = converter->fromIClipboard(m_data[clipboardFormat]);
-					format = converter->getDataSize();
-					type   = converter->getAtom();
-				}
-				catch (...) {
-					// ignore -- cannot convert
+		// the data can't change while we own the selection so reuse
+		// any earlier conversion to this target
+		ConversionMap::const_iterator cached = m_conversions.find(target);
+		if (cached != m_conversions.end()) {
+			data   = cached->second.m_data;
+			format = cached->second.m_format;
+			type   = cached->second.m_type;
+		}
+		else {
+			IXWindowsClipboardConverter* converter = getConverter(target);
+			if (converter != NULL) {
+				IClipboard::EFormat clipboardFormat = converter->getFormat();
+				if (m_added[clipboardFormat]) {
+					try {
+						++m_numConversions;
+						data   = converter->fromIClipboard(m_data[clipboardFormat]);
+						format = converter->getDataSize();
+						type   = converter->getAtom();
+
+						Conversion& conversion = m_conversions[target];
+						conversion.m_data   = data;
+						conversion.m_format = format;
+						conversion.m_type   = type;
+					}
+					catch (...) {
+						// ignore -- cannot convert
+					}
 				}
 			}
 		}
@@ -265,6 +286,18 @@ XWindowsClipboard::getSelection() const
 	return m_selection;
 }
 
+UInt32
+XWindowsClipboard::getConversions() const
+{
+	return m_numConversions;
+}
+
+UInt32
+XWindowsClipboard::getPropertyWrites() const
+{
+	return m_numPropertyWrites;
+}
+
 bool
 XWindowsClipboard::empty()
 {
@@ -308,6 +341,7 @@ XWindowsClipboard::add(EFormat format, const String& data)
 
 	m_data[format]  = data;
 	m_added[format] = true;
+	m_conversions.clear();
 
 	// FIXME -- set motif clipboard item?
 }
@@ -471,6 +505,7 @@ XWindowsClipboard::doClearCache()
 		m_data[index]  = "";
 		m_added[index] = false;
 	}
+	m_conversions.clear();
 }
 
 void
@@ -620,7 +655,7 @@ XWindowsClipboard::motifLockClipboard() const
 	// FIXME -- is this right?  there's a race condition here --
 	// A grabs successfully, B grabs successfully, A thinks it
 	// still has the grab until it gets a SelectionClear.
-	Time time = XWindowsUtil::getCurrentTime(m_display, m_window);
+	Time time = getCurrentTime();
 	XSetSelectionOwner(m_display, m_atomMotifClipLock, m_window, time);
     lockOwner = XGetSelectionOwner(m_display, m_atomMotifClipLock);
 	if (lockOwner != m_window) {
@@ -644,7 +679,7 @@ XWindowsClipboard::motifUnlockClipboard() const
 	}
 
 	// release lock
-	Time time = XWindowsUtil::getCurrentTime(m_display, m_window);
+	Time time = getCurrentTime();
 	XSetSelectionOwner(m_display, m_atomMotifClipLock, None, time);
 }
 
@@ -1005,13 +1040,16 @@ XWindowsClipboard::sendReply(Reply* reply)
 		LOG((CLOG_DEBUG1 "clipboard: setting property on 0x%08x,%d,%d", reply->m_requestor, reply->m_target, reply->m_property));
 
 		// send using INCR if already sending incrementally or if reply
-		// is too large, otherwise just send it.
-		const UInt32 maxRequestSize = 3 * XMaxRequestSize(m_display);
+		// is too large, otherwise just send it.  with BIG-REQUESTS
+		// even very large selections usually go in one write.
+		const UInt32 maxRequestSize =
+			3 * XWindowsUtil::getMaxRequestSize(m_display);
 		const bool useINCR = (reply->m_data.size() > maxRequestSize);
 
 		// send INCR reply if incremental and we haven't replied yet
 		if (useINCR && !reply->m_replied) {
 			UInt32 size = reply->m_data.size();
+			++m_numPropertyWrites;
 			if (!XWindowsUtil::setWindowProperty(m_display,
 								reply->m_requestor, reply->m_property,
 								&size, 4, m_atomINCR, 32)) {
@@ -1027,6 +1065,7 @@ XWindowsClipboard::sendReply(Reply* reply)
 				size = maxRequestSize;
 
 			// send it
+			++m_numPropertyWrites;
 			if (!XWindowsUtil::setWindowProperty(m_display,
 								reply->m_requestor, reply->m_property,
 								reply->m_data.data() + reply->m_ptr,
@@ -1200,7 +1239,7 @@ XWindowsClipboard::wasOwnedAtTime(::Time time) const
 			return true;
 		}
 		else {
-			lost = XWindowsUtil::getCurrentTime(m_display, m_window);
+			lost = getCurrentTime();
 		}
 	}
 	else {
@@ -1251,6 +1290,15 @@ XWindowsClipboard::getTimestampData(String& data, int* format) const
 	return m_atomInteger;
 }
 
+::Time
+XWindowsClipboard::getCurrentTime() const
+{
+	if (m_serverTime != NULL) {
+		return m_serverTime->get();
+	}
+	return XWindowsUtil::getCurrentTime(m_display, m_window);
+}
+
 
 //
 // XWindowsClipboard::CICCCMGetClipboard
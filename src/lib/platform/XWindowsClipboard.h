@@ -31,15 +31,18 @@
 #endif
 
 class IXWindowsClipboardConverter;
+class XWindowsServerTime;
 
 //! X11 clipboard implementation
 class XWindowsClipboard : public IClipboard {
 public:
 	/*!
 	Use \c window as the window that owns or interacts with the
-	clipboard identified by \c id.
+	clipboard identified by \c id.  The X server time comes from
+	\c serverTime if it isn't NULL, otherwise from the server.
 	*/
-	XWindowsClipboard(Display*, Window window, ClipboardID id);
+	XWindowsClipboard(Display*, Window window, ClipboardID id,
+							XWindowsServerTime* serverTime = NULL);
 	virtual ~XWindowsClipboard();
 
 	//! Notify clipboard was lost
@@ -86,6 +89,22 @@ public:
 	*/
 	Atom				getSelection() const;
 
+	//! Get conversion count
+	/*!
+	Returns the number of times data was converted to an X selection
+	format to serve a request.  Conversions are cached per target
+	while we own the selection so repeated pastes don't add to this.
+	*/
+	UInt32				getConversions() const;
+
+	//! Get property write count
+	/*!
+	Returns the number of property writes made to serve requests.
+	Each write after the first of an INCR transfer waits for the
+	requestor to delete the property.
+	*/
+	UInt32				getPropertyWrites() const;
+
 	// IClipboard overrides
 	virtual bool		empty();
 	virtual void		add(EFormat, const String& data);
@@ -246,9 +265,18 @@ private:
 		// index of next byte in m_data to send
 		UInt32			m_ptr;
 	};
+	// selection data already converted for a target
+	class Conversion {
+	public:
+		String			m_data;
+		Atom			m_type;
+		int				m_format;
+	};
+
 	typedef std::list<Reply*> ReplyList;
 	typedef std::map<Window, ReplyList> ReplyMap;
 	typedef std::map<Window, long> ReplyEventMask;
+	typedef std::map<Atom, Conversion> ConversionMap;
 
 	// ICCCM interoperability methods
 	void				icccmFillCache();
@@ -282,12 +310,16 @@ private:
 	Atom				getTargetsData(String&, int* format) const;
 	Atom				getTimestampData(String&, int* format) const;
 
+	// get the X server time
+	::Time				getCurrentTime() const;
+
 private:
 	typedef std::vector<IXWindowsClipboardConverter*> ConverterList;
 
 	Display*			m_display;
 	Window				m_window;
 	ClipboardID			m_id;
+	XWindowsServerTime*	m_serverTime;
 	Atom				m_selection;
 	mutable bool		m_open;
 	mutable Time		m_time;
@@ -309,6 +341,11 @@ private:
 	ReplyMap			m_replies;
 	ReplyEventMask		m_eventMasks;
 
+	// converted data by target while we own the selection
+	ConversionMap		m_conversions;
+	UInt32				m_numConversions;
+	UInt32				m_numPropertyWrites;
+
 	// clipboard format converters
 	ConverterList		m_converters;
 
@@ -18,6 +18,7 @@
 
 #include "platform/XWindowsEventQueueBuffer.h"
 
+#include "platform/XWindowsServerTime.h"
 #include "mt/Lock.h"
 #include "mt/Thread.h"
 #include "base/Event.h"
@@ -53,11 +54,13 @@ class EventQueueTimer { };
 //
 
 XWindowsEventQueueBuffer::XWindowsEventQueueBuffer(
-		Display* display, Window window, IEventQueue* events) :
+		Display* display, Window window, IEventQueue* events,
+		XWindowsServerTime* serverTime) :
 	m_events(events),
 	m_display(display),
 	m_window(window),
-	m_waiting(false)
+	m_waiting(false),
+	m_serverTime(serverTime)
 {
 	assert(m_display != NULL);
 	assert(m_window  != None);
@@ -207,6 +210,9 @@ XWindowsEventQueueBuffer::getEvent(Event& event, UInt32& dataID)
 
 	// get next event
 	XNextEvent(m_display, &m_event);
+	if (m_serverTime != NULL) {
+		m_serverTime->update(m_event);
+	}
 
 	// process event
 	if (m_event.xany.type == ClientMessage &&
@@ -29,11 +29,16 @@
 #endif
 
 class IEventQueue;
+class XWindowsServerTime;
 
 //! Event queue buffer for X11
 class XWindowsEventQueueBuffer : public IEventQueueBuffer {
 public:
-	XWindowsEventQueueBuffer(Display*, Window, IEventQueue* events);
+	/*!
+	If \c serverTime isn't NULL it's updated with every event read.
+	*/
+	XWindowsEventQueueBuffer(Display*, Window, IEventQueue* events,
+							XWindowsServerTime* serverTime = NULL);
 	virtual ~XWindowsEventQueueBuffer();
 
 	// IEventQueueBuffer overrides
@@ -61,4 +66,5 @@ private:
 	bool				m_waiting;
 	int					m_pipefd[2];
 	IEventQueue*		m_events;
+	XWindowsServerTime*	m_serverTime;
 };
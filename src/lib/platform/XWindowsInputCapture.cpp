@@ -0,0 +1,229 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "platform/XWindowsInputCapture.h"
+
+#include "synergy/XScreen.h"
+#include "base/Log.h"
+
+#if HAVE_POLL
+#	include <poll.h>
+#else
+#	if HAVE_SYS_SELECT_H
+#		include <sys/select.h>
+#	endif
+#	if HAVE_SYS_TIME_H
+#		include <sys/time.h>
+#	endif
+#	if HAVE_SYS_TYPES_H
+#		include <sys/types.h>
+#	endif
+#endif
+#ifdef HAVE_XI2
+#	include <X11/extensions/XInput2.h>
+#endif
+
+// records held for the main thread.  at 1000Hz that's a second of
+// motion.
+static const UInt32		s_capacity = 1024;
+
+//
+// XWindowsInputCapture
+//
+
+XWindowsInputCapture::XWindowsInputCapture(const char* displayName,
+		IEventQueue* events, void* eventTarget) :
+	InputCapture(events, eventTarget, s_capacity),
+	m_display(NULL),
+	m_root(None),
+	m_xiOpcode(0)
+{
+	m_display = XOpenDisplay(displayName);
+	if (m_display == NULL) {
+		throw XScreenOpenFailure();
+	}
+	m_root = DefaultRootWindow(m_display);
+
+#ifdef HAVE_XI2
+	int event, error;
+	int major = 2, minor = 1;
+	if (!XQueryExtension(m_display, "XInputExtension",
+							&m_xiOpcode, &event, &error) ||
+		XIQueryVersion(m_display, &major, &minor) != Success ||
+		(major == 2 && minor < 1)) {
+		XCloseDisplay(m_display);
+		throw XScreenXInputFailure();
+	}
+
+	unsigned char bits[XIMaskLen(XI_LASTEVENT)] = { 0 };
+	XIEventMask mask;
+	mask.deviceid = XIAllMasterDevices;
+	mask.mask_len = sizeof(bits);
+	mask.mask     = bits;
+	XISetMask(bits, XI_RawMotion);
+	XISetMask(bits, XI_RawButtonPress);
+	XISetMask(bits, XI_RawButtonRelease);
+	XISelectEvents(m_display, m_root, &mask, 1);
+#else
+	XCloseDisplay(m_display);
+	throw XScreenXInputFailure();
+#endif
+
+	updateButtons();
+	XFlush(m_display);
+}
+
+XWindowsInputCapture::~XWindowsInputCapture()
+{
+	stop();
+	XCloseDisplay(m_display);
+}
+
+void
+XWindowsInputCapture::capture(double timeout)
+{
+	// wait for input
+	if (XPending(m_display) == 0) {
+		int fd = ConnectionNumber(m_display);
+#if HAVE_POLL
+		struct pollfd pfd;
+		pfd.fd      = fd;
+		pfd.events  = POLLIN;
+		pfd.revents = 0;
+		poll(&pfd, 1, static_cast<int>(1000.0 * timeout));
+#else
+		struct timeval tv;
+		tv.tv_sec  = static_cast<int>(timeout);
+		tv.tv_usec = static_cast<int>(1.0e+6 * (timeout - tv.tv_sec));
+		fd_set rfds;
+		FD_ZERO(&rfds);
+		FD_SET(fd, &rfds);
+		select(fd + 1, SELECT_TYPE_ARG234 &rfds,
+							SELECT_TYPE_ARG234 NULL,
+							SELECT_TYPE_ARG234 NULL,
+							SELECT_TYPE_ARG5   &tv);
+#endif
+	}
+
+	while (XPending(m_display) > 0) {
+		XEvent xevent;
+		XNextEvent(m_display, &xevent);
+
+		if (xevent.type == MappingNotify) {
+			if (xevent.xmapping.request == MappingPointer) {
+				updateButtons();
+			}
+			continue;
+		}
+
+		// a later position supersedes this one so don't spend a round
+		// trip querying it
+		if (isRawMotion(xevent) && QLength(m_display) > 0) {
+			XEvent xnext;
+			XPeekEvent(m_display, &xnext);
+			if (isRawMotion(xnext)) {
+				continue;
+			}
+		}
+
+		XGenericEventCookie* cookie = &xevent.xcookie;
+		if (cookie->type == GenericEvent &&
+			cookie->extension == m_xiOpcode &&
+			XGetEventData(m_display, cookie)) {
+			onRawEvent(cookie);
+			XFreeEventData(m_display, cookie);
+		}
+	}
+}
+
+void
+XWindowsInputCapture::onRawEvent(XGenericEventCookie* cookie)
+{
+#ifdef HAVE_XI2
+	const XIRawEvent* raw = static_cast<const XIRawEvent*>(cookie->data);
+
+	InputRecord record;
+	switch (cookie->evtype) {
+	case XI_RawMotion:
+		record.m_type   = InputRecord::kMotion;
+		record.m_button = 0;
+		break;
+
+	case XI_RawButtonPress:
+	case XI_RawButtonRelease:
+		record.m_type   = (cookie->evtype == XI_RawButtonPress) ?
+							InputRecord::kButtonDown : InputRecord::kButtonUp;
+
+		// raw events report the physical button
+		record.m_button = raw->detail;
+		if (raw->detail >= 1 &&
+			raw->detail <= static_cast<int>(m_buttons.size())) {
+			record.m_button = m_buttons[raw->detail - 1];
+		}
+		if (record.m_button == 0) {
+			// button is disabled
+			return;
+		}
+		break;
+
+	default:
+		return;
+	}
+
+	// stamp the generation before sampling the position so a sample
+	// taken after a warp is never mistaken for one from before it
+	record.m_generation = getGeneration();
+	record.m_time       = static_cast<UInt32>(raw->time);
+
+	Window root, window;
+	int xRoot, yRoot, xWindow, yWindow;
+	unsigned int state;
+	if (!XQueryPointer(m_display, m_root, &root, &window,
+							&xRoot, &yRoot, &xWindow, &yWindow, &state)) {
+		// pointer is on another screen
+		return;
+	}
+	record.m_x     = xRoot;
+	record.m_y     = yRoot;
+	record.m_state = state;
+
+	LOG((CLOG_DEBUG2 "captured raw event %d at %d,%d", cookie->evtype, xRoot, yRoot));
+	post(record);
+#endif
+}
+
+bool
+XWindowsInputCapture::isRawMotion(const XEvent& xevent) const
+{
+#ifdef HAVE_XI2
+	return (xevent.xcookie.type == GenericEvent &&
+			xevent.xcookie.extension == m_xiOpcode &&
+			xevent.xcookie.evtype == XI_RawMotion);
+#else
+	return false;
+#endif
+}
+
+void
+XWindowsInputCapture::updateButtons()
+{
+	int numButtons = XGetPointerMapping(m_display, NULL, 0);
+	m_buttons.resize(numButtons);
+	if (numButtons > 0) {
+		XGetPointerMapping(m_display, &m_buttons[0], numButtons);
+	}
+}
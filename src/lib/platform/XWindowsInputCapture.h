@@ -0,0 +1,68 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "synergy/InputCapture.h"
+#include "common/stdvector.h"
+
+#if X_DISPLAY_MISSING
+#	error X11 is required to build synergy
+#else
+#	include <X11/Xlib.h>
+#endif
+
+//! X11 input capture
+/*!
+Reads XInput2 raw pointer motion and button events on a connection of
+its own so they're read even while the main thread is busy.  Raw events
+carry no position so each record holds the root position and state
+from a pointer query made on the capture thread.  Button records hold
+the logical button and every record holds the X server time.
+
+Requires XInput 2.1 or later, where raw events reach every client that
+selects them and not only the one holding a grab.
+*/
+class XWindowsInputCapture : public InputCapture {
+public:
+	/*!
+	Throws XScreenOpenFailure if the display can't be opened and
+	XScreenXInputFailure if XInput 2.1 isn't available.
+	*/
+	XWindowsInputCapture(const char* displayName,
+							IEventQueue* events, void* eventTarget);
+	virtual ~XWindowsInputCapture();
+
+protected:
+	// InputCapture overrides
+	virtual void		capture(double timeout);
+
+private:
+	void				onRawEvent(XGenericEventCookie*);
+	bool				isRawMotion(const XEvent&) const;
+	void				updateButtons();
+
+private:
+	typedef std::vector<unsigned char> ButtonMap;
+
+	Display*			m_display;
+	Window				m_root;
+	int					m_xiOpcode;
+
+	// m_buttons[i] is the logical button for physical button i+1
+	ButtonMap			m_buttons;
+};
@@ -20,16 +20,18 @@
 
 #include "platform/XWindowsClipboard.h"
 #include "platform/XWindowsEventQueueBuffer.h"
+#include "platform/XWindowsInputCapture.h"
 #include "platform/XWindowsKeyState.h"
 #include "platform/XWindowsScreenSaver.h"
+#include "platform/XWindowsServerTime.h"
 #include "platform/XWindowsUtil.h"
 #include "synergy/Clipboard.h"
+#include "synergy/InputCapture.h"
 #include "synergy/KeyMap.h"
 #include "synergy/XScreen.h"
 #include "arch/XArch.h"
 #include "arch/Arch.h"
 #include "base/Log.h"
-#include "base/Stopwatch.h"
 #include "base/String.h"
 #include "base/IEventQueue.h"
 #include "base/TMethodEventJob.h"
@@ -107,6 +109,8 @@ XWindowsScreen::XWindowsScreen(
 	m_w(0), m_h(0),
 	m_xCenter(0), m_yCenter(0),
 	m_xCursor(0), m_yCursor(0),
+	m_xPointer(0), m_yPointer(0),
+	m_pointerValid(false),
 	m_keyState(NULL),
 	m_lastFocus(None),
 	m_lastFocusRevert(RevertToNone),
@@ -114,12 +118,14 @@ XWindowsScreen::XWindowsScreen(
 	m_ic(NULL),
 	m_lastKeycode(0),
 	m_sequenceNumber(0),
+	m_serverTime(NULL),
 	m_screensaver(NULL),
 	m_screensaverNotify(false),
 	m_xtestIsXineramaUnaware(true),
 	m_preserveFocus(false),
 	m_xkb(false),
 	m_xi2detected(false),
+	m_inputCapture(NULL),
 	m_xrandr(false),
 	m_events(events),
 	PlatformScreen(events)
@@ -145,6 +151,7 @@ XWindowsScreen::XWindowsScreen(
 		m_root        = DefaultRootWindow(m_display);
 		saveShape();
 		m_window      = openWindow();
+		m_serverTime  = new XWindowsServerTime(m_display);
 		m_screensaver = new XWindowsScreenSaver(m_display,
 								m_window, getEventTarget(), events);
 		m_keyState    = new XWindowsKeyState(m_display, m_xkb, events, m_keyMap);
@@ -152,6 +159,7 @@ XWindowsScreen::XWindowsScreen(
 		LOG((CLOG_DEBUG "window is 0x%08x", m_window));
 	}
 	catch (...) {
+		delete m_serverTime;
 		if (m_display != NULL) {
 			XCloseDisplay(m_display);
 		}
@@ -163,7 +171,15 @@ XWindowsScreen::XWindowsScreen(
 #ifdef HAVE_XI2
 		m_xi2detected = detectXI2();
 		if (m_xi2detected) {
-			selectXIRawMotion();
+			// the capture thread makes Xlib calls of its own so it needs
+			// Xlib's thread support
+			if (disableXInitThreads) {
+				LOG((CLOG_DEBUG "not capturing pointer input on its own thread without XInitThreads()"));
+				selectXIRawMotion();
+			}
+			else if (!startInputCapture()) {
+				selectXIRawMotion();
+			}
 		} else
 #endif
 		{
@@ -181,7 +197,8 @@ XWindowsScreen::XWindowsScreen(
 
 	// initialize the clipboards
 	for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
-		m_clipboard[id] = new XWindowsClipboard(m_display, m_window, id);
+		m_clipboard[id] = new XWindowsClipboard(m_display, m_window, id,
+								m_serverTime);
 	}
 
 	// install event handlers
@@ -191,7 +208,15 @@ XWindowsScreen::XWindowsScreen(
 
 	// install the platform event queue
 	m_events->adoptBuffer(new XWindowsEventQueueBuffer(
-		m_display, m_window, m_events));
+		m_display, m_window, m_events, m_serverTime));
+
+	if (m_inputCapture != NULL) {
+		m_events->adoptHandler(m_events->forIPrimaryScreen().inputCaptured(),
+							getEventTarget(),
+							new TMethodEventJob<XWindowsScreen>(this,
+								&XWindowsScreen::handleInputCaptured));
+		m_inputCapture->start();
+	}
 }
 
 XWindowsScreen::~XWindowsScreen()
@@ -199,11 +224,17 @@ XWindowsScreen::~XWindowsScreen()
 	assert(s_screen  != NULL);
 	assert(m_display != NULL);
 
+	if (m_inputCapture != NULL) {
+		delete m_inputCapture;
+		m_events->removeHandler(m_events->forIPrimaryScreen().inputCaptured(),
+							getEventTarget());
+	}
 	m_events->adoptBuffer(NULL);
 	m_events->removeHandler(Event::kSystem, m_events->getSystemTarget());
 	for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
 		delete m_clipboard[id];
 	}
+	delete m_serverTime;
 	delete m_keyState;
 	delete m_screensaver;
 	m_keyState    = NULL;
@@ -269,6 +300,9 @@ XWindowsScreen::enter()
 {
 	screensaver(false);
 
+	// the pointer may have moved while we were grabbing it
+	invalidatePointerPos();
+
 	// release input context focus
 	if (m_ic != NULL) {
 		XUnsetICFocus(m_ic);
@@ -389,8 +423,7 @@ XWindowsScreen::setClipboard(ClipboardID id, const IClipboard* clipboard)
 	}
 
 	// get the actual time.  ICCCM does not allow CurrentTime.
-	Time timestamp = XWindowsUtil::getCurrentTime(
-								m_display, m_clipboard[id]->getWindow());
+	Time timestamp = m_serverTime->get();
 
 	if (clipboard != NULL) {
 		// save clipboard data
@@ -492,8 +525,7 @@ XWindowsScreen::getClipboard(ClipboardID id, IClipboard* clipboard) const
 	}
 
 	// get the actual time.  ICCCM does not allow CurrentTime.
-	Time timestamp = XWindowsUtil::getCurrentTime(
-								m_display, m_clipboard[id]->getWindow());
+	Time timestamp = m_serverTime->get();
 
 	// copy the clipboard
 	return Clipboard::copy(clipboard, m_clipboard[id], timestamp);
@@ -511,13 +543,15 @@ XWindowsScreen::getShape(SInt32& x, SInt32& y, SInt32& w, SInt32& h) const
 void
 XWindowsScreen::getCursorPos(SInt32& x, SInt32& y) const
 {
-	Window root, window;
-	int mx, my, xWindow, yWindow;
-	unsigned int mask;
-	if (XQueryPointer(m_display, m_root, &root, &window,
-								&mx, &my, &xWindow, &yWindow, &mask)) {
-		x = mx;
-		y = my;
+	if (m_pointerValid && isPointerPosTracked()) {
+		x = m_xPointer;
+		y = m_yPointer;
+		return;
+	}
+
+	unsigned int state;
+	if (queryPointer(x, y, state)) {
+		setPointerPos(x, y);
 	}
 	else {
 		x = m_xCenter;
@@ -801,11 +835,10 @@ bool
 XWindowsScreen::isAnyMouseButtonDown(UInt32& buttonID) const
 {
 	// query the pointer to get the button state
-	Window root, window;
-	int xRoot, yRoot, xWindow, yWindow;
+	SInt32 x, y;
 	unsigned int state;
-	if (XQueryPointer(m_display, m_root, &root, &window,
-								&xRoot, &yRoot, &xWindow, &yWindow, &state)) {
+	if (queryPointer(x, y, state)) {
+		setPointerPos(x, y);
 		return ((state & (Button1Mask | Button2Mask | Button3Mask |
 							Button4Mask | Button5Mask)) != 0);
 	}
@@ -842,6 +875,10 @@ XWindowsScreen::fakeMouseMove(SInt32 x, SInt32 y)
 							x, y, CurrentTime);
 	}
 	XFlush(m_display);
+
+	// the server confines the pointer to the screen
+	setPointerPos(std::max(m_x, std::min(x, m_x + m_w - 1)),
+				  std::max(m_y, std::min(y, m_y + m_h - 1)));
 }
 
 void
@@ -855,6 +892,9 @@ XWindowsScreen::fakeMouseRelativeMove(SInt32 dx, SInt32 dy) const
 		XTestFakeRelativeMotionEvent(m_display, dx, dy, CurrentTime);
 	}
 	XFlush(m_display);
+
+	// pointer acceleration means we can't know where this ends up
+	invalidatePointerPos();
 }
 
 void
@@ -1166,6 +1206,13 @@ XWindowsScreen::handleSystemEvent(const Event& event, void*)
 	// update key state
 	bool isRepeat = false;
 	if (m_isPrimary) {
+		if (m_inputCapture != NULL &&
+			(xevent->type == KeyPress || xevent->type == KeyRelease)) {
+			// pointer input read by the capture thread may not have been
+			// handled yet.  handle what came before this key first.
+			flushCapturedInput(xevent->xkey.time);
+		}
+
 		if (xevent->type == KeyRelease) {
 			// check if this is a key repeat by getting the next
 			// KeyPress event that has the same key and time as
@@ -1253,22 +1300,21 @@ XWindowsScreen::handleSystemEvent(const Event& event, void*)
 				cookie->type == GenericEvent &&
 				cookie->extension == xi_opcode) {
 			if (cookie->evtype == XI_RawMotion) {
-				// Get current pointer's position
-				Window root, child;
+				// Get current pointer's position.  raw events carry
+				// no position so this is the one query we can't avoid.
 				XMotionEvent xmotion;
 				xmotion.type = MotionNotify;
 				xmotion.send_event = False; // Raw motion
 				xmotion.display = m_display;
 				xmotion.window = m_window;
+				xmotion.root = m_root;
+				xmotion.subwindow = None;
 				/* xmotion's time, state and is_hint are not used */
+				SInt32 x = m_xCursor, y = m_yCursor;
 				unsigned int msk;
-					xmotion.same_screen = XQueryPointer(
-						m_display, m_root, &xmotion.root, &xmotion.subwindow,
-						&xmotion.x_root,
-						&xmotion.y_root,
-						&xmotion.x,
-						&xmotion.y,
-						&msk);
+					xmotion.same_screen = queryPointer(x, y, msk);
+					xmotion.x_root = xmotion.x = x;
+					xmotion.y_root = xmotion.y = y;
 					onMouseMove(xmotion);
 					XFreeEventData(m_display, cookie);
 					return;
@@ -1369,19 +1415,19 @@ XWindowsScreen::handleSystemEvent(const Event& event, void*)
 		return;
 
 	case ButtonPress:
-		if (m_isPrimary) {
+		if (m_isPrimary && m_inputCapture == NULL) {
 			onMousePress(xevent->xbutton);
 		}
 		return;
 
 	case ButtonRelease:
-		if (m_isPrimary) {
+		if (m_isPrimary && m_inputCapture == NULL) {
 			onMouseRelease(xevent->xbutton);
 		}
 		return;
 
 	case MotionNotify:
-		if (m_isPrimary) {
+		if (m_isPrimary && m_inputCapture == NULL) {
 			onMouseMove(xevent->xmotion);
 		}
 		return;
@@ -1415,6 +1461,7 @@ XWindowsScreen::handleSystemEvent(const Event& event, void*)
 
 				// requery/recalculate the screen shape
 				saveShape();
+				invalidatePointerPos();
 
 				// we need to resize m_window, otherwise we'll get a weird problem where moving
 				// off the server onto the client causes the pointer to warp to the
@@ -1587,6 +1634,7 @@ XWindowsScreen::onMouseMove(const XMotionEvent& xmotion)
 	// save position to compute delta of next motion
 	m_xCursor = xmotion.x_root;
 	m_yCursor = xmotion.y_root;
+	setPointerPos(xmotion.x_root, xmotion.y_root);
 
 	if (xmotion.send_event) {
 		// we warped the mouse.  discard events until we
@@ -1643,6 +1691,82 @@ XWindowsScreen::onMouseMove(const XMotionEvent& xmotion)
 	}
 }
 
+void
+XWindowsScreen::handleInputCaptured(const Event&, void*)
+{
+	InputRecord record;
+	while (m_inputCapture->take(record)) {
+		onCapturedInput(record);
+	}
+}
+
+void
+XWindowsScreen::flushCapturedInput(Time time)
+{
+	// X server time wraps so compare the difference
+	InputRecord record;
+	while (m_inputCapture->peek(record) &&
+			static_cast<SInt32>(record.m_time - static_cast<UInt32>(time)) <= 0) {
+		m_inputCapture->take(record);
+		onCapturedInput(record);
+	}
+}
+
+void
+XWindowsScreen::onCapturedInput(const InputRecord& record)
+{
+	switch (record.m_type) {
+	case InputRecord::kMotion: {
+		XMotionEvent xmotion;
+		xmotion.type        = MotionNotify;
+		xmotion.send_event  = False;
+		xmotion.display     = m_display;
+		xmotion.window      = m_window;
+		xmotion.root        = m_root;
+		xmotion.subwindow   = None;
+		xmotion.time        = record.m_time;
+		xmotion.x_root      = xmotion.x = record.m_x;
+		xmotion.y_root      = xmotion.y = record.m_y;
+		xmotion.state       = record.m_state;
+		xmotion.is_hint     = NotifyNormal;
+		xmotion.same_screen = True;
+		onMouseMove(xmotion);
+		break;
+	}
+
+	case InputRecord::kButtonDown:
+	case InputRecord::kButtonUp: {
+		// we only get core button events while we have the pointer
+		// grabbed.  the capture thread sees them all.
+		if (m_isOnScreen) {
+			break;
+		}
+
+		XButtonEvent xbutton;
+		xbutton.type        = (record.m_type == InputRecord::kButtonDown) ?
+								ButtonPress : ButtonRelease;
+		xbutton.send_event  = False;
+		xbutton.display     = m_display;
+		xbutton.window      = m_window;
+		xbutton.root        = m_root;
+		xbutton.subwindow   = None;
+		xbutton.time        = record.m_time;
+		xbutton.x_root      = xbutton.x = record.m_x;
+		xbutton.y_root      = xbutton.y = record.m_y;
+		xbutton.state       = record.m_state;
+		xbutton.button      = record.m_button;
+		xbutton.same_screen = True;
+		if (xbutton.type == ButtonPress) {
+			onMousePress(xbutton);
+		}
+		else {
+			onMouseRelease(xbutton);
+		}
+		break;
+	}
+	}
+}
+
 Cursor
 XWindowsScreen::createBlankCursor() const
 {
@@ -1933,14 +2057,72 @@ XWindowsScreen::warpCursorNoFlush(SInt32 x, SInt32 y)
 
 	// warp mouse
 	XWarpPointer(m_display, None, m_root, 0, 0, 0, 0, x, y);
+	setPointerPos(x, y);
 
 	// send an event that we can recognize after the mouse warp
 	XSendEvent(m_display, m_window, False, 0, &eventAfter);
 	XSync(m_display, False);
 
+	if (m_inputCapture != NULL) {
+		// the capture thread doesn't see those events.  it's enough
+		// that the warp has happened so drop what it read before.
+		m_inputCapture->invalidate();
+		m_xCursor = x;
+		m_yCursor = y;
+	}
+
 	LOG((CLOG_DEBUG2 "warped to %d,%d", x, y));
 }
 
+bool
+XWindowsScreen::queryPointer(SInt32& x, SInt32& y, unsigned int& state) const
+{
+	Window root, window;
+	int xRoot, yRoot, xWindow, yWindow;
+	if (!XQueryPointer(m_display, m_root, &root, &window,
+								&xRoot, &yRoot, &xWindow, &yWindow, &state)) {
+		return false;
+	}
+	x = xRoot;
+	y = yRoot;
+	return true;
+}
+
+Display*
+XWindowsScreen::getDisplay() const
+{
+	return m_display;
+}
+
+XWindowsServerTime*
+XWindowsScreen::getServerTime() const
+{
+	return m_serverTime;
+}
+
+void
+XWindowsScreen::setPointerPos(SInt32 x, SInt32 y) const
+{
+	m_xPointer     = x;
+	m_yPointer     = y;
+	m_pointerValid = true;
+}
+
+void
+XWindowsScreen::invalidatePointerPos() const
+{
+	m_pointerValid = false;
+}
+
+bool
+XWindowsScreen::isPointerPosTracked() const
+{
+	// we only see every pointer motion on the primary screen and,
+	// without XI2, only while we've grabbed the pointer.  on a
+	// secondary screen the local mouse can move it behind our back.
+	return (m_isPrimary && (m_xi2detected || !m_isOnScreen));
+}
+
 void
 XWindowsScreen::updateButtons()
 {
@@ -1978,45 +2160,29 @@ XWindowsScreen::grabMouseAndKeyboard()
 {
 	unsigned int event_mask = ButtonPressMask | ButtonReleaseMask | EnterWindowMask | LeaveWindowMask | PointerMotionMask;
 
-	// grab the mouse and keyboard.  keep trying until we get them.
-	// if we can't grab one after grabbing the other then ungrab
-	// and wait before retrying.  give up after s_timeout seconds.
-	static const double s_timeout = 1.0;
-	int result;
-	Stopwatch timer;
-	do {
-		// keyboard first
-		do {
-			result = XGrabKeyboard(m_display, m_window, True,
+	// grab the mouse and keyboard.  make one attempt only;  if another
+	// client holds either grab then the server retries from a timer so
+	// the event loop isn't stalled while we wait.
+	int result = XGrabKeyboard(m_display, m_window, True,
 								GrabModeAsync, GrabModeAsync, CurrentTime);
-			assert(result != GrabNotViewable);
-			if (result != GrabSuccess) {
-				LOG((CLOG_DEBUG2 "waiting to grab keyboard"));
-				ARCH->sleep(0.05);
-				if (timer.getTime() >= s_timeout) {
-					LOG((CLOG_DEBUG2 "grab keyboard timed out"));
-					return false;
-				}
-			}
-		} while (result != GrabSuccess);
-		LOG((CLOG_DEBUG2 "grabbed keyboard"));
+	assert(result != GrabNotViewable);
+	if (result != GrabSuccess) {
+		LOG((CLOG_DEBUG2 "can't grab keyboard yet"));
+		return false;
+	}
+	LOG((CLOG_DEBUG2 "grabbed keyboard"));
 
-		// now the mouse --- use event_mask to get EnterNotify, LeaveNotify events
-		result = XGrabPointer(m_display, m_window, False, event_mask,
+	// now the mouse --- use event_mask to get EnterNotify, LeaveNotify events
+	result = XGrabPointer(m_display, m_window, False, event_mask,
 								GrabModeAsync, GrabModeAsync,
 								m_window, None, CurrentTime);
-		assert(result != GrabNotViewable);
-		if (result != GrabSuccess) {
-			// back off to avoid grab deadlock
-			XUngrabKeyboard(m_display, CurrentTime);
-			LOG((CLOG_DEBUG2 "ungrabbed keyboard, waiting to grab pointer"));
-			ARCH->sleep(0.05);
-			if (timer.getTime() >= s_timeout) {
-				LOG((CLOG_DEBUG2 "grab pointer timed out"));
-				return false;
-			}
-		}
-	} while (result != GrabSuccess);
+	assert(result != GrabNotViewable);
+	if (result != GrabSuccess) {
+		// back off to avoid grab deadlock
+		XUngrabKeyboard(m_display, CurrentTime);
+		LOG((CLOG_DEBUG2 "ungrabbed keyboard, can't grab pointer yet"));
+		return false;
+	}
 
 	LOG((CLOG_DEBUG1 "grabbed pointer and keyboard"));
 	return true;
@@ -2093,4 +2259,21 @@ XWindowsScreen::selectXIRawMotion()
 	XISelectEvents(m_display, DefaultRootWindow(m_display), &mask, 1);
 	free(mask.mask);
 }
+
+bool
+XWindowsScreen::startInputCapture()
+{
+	// read pointer input on a thread of its own so a slow handler on
+	// the main thread can't hold it up
+	try {
+		m_inputCapture = new XWindowsInputCapture(
+							DisplayString(m_display), m_events, getEventTarget());
+		LOG((CLOG_DEBUG "capturing pointer input on its own thread"));
+		return true;
+	}
+	catch (XScreen&) {
+		LOG((CLOG_DEBUG "pointer input capture thread unavailable, needs XInput 2.1"));
+		return false;
+	}
+}
 #endif
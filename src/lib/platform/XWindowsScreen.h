@@ -29,9 +29,12 @@
 #	include <X11/Xlib.h>
 #endif
 
+class InputRecord;
 class XWindowsClipboard;
+class XWindowsInputCapture;
 class XWindowsKeyState;
 class XWindowsScreenSaver;
+class XWindowsServerTime;
 
 //! Implementation of IPlatformScreen for X11
 class XWindowsScreen : public PlatformScreen {
@@ -91,6 +94,15 @@ protected:
 	virtual void		updateButtons();
 	virtual IKeyState*	getKeyState() const;
 
+	// query the X server for the pointer position and button state.
+	// this is a round trip so callers should prefer the cached position.
+	virtual bool		queryPointer(SInt32& x, SInt32& y,
+							unsigned int& state) const;
+
+	// the display and the X server time tracked from its events
+	Display*			getDisplay() const;
+	XWindowsServerTime*	getServerTime() const;
+
 private:
 	// event sending
 	void				sendEvent(Event::Type, void* = NULL);
@@ -139,7 +151,13 @@ private:
 	bool				detectXI2();
 #ifdef HAVE_XI2
 	void				selectXIRawMotion();
+	bool				startInputCapture();
 #endif
+
+	// pointer input read by the capture thread
+	void				handleInputCaptured(const Event&, void*);
+	void				flushCapturedInput(Time time);
+	void				onCapturedInput(const InputRecord&);
 	void				selectEvents(Window) const;
 	void				doSelectEvents(Window) const;
 
@@ -149,6 +167,11 @@ private:
 
 	void				warpCursorNoFlush(SInt32 x, SInt32 y);
 
+	// cached pointer position
+	void				setPointerPos(SInt32 x, SInt32 y) const;
+	void				invalidatePointerPos() const;
+	bool				isPointerPosTracked() const;
+
 	void				refreshKeyboard(XEvent*);
 
 	static Bool			findKeyEvent(Display*, XEvent* xevent, XPointer arg);
@@ -189,6 +212,12 @@ private:
 	// last mouse position
 	SInt32				m_xCursor, m_yCursor;
 
+	// authoritative pointer position, kept up to date from motion
+	// events and our own warps so getCursorPos() needn't query the
+	// X server.  only valid while m_pointerValid is true.
+	mutable SInt32		m_xPointer, m_yPointer;
+	mutable bool		m_pointerValid;
+
 	// keyboard stuff
 	XWindowsKeyState*	m_keyState;
 
@@ -211,6 +240,9 @@ private:
 	XWindowsClipboard*	m_clipboard[kClipboardEnd];
 	UInt32				m_sequenceNumber;
 
+	// latest X server time, for clipboard time stamps
+	XWindowsServerTime*	m_serverTime;
+
 	// screen saver stuff
 	XWindowsScreenSaver*	m_screensaver;
 	bool				m_screensaverNotify;
@@ -239,6 +271,9 @@ private:
 
 	bool				m_xi2detected;
 
+	// reads pointer input on its own thread, if XI2 allows it
+	XWindowsInputCapture*	m_inputCapture;
+
 	// XRandR extension stuff
 	bool                m_xrandr;
 	int                 m_xrandrEventBase;
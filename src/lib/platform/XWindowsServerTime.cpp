@@ -0,0 +1,165 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "platform/XWindowsServerTime.h"
+
+#include "arch/Arch.h"
+#include "base/Log.h"
+
+#include <X11/Xatom.h>
+
+// how long after it arrives we estimate the server time from an
+// event's time stamp.  the server and our clocks run at the same rate
+// so this only needs to be short enough to ride out a clock change.
+static const double		s_maxAge = 2.0;
+
+//
+// XWindowsServerTime
+//
+
+XWindowsServerTime::XWindowsServerTime(Display* display) :
+	m_display(display),
+	m_window(None),
+	m_atomTimestamp(None),
+	m_time(CurrentTime),
+	m_timeAt(-1.0),
+	m_roundTrips(0)
+{
+	// an unmapped window of our own to change a property on, so we
+	// don't have to change the event mask of anybody else's window
+	XSetWindowAttributes attr;
+	attr.event_mask = PropertyChangeMask;
+	m_window        = XCreateWindow(m_display, DefaultRootWindow(m_display),
+							0, 0, 1, 1, 0, 0, InputOnly, CopyFromParent,
+							CWEventMask, &attr);
+	m_atomTimestamp = XInternAtom(m_display, "TIMESTAMP", False);
+}
+
+XWindowsServerTime::~XWindowsServerTime()
+{
+	// the window goes when the display is closed.  the display may
+	// already be gone so don't use it here.
+}
+
+void
+XWindowsServerTime::update(const XEvent& xevent)
+{
+	// events sent by other clients have whatever time they put there
+	if (xevent.xany.send_event) {
+		return;
+	}
+
+	Time time;
+	switch (xevent.type) {
+	case KeyPress:
+	case KeyRelease:
+		time = xevent.xkey.time;
+		break;
+
+	case ButtonPress:
+	case ButtonRelease:
+		time = xevent.xbutton.time;
+		break;
+
+	case MotionNotify:
+		time = xevent.xmotion.time;
+		break;
+
+	case EnterNotify:
+	case LeaveNotify:
+		time = xevent.xcrossing.time;
+		break;
+
+	case PropertyNotify:
+		time = xevent.xproperty.time;
+		break;
+
+	default:
+		// no time stamp or one chosen by a client
+		return;
+	}
+
+	if (time != CurrentTime) {
+		update(time, ARCH->time());
+	}
+}
+
+Time
+XWindowsServerTime::get()
+{
+	double age = ARCH->time() - m_timeAt;
+	if (m_timeAt >= 0.0 && age >= 0.0 && age < s_maxAge) {
+		// the server's clock has moved on at least this far since it
+		// stamped the event
+		return (m_time + static_cast<Time>(1000.0 * age)) & 0xffffffffu;
+	}
+
+	Time time = fetch();
+	update(time, ARCH->time());
+	return time;
+}
+
+UInt32
+XWindowsServerTime::getRoundTrips() const
+{
+	return m_roundTrips;
+}
+
+void
+XWindowsServerTime::update(Time time, double now)
+{
+	// keep the newest time.  X time is 32 bits and wraps so compare
+	// the difference rather than the times.
+	if (m_timeAt >= 0.0 && now >= m_timeAt) {
+		Time estimate = m_time + static_cast<Time>(1000.0 * (now - m_timeAt));
+		if (static_cast<SInt32>(static_cast<UInt32>(time - estimate)) < 0) {
+			return;
+		}
+	}
+	m_time   = time;
+	m_timeAt = now;
+}
+
+Time
+XWindowsServerTime::fetch()
+{
+	++m_roundTrips;
+
+	// do a zero-length append to get the current time
+	XLockDisplay(m_display);
+	unsigned char dummy;
+	XChangeProperty(m_display, m_window, m_atomTimestamp,
+							XA_INTEGER, 8, PropModeAppend, &dummy, 0);
+
+	XEvent xevent;
+	XIfEvent(m_display, &xevent, &XWindowsServerTime::isTimestampNotify,
+							reinterpret_cast<XPointer>(this));
+	XUnlockDisplay(m_display);
+
+	LOG((CLOG_DEBUG2 "fetched server time %u",
+							static_cast<UInt32>(xevent.xproperty.time)));
+	return xevent.xproperty.time;
+}
+
+Bool
+XWindowsServerTime::isTimestampNotify(Display*, XEvent* xevent, XPointer arg)
+{
+	XWindowsServerTime* self = reinterpret_cast<XWindowsServerTime*>(arg);
+	return (xevent->type             == PropertyNotify &&
+			xevent->xproperty.window == self->m_window &&
+			xevent->xproperty.atom   == self->m_atomTimestamp) ? True : False;
+}
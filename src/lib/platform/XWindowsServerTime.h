@@ -0,0 +1,90 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/basic_types.h"
+
+#if X_DISPLAY_MISSING
+#	error X11 is required to build synergy
+#else
+#	include <X11/Xlib.h>
+#endif
+
+//! X server time tracker
+/*!
+ICCCM doesn't allow CurrentTime for selection operations so we need
+the X server's time.  Asking for it means changing a property and
+waiting for the PropertyNotify, a round trip.  Instead this remembers
+the latest time stamp on the events we receive and, while that's
+recent, estimates the server time from it and how long ago it
+arrived.  Only when there's no recent event does it make the round
+trip.
+
+Not thread safe;  it's used from the thread reading events.
+*/
+class XWindowsServerTime {
+public:
+	XWindowsServerTime(Display*);
+	~XWindowsServerTime();
+
+	//! @name manipulators
+	//@{
+
+	//! Note an event's time stamp
+	/*!
+	Call with every event read from the display.  Events without a
+	server generated time stamp are ignored.
+	*/
+	void				update(const XEvent&);
+
+	//! Get the X server time
+	/*!
+	Returns the current X server time, making a round trip to the
+	server if no recent event carried a time stamp.
+	*/
+	Time				get();
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get the number of round trips
+	/*!
+	Returns how many times get() had to ask the server.
+	*/
+	UInt32				getRoundTrips() const;
+
+	//@}
+
+private:
+	void				update(Time, double now);
+	Time				fetch();
+
+	static Bool			isTimestampNotify(Display*, XEvent*, XPointer);
+
+private:
+	Display*			m_display;
+	Window				m_window;
+	Atom				m_atomTimestamp;
+
+	// the newest server time we know of and when we learned it
+	Time				m_time;
+	double				m_timeAt;
+
+	UInt32				m_roundTrips;
+};
@@ -1292,6 +1292,17 @@ static const KeySym s_map1008FF[] =
 
 XWindowsUtil::KeySymMap	XWindowsUtil::s_keySymToUCS4;
 
+long
+XWindowsUtil::getMaxRequestSize(Display* display)
+{
+	// zero means the server doesn't do BIG-REQUESTS
+	long size = XExtendedMaxRequestSize(display);
+	if (size == 0) {
+		size = XMaxRequestSize(display);
+	}
+	return size;
+}
+
 bool
 XWindowsUtil::getWindowProperty(Display* display, Window window,
 				Atom property, String* data, Atom* type,
@@ -1307,7 +1318,7 @@ XWindowsUtil::getWindowProperty(Display* display, Window window,
 
 	// read the property
 	bool okay = true;
-	const long length = XMaxRequestSize(display);
+	const long length = getMaxRequestSize(display);
 	long offset = 0;
 	unsigned long bytesLeft = 1;
 	while (bytesLeft != 0) {
@@ -1385,7 +1396,7 @@ XWindowsUtil::setWindowProperty(Display* display, Window window,
 				Atom property, const void* vdata, UInt32 size,
 				Atom type, SInt32 format)
 {
-	const UInt32 length       = 4 * XMaxRequestSize(display);
+	const UInt32 length       = 4 * getMaxRequestSize(display);
 	const unsigned char* data = static_cast<const unsigned char*>(vdata);
 	UInt32 datumSize    = static_cast<UInt32>(format / 8);
 	// format 32 on 64bit systems is 8 bytes not 4.
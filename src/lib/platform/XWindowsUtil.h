@@ -34,6 +34,14 @@ class XWindowsUtil {
 public:
 	typedef std::vector<KeySym> KeySyms;
 
+	//! Get maximum request size
+	/*!
+	Returns the largest request the server accepts, in 4 byte units.
+	This is the BIG-REQUESTS limit if the server supports that
+	extension, otherwise the core protocol limit.
+	*/
+	static long			getMaxRequestSize(Display*);
+
 	//! Get property
 	/*!
 	Gets property \c property on \c window.  \b Appends the data to
@@ -20,6 +20,7 @@
 
 #include "synergy/IClient.h"
 #include "base/String.h"
+#include "common/stdvector.h"
 
 namespace synergy { class IStream; }
 
@@ -41,6 +42,19 @@ public:
 	*/
 	void				setJumpCursorPos(SInt32 x, SInt32 y);
 
+	//! Send files
+	/*!
+	Starts sending \c paths, including the contents of directories, as
+	a file set.  Returns false if the client doesn't support file sets.
+	*/
+	virtual bool		sendFiles(const std::vector<String>&) { return false; }
+
+	//! Interrupt sending files
+	/*!
+	Stops a file set transfer started by sendFiles().
+	*/
+	virtual void		interruptFiles() { }
+
 	//@}
 	//! @name accessors
 	//@{
@@ -33,7 +33,8 @@
 
 ClientProxy1_0::ClientProxy1_0(const String& name, synergy::IStream* stream, IEventQueue* events) :
 	ClientProxy(name, stream),
-	m_heartbeatTimer(NULL),
+	m_heartbeatMonitor(HeartbeatMonitor::acquire(events)),
+	m_heartbeat(NULL),
 	m_parser(&ClientProxy1_0::parseHandshakeMessage),
 	m_events(events)
 {
@@ -54,10 +55,6 @@ ClientProxy1_0::ClientProxy1_0(const String& name, synergy::IStream* stream, IEv
 							stream->getEventTarget(),
 							new TMethodEventJob<ClientProxy1_0>(this,
 								&ClientProxy1_0::handleWriteError, NULL));
-	m_events->adoptHandler(Event::kTimer, this,
-							new TMethodEventJob<ClientProxy1_0>(this,
-								&ClientProxy1_0::handleFlatline, NULL));
-
 	setHeartbeatRate(kHeartRate, kHeartRate * kHeartBeatsUntilDeath);
 
 	LOG((CLOG_DEBUG1 "querying client \"%s\" info", getName().c_str()));
@@ -67,6 +64,7 @@ ClientProxy1_0::ClientProxy1_0(const String& name, synergy::IStream* stream, IEv
 ClientProxy1_0::~ClientProxy1_0()
 {
 	removeHandlers();
+	m_heartbeatMonitor->release();
 }
 
 void
@@ -89,7 +87,6 @@ ClientProxy1_0::removeHandlers()
 							getStream()->getEventTarget());
 	m_events->removeHandler(m_events->forIStream().outputShutdown(),
 							getStream()->getEventTarget());
-	m_events->removeHandler(Event::kTimer, this);
 
 	// remove timer
 	removeHeartbeatTimer();
@@ -98,26 +95,34 @@ ClientProxy1_0::removeHandlers()
 void
 ClientProxy1_0::addHeartbeatTimer()
 {
-	if (m_heartbeatAlarm > 0.0) {
-		m_heartbeatTimer = m_events->newOneShotTimer(m_heartbeatAlarm, this);
+	if (m_heartbeatAlarm > 0.0 && m_heartbeat == NULL) {
+		m_heartbeat = m_heartbeatMonitor->add(m_heartbeatAlarm, 0.0,
+							new TMethodEventJob<ClientProxy1_0>(this,
+								&ClientProxy1_0::handleFlatline, NULL),
+							NULL);
 	}
 }
 
 void
 ClientProxy1_0::removeHeartbeatTimer()
 {
-	if (m_heartbeatTimer != NULL) {
-		m_events->deleteTimer(m_heartbeatTimer);
-		m_heartbeatTimer = NULL;
+	if (m_heartbeat != NULL) {
+		m_heartbeatMonitor->remove(m_heartbeat);
+		m_heartbeat = NULL;
 	}
 }
 
 void
 ClientProxy1_0::resetHeartbeatTimer()
 {
-	// reset the alarm
-	removeHeartbeatTimer();
-	addHeartbeatTimer();
+	// reset the alarm.  this happens for every message so just note
+	// that we heard from the client.
+	if (m_heartbeat != NULL) {
+		m_heartbeat->touch();
+	}
+	else {
+		ClientProxy1_0::addHeartbeatTimer();
+	}
 }
 
 void
@@ -132,12 +137,19 @@ ClientProxy1_0::setHeartbeatRate(double, double alarm)
 	m_heartbeatAlarm = alarm;
 }
 
+HeartbeatMonitor*
+ClientProxy1_0::getHeartbeatMonitor() const
+{
+	return m_heartbeatMonitor;
+}
+
 void
 ClientProxy1_0::handleData(const Event&, void*)
 {
 	// handle messages until there are no more.  first read message code.
+	// messages are decoded in place when the stream has whole packets.
 	UInt8 code[4];
-	UInt32 n = getStream()->read(code, 4);
+	UInt32 n = ProtocolUtil::readCode(getStream(), code);
 	while (n != 0) {
 		// verify we got an entire code
 		if (n != 4) {
@@ -155,7 +167,7 @@ ClientProxy1_0::handleData(const Event&, void*)
 		}
 
 		// next message
-		n = getStream()->read(code, 4);
+		n = ProtocolUtil::readCode(getStream(), code);
 	}
 
 	// restart heartbeat timer
@@ -20,10 +20,10 @@
 
 #include "server/ClientProxy.h"
 #include "synergy/Clipboard.h"
+#include "synergy/HeartbeatMonitor.h"
 #include "synergy/protocol_types.h"
 
 class Event;
-class EventQueueTimer;
 class IEventQueue;
 
 //! Proxy for client implementing protocol version 1.0
@@ -71,6 +71,9 @@ protected:
 	virtual void		addHeartbeatTimer();
 	virtual void		removeHeartbeatTimer();
 	virtual bool		recvClipboard();
+
+	HeartbeatMonitor*	getHeartbeatMonitor() const;
+
 private:
 	void				disconnect();
 	void				removeHandlers();
@@ -101,7 +104,8 @@ private:
 
 	ClientInfo			m_info;
 	double				m_heartbeatAlarm;
-	EventQueueTimer*	m_heartbeatTimer;
+	HeartbeatMonitor*	m_heartbeatMonitor;
+	HeartbeatMonitor::Peer*	m_heartbeat;
 	MessageParser		m_parser;
 	IEventQueue*		m_events;
 };
@@ -33,7 +33,7 @@
 ClientProxy1_3::ClientProxy1_3(const String& name, synergy::IStream* stream, IEventQueue* events) :
 	ClientProxy1_2(name, stream, events),
 	m_keepAliveRate(kKeepAliveRate),
-	m_keepAliveTimer(NULL),
+	m_keepAlive(NULL),
 	m_events(events)
 {
 	setHeartbeatRate(kKeepAliveRate, kKeepAliveRate * kKeepAlivesUntilDeath);
@@ -83,17 +83,15 @@ void
 ClientProxy1_3::resetHeartbeatTimer()
 {
 	// reset the alarm but not the keep alive timer
-	ClientProxy1_2::removeHeartbeatTimer();
-	ClientProxy1_2::addHeartbeatTimer();
+	ClientProxy1_2::resetHeartbeatTimer();
 }
 
 void
 ClientProxy1_3::addHeartbeatTimer()
 {
-	// create and install a timer to periodically send keep alives
-	if (m_keepAliveRate > 0.0) {
-		m_keepAliveTimer = m_events->newTimer(m_keepAliveRate, NULL);
-		m_events->adoptHandler(Event::kTimer, m_keepAliveTimer,
+	// periodically send keep alives
+	if (m_keepAliveRate > 0.0 && m_keepAlive == NULL) {
+		m_keepAlive = getHeartbeatMonitor()->add(0.0, m_keepAliveRate, NULL,
 							new TMethodEventJob<ClientProxy1_3>(this,
 								&ClientProxy1_3::handleKeepAlive, NULL));
 	}
@@ -105,11 +103,10 @@ ClientProxy1_3::addHeartbeatTimer()
 void
 ClientProxy1_3::removeHeartbeatTimer()
 {
-	// remove the timer that sends keep alives periodically
-	if (m_keepAliveTimer != NULL) {
-		m_events->removeHandler(Event::kTimer, m_keepAliveTimer);
-		m_events->deleteTimer(m_keepAliveTimer);
-		m_keepAliveTimer = NULL;
+	// stop sending keep alives
+	if (m_keepAlive != NULL) {
+		getHeartbeatMonitor()->remove(m_keepAlive);
+		m_keepAlive = NULL;
 	}
 
 	// superclass does the alarm
@@ -43,6 +43,6 @@ protected:
 
 private:
 	double				m_keepAliveRate;
-	EventQueueTimer*	m_keepAliveTimer;
+	HeartbeatMonitor::Peer*	m_keepAlive;
 	IEventQueue*		m_events;
 };
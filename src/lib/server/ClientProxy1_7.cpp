@@ -0,0 +1,87 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "server/ClientProxy1_7.h"
+
+#include "server/Server.h"
+#include "synergy/FileSetChunk.h"
+#include "synergy/protocol_types.h"
+#include "base/TMethodEventJob.h"
+#include "base/Log.h"
+
+#include <cstring>
+
+//
+// ClientProxy1_7
+//
+
+ClientProxy1_7::ClientProxy1_7(const String& name, synergy::IStream* stream, Server* server, IEventQueue* events) :
+	ClientProxy1_6(name, stream, server, events),
+	m_events(events),
+	m_fileSetSender(events, this)
+{
+	m_events->adoptHandler(m_events->forFile().fileSetChunkSending(),
+								this,
+								new TMethodEventJob<ClientProxy1_7>(this,
+									&ClientProxy1_7::handleFileSetSendingEvent));
+}
+
+ClientProxy1_7::~ClientProxy1_7()
+{
+	m_fileSetSender.interrupt();
+	m_events->removeHandler(m_events->forFile().fileSetChunkSending(), this);
+}
+
+bool
+ClientProxy1_7::sendFiles(const std::vector<String>& paths)
+{
+	LOG((CLOG_DEBUG "sending file set to \"%s\"", getName().c_str()));
+	m_fileSetSender.start(paths);
+	return true;
+}
+
+void
+ClientProxy1_7::interruptFiles()
+{
+	m_fileSetSender.interrupt();
+}
+
+bool
+ClientProxy1_7::parseMessage(const UInt8* code)
+{
+	if (memcmp(code, kMsgDFileSetTransfer, 4) == 0) {
+		fileSetChunkReceived();
+		return true;
+	}
+	return ClientProxy1_6::parseMessage(code);
+}
+
+void
+ClientProxy1_7::handleFileSetSendingEvent(const Event& event, void*)
+{
+	static_cast<FileSetChunk*>(event.getDataObject())->send(getStream());
+	m_fileSetSender.chunkSent();
+}
+
+void
+ClientProxy1_7::fileSetChunkReceived()
+{
+	FileSetChunk chunk;
+	if (chunk.read(getStream())) {
+		getServer()->fileSetChunkReceived(chunk);
+	}
+}
@@ -0,0 +1,131 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "server/ClientProxy1_8.h"
+
+#include "synergy/ProtocolUtil.h"
+#include "synergy/StreamChunker.h"
+#include "synergy/ClipboardChunk.h"
+#include "synergy/protocol_types.h"
+#include "io/IStream.h"
+#include "base/Log.h"
+
+#include <cstring>
+
+//
+// ClientProxy1_8
+//
+
+ClientProxy1_8::ClientProxy1_8(const String& name, synergy::IStream* stream, Server* server, IEventQueue* events) :
+	ClientProxy1_7(name, stream, server, events),
+	m_events(events)
+{
+	// do nothing
+}
+
+ClientProxy1_8::~ClientProxy1_8()
+{
+	// do nothing
+}
+
+void
+ClientProxy1_8::setClipboard(ClipboardID id, const IClipboard* clipboard)
+{
+	// ignore if this clipboard is already clean
+	if (m_clipboard[id].m_dirty) {
+		// this clipboard is now clean
+		m_clipboard[id].m_dirty = false;
+		Clipboard::copy(&m_clipboard[id].m_clipboard, clipboard);
+
+		// send only what the client doesn't already have
+		String data = m_clipboardDelta[id].makeUpdate(&m_clipboard[id].m_clipboard);
+		LOG((CLOG_DEBUG "sending clipboard %d to \"%s\" size=%d", id, getName().c_str(), data.size()));
+
+		StreamChunker::sendClipboard(data, data.size(), id, 0, m_events, this);
+	}
+}
+
+bool
+ClientProxy1_8::recvClipboard()
+{
+	ClipboardID id;
+	UInt32 seq;
+	int r = ClipboardChunk::assemble(getStream(), m_clipboardData, id, seq);
+
+	if (r == kStart) {
+		size_t size = ClipboardChunk::getExpectedSize();
+		LOG((CLOG_DEBUG "receiving clipboard %d size=%d", id, size));
+	}
+	else if (r == kFinish) {
+		LOG((CLOG_DEBUG "received client \"%s\" clipboard %d seqnum=%d, size=%d",
+				getName().c_str(), id, seq, m_clipboardData.size()));
+
+		// apply the update to what the client sent before
+		UInt32 version = 0;
+		bool applied = m_clipboardDelta[id].applyUpdate(m_clipboardData,
+							&m_clipboard[id].m_clipboard, version);
+		m_clipboardData.clear();
+		ProtocolUtil::writef(getStream(), kMsgCClipboardAck,
+							id, version, applied ? 1 : 0);
+		if (!applied) {
+			// the client will send it all again
+			return true;
+		}
+		m_clipboard[id].m_sequenceNumber = seq;
+
+		// notify
+		ClipboardInfo* info = new ClipboardInfo;
+		info->m_id = id;
+		info->m_sequenceNumber = seq;
+		m_events->addEvent(Event(m_events->forClipboard().clipboardChanged(),
+								 getEventTarget(), info));
+	}
+
+	return true;
+}
+
+bool
+ClientProxy1_8::parseMessage(const UInt8* code)
+{
+	if (memcmp(code, kMsgCClipboardAck, 4) == 0) {
+		return recvClipboardAck();
+	}
+	return ClientProxy1_7::parseMessage(code);
+}
+
+bool
+ClientProxy1_8::recvClipboardAck()
+{
+	ClipboardID id;
+	UInt32 version;
+	UInt8 applied;
+	if (!ProtocolUtil::readf(getStream(), kMsgCClipboardAck + 4,
+							&id, &version, &applied)) {
+		return false;
+	}
+	LOG((CLOG_DEBUG2 "recv clipboard %d ack version=%d applied=%d", id, version, applied));
+	if (id >= kClipboardEnd) {
+		return false;
+	}
+
+	if (!m_clipboardDelta[id].acknowledge(version, applied != 0)) {
+		String data = m_clipboardDelta[id].makeResync();
+		LOG((CLOG_DEBUG "resending clipboard %d to \"%s\" size=%d", id, getName().c_str(), data.size()));
+		StreamChunker::sendClipboard(data, data.size(), id, 0, m_events, this);
+	}
+	return true;
+}
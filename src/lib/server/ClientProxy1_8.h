@@ -0,0 +1,48 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "server/ClientProxy1_7.h"
+#include "synergy/ClipboardDelta.h"
+
+class Server;
+class IEventQueue;
+
+//! Proxy for client implementing protocol version 1.8
+class ClientProxy1_8 : public ClientProxy1_7 {
+public:
+	ClientProxy1_8(const String& name, synergy::IStream* adoptedStream, Server* server, IEventQueue* events);
+	~ClientProxy1_8();
+
+	// IClient overrides
+	virtual void		setClipboard(ClipboardID id, const IClipboard* clipboard);
+
+	// ClientProxy1_0 overrides
+	virtual bool		recvClipboard();
+
+	// ClientProxy1_5 overrides
+	virtual bool		parseMessage(const UInt8* code);
+
+private:
+	bool				recvClipboardAck();
+
+private:
+	IEventQueue*		m_events;
+	ClipboardDelta		m_clipboardDelta[kClipboardEnd];
+	String				m_clipboardData;
+};
@@ -26,6 +26,8 @@
 #include "server/ClientProxy1_4.h"
 #include "server/ClientProxy1_5.h"
 #include "server/ClientProxy1_6.h"
+#include "server/ClientProxy1_7.h"
+#include "server/ClientProxy1_8.h"
 #include "synergy/protocol_types.h"
 #include "synergy/ProtocolUtil.h"
 #include "synergy/XSynergy.h"
@@ -232,6 +234,14 @@ ClientProxyUnknown::handleData(const Event&, void*)
 			case 6:
 				m_proxy = new ClientProxy1_6(name, m_stream, m_server, m_events);
 				break;
+
+			case 7:
+				m_proxy = new ClientProxy1_7(name, m_stream, m_server, m_events);
+				break;
+
+			case 8:
+				m_proxy = new ClientProxy1_8(name, m_stream, m_server, m_events);
+				break;
 			}
 		}
 
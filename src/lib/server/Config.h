@@ -56,6 +56,8 @@ comparing names.  Screen names and their aliases share a
 namespace and must be unique.
 */
 class Config {
+	friend class ConfigCache;
+
 public:
 	typedef std::map<OptionID, OptionValue> ScreenOptions;
 	typedef std::pair<float, float> Interval;
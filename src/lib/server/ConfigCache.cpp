@@ -0,0 +1,405 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "server/ConfigCache.h"
+
+#include "server/Config.h"
+#include "net/XSocket.h"
+#include "base/Log.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+//
+// ConfigCache image encoding
+//
+// all integers are stored big-endian and floats as their IEEE bits so
+// that link intervals survive exactly.
+//
+
+static const char		s_magic[] = { 'S', 'C', 'F', 'G' };
+static const UInt32		s_headerSize = 24;
+
+class ConfigImageWriter {
+public:
+	ConfigImageWriter(String& image) : m_image(image) { }
+
+	void				writeInt(UInt32 x)
+	{
+		m_image += static_cast<char>((x >> 24) & 0xff);
+		m_image += static_cast<char>((x >> 16) & 0xff);
+		m_image += static_cast<char>((x >>  8) & 0xff);
+		m_image += static_cast<char>( x        & 0xff);
+	}
+
+	void				writeFloat(float x)
+	{
+		UInt32 bits;
+		memcpy(&bits, &x, sizeof(bits));
+		writeInt(bits);
+	}
+
+	void				writeString(const String& x)
+	{
+		writeInt(static_cast<UInt32>(x.size()));
+		m_image += x;
+	}
+
+	void				writeOptions(const Config::ScreenOptions* options)
+	{
+		if (options == NULL) {
+			writeInt(0);
+			return;
+		}
+		writeInt(static_cast<UInt32>(options->size()));
+		for (Config::ScreenOptions::const_iterator index = options->begin();
+								index != options->end(); ++index) {
+			writeInt(index->first);
+			writeInt(static_cast<UInt32>(index->second));
+		}
+	}
+
+private:
+	String&				m_image;
+};
+
+class ConfigImageReader {
+public:
+	ConfigImageReader(const String& image, UInt32 offset) :
+		m_data(reinterpret_cast<const UInt8*>(image.data())),
+		m_size(static_cast<UInt32>(image.size())),
+		m_offset(offset),
+		m_ok(true) { }
+
+	UInt32				readInt()
+	{
+		if (!has(4)) {
+			return 0;
+		}
+		const UInt8* p = m_data + m_offset;
+		m_offset += 4;
+		return (static_cast<UInt32>(p[0]) << 24) |
+				(static_cast<UInt32>(p[1]) << 16) |
+				(static_cast<UInt32>(p[2]) <<  8) |
+				 static_cast<UInt32>(p[3]);
+	}
+
+	float				readFloat()
+	{
+		UInt32 bits = readInt();
+		float x;
+		memcpy(&x, &bits, sizeof(x));
+		return x;
+	}
+
+	String				readString()
+	{
+		UInt32 n = readInt();
+		if (!has(n)) {
+			return String();
+		}
+		String x(reinterpret_cast<const char*>(m_data + m_offset), n);
+		m_offset += n;
+		return x;
+	}
+
+	bool				isOkay() const { return m_ok; }
+	bool				isDone() const { return m_offset == m_size; }
+
+private:
+	bool				has(UInt32 n)
+	{
+		if (m_ok && n > m_size - m_offset) {
+			m_ok = false;
+		}
+		return m_ok;
+	}
+
+private:
+	const UInt8*		m_data;
+	UInt32				m_size;
+	UInt32				m_offset;
+	bool				m_ok;
+};
+
+//
+// ConfigCache
+//
+
+const UInt32			ConfigCache::kVersion = 1;
+
+bool
+ConfigCache::load(const String& pathname,
+				const String& source, Config& config)
+{
+	std::ifstream file(pathname.c_str(), std::ios::in | std::ios::binary);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	// pull in the whole image with a single read
+	file.seekg(0, std::ios::end);
+	std::streamoff size = file.tellg();
+	file.seekg(0, std::ios::beg);
+	if (size < static_cast<std::streamoff>(s_headerSize)) {
+		return false;
+	}
+	String image(static_cast<String::size_type>(size), '\0');
+	if (!file.read(&image[0], size)) {
+		return false;
+	}
+
+	if (!decode(image, source, config)) {
+		LOG((CLOG_DEBUG "configuration cache \"%s\" is stale", pathname.c_str()));
+		return false;
+	}
+	return true;
+}
+
+bool
+ConfigCache::save(const String& pathname,
+				const String& source, const Config& config)
+{
+	String image = encode(source, config);
+
+	// write to a temporary file first so a reader never sees a
+	// partial image
+	String tmpPath = pathname + ".tmp";
+	{
+		std::ofstream file(tmpPath.c_str(),
+							std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			return false;
+		}
+		file.write(image.data(), static_cast<std::streamsize>(image.size()));
+		if (!file) {
+			file.close();
+			remove(tmpPath.c_str());
+			return false;
+		}
+	}
+	remove(pathname.c_str());
+	if (rename(tmpPath.c_str(), pathname.c_str()) != 0) {
+		remove(tmpPath.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool
+ConfigCache::decode(const String& image,
+				const String& source, Config& config)
+{
+	// check the header
+	if (image.size() < s_headerSize ||
+		memcmp(image.data(), s_magic, sizeof(s_magic)) != 0) {
+		return false;
+	}
+	ConfigImageReader header(image, sizeof(s_magic));
+	UInt32 version     = header.readInt();
+	UInt32 sourceSize  = header.readInt();
+	UInt32 sourceHash  = header.readInt();
+	UInt32 payloadSize = header.readInt();
+	UInt32 checksum    = header.readInt();
+	if (version != kVersion ||
+		sourceSize != source.size() ||
+		sourceHash != hash(source.data(), static_cast<UInt32>(source.size())) ||
+		payloadSize != image.size() - s_headerSize ||
+		checksum != hash(image.data() + s_headerSize, payloadSize)) {
+		return false;
+	}
+
+	// rebuild the configuration.  the image was taken from a validated
+	// configuration so failing here means it's corrupt.
+	ConfigImageReader s(image, s_headerSize);
+	Config tmp(config.m_events);
+
+	// screens and their options
+	UInt32 n = s.readInt();
+	for (UInt32 i = 0; i < n && s.isOkay(); ++i) {
+		String name = s.readString();
+		if (!tmp.addScreen(name)) {
+			return false;
+		}
+		for (UInt32 j = s.readInt(); j > 0 && s.isOkay(); --j) {
+			OptionID id       = s.readInt();
+			OptionValue value = static_cast<OptionValue>(s.readInt());
+			tmp.addOption(name, id, value);
+		}
+	}
+
+	// aliases
+	n = s.readInt();
+	for (UInt32 i = 0; i < n && s.isOkay(); ++i) {
+		String alias     = s.readString();
+		String canonical = s.readString();
+		if (s.isOkay() && !tmp.addAlias(canonical, alias)) {
+			return false;
+		}
+	}
+
+	// links
+	n = s.readInt();
+	for (UInt32 i = 0; i < n && s.isOkay(); ++i) {
+		String src      = s.readString();
+		UInt32 side     = s.readInt();
+		float srcStart  = s.readFloat();
+		float srcEnd    = s.readFloat();
+		String dst      = s.readString();
+		float dstStart  = s.readFloat();
+		float dstEnd    = s.readFloat();
+		if (!s.isOkay()) {
+			break;
+		}
+		if (side < static_cast<UInt32>(kFirstDirection) ||
+			side > static_cast<UInt32>(kLastDirection) ||
+			!tmp.connect(src, static_cast<EDirection>(side),
+							srcStart, srcEnd, dst, dstStart, dstEnd)) {
+			return false;
+		}
+	}
+
+	// global options
+	for (UInt32 j = s.readInt(); j > 0 && s.isOkay(); --j) {
+		OptionID id       = s.readInt();
+		OptionValue value = static_cast<OptionValue>(s.readInt());
+		tmp.addOption("", id, value);
+	}
+
+	// address and hot keys.  hot keys are few so they're kept in
+	// their text form.
+	UInt32 hasAddress = s.readInt();
+	String hostname   = s.readString();
+	UInt32 port       = s.readInt();
+	String filter     = s.readString();
+	if (!s.isOkay() || !s.isDone()) {
+		return false;
+	}
+	try {
+		if (hasAddress != 0) {
+			tmp.m_synergyAddress = NetworkAddress(hostname, port);
+			tmp.m_synergyAddress.resolve();
+		}
+		if (!filter.empty()) {
+			std::istringstream filterStream(filter + "end\n");
+			ConfigReadContext context(filterStream);
+			tmp.readSectionOptions(context);
+		}
+	}
+	catch (XSocketAddress&) {
+		return false;
+	}
+	catch (XConfigRead&) {
+		return false;
+	}
+
+	config = tmp;
+	return true;
+}
+
+String
+ConfigCache::encode(const String& source, const Config& config)
+{
+	String payload;
+	ConfigImageWriter s(payload);
+
+	// screens and their options
+	s.writeInt(static_cast<UInt32>(config.m_map.size()));
+	for (Config::const_iterator screen = config.begin();
+								screen != config.end(); ++screen) {
+		s.writeString(*screen);
+		s.writeOptions(config.getOptions(*screen));
+	}
+
+	// aliases
+	UInt32 n = static_cast<UInt32>(config.m_nameToCanonicalName.size() -
+									config.m_map.size());
+	s.writeInt(n);
+	for (Config::all_const_iterator index = config.beginAll();
+								index != config.endAll(); ++index) {
+		if (index->first != index->second) {
+			s.writeString(index->first);
+			s.writeString(index->second);
+		}
+	}
+
+	// links
+	n = 0;
+	for (Config::const_iterator screen = config.begin();
+								screen != config.end(); ++screen) {
+		n += static_cast<UInt32>(std::distance(config.beginNeighbor(*screen),
+											config.endNeighbor(*screen)));
+	}
+	s.writeInt(n);
+	for (Config::const_iterator screen = config.begin();
+								screen != config.end(); ++screen) {
+		for (Config::link_const_iterator
+				link = config.beginNeighbor(*screen),
+				nend = config.endNeighbor(*screen); link != nend; ++link) {
+			s.writeString(*screen);
+			s.writeInt(static_cast<UInt32>(link->first.getSide()));
+			s.writeFloat(link->first.getInterval().first);
+			s.writeFloat(link->first.getInterval().second);
+			s.writeString(link->second.getName());
+			s.writeFloat(link->second.getInterval().first);
+			s.writeFloat(link->second.getInterval().second);
+		}
+	}
+
+	// global options
+	s.writeOptions(config.getOptions(""));
+
+	// address and hot keys
+	const NetworkAddress& address = config.m_synergyAddress;
+	s.writeInt(address.isValid() ? 1 : 0);
+	s.writeString(address.isValid() ? address.getHostname() : String());
+	s.writeInt(address.isValid() ? static_cast<UInt32>(address.getPort()) : 0);
+	s.writeString(config.m_inputFilter.format("\t"));
+
+	// prepend the header
+	String image(s_magic, sizeof(s_magic));
+	ConfigImageWriter header(image);
+	header.writeInt(kVersion);
+	header.writeInt(static_cast<UInt32>(source.size()));
+	header.writeInt(hash(source.data(), static_cast<UInt32>(source.size())));
+	header.writeInt(static_cast<UInt32>(payload.size()));
+	header.writeInt(hash(payload.data(), static_cast<UInt32>(payload.size())));
+	image += payload;
+	return image;
+}
+
+String
+ConfigCache::getCachePath(const String& pathname)
+{
+	return pathname + ".cache";
+}
+
+UInt32
+ConfigCache::hash(const void* data, UInt32 size)
+{
+	// FNV-1a
+	const UInt8* p = static_cast<const UInt8*>(data);
+	UInt32 h = 2166136261u;
+	for (UInt32 i = 0; i < size; ++i) {
+		h ^= p[i];
+		h *= 16777619u;
+	}
+	return h;
+}
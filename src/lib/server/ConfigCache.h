@@ -0,0 +1,86 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/String.h"
+#include "common/basic_types.h"
+
+class Config;
+
+//! Compiled configuration cache
+/*!
+Stores a validated Config in a compact binary form so that large
+configurations don't have to be parsed again on every start or
+reload.  The image records a hash of the text it was compiled from
+and is ignored when that text changes, when its version is unknown
+or when its checksum doesn't match.
+*/
+class ConfigCache {
+public:
+	//! Image format version
+	static const UInt32	kVersion;
+
+	//! @name manipulators
+	//@{
+
+	//! Load cached configuration
+	/*!
+	Replaces \c config with the image in \c pathname and returns true
+	if the image was compiled from \c source.  Otherwise returns false
+	and leaves \c config unchanged.
+	*/
+	static bool			load(const String& pathname,
+							const String& source, Config& config);
+
+	//! Save configuration
+	/*!
+	Writes the image of \c config, compiled from \c source, to
+	\c pathname.  Returns false if the file can't be written.
+	*/
+	static bool			save(const String& pathname,
+							const String& source, const Config& config);
+
+	//! Decode configuration
+	/*!
+	Like load() but decodes the image from memory.
+	*/
+	static bool			decode(const String& image,
+							const String& source, Config& config);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Encode configuration
+	/*!
+	Returns the image of \c config compiled from \c source.
+	*/
+	static String		encode(const String& source, const Config& config);
+
+	//! Get cache path
+	/*!
+	Returns the path of the cache for the configuration file
+	\c pathname.
+	*/
+	static String		getCachePath(const String& pathname);
+
+	//@}
+
+private:
+	static UInt32		hash(const void* data, UInt32 size);
+};
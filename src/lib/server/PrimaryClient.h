@@ -87,7 +87,7 @@ public:
 	Return the jump zone size, the size of the regions on the edges of
 	the screen that cause the cursor to jump to another screen.
 	*/
-	SInt32				getJumpZoneSize() const;
+	virtual SInt32		getJumpZoneSize() const;
 
 	//! Get cursor center position
 	/*!
@@ -95,7 +95,7 @@ public:
 	cursor to compute cursor motion deltas and should be far from
 	the edges of the screen, typically the center.
 	*/
-	void				getCursorCenter(SInt32& x, SInt32& y) const;
+	virtual void		getCursorCenter(SInt32& x, SInt32& y) const;
 	
 	//! Get toggle key state
 	/*!
@@ -108,7 +108,7 @@ public:
 	/*!
 	Returns true if the user is locked to the screen.
 	*/
-	bool				isLockedToScreen() const;
+	virtual bool		isLockedToScreen() const;
 
 	//@}
 
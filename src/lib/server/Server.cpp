@@ -22,7 +22,10 @@
 #include "server/ClientProxyUnknown.h"
 #include "server/PrimaryClient.h"
 #include "server/ClientListener.h"
+#include "server/SwitchRetry.h"
 #include "synergy/FileChunk.h"
+#include "synergy/FileSetChunk.h"
+#include "synergy/FileSetDropper.h"
 #include "synergy/IPlatformScreen.h"
 #include "synergy/DropHelper.h"
 #include "synergy/option_types.h"
@@ -52,6 +55,9 @@
 #include <fstream>
 #include <ctime>
 
+// how far ahead of a predicted switch to start sending clipboards
+static const double		s_clipboardPrefetchTime = 0.25;
+
 //
 // Server
 //
@@ -70,11 +76,14 @@ Server::Server(
 	m_yDelta(0),
 	m_xDelta2(0),
 	m_yDelta2(0),
+	m_prefetchScreen(NULL),
+	m_prefetchPending(false),
 	m_config(&config),
 	m_inputFilter(config.getInputFilter()),
 	m_activeSaver(NULL),
 	m_switchDir(kNoDirection),
 	m_switchScreen(NULL),
+	m_switchRetry(NULL),
 	m_switchWaitDelay(0.0),
 	m_switchWaitTimer(NULL),
 	m_switchTwoTapDelay(0.0),
@@ -91,6 +100,7 @@ Server::Server(
 	m_events(events),
 	m_sendFileThread(NULL),
 	m_writeToDropDirThread(NULL),
+	m_fileSetDropper(NULL),
 	m_ignoreFileTransfer(false),
 	m_enableClipboard(true),
 	m_sendDragInfoThread(NULL),
@@ -116,7 +126,11 @@ Server::Server(
 		clipboard.m_clipboardData   = clipboard.m_clipboard.marshall();
 	}
 
+	m_fileSetDropper = new FileSetDropper(m_events, this, m_screen);
+
 	// install event handlers
+	m_switchRetry = new SwitchRetry(m_events,
+							new TMethodJob<Server>(this, &Server::retrySwitch));
 	m_events->adoptHandler(Event::kTimer, this,
 							new TMethodEventJob<Server>(this,
 								&Server::handleSwitchWaitTimeout));
@@ -184,6 +198,10 @@ Server::Server(
 							m_inputFilter,
 							new TMethodEventJob<Server>(this,
 								&Server::handleFakeInputEndEvent));
+	m_events->adoptHandler(m_events->forServer().clipboardPrefetch(),
+							this,
+							new TMethodEventJob<Server>(this,
+								&Server::handleClipboardPrefetchEvent));
 
 	if (m_args.m_enableDragDrop) {
 		m_events->adoptHandler(m_events->forFile().fileChunkSending(),
@@ -245,8 +263,10 @@ Server::~Server()
 							m_inputFilter);
 	m_events->removeHandler(m_events->forIPrimaryScreen().fakeInputEnd(),
 							m_inputFilter);
+	m_events->removeHandler(m_events->forServer().clipboardPrefetch(), this);
 	m_events->removeHandler(Event::kTimer, this);
 	stopSwitch();
+	delete m_switchRetry;
 
 	// force immediate disconnection of secondary clients
 	disconnect();
@@ -265,6 +285,9 @@ Server::~Server()
 	// disable and disconnect primary client
 	m_primaryClient->disable();
 	removeClient(m_primaryClient);
+
+	// discard file sets not yet dropped
+	delete m_fileSetDropper;
 }
 
 bool
@@ -468,7 +491,20 @@ Server::switchScreen(BaseClientProxy* dst,
 #endif
 	assert(m_active != NULL);
 
-	LOG((CLOG_INFO "switch from \"%s\" to \"%s\" at %d,%d", getName(m_active).c_str(), getName(dst).c_str(), x, y));
+	// a switch is already waiting for the active screen to let go.
+	// just change where it goes;  the retry will take it there.  going
+	// back to the active screen needs no wait so that cancels it.
+	if (m_switchRetry->isWaiting() && !m_switchRetry->isRetrying()) {
+		if (dst != m_active) {
+			m_switchRetry->start(dst, x, y, forScreensaver);
+			return;
+		}
+		m_switchRetry->stop();
+	}
+
+	if (!m_switchRetry->isRetrying()) {
+		LOG((CLOG_INFO "switch from \"%s\" to \"%s\" at %d,%d", getName(m_active).c_str(), getName(dst).c_str(), x, y));
+	}
 
 	// stop waiting to switch
 	stopSwitch();
@@ -480,6 +516,8 @@ Server::switchScreen(BaseClientProxy* dst,
 	m_yDelta  = 0;
 	m_xDelta2 = 0;
 	m_yDelta2 = 0;
+	m_switchPredictor.reset();
+	m_prefetchScreen = NULL;
 
 	// wrapping means leaving the active screen and entering it again.
 	// since that's a waste of time we skip that and just warp the
@@ -487,10 +525,18 @@ Server::switchScreen(BaseClientProxy* dst,
 	if (m_active != dst) {
 		// leave active screen
 		if (!m_active->leave()) {
+			if (m_active == m_primaryClient) {
+				// probably another client has grabbed the keyboard
+				// or pointer.  try again soon instead of blocking.
+				m_switchRetry->start(dst, x, y, forScreensaver);
+				return;
+			}
+
 			// cannot leave screen
 			LOG((CLOG_WARN "can't leave screen"));
 			return;
 		}
+		m_switchRetry->stop();
 
 		// update the primary client's clipboards if we're leaving the
 		// primary screen.
@@ -527,6 +573,7 @@ Server::switchScreen(BaseClientProxy* dst,
 		m_events->addEvent(Event(m_events->forServer().screenSwitched(), this, info));
 	}
 	else {
+		m_switchRetry->stop();
 		m_active->mouseMove(x, y);
 	}
 }
@@ -908,6 +955,64 @@ Server::noSwitch(SInt32 x, SInt32 y)
 {
 	armSwitchTwoTap(x, y);
 	stopSwitchWait();
+
+	// the mouse has moved back off the edge so don't leave after all
+	m_switchRetry->stop();
+}
+
+void
+Server::predictSwitch(SInt32 x, SInt32 y,
+				SInt32 ax, SInt32 ay, SInt32 aw, SInt32 ah, SInt32 zoneSize)
+{
+	if (!m_enableClipboard) {
+		return;
+	}
+
+	// find the screen the cursor is heading for, if it'll get there soon
+	BaseClientProxy* dst = NULL;
+	SInt32 xn, yn;
+	EDirection dir = m_switchPredictor.predict(x, y, ax, ay, aw, ah,
+							zoneSize, s_clipboardPrefetchTime, xn, yn);
+	if (dir != kNoDirection) {
+		dst = mapToNeighbor(m_active, dir, xn, yn);
+	}
+
+	// only prefetch once per approach
+	if (dst == m_prefetchScreen) {
+		return;
+	}
+	m_prefetchScreen = dst;
+
+	// reading the clipboards can take a while so leave it until the
+	// input that's waiting has been handled
+	if (dst != NULL && dst != m_active && !m_prefetchPending) {
+		m_prefetchPending = true;
+		m_events->addEvent(Event(m_events->forServer().clipboardPrefetch(),
+								this));
+	}
+}
+
+void
+Server::prefetchClipboards(BaseClientProxy* dst)
+{
+	LOG((CLOG_DEBUG1 "prefetching clipboards for \"%s\"", getName(dst).c_str()));
+
+	// pick up changes to the primary screen's clipboards now instead of
+	// when we leave it.  onClipboardChanged() marks every other screen
+	// dirty if the data changed and ignores it if not.
+	for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
+		ClipboardInfo& clipboard = m_clipboards[id];
+		if (clipboard.m_clipboardOwner == getName(m_primaryClient)) {
+			onClipboardChanged(m_primaryClient,
+				id, clipboard.m_clipboardSeqNum);
+		}
+	}
+
+	// send whatever the destination doesn't have.  the proxy clears
+	// its dirty flag so the switch won't send the same data again.
+	for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
+		dst->setClipboard(id, &m_clipboards[id].m_clipboard);
+	}
 }
 
 void
@@ -921,6 +1026,15 @@ Server::stopSwitch()
 	}
 }
 
+void
+Server::retrySwitch(void*)
+{
+	SInt32 x, y;
+	m_switchRetry->getPosition(x, y);
+	switchScreen(m_switchRetry->getScreen(), x, y,
+							m_switchRetry->isForScreensaver());
+}
+
 void
 Server::startSwitchTwoTap()
 {
@@ -1516,6 +1630,19 @@ Server::handleFileChunkSendingEvent(const Event& event, void*)
 	onFileChunkSending(event.getData());
 }
 
+void
+Server::handleClipboardPrefetchEvent(const Event&, void*)
+{
+	m_prefetchPending = false;
+
+	// the cursor may have switched or turned away in the meantime
+	BaseClientProxy* dst = m_prefetchScreen;
+	if (dst != NULL && m_active == m_primaryClient && dst != m_active &&
+		!isLockedToScreenServer() && !m_primaryClient->isLockedToScreen()) {
+		prefetchClipboards(dst);
+	}
+}
+
 void
 Server::handleFileRecieveCompletedEvent(const Event& event, void*)
 {
@@ -1712,7 +1839,8 @@ Server::onMouseUp(ButtonID id)
 	if (m_args.m_enableDragDrop) {
 		if (!m_screen->isOnScreen()) {
 			String& file = m_screen->getDraggingFilename();
-			if (!file.empty()) {
+			if (!file.empty() &&
+				!sendFilesToClient(std::vector<String>(1, file))) {
 				sendFileToClient(file.c_str());
 			}
 		}
@@ -1744,6 +1872,7 @@ Server::onMouseMovePrimary(SInt32 x, SInt32 y)
 	// save position
 	m_x       = x;
 	m_y       = y;
+	m_switchPredictor.addMotion(x, y, ARCH->time());
 
 	// get screen shape
 	SInt32 ax, ay, aw, ah;
@@ -1788,6 +1917,7 @@ Server::onMouseMovePrimary(SInt32 x, SInt32 y)
 	}
 	if (dirh == kNoDirection && dirv == kNoDirection) {
 		// still on local screen
+		predictSwitch(x, y, ax, ay, aw, ah, zoneSize);
 		noSwitch(x, y);
 		return false;
 	}
@@ -2013,6 +2143,7 @@ Server::onMouseMoveSecondary(SInt32 dx, SInt32 dy)
 			StreamChunker::interruptFile();
 			m_sendFileThread = NULL;
 		}
+		m_active->interruptFiles();
 
 		SInt32 newX = m_x;
 		SInt32 newY = m_y;
@@ -2074,6 +2205,9 @@ Server::onFileChunkSending(const void* data)
 void
 Server::onFileRecieveCompleted()
 {
+	if (m_fileSetDropper->drop()) {
+		return;
+	}
 	if (isReceivedFileSizeValid()) {
 		m_writeToDropDirThread = new Thread(
 									   new TMethodJob<Server>(
@@ -2151,6 +2285,9 @@ Server::removeClient(BaseClientProxy* client)
 	// remove from list
 	m_clients.erase(getName(client));
 	m_clientSet.erase(i);
+	if (m_prefetchScreen == client) {
+		m_prefetchScreen = NULL;
+	}
 
 	return true;
 }
@@ -2246,6 +2383,11 @@ Server::removeOldClient(BaseClientProxy* client)
 void
 Server::forceLeaveClient(BaseClientProxy* client)
 {
+	// don't keep trying to switch to a screen that's going away
+	if (m_switchRetry->getScreen() == client) {
+		m_switchRetry->stop();
+	}
+
 	BaseClientProxy* active =
 		(m_activeSaver != NULL) ? m_activeSaver : m_active;
 	if (active == client) {
@@ -2371,6 +2513,12 @@ Server::isReceivedFileSizeValid()
 	return m_expectedFileSize == m_receivedFileData.size();
 }
 
+FileSetReceiver*
+Server::getReceivedFileSet() const
+{
+	return m_fileSetDropper->getReceived();
+}
+
 void
 Server::sendFileToClient(const char* filename)
 {
@@ -2384,6 +2532,23 @@ Server::sendFileToClient(const char* filename)
 			static_cast<void*>(const_cast<char*>(filename))));
 }
 
+bool
+Server::sendFilesToClient(const std::vector<String>& paths)
+{
+	return m_active->sendFiles(paths);
+}
+
+void
+Server::fileSetChunkReceived(const FileSetChunk& chunk)
+{
+	if (!m_args.m_enableDragDrop) {
+		LOG((CLOG_DEBUG "drag drop not enabled, ignoring file set"));
+		return;
+	}
+
+	m_fileSetDropper->handle(chunk);
+}
+
 void
 Server::sendFileThread(void* data)
 {
@@ -19,6 +19,7 @@
 #pragma once
 
 #include "server/Config.h"
+#include "server/SwitchPredictor.h"
 #include "synergy/clipboard_types.h"
 #include "synergy/Clipboard.h"
 #include "synergy/key_types.h"
@@ -41,6 +42,10 @@ namespace synergy { class Screen; }
 class IEventQueue;
 class Thread;
 class ClientListener;
+class FileSetChunk;
+class FileSetReceiver;
+class FileSetDropper;
+class SwitchRetry;
 
 //! Synergy server
 /*!
@@ -111,7 +116,7 @@ public:
 	~Server();
 
 #ifdef TEST_ENV
-	Server() : m_mock(true), m_config(NULL) { }
+	Server() : m_mock(true), m_config(NULL), m_switchRetry(NULL) { }
 	void setActive(BaseClientProxy* active) {	m_active = active; }
 #endif
 
@@ -145,6 +150,17 @@ public:
 	//! Create a new thread and use it to send file to client
 	void				sendFileToClient(const char* filename);
 
+	//! Send files to the active client
+	/*!
+	Sends \c paths, which may name files and directories, to the active
+	client as a file set.  Returns false if the client doesn't support
+	file sets.
+	*/
+	bool				sendFilesToClient(const std::vector<String>& paths);
+
+	//! Received file set message from client
+	void				fileSetChunkReceived(const FileSetChunk& chunk);
+
 	//! Received dragging information from client
 	void				dragInfoReceived(UInt32 fileNum, String content);
 
@@ -179,6 +195,12 @@ public:
 	//! Return fake drag file list
 	DragFileList		getFakeDragFileList() { return m_fakeDragFileList; }
 
+	//! Return received file set
+	/*!
+	Returns the last complete file set received from a client, or NULL.
+	*/
+	FileSetReceiver*	getReceivedFileSet() const;
+
 	//@}
 
 private:
@@ -249,9 +271,22 @@ private:
 	// doesn't switch screens.
 	void				noSwitch(SInt32 x, SInt32 y);
 
+	// predict a switch from the primary screen due to a mouse move at
+	// \p x, \p y and queue sending the clipboards to the likely
+	// destination ahead of it.
+	void				predictSwitch(SInt32 x, SInt32 y,
+							SInt32 ax, SInt32 ay, SInt32 aw, SInt32 ah,
+							SInt32 zoneSize);
+
+	// send clipboards that \p dst doesn't have yet
+	void				prefetchClipboards(BaseClientProxy* dst);
+
 	// stop switch timers
 	void				stopSwitch();
 
+	// try again to switch to the screen a switch is waiting for
+	void				retrySwitch(void*);
+
 	// start two tap switch timer
 	void				startSwitchTwoTap();
 
@@ -315,6 +350,7 @@ private:
 	void				handleFakeInputEndEvent(const Event&, void*);
 	void				handleFileChunkSendingEvent(const Event&, void*);
 	void				handleFileRecieveCompletedEvent(const Event&, void*);
+	void				handleClipboardPrefetchEvent(const Event&, void*);
 
 	// event processing
 	void				onClipboardChanged(BaseClientProxy* sender,
@@ -362,6 +398,8 @@ private:
 	// thread function for writing file to drop directory
 	void				writeToDropDirThread(void*);
 
+	// thread function for moving file set to drop directory
+
 	// thread function for sending drag information
 	void				sendDragInfoThread(void*);
 
@@ -413,6 +451,12 @@ private:
 	SInt32				m_xDelta, m_yDelta;
 	SInt32				m_xDelta2, m_yDelta2;
 
+	// cursor motion on the primary screen, used to send clipboards to
+	// the screen we're about to switch to before the switch
+	SwitchPredictor		m_switchPredictor;
+	BaseClientProxy*	m_prefetchScreen;
+	bool				m_prefetchPending;
+
 	// current configuration
 	Config*				m_config;
 
@@ -431,6 +475,9 @@ private:
 	EDirection			m_switchDir;
 	BaseClientProxy*	m_switchScreen;
 
+	// a switch waiting for the primary screen to let go
+	SwitchRetry*		m_switchRetry;
+
 	// state for delayed screen switching
 	double				m_switchWaitDelay;
 	EventQueueTimer*	m_switchWaitTimer;
@@ -471,6 +518,7 @@ private:
 	DragFileList		m_fakeDragFileList;
 	Thread*				m_sendFileThread;
 	Thread*				m_writeToDropDirThread;
+	FileSetDropper*	m_fileSetDropper;
 	String				m_dragFileExt;
 	bool				m_ignoreFileTransfer;
 	bool				m_enableClipboard;
@@ -0,0 +1,134 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "server/SwitchPredictor.h"
+
+// motion older than this says nothing about where the cursor is going
+static const double		s_maxInterval = 0.1;
+
+// samples closer together than this are too noisy to estimate from
+static const double		s_minInterval = 0.002;
+
+// weight of the newest sample in the smoothed velocity
+static const double		s_smoothing = 0.5;
+
+//
+// SwitchPredictor
+//
+
+SwitchPredictor::SwitchPredictor() :
+	m_valid(false),
+	m_x(0),
+	m_y(0),
+	m_time(0.0),
+	m_xVelocity(0.0),
+	m_yVelocity(0.0)
+{
+	// do nothing
+}
+
+void
+SwitchPredictor::reset()
+{
+	m_valid     = false;
+	m_xVelocity = 0.0;
+	m_yVelocity = 0.0;
+}
+
+void
+SwitchPredictor::addMotion(SInt32 x, SInt32 y, double time)
+{
+	double dt = time - m_time;
+	if (!m_valid || dt > s_maxInterval || dt < 0.0) {
+		// the cursor was at rest (or we know nothing about it)
+		m_valid     = true;
+		m_x         = x;
+		m_y         = y;
+		m_time      = time;
+		m_xVelocity = 0.0;
+		m_yVelocity = 0.0;
+		return;
+	}
+
+	// wait for the next sample rather than divide by a tiny interval.
+	// the motion isn't lost;  it's measured from the last sample.
+	if (dt < s_minInterval) {
+		return;
+	}
+
+	double vx   = (x - m_x) / dt;
+	double vy   = (y - m_y) / dt;
+	m_xVelocity = s_smoothing * vx + (1.0 - s_smoothing) * m_xVelocity;
+	m_yVelocity = s_smoothing * vy + (1.0 - s_smoothing) * m_yVelocity;
+	m_x         = x;
+	m_y         = y;
+	m_time      = time;
+}
+
+EDirection
+SwitchPredictor::predict(SInt32 x, SInt32 y,
+				SInt32 ax, SInt32 ay, SInt32 aw, SInt32 ah,
+				SInt32 zoneSize, double horizon,
+				SInt32& xOut, SInt32& yOut) const
+{
+	// time until the cursor enters the jump zone on each axis
+	EDirection dirh = kNoDirection, dirv = kNoDirection;
+	double th = horizon, tv = horizon;
+	if (m_xVelocity < 0.0) {
+		double t = (x - (ax + zoneSize) + 1) / -m_xVelocity;
+		if (t <= th) {
+			th   = t;
+			dirh = kLeft;
+		}
+	}
+	else if (m_xVelocity > 0.0) {
+		double t = ((ax + aw - zoneSize) - x) / m_xVelocity;
+		if (t <= th) {
+			th   = t;
+			dirh = kRight;
+		}
+	}
+	if (m_yVelocity < 0.0) {
+		double t = (y - (ay + zoneSize) + 1) / -m_yVelocity;
+		if (t <= tv) {
+			tv   = t;
+			dirv = kTop;
+		}
+	}
+	else if (m_yVelocity > 0.0) {
+		double t = ((ay + ah - zoneSize) - y) / m_yVelocity;
+		if (t <= tv) {
+			tv   = t;
+			dirv = kBottom;
+		}
+	}
+
+	// the axis reached first wins
+	if (dirh != kNoDirection && (dirv == kNoDirection || th <= tv)) {
+		SInt32 yc = y + static_cast<SInt32>(m_yVelocity * th);
+		xOut = (dirh == kLeft) ? ax - 1 : ax + aw;
+		yOut = (yc < ay) ? ay : ((yc >= ay + ah) ? ay + ah - 1 : yc);
+		return dirh;
+	}
+	if (dirv != kNoDirection) {
+		SInt32 xc = x + static_cast<SInt32>(m_xVelocity * tv);
+		xOut = (xc < ax) ? ax : ((xc >= ax + aw) ? ax + aw - 1 : xc);
+		yOut = (dirv == kTop) ? ay - 1 : ay + ah;
+		return dirv;
+	}
+	return kNoDirection;
+}
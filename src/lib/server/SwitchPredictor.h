@@ -0,0 +1,79 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "synergy/protocol_types.h"
+#include "common/basic_types.h"
+
+//! Screen edge crossing predictor
+/*!
+Tracks the cursor velocity on the active screen and predicts which
+side of it the cursor is about to leave by, so that work the switch
+would otherwise do can be started while the cursor is still on its
+way.
+*/
+class SwitchPredictor {
+public:
+	SwitchPredictor();
+
+	//! @name manipulators
+	//@{
+
+	//! Forget motion history
+	/*!
+	Call when the cursor jumps, e.g. on a screen switch.
+	*/
+	void				reset();
+
+	//! Record cursor motion
+	/*!
+	Records the cursor at \c x,\c y at \c time seconds.
+	*/
+	void				addMotion(SInt32 x, SInt32 y, double time);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Predict edge crossing
+	/*!
+	Returns the side of the screen \c ax,\c ay,\c aw,\c ah through
+	which the cursor at \c x,\c y will enter the jump zone of
+	\c zoneSize pixels within \c horizon seconds, or kNoDirection.  On
+	success \c xOut,\c yOut is set to the point just beyond that side
+	where the cursor is expected to cross it.
+	*/
+	EDirection			predict(SInt32 x, SInt32 y,
+							SInt32 ax, SInt32 ay, SInt32 aw, SInt32 ah,
+							SInt32 zoneSize, double horizon,
+							SInt32& xOut, SInt32& yOut) const;
+
+	//! Get horizontal velocity in pixels per second
+	double				getXVelocity() const { return m_xVelocity; }
+
+	//! Get vertical velocity in pixels per second
+	double				getYVelocity() const { return m_yVelocity; }
+
+	//@}
+
+private:
+	bool				m_valid;
+	SInt32				m_x, m_y;
+	double				m_time;
+	double				m_xVelocity, m_yVelocity;
+};
@@ -0,0 +1,125 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "server/SwitchRetry.h"
+
+#include "base/IEventQueue.h"
+#include "base/IJob.h"
+#include "base/Log.h"
+#include "base/TMethodEventJob.h"
+
+//
+// SwitchRetry
+//
+
+const double			SwitchRetry::kInterval = 0.05;
+const double			SwitchRetry::kTimeout  = 1.0;
+
+SwitchRetry::SwitchRetry(IEventQueue* events, IJob* adoptedJob) :
+	m_events(events),
+	m_job(adoptedJob),
+	m_timer(NULL),
+	m_retrying(false),
+	m_screen(NULL),
+	m_x(0),
+	m_y(0),
+	m_forScreensaver(false)
+{
+	assert(m_job != NULL);
+}
+
+SwitchRetry::~SwitchRetry()
+{
+	stop();
+	delete m_job;
+}
+
+void
+SwitchRetry::start(BaseClientProxy* dst, SInt32 x, SInt32 y,
+				bool forScreensaver)
+{
+	m_screen         = dst;
+	m_x              = x;
+	m_y              = y;
+	m_forScreensaver = forScreensaver;
+
+	if (m_timer == NULL) {
+		LOG((CLOG_DEBUG1 "waiting to leave screen"));
+		m_waited.reset();
+		m_timer = m_events->newTimer(kInterval, NULL);
+		m_events->adoptHandler(Event::kTimer, m_timer,
+							new TMethodEventJob<SwitchRetry>(this,
+								&SwitchRetry::handleTimer));
+	}
+}
+
+void
+SwitchRetry::stop()
+{
+	if (m_timer != NULL) {
+		m_events->removeHandler(Event::kTimer, m_timer);
+		m_events->deleteTimer(m_timer);
+		m_timer  = NULL;
+		m_screen = NULL;
+	}
+}
+
+bool
+SwitchRetry::isWaiting() const
+{
+	return (m_timer != NULL);
+}
+
+bool
+SwitchRetry::isRetrying() const
+{
+	return m_retrying;
+}
+
+BaseClientProxy*
+SwitchRetry::getScreen() const
+{
+	return m_screen;
+}
+
+void
+SwitchRetry::getPosition(SInt32& x, SInt32& y) const
+{
+	x = m_x;
+	y = m_y;
+}
+
+bool
+SwitchRetry::isForScreensaver() const
+{
+	return m_forScreensaver;
+}
+
+void
+SwitchRetry::handleTimer(const Event&, void*)
+{
+	if (m_waited.getTime() >= kTimeout) {
+		LOG((CLOG_WARN "can't leave screen"));
+		stop();
+		return;
+	}
+
+	// the job stops us if the switch succeeds
+	m_retrying = true;
+	m_job->run();
+	m_retrying = false;
+}
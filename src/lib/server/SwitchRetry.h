@@ -0,0 +1,109 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/Stopwatch.h"
+#include "common/basic_types.h"
+
+class BaseClientProxy;
+class Event;
+class EventQueueTimer;
+class IEventQueue;
+class IJob;
+
+//! Retries a screen switch from a timer
+/*!
+The primary screen can't be left while another X client holds a
+keyboard or pointer grab.  Rather than block the event loop until the
+grab is released, a switch that can't leave the primary waits here
+and a timer retries it, so network I/O, clipboard requests and
+heartbeats carry on meanwhile.  Switches requested while waiting
+only update where the switch goes, so the entry point follows the
+mouse.  The retry is abandoned after a timeout.
+
+Input isn't buffered while waiting.  Without the grab the X server
+delivers keys straight to the focused window, so the server never
+sees them to hold back.
+*/
+class SwitchRetry {
+public:
+	/*!
+	\c adoptedJob is run on each retry and should attempt the switch
+	returned by getScreen() and getPosition().
+	*/
+	SwitchRetry(IEventQueue* events, IJob* adoptedJob);
+	~SwitchRetry();
+
+	//! @name manipulators
+	//@{
+
+	//! Wait to switch
+	/*!
+	Starts waiting to switch to \c dst at \c x,\c y or, if already
+	waiting, changes where the switch goes without restarting the
+	timeout.
+	*/
+	void				start(BaseClientProxy* dst, SInt32 x, SInt32 y,
+							bool forScreensaver);
+
+	//! Stop waiting
+	void				stop();
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Test if waiting to switch
+	bool				isWaiting() const;
+
+	//! Test if retrying
+	/*!
+	Returns true while the retry job is running.
+	*/
+	bool				isRetrying() const;
+
+	//! Get the screen to switch to
+	BaseClientProxy*	getScreen() const;
+
+	//! Get the position to switch to
+	void				getPosition(SInt32& x, SInt32& y) const;
+
+	//! Test if the switch is for the screen saver
+	bool				isForScreensaver() const;
+
+	//@}
+
+	//! Time between retries in seconds
+	static const double	kInterval;
+
+	//! Time to give up after in seconds
+	static const double	kTimeout;
+
+private:
+	void				handleTimer(const Event&, void*);
+
+private:
+	IEventQueue*		m_events;
+	IJob*				m_job;
+	EventQueueTimer*	m_timer;
+	Stopwatch			m_waited;
+	bool				m_retrying;
+	BaseClientProxy*	m_screen;
+	SInt32				m_x, m_y;
+	bool				m_forScreensaver;
+};
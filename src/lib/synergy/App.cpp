@@ -31,6 +31,8 @@
 #include "base/TMethodEventJob.h"
 #include "ipc/IpcMessage.h"
 #include "ipc/Ipc.h"
+#include "mt/Mutex.h"
+#include "mt/MutexProfiler.h"
 #include "base/EventQueue.h"
 
 #if SYSAPI_WIN32
@@ -188,6 +190,13 @@ App::initApp(int argc, const char** argv)
 		LOG((CLOG_INFO "drag and drop enabled"));
 	}
 
+	if (argsBase().m_profileLocks) {
+		LOG((CLOG_INFO "lock profiling enabled"));
+		MutexProfiler::setEnabled(true);
+	}
+	Mutex::setSpinning(argsBase().m_spinLocks);
+	ARCH->setSignalHandler(Arch::kUSER, &App::lockStatsSignalHandler, NULL);
+
 	// setup file logging after parsing args
 	setupFileLogging();
 
@@ -236,6 +245,12 @@ App::handleIpcMessage(const Event& e, void*)
     }
 }
 
+void
+App::lockStatsSignalHandler(Arch::ESignal, void*)
+{
+	MutexProfiler::log();
+}
+
 void
 App::runEventsLoop(void*)
 {
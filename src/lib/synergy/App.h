@@ -102,6 +102,7 @@ public:
 
 private:
 	void				handleIpcMessage(const Event&, void*);
+	static void			lockStatsSignalHandler(Arch::ESignal, void*);
 
 protected:
 	void				initIpcClient();
@@ -164,7 +165,11 @@ private:
 	"  -l  --log <file>         write log messages to file.\n" \
 	"      --no-tray            disable the system tray icon.\n" \
 	"      --enable-drag-drop   enable file drag & drop.\n" \
-	"      --enable-crypto      enable the crypto (ssl) plugin.\n"
+	"      --enable-crypto      enable the crypto (ssl) plugin.\n" \
+	"      --enable-io-uring    use io_uring for socket i/o where supported.\n" \
+	"      --profile-locks      collect lock contention statistics and log them\n" \
+	"                             when sent SIGUSR2.\n" \
+	"      --spin-locks         spin briefly before waiting on a busy lock.\n"
 
 #define HELP_COMMON_INFO_2 \
 	"  -h, --help               display this help and exit.\n" \
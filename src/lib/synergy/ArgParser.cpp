@@ -26,6 +26,8 @@
 #include "base/Log.h"
 #include "base/String.h"
 
+#include <stdio.h>
+
 ArgsBase* ArgParser::m_argsBase = NULL;
 
 ArgParser::ArgParser(App* app) :
@@ -60,6 +62,17 @@ ArgParser::parseServerArgs(ServerArgs& args, int argc, const char* const* argv)
 		else if (isArg(i, argc, argv, "", "--serial-key", 1)) {
 			args.m_serial = SerialKey(argv[++i]);
 		}
+		else if (isArg(i, argc, argv, NULL, "--socket-threads", 1)) {
+			// number of threads servicing client sockets
+			args.m_socketThreads = atoi(argv[++i]);
+			if (args.m_socketThreads < 1) {
+				args.m_socketThreads = 1;
+			}
+		}
+		else if (isArg(i, argc, argv, NULL, "--config-cache")) {
+			// keep a compiled copy of the configuration next to it
+			args.m_configCache = true;
+		}
 		else {
 			LOG((CLOG_PRINT "%s: unrecognized option `%s'" BYE, args.m_pname, argv[i], args.m_pname));
 			return false;
@@ -100,6 +113,22 @@ ArgParser::parseClientArgs(ClientArgs& args, int argc, const char* const* argv)
 			// define scroll
 			args.m_yscroll = atoi(argv[++i]);
 		}
+		else if (isArg(i, argc, argv, NULL, "--smooth-motion")) {
+			// buffer mouse motion that arrives in bursts
+			args.m_smoothMotion = true;
+		}
+#if HAVE_LINUX_UINPUT_H
+		else if (isArg(i, argc, argv, NULL, "--uinput", 1)) {
+			// inject through uinput, given the screen size
+			if (sscanf(argv[++i], "%dx%d", &args.m_uinputWidth,
+							&args.m_uinputHeight) != 2 ||
+				args.m_uinputWidth <= 0 || args.m_uinputHeight <= 0) {
+				LOG((CLOG_PRINT "%s: invalid screen size `%s' for --uinput" BYE,
+					args.m_pname, argv[i], args.m_pname));
+				return false;
+			}
+		}
+#endif
 		else {
 			if (i + 1 == argc) {
 				args.m_synergyAddress = argv[i];
@@ -297,6 +326,15 @@ ArgParser::parseGenericArgs(int argc, const char* const* argv, int& i)
 	else if (isArg(i, argc, argv, NULL, "--enable-crypto")) {
 		argsBase().m_enableCrypto = true;
 	}
+	else if (isArg(i, argc, argv, NULL, "--enable-io-uring")) {
+		argsBase().m_enableIOUring = true;
+	}
+	else if (isArg(i, argc, argv, NULL, "--profile-locks")) {
+		argsBase().m_profileLocks = true;
+	}
+	else if (isArg(i, argc, argv, NULL, "--spin-locks")) {
+		argsBase().m_spinLocks = true;
+	}
 	else if (isArg(i, argc, argv, NULL, "--profile-dir", 1)) {
 		argsBase().m_profileDirectory = argv[++i];
 	}
@@ -43,6 +43,9 @@ m_enableDragDrop(false),
 m_shouldExit(false),
 m_synergyAddress(),
 m_enableCrypto(false),
+m_enableIOUring(false),
+m_profileLocks(false),
+m_spinLocks(false),
 m_profileDirectory(""),
 m_pluginDirectory("")
 {
@@ -49,6 +49,9 @@ public:
 	bool				m_shouldExit;
 	String				m_synergyAddress;
 	bool				m_enableCrypto;
+	bool				m_enableIOUring;
+	bool				m_profileLocks;
+	bool				m_spinLocks;
 	String				m_profileDirectory;
 	String				m_pluginDirectory;
 };
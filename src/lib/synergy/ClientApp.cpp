@@ -49,6 +49,10 @@
 #include "platform/MSWindowsScreen.h"
 #elif WINAPI_XWINDOWS
 #include "platform/XWindowsScreen.h"
+#if HAVE_LINUX_UINPUT_H
+#include "platform/UinputScreen.h"
+#include "platform/UinputDevice.h"
+#endif
 #elif WINAPI_CARBON
 #include "platform/OSXScreen.h"
 #endif
@@ -66,7 +70,8 @@ ClientApp::ClientApp(IEventQueue* events, CreateTaskBarReceiverFunc createTaskBa
 	App(events, createTaskBarReceiver, new ClientArgs()),
 	m_client(NULL),
 	m_clientScreen(NULL),
-	m_serverAddress(NULL)
+	m_serverAddress(NULL),
+	m_established(false)
 {
 }
 
@@ -84,21 +89,39 @@ ClientApp::parseArgs(int argc, const char* const* argv)
 		m_bye(kExitArgs);
 	}
 	else {
-		// save server address
+		// save server addresses.  the first is the preferred server, the
+		// rest are standbys tried in order if it can't be reached.
 		if (!args().m_synergyAddress.empty()) {
-			try {
-				*m_serverAddress = NetworkAddress(args().m_synergyAddress, kDefaultPort);
-				m_serverAddress->resolve();
+			std::vector<String> addresses =
+				synergy::string::splitString(args().m_synergyAddress, ',');
+			if (addresses.empty()) {
+				addresses.push_back(args().m_synergyAddress);
 			}
-			catch (XSocketAddress& e) {
-				// allow an address that we can't look up if we're restartable.
-				// we'll try to resolve the address each time we connect to the
-				// server.  a bad port will never get better.  patch by Brent
-				// Priddy.
-				if (!args().m_restartable || e.getError() == XSocketAddress::kBadPort) {
-					LOG((CLOG_PRINT "%s: %s" BYE,
-						args().m_pname, e.what(), args().m_pname));
-					m_bye(kExitFailed);
+
+			m_standbyAddresses.clear();
+			for (size_t i = 0; i < addresses.size(); ++i) {
+				NetworkAddress address;
+				try {
+					address = NetworkAddress(addresses[i], kDefaultPort);
+					address.resolve();
+				}
+				catch (XSocketAddress& e) {
+					// allow an address that we can't look up if we're restartable.
+					// we'll try to resolve the address each time we connect to the
+					// server.  a bad port will never get better.  patch by Brent
+					// Priddy.
+					if (!args().m_restartable || e.getError() == XSocketAddress::kBadPort) {
+						LOG((CLOG_PRINT "%s: %s" BYE,
+							args().m_pname, e.what(), args().m_pname));
+						m_bye(kExitFailed);
+					}
+				}
+
+				if (i == 0) {
+					*m_serverAddress = address;
+				}
+				else {
+					m_standbyAddresses.push_back(address);
 				}
 			}
 		}
@@ -108,7 +131,16 @@ ClientApp::parseArgs(int argc, const char* const* argv)
 void
 ClientApp::help()
 {
-#if WINAPI_XWINDOWS
+#if WINAPI_XWINDOWS && HAVE_LINUX_UINPUT_H
+#  define WINAPI_ARG \
+	" [--display <display>] [--no-xinitthreads] [--uinput <width>x<height>]"
+#  define WINAPI_INFO \
+	"      --display <display>  connect to the X server at <display>\n" \
+	"      --no-xinitthreads    do not call XInitThreads()\n" \
+	"      --uinput <width>x<height>\n" \
+	"                           inject input through /dev/uinput instead of\n" \
+	"                             the X server, e.g. on Wayland or a console.\n"
+#elif WINAPI_XWINDOWS
 #  define WINAPI_ARG \
 	" [--display <display>] [--no-xinitthreads]"
 #  define WINAPI_INFO \
@@ -119,15 +151,16 @@ ClientApp::help()
 #  define WINAPI_INFO
 #endif
 
-	char buffer[2000];
+	char buffer[3000];
 	sprintf(
 		buffer,
 		"Usage: %s"
 		" [--yscroll <delta>]"
+		" [--smooth-motion]"
 		WINAPI_ARG
 		HELP_SYS_ARGS
 		HELP_COMMON_ARGS
-		" <server-address>"
+		" <server-address>[,<server-address>...]"
 		"\n\n"
 		"Connect to a synergy mouse/keyboard sharing server.\n"
 		"\n"
@@ -136,13 +169,18 @@ ClientApp::help()
 		HELP_SYS_INFO
 		"      --yscroll <delta>    defines the vertical scrolling delta, which is\n"
 		"                             120 by default.\n"
+		"      --smooth-motion      pace out mouse motion that arrives in bursts\n"
+		"                             over a congested network, adding at most\n"
+		"                             30ms of latency.\n"
 		HELP_COMMON_INFO_2
 		"\n"
 		"* marks defaults.\n"
 		"\n"
 		"The server address is of the form: [<hostname>][:<port>].  The hostname\n"
 		"must be the address or hostname of the server.  The port overrides the\n"
-		"default port, %d.\n",
+		"default port, %d.  Give a comma separated list of servers to fail over\n"
+		"between them;  the first is preferred and the others are connected to\n"
+		"in order if it doesn't answer.\n",
 		args().m_pname, kDefaultPort
 	);
 
@@ -176,6 +214,13 @@ ClientApp::createScreen()
 	return new synergy::Screen(new MSWindowsScreen(
 		false, args().m_noHooks, args().m_stopOnDeskSwitch, m_events), m_events);
 #elif WINAPI_XWINDOWS
+#if HAVE_LINUX_UINPUT_H
+	if (args().m_uinputWidth > 0) {
+		return new synergy::Screen(new UinputScreen(
+			new UinputDevice(args().m_uinputWidth, args().m_uinputHeight),
+			m_events), m_events);
+	}
+#endif
 	return new synergy::Screen(new XWindowsScreen(
 		args().m_display, false, args().m_disableXInitThreads,
 		args().m_yscroll, m_events), m_events);
@@ -292,6 +337,7 @@ void
 ClientApp::handleClientConnected(const Event&, void*)
 {
 	LOG((CLOG_NOTE "connected to server"));
+	m_established = true;
 	resetRestartTimeout();
 	updateStatus();
 }
@@ -326,8 +372,13 @@ ClientApp::handleClientDisconnected(const Event&, void*)
 		m_events->addEvent(Event(Event::kQuit));
 	}
 	else if (!m_suspended) {
-		scheduleClientRestart(nextRestartTimeout());
+		// reconnect straight away after losing a working server so a
+		// standby takes over without the user noticing.  a server that
+		// drops us again before the handshake completes gets the usual
+		// delay so we don't spin.
+		scheduleClientRestart(m_established ? 0.0 : nextRestartTimeout());
 	}
+	m_established = false;
 	updateStatus();
 }
 
@@ -342,6 +393,9 @@ ClientApp::openClient(const String& name, const NetworkAddress& address,
 		new TCPSocketFactory(m_events, getSocketMultiplexer()),
 		screen,
 		args());
+	for (size_t i = 0; i < m_standbyAddresses.size(); ++i) {
+		client->addServerAddress(m_standbyAddresses[i]);
+	}
 
 	try {
 		m_events->adoptHandler(
@@ -452,7 +506,8 @@ ClientApp::mainLoop()
 {
 	// create socket multiplexer.  this must happen after daemonization
 	// on unix because threads evaporate across a fork().
-	SocketMultiplexer multiplexer;
+	SocketMultiplexer multiplexer(argsBase().m_enableIOUring ?
+		SocketMultiplexer::kIOUringBackend : SocketMultiplexer::kPollBackend);
 	setSocketMultiplexer(&multiplexer);
 
 	// start client, etc
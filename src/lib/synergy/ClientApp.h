@@ -19,11 +19,12 @@
 #pragma once
 
 #include "synergy/App.h"
+#include "net/NetworkAddress.h"
+#include "common/stdvector.h"
 
 namespace synergy { class Screen; }
 class Event;
 class Client;
-class NetworkAddress;
 class Thread;
 class ClientArgs;
 
@@ -80,4 +81,6 @@ private:
 	Client*			m_client;
 	synergy::Screen*m_clientScreen;
 	NetworkAddress*	m_serverAddress;
+	std::vector<NetworkAddress> m_standbyAddresses;
+	bool			m_established;
 };
@@ -18,6 +18,9 @@
 #include "synergy/ClientArgs.h"
 
 ClientArgs::ClientArgs() :
-	m_yscroll(0)
+	m_yscroll(0),
+	m_smoothMotion(false),
+	m_uinputWidth(0),
+	m_uinputHeight(0)
 {
 }
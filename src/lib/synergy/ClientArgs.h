@@ -27,4 +27,11 @@ public:
 
 public:
 	int					m_yscroll;
+
+	// pace out bursty mouse motion from the server
+	bool				m_smoothMotion;
+
+	// inject through uinput with this screen size, if non-zero
+	int					m_uinputWidth;
+	int					m_uinputHeight;
 };
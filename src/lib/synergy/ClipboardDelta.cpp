@@ -0,0 +1,499 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/ClipboardDelta.h"
+
+#include "synergy/FileSetChunk.h"
+#include "base/Log.h"
+#include "common/stdvector.h"
+
+#include <cstring>
+
+// kinds of change to a format in an update
+enum {
+	kFormatRemoved  = 0,
+	kFormatReplaced = 1,
+	kFormatPatched  = 2
+};
+
+// binary delta operations
+enum {
+	kDeltaCopy   = 1,
+	kDeltaInsert = 2
+};
+
+// bytes per block of the base indexed by diff()
+static const UInt32		s_blockSize = 32;
+
+static
+void
+writeUInt32(String& buf, UInt32 v)
+{
+	buf += static_cast<char>((v >> 24) & 0xff);
+	buf += static_cast<char>((v >> 16) & 0xff);
+	buf += static_cast<char>((v >>  8) & 0xff);
+	buf += static_cast<char>( v        & 0xff);
+}
+
+static
+bool
+readUInt32(const String& buf, size_t& pos, UInt32& v)
+{
+	if (buf.size() - pos < 4) {
+		return false;
+	}
+	const unsigned char* ubuf =
+		reinterpret_cast<const unsigned char*>(buf.data() + pos);
+	v =	(static_cast<UInt32>(ubuf[0]) << 24) |
+		(static_cast<UInt32>(ubuf[1]) << 16) |
+		(static_cast<UInt32>(ubuf[2]) <<  8) |
+		 static_cast<UInt32>(ubuf[3]);
+	pos += 4;
+	return true;
+}
+
+static
+bool
+readUInt8(const String& buf, size_t& pos, UInt8& v)
+{
+	if (pos >= buf.size()) {
+		return false;
+	}
+	v = static_cast<UInt8>(buf[pos++]);
+	return true;
+}
+
+// reads a length prefixed string
+static
+bool
+readString(const String& buf, size_t& pos, String& v)
+{
+	UInt32 size;
+	if (!readUInt32(buf, pos, size) || buf.size() - pos < size) {
+		return false;
+	}
+	v.assign(buf, pos, size);
+	pos += size;
+	return true;
+}
+
+// rsync style weak checksum of a block.  a is the sum of the bytes
+// and b the sum of the running sums, so both can be rolled along a
+// byte at a time.
+static
+void
+hashBlock(const unsigned char* data, UInt32& a, UInt32& b)
+{
+	a = 0;
+	b = 0;
+	for (UInt32 i = 0; i < s_blockSize; ++i) {
+		a += data[i];
+		b += a;
+	}
+}
+
+static
+UInt32
+hashValue(UInt32 a, UInt32 b)
+{
+	return (a & 0xffff) | ((b & 0xffff) << 16);
+}
+
+static
+void
+appendInsert(String& delta, const String& target, size_t offset, size_t size)
+{
+	if (size != 0) {
+		delta += static_cast<char>(kDeltaInsert);
+		writeUInt32(delta, static_cast<UInt32>(size));
+		delta.append(target, offset, size);
+	}
+}
+
+static
+void
+appendCopy(String& delta, size_t offset, size_t size)
+{
+	delta += static_cast<char>(kDeltaCopy);
+	writeUInt32(delta, static_cast<UInt32>(offset));
+	writeUInt32(delta, static_cast<UInt32>(size));
+}
+
+//
+// ClipboardDelta
+//
+
+const UInt32			ClipboardDelta::kMinDeltaSize = 4096;
+
+ClipboardDelta::ClipboardDelta() :
+	m_sentVersion(0),
+	m_resyncVersion(0),
+	m_ackedVersion(0),
+	m_receivedVersion(0)
+{
+	// do nothing
+}
+
+ClipboardDelta::~ClipboardDelta()
+{
+	// do nothing
+}
+
+String
+ClipboardDelta::makeUpdate(const IClipboard* clipboard)
+{
+	String data = encode(clipboard, false);
+	IClipboard::copy(&m_sent, clipboard);
+	return data;
+}
+
+String
+ClipboardDelta::makeResync()
+{
+	String data     = encode(&m_sent, true);
+	m_resyncVersion = m_sentVersion;
+	return data;
+}
+
+bool
+ClipboardDelta::acknowledge(UInt32 version, bool applied)
+{
+	if (applied) {
+		m_ackedVersion = version;
+		return true;
+	}
+
+	// updates sent before the last resync were made good by it
+	if (version < m_resyncVersion) {
+		return true;
+	}
+
+	LOG((CLOG_DEBUG "peer couldn't apply clipboard update %d", version));
+	return false;
+}
+
+bool
+ClipboardDelta::applyUpdate(const String& data,
+				IClipboard* clipboard, UInt32& version)
+{
+	size_t pos = 0;
+	UInt32 baseVersion, numFormats;
+	if (!readUInt32(data, pos, baseVersion) ||
+		!readUInt32(data, pos, version) ||
+		!readUInt32(data, pos, numFormats)) {
+		LOG((CLOG_ERR "clipboard update is truncated"));
+		return false;
+	}
+	if (baseVersion != 0 && baseVersion != m_receivedVersion) {
+		LOG((CLOG_DEBUG "clipboard update %d is relative to %d but we have %d", version, baseVersion, m_receivedVersion));
+		return false;
+	}
+
+	// start from the update's base
+	String formatData[IClipboard::kNumFormats];
+	bool has[IClipboard::kNumFormats];
+	m_received.open(0);
+	for (UInt32 format = 0; format != IClipboard::kNumFormats; ++format) {
+		IClipboard::EFormat eFormat = static_cast<IClipboard::EFormat>(format);
+		has[format] = (baseVersion != 0 && m_received.has(eFormat));
+		if (has[format]) {
+			formatData[format] = m_received.get(eFormat);
+		}
+	}
+	m_received.close();
+
+	// apply the changes.  formats we don't know, because the peer
+	// supports more than we do, are skipped.
+	for (UInt32 i = 0; i < numFormats; ++i) {
+		UInt32 format;
+		UInt8 kind;
+		if (!readUInt32(data, pos, format) || !readUInt8(data, pos, kind)) {
+			LOG((CLOG_ERR "clipboard update %d is truncated", version));
+			return false;
+		}
+		const bool known = (format < IClipboard::kNumFormats);
+
+		String value;
+		UInt32 crc = 0;
+		switch (kind) {
+		case kFormatRemoved:
+			if (known) {
+				has[format] = false;
+				formatData[format].clear();
+			}
+			break;
+
+		case kFormatReplaced:
+			if (!readString(data, pos, value)) {
+				LOG((CLOG_ERR "clipboard update %d is truncated", version));
+				return false;
+			}
+			if (known) {
+				has[format] = true;
+				formatData[format].swap(value);
+			}
+			break;
+
+		case kFormatPatched:
+			if (!readUInt32(data, pos, crc) || !readString(data, pos, value)) {
+				LOG((CLOG_ERR "clipboard update %d is truncated", version));
+				return false;
+			}
+			if (known) {
+				String patched;
+				if (!has[format] ||
+					!patch(formatData[format], value, patched) ||
+					FileSetChunk::checksum(0, patched.data(),
+										patched.size()) != crc) {
+					LOG((CLOG_ERR "clipboard update %d has a bad delta for format %d", version, format));
+					return false;
+				}
+				formatData[format].swap(patched);
+			}
+			break;
+
+		default:
+			LOG((CLOG_ERR "clipboard update %d has unknown change %d", version, kind));
+			return false;
+		}
+	}
+	if (pos != data.size()) {
+		LOG((CLOG_ERR "clipboard update %d has trailing data", version));
+		return false;
+	}
+
+	// that's now our copy of the peer's clipboard
+	m_received.open(0);
+	m_received.empty();
+	for (UInt32 format = 0; format != IClipboard::kNumFormats; ++format) {
+		if (has[format]) {
+			m_received.add(static_cast<IClipboard::EFormat>(format),
+							formatData[format]);
+		}
+	}
+	m_received.close();
+	m_receivedVersion = version;
+
+	LOG((CLOG_DEBUG1 "applied clipboard update %d with %d changed formats", version, numFormats));
+	return IClipboard::copy(clipboard, &m_received);
+}
+
+UInt32
+ClipboardDelta::getAcknowledgedVersion() const
+{
+	return m_ackedVersion;
+}
+
+String
+ClipboardDelta::diff(const String& base, const String& target)
+{
+	String delta;
+	writeUInt32(delta, static_cast<UInt32>(target.size()));
+
+	const size_t n = target.size();
+	const size_t m = base.size();
+	if (n < s_blockSize || m < s_blockSize) {
+		appendInsert(delta, target, 0, n);
+		return delta;
+	}
+
+	// index the blocks of the base by weak hash.  collisions just
+	// overwrite;  every match is verified so that only costs matches.
+	size_t tableSize = 1;
+	while (tableSize < 2 * (m / s_blockSize)) {
+		tableSize <<= 1;
+	}
+	const size_t mask = tableSize - 1;
+	std::vector<UInt32> table(tableSize, 0);
+	const unsigned char* b = reinterpret_cast<const unsigned char*>(base.data());
+	const unsigned char* t = reinterpret_cast<const unsigned char*>(target.data());
+	for (size_t offset = 0; offset + s_blockSize <= m; offset += s_blockSize) {
+		UInt32 hashA, hashB;
+		hashBlock(b + offset, hashA, hashB);
+		table[hashValue(hashA, hashB) & mask] = static_cast<UInt32>(offset + 1);
+	}
+
+	// roll along the target looking for blocks of the base
+	size_t literal = 0;
+	size_t p       = 0;
+	UInt32 hashA, hashB;
+	hashBlock(t, hashA, hashB);
+	while (p + s_blockSize <= n) {
+		UInt32 slot = table[hashValue(hashA, hashB) & mask];
+		if (slot != 0 && memcmp(b + slot - 1, t + p, s_blockSize) == 0) {
+			// grow the match both ways as far as it goes
+			size_t from  = slot - 1;
+			size_t start = p;
+			while (start > literal && from > 0 && b[from - 1] == t[start - 1]) {
+				--start;
+				--from;
+			}
+			size_t end  = p + s_blockSize;
+			size_t last = from + (end - start);
+			while (end < n && last < m && b[last] == t[end]) {
+				++end;
+				++last;
+			}
+
+			appendInsert(delta, target, literal, start - literal);
+			appendCopy(delta, from, end - start);
+			p = literal = end;
+			if (p + s_blockSize <= n) {
+				hashBlock(t + p, hashA, hashB);
+			}
+			continue;
+		}
+
+		// slide the window along one byte
+		if (p + s_blockSize < n) {
+			hashA += t[p + s_blockSize] - t[p];
+			hashB += hashA - s_blockSize * t[p];
+		}
+		++p;
+	}
+	appendInsert(delta, target, literal, n - literal);
+
+	return delta;
+}
+
+bool
+ClipboardDelta::patch(const String& base, const String& delta, String& target)
+{
+	size_t pos = 0;
+	UInt32 size;
+	if (!readUInt32(delta, pos, size)) {
+		return false;
+	}
+
+	target.clear();
+	if (size <= base.size() + delta.size()) {
+		target.reserve(size);
+	}
+	while (pos < delta.size()) {
+		UInt8 op;
+		UInt32 offset, length;
+		readUInt8(delta, pos, op);
+		switch (op) {
+		case kDeltaCopy:
+			if (!readUInt32(delta, pos, offset) ||
+				!readUInt32(delta, pos, length) ||
+				offset > base.size() || length > base.size() - offset) {
+				return false;
+			}
+			target.append(base, offset, length);
+			break;
+
+		case kDeltaInsert:
+			if (!readUInt32(delta, pos, length) ||
+				length > delta.size() - pos) {
+				return false;
+			}
+			target.append(delta, pos, length);
+			pos += length;
+			break;
+
+		default:
+			return false;
+		}
+		if (target.size() > size) {
+			return false;
+		}
+	}
+
+	return (target.size() == size);
+}
+
+String
+ClipboardDelta::encode(const IClipboard* clipboard, bool full)
+{
+	const bool relative      = (!full && m_sentVersion != 0);
+	const UInt32 baseVersion = relative ? m_sentVersion : 0;
+	m_sentVersion            = nextVersion();
+
+	// the number of changed formats is filled in at the end
+	String data;
+	writeUInt32(data, baseVersion);
+	writeUInt32(data, m_sentVersion);
+	writeUInt32(data, 0);
+
+	UInt32 numFormats = 0;
+	if (clipboard->open(0)) {
+		if (relative) {
+			m_sent.open(0);
+		}
+		for (UInt32 format = 0; format != IClipboard::kNumFormats; ++format) {
+			IClipboard::EFormat eFormat = static_cast<IClipboard::EFormat>(format);
+			const bool had = (relative && m_sent.has(eFormat));
+			if (!clipboard->has(eFormat)) {
+				if (had) {
+					writeUInt32(data, format);
+					data += static_cast<char>(kFormatRemoved);
+					++numFormats;
+				}
+				continue;
+			}
+
+			String value = clipboard->get(eFormat);
+			if (had) {
+				String old = m_sent.get(eFormat);
+				if (old == value) {
+					continue;
+				}
+
+				// send a small change to a large format as a delta if
+				// that's a good deal smaller
+				if (value.size() >= kMinDeltaSize && old.size() >= kMinDeltaSize) {
+					String delta = diff(old, value);
+					if (delta.size() < value.size() / 2) {
+						writeUInt32(data, format);
+						data += static_cast<char>(kFormatPatched);
+						writeUInt32(data, FileSetChunk::checksum(0,
+										value.data(), value.size()));
+						writeUInt32(data, static_cast<UInt32>(delta.size()));
+						data += delta;
+						++numFormats;
+						continue;
+					}
+				}
+			}
+
+			writeUInt32(data, format);
+			data += static_cast<char>(kFormatReplaced);
+			writeUInt32(data, static_cast<UInt32>(value.size()));
+			data += value;
+			++numFormats;
+		}
+		if (relative) {
+			m_sent.close();
+		}
+		clipboard->close();
+	}
+
+	String count;
+	writeUInt32(count, numFormats);
+	data.replace(8, 4, count);
+
+	LOG((CLOG_DEBUG1 "clipboard update %d relative to %d: %d changed formats, %d bytes", m_sentVersion, baseVersion, numFormats, data.size()));
+	return data;
+}
+
+UInt32
+ClipboardDelta::nextVersion()
+{
+	// zero means no version
+	return (m_sentVersion == 0xffffffff) ? 1 : m_sentVersion + 1;
+}
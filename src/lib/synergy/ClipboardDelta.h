@@ -0,0 +1,117 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "synergy/Clipboard.h"
+#include "base/String.h"
+#include "common/basic_types.h"
+
+//! Clipboard updates that carry only what changed
+/*!
+Tracks one clipboard shared with one peer, in each direction, so that
+an update carries only the formats that changed since the previous
+update.  Large formats that changed a little are sent as a binary
+delta against the peer's copy.
+
+Every update is numbered and names the update it's relative to.  The
+receiver acknowledges each one;  if it can't apply an update then the
+sender resends the whole clipboard with makeResync().
+*/
+class ClipboardDelta {
+public:
+	ClipboardDelta();
+	~ClipboardDelta();
+
+	//! @name manipulators
+	//@{
+
+	//! Make an update
+	/*!
+	Returns an update that turns the peer's copy of the clipboard
+	into \c clipboard.
+	*/
+	String				makeUpdate(const IClipboard* clipboard);
+
+	//! Make a full update
+	/*!
+	Returns an update holding the whole clipboard last sent, relative
+	to nothing.
+	*/
+	String				makeResync();
+
+	//! Handle an acknowledgement
+	/*!
+	Records the peer's acknowledgement of update \c version.  Returns
+	false if the peer couldn't apply it and still needs the clipboard
+	resent in full, true otherwise.
+	*/
+	bool				acknowledge(UInt32 version, bool applied);
+
+	//! Apply an update
+	/*!
+	Applies update \c data to our copy of the peer's clipboard and
+	copies the result to \c clipboard.  Sets \c version to the number
+	of the update.  Returns false, leaving \c clipboard alone, if the
+	update is corrupt or is relative to an update we don't have.
+	*/
+	bool				applyUpdate(const String& data,
+							IClipboard* clipboard, UInt32& version);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get version acknowledged by the peer
+	UInt32				getAcknowledgedVersion() const;
+
+	//! Compute binary delta
+	/*!
+	Returns a delta that patch() turns \c base into \c target with.
+	Runs of \c target found in \c base, located with a rolling hash,
+	become copies;  everything else is sent literally.
+	*/
+	static String		diff(const String& base, const String& target);
+
+	//! Apply binary delta
+	/*!
+	Applies \c delta made by diff() to \c base and stores the result in
+	\c target.  Returns false if the delta is malformed.
+	*/
+	static bool			patch(const String& base, const String& delta,
+							String& target);
+
+	//@}
+
+	//! Smallest format, in bytes, worth sending as a binary delta
+	static const UInt32	kMinDeltaSize;
+
+private:
+	String				encode(const IClipboard* clipboard, bool full);
+	UInt32				nextVersion();
+
+private:
+	// what we last sent and what the peer has acknowledged
+	Clipboard			m_sent;
+	UInt32				m_sentVersion;
+	UInt32				m_resyncVersion;
+	UInt32				m_ackedVersion;
+
+	// what we last received
+	Clipboard			m_received;
+	UInt32				m_receivedVersion;
+};
@@ -16,6 +16,7 @@
  */
 
 #include "synergy/DragInformation.h"
+#include "arch/Arch.h"
 #include "base/Log.h"
 
 #include <fstream>
@@ -139,6 +140,11 @@ DragInformation::stringToNum(String& str)
 String
 DragInformation::getFileSize(String& filename)
 {
+	// directories are sent as file sets and have no size of their own
+	if (ARCH->isDirectory(filename)) {
+		return "0";
+	}
+
 	std::fstream file(filename.c_str(), ios::in|ios::binary);
 
 	if (!file.is_open()) {
@@ -0,0 +1,132 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/FileSetChunk.h"
+
+#include "synergy/ProtocolUtil.h"
+#include "synergy/protocol_types.h"
+#include "base/Log.h"
+
+// CRC-32 (IEEE 802.3) table, filled in before main() so that sender
+// and receiver threads can share it without locking
+static UInt32			s_crcTable[256];
+
+class CrcTableInit {
+public:
+	CrcTableInit()
+	{
+		for (UInt32 i = 0; i < 256; ++i) {
+			UInt32 c = i;
+			for (int k = 0; k < 8; ++k) {
+				c = (c & 1) ? (0xedb88320u ^ (c >> 1)) : (c >> 1);
+			}
+			s_crcTable[i] = c;
+		}
+	}
+};
+static CrcTableInit		s_crcTableInit;
+
+//
+// FileSetChunk
+//
+
+FileSetChunk::FileSetChunk() :
+	m_mark(0),
+	m_id(0)
+{
+	// do nothing
+}
+
+FileSetChunk::FileSetChunk(UInt8 mark, UInt32 id,
+				const String& path, const String& data) :
+	m_mark(mark),
+	m_id(id),
+	m_path(path),
+	m_data(data)
+{
+	// do nothing
+}
+
+FileSetChunk*
+FileSetChunk::set(UInt8 mark, UInt32 entries)
+{
+	return new FileSetChunk(mark, 0, "",
+							synergy::string::sizeTypeToString(entries));
+}
+
+FileSetChunk*
+FileSetChunk::start(UInt32 id, const String& path, const String& size)
+{
+	return new FileSetChunk(kDataStart, id, path, size);
+}
+
+FileSetChunk*
+FileSetChunk::data(UInt32 id, const String& data)
+{
+	return new FileSetChunk(kDataChunk, id, "", data);
+}
+
+FileSetChunk*
+FileSetChunk::end(UInt32 id, UInt32 checksum)
+{
+	return new FileSetChunk(kDataEnd, id, "", formatChecksum(checksum));
+}
+
+bool
+FileSetChunk::read(synergy::IStream* stream)
+{
+	return ProtocolUtil::readf(stream, kMsgDFileSetTransfer + 4,
+							&m_mark, &m_id, &m_path, &m_data);
+}
+
+void
+FileSetChunk::send(synergy::IStream* stream) const
+{
+	switch (m_mark) {
+	case kDataStart:
+		LOG((CLOG_DEBUG2 "sending file set start: id=%d path=%s size=%s", m_id, m_path.c_str(), m_data.c_str()));
+		break;
+
+	case kDataChunk:
+		LOG((CLOG_DEBUG2 "sending file set chunk: id=%d size=%i", m_id, m_data.size()));
+		break;
+
+	case kDataEnd:
+		LOG((CLOG_DEBUG2 "sending file set end: id=%d", m_id));
+		break;
+	}
+
+	ProtocolUtil::writef(stream, kMsgDFileSetTransfer,
+							m_mark, m_id, &m_path, &m_data);
+}
+
+UInt32
+FileSetChunk::checksum(UInt32 crc, const void* data, size_t size)
+{
+	const UInt8* p = static_cast<const UInt8*>(data);
+	crc = ~crc;
+	for (size_t i = 0; i < size; ++i) {
+		crc = s_crcTable[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+String
+FileSetChunk::formatChecksum(UInt32 crc)
+{
+	return synergy::string::sprintf("%08x", crc);
+}
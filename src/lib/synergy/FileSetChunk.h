@@ -0,0 +1,78 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/Event.h"
+#include "base/String.h"
+#include "common/basic_types.h"
+
+namespace synergy {
+class IStream;
+};
+
+//! File set transfer message
+/*!
+One kMsgDFileSetTransfer message, passed from a FileSetSender to the
+connection that writes it.
+*/
+class FileSetChunk : public EventData {
+public:
+	FileSetChunk();
+	FileSetChunk(UInt8 mark, UInt32 id,
+							const String& path, const String& data);
+
+	//! Create set start or end
+	static FileSetChunk*
+						set(UInt8 mark, UInt32 entries);
+	//! Create entry start
+	static FileSetChunk*
+						start(UInt32 id, const String& path,
+							const String& size);
+	//! Create file data
+	static FileSetChunk*
+						data(UInt32 id, const String& data);
+	//! Create file end
+	static FileSetChunk*
+						end(UInt32 id, UInt32 checksum);
+
+	//! Read message
+	/*!
+	Reads the rest of a kMsgDFileSetTransfer message from \c stream.
+	Returns false if the message is malformed.
+	*/
+	bool				read(synergy::IStream* stream);
+
+	//! Write message
+	void				send(synergy::IStream* stream) const;
+
+	//! Update checksum
+	/*!
+	Returns the CRC-32 of \c data continued from \c crc.  Start a new
+	checksum with zero.
+	*/
+	static UInt32		checksum(UInt32 crc, const void* data, size_t size);
+
+	//! Format checksum
+	static String		formatChecksum(UInt32 crc);
+
+public:
+	UInt8				m_mark;
+	UInt32				m_id;
+	String				m_path;
+	String				m_data;
+};
@@ -0,0 +1,164 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "synergy/FileSetDropper.h"
+
+#include "synergy/FileSetReceiver.h"
+#include "synergy/Screen.h"
+#include "synergy/protocol_types.h"
+#include "mt/Lock.h"
+#include "mt/Thread.h"
+#include "arch/Arch.h"
+#include "base/IEventQueue.h"
+#include "base/TMethodJob.h"
+#include "base/Log.h"
+
+//
+// FileSetDropper
+//
+
+FileSetDropper::FileSetDropper(IEventQueue* events, void* eventTarget,
+				synergy::Screen* screen) :
+	m_events(events),
+	m_eventTarget(eventTarget),
+	m_screen(screen),
+	m_receiving(NULL),
+	m_received(NULL),
+	m_thread(NULL),
+	m_queued(NULL),
+	m_running(false),
+	m_interrupted(false)
+{
+	// do nothing
+}
+
+FileSetDropper::~FileSetDropper()
+{
+	if (m_thread != NULL) {
+		{
+			Lock lock(&m_mutex);
+			m_interrupted = true;
+		}
+		m_thread->wait();
+		delete m_thread;
+	}
+
+	// discard sets not yet dropped
+	delete m_queued;
+	delete m_received;
+	delete m_receiving;
+}
+
+void
+FileSetDropper::handle(const FileSetChunk& chunk)
+{
+	if (m_receiving == NULL) {
+		m_receiving = new FileSetReceiver(
+								FileSetReceiver::newStagingDirectory());
+	}
+
+	switch (m_receiving->handle(chunk)) {
+	case kFinish:
+		LOG((CLOG_DEBUG "received file set, %d files, %d failed",
+			m_receiving->getFileCount(),
+			m_receiving->getFailedCount()));
+		delete m_received;
+		m_received  = m_receiving;
+		m_receiving = NULL;
+		m_events->addEvent(Event(m_events->forFile().fileRecieveCompleted(),
+							m_eventTarget));
+		break;
+
+	case kError:
+		LOG((CLOG_ERR "malformed file set message, discarding file set"));
+		delete m_receiving;
+		m_receiving = NULL;
+		break;
+	}
+}
+
+bool
+FileSetDropper::drop()
+{
+	if (m_received == NULL) {
+		return false;
+	}
+
+	bool start;
+	{
+		Lock lock(&m_mutex);
+		delete m_queued;
+		m_queued   = m_received;
+		m_received = NULL;
+		start      = !m_running;
+		m_running  = true;
+	}
+
+	// a worker that's not running has exited or is about to
+	if (start) {
+		if (m_thread != NULL) {
+			m_thread->wait();
+			delete m_thread;
+		}
+		m_thread = new Thread(new TMethodJob<FileSetDropper>(
+								this, &FileSetDropper::dropThread));
+	}
+	return true;
+}
+
+FileSetReceiver*
+FileSetDropper::getReceived() const
+{
+	return m_received;
+}
+
+void
+FileSetDropper::dropThread(void*)
+{
+	LOG((CLOG_DEBUG "starting write file set to drop dir thread"));
+
+	for (;;) {
+		while (m_screen->isFakeDraggingStarted()) {
+			{
+				Lock lock(&m_mutex);
+				if (m_interrupted) {
+					m_running = false;
+					return;
+				}
+			}
+			ARCH->sleep(.1f);
+		}
+
+		// take the set.  the main thread never touches it again.
+		FileSetReceiver* fileSet;
+		{
+			Lock lock(&m_mutex);
+			if (m_queued == NULL || m_interrupted) {
+				m_running = false;
+				return;
+			}
+			fileSet  = m_queued;
+			m_queued = NULL;
+		}
+
+		if (!fileSet->moveTo(m_screen->getDropTarget())) {
+			LOG((CLOG_ERR "failed to move file set to drop directory"));
+		}
+		delete fileSet;
+	}
+}
@@ -0,0 +1,89 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "mt/Mutex.h"
+
+class FileSetChunk;
+class FileSetReceiver;
+class IEventQueue;
+class Thread;
+namespace synergy { class Screen; }
+
+//! File set dropper
+/*!
+Receives file sets into staging directories and moves complete sets
+into the screen's drop directory.  A complete set is posted to the
+event target as a \c fileRecieveCompleted event;  the target then calls
+drop() to move it once any fake drag on the screen has finished.  The
+move happens on a worker thread that owns the set from then on.
+*/
+class FileSetDropper {
+public:
+	FileSetDropper(IEventQueue* events, void* eventTarget,
+							synergy::Screen* screen);
+	~FileSetDropper();
+
+	//! @name manipulators
+	//@{
+
+	//! Handle a message
+	/*!
+	Passes \c chunk to the set being received, starting one if needed.
+	A malformed message discards the set.
+	*/
+	void				handle(const FileSetChunk& chunk);
+
+	//! Drop received set
+	/*!
+	Hands the last complete set to the worker thread, which moves it
+	into the drop directory.  A set still waiting for the worker is
+	replaced.  Returns false if there's no complete set.
+	*/
+	bool				drop();
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get complete set
+	/*!
+	Returns the last complete set not yet handed to drop(), or NULL.
+	*/
+	FileSetReceiver*	getReceived() const;
+
+	//@}
+
+private:
+	void				dropThread(void*);
+
+private:
+	IEventQueue*		m_events;
+	void*				m_eventTarget;
+	synergy::Screen*	m_screen;
+	FileSetReceiver*	m_receiving;
+	FileSetReceiver*	m_received;
+	Thread*				m_thread;
+
+	// shared with the worker thread
+	Mutex				m_mutex;
+	FileSetReceiver*	m_queued;
+	bool				m_running;
+	bool				m_interrupted;
+};
@@ -0,0 +1,473 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/FileSetReceiver.h"
+
+#include "synergy/FileSetChunk.h"
+#include "synergy/protocol_types.h"
+#include "arch/Arch.h"
+#include "base/Log.h"
+
+#include <cstdio>
+#include <fstream>
+
+// suffix of files that are still being written
+static const char		s_partSuffix[] = ".synergy-part";
+
+static bool
+copyTree(const String& from, const String& to)
+{
+	if (ARCH->isDirectory(from)) {
+		std::vector<std::string> children;
+		if (!ARCH->makeDirectory(to) ||
+			!ARCH->getDirectoryEntries(from, children)) {
+			return false;
+		}
+		bool ok = true;
+		for (size_t i = 0; i < children.size(); ++i) {
+			ok = copyTree(ARCH->concatPath(from, children[i]),
+							ARCH->concatPath(to, children[i])) && ok;
+		}
+		return ok;
+	}
+
+	std::ifstream in(from.c_str(), std::ios::in | std::ios::binary);
+	if (!in.is_open()) {
+		return false;
+	}
+	std::ofstream out(to.c_str(),
+						std::ios::out | std::ios::binary | std::ios::trunc);
+	char buffer[64 * 1024];
+	while (out && in.read(buffer, sizeof(buffer)).gcount() > 0) {
+		out.write(buffer, in.gcount());
+	}
+	return !!out;
+}
+
+static bool
+moveTree(const String& from, const String& to)
+{
+	// a rename is atomic
+	if (ARCH->movePath(from, to)) {
+		return true;
+	}
+
+	// merge into an existing directory entry by entry
+	if (ARCH->isDirectory(from) && ARCH->isDirectory(to)) {
+		std::vector<std::string> children;
+		if (!ARCH->getDirectoryEntries(from, children)) {
+			return false;
+		}
+		bool ok = true;
+		for (size_t i = 0; i < children.size(); ++i) {
+			ok = moveTree(ARCH->concatPath(from, children[i]),
+							ARCH->concatPath(to, children[i])) && ok;
+		}
+		return ok;
+	}
+
+	// otherwise, e.g. across file systems, copy to a temporary sibling
+	// and rename that into place so the entry appears whole
+	String partPath = to + s_partSuffix;
+	FileSetReceiver::removeTree(partPath);
+	if (!copyTree(from, partPath) || !ARCH->movePath(partPath, to)) {
+		FileSetReceiver::removeTree(partPath);
+		return false;
+	}
+	return true;
+}
+
+//
+// FileSetReceiver::PartialFile
+//
+
+class FileSetReceiver::PartialFile {
+public:
+	PartialFile(const String& name) :
+		m_name(name),
+		m_size(0),
+		m_received(0),
+		m_crc(0),
+		m_progress(0),
+		m_failed(false) { }
+
+public:
+	String				m_name;
+	String				m_path;
+	String				m_partPath;
+	std::ofstream		m_file;
+	size_t				m_size;
+	size_t				m_received;
+	UInt32				m_crc;
+	int					m_progress;
+	bool				m_failed;
+};
+
+//
+// FileSetReceiver
+//
+
+FileSetReceiver::FileSetReceiver(const String& directory) :
+	m_directory(directory),
+	m_fileCount(0),
+	m_failedCount(0),
+	m_complete(false)
+{
+	// do nothing
+}
+
+FileSetReceiver::~FileSetReceiver()
+{
+	for (FileMap::iterator i = m_files.begin(); i != m_files.end(); ++i) {
+		fail(i->second, "transfer abandoned");
+		delete i->second;
+	}
+	if (!m_directory.empty()) {
+		removeTree(m_directory);
+	}
+}
+
+int
+FileSetReceiver::handle(const FileSetChunk& chunk)
+{
+	// the set itself
+	if (chunk.m_id == 0) {
+		if (chunk.m_mark == kDataStart) {
+			reset();
+			LOG((CLOG_DEBUG "receiving file set: entries=%s", chunk.m_data.c_str()));
+			return kStart;
+		}
+		else if (chunk.m_mark == kDataEnd) {
+			for (FileMap::iterator i = m_files.begin(); i != m_files.end(); ++i) {
+				fail(i->second, "incomplete");
+				delete i->second;
+			}
+			m_files.clear();
+			m_complete = true;
+			LOG((CLOG_DEBUG "file set received: files=%d failed=%d", m_fileCount, m_failedCount));
+			return kFinish;
+		}
+		return kError;
+	}
+
+	if (m_complete) {
+		return kError;
+	}
+
+	switch (chunk.m_mark) {
+	case kDataStart:
+		return startEntry(chunk);
+
+	case kDataChunk:
+		return appendData(chunk);
+
+	case kDataEnd:
+		return endEntry(chunk);
+	}
+	return kError;
+}
+
+bool
+FileSetReceiver::moveTo(const String& directory)
+{
+	bool ok = true;
+	for (size_t i = 0; i < m_names.size(); ++i) {
+		String from = ARCH->concatPath(m_directory, m_names[i]);
+		String to   = ARCH->concatPath(directory, m_names[i]);
+
+		if (moveTree(from, to)) {
+			removeTree(from);
+			LOG((CLOG_DEBUG "%s is saved to %s", m_names[i].c_str(), directory.c_str()));
+		}
+		else {
+			LOG((CLOG_ERR "drop file failed: cannot move %s to %s", m_names[i].c_str(), directory.c_str()));
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+String
+FileSetReceiver::newStagingDirectory()
+{
+	// other instances may share the profile directory so only ever use
+	// (and later remove) a directory made just for us
+	String path = ARCH->getProfileDirectory();
+	ARCH->makeDirectory(path);
+	path = ARCH->concatPath(path, "incoming");
+	ARCH->makeDirectory(path);
+	path = ARCH->makeTempDirectory(path);
+	if (path.empty()) {
+		LOG((CLOG_ERR "cannot create directory for received files"));
+	}
+	return path;
+}
+
+void
+FileSetReceiver::removeTree(const String& path)
+{
+	if (ARCH->isDirectory(path)) {
+		std::vector<std::string> children;
+		ARCH->getDirectoryEntries(path, children);
+		for (size_t i = 0; i < children.size(); ++i) {
+			removeTree(ARCH->concatPath(path, children[i]));
+		}
+		ARCH->removeDirectory(path);
+	}
+	else {
+		remove(path.c_str());
+	}
+}
+
+bool
+FileSetReceiver::isComplete() const
+{
+	return m_complete;
+}
+
+UInt32
+FileSetReceiver::getFileCount() const
+{
+	return m_fileCount;
+}
+
+UInt32
+FileSetReceiver::getFailedCount() const
+{
+	return m_failedCount;
+}
+
+const std::vector<String>&
+FileSetReceiver::getNames() const
+{
+	return m_names;
+}
+
+const String&
+FileSetReceiver::getDirectory() const
+{
+	return m_directory;
+}
+
+bool
+FileSetReceiver::isSafeName(const String& name)
+{
+	// no absolute paths, drive letters, alternate streams or other
+	// separators
+	if (name.empty() || name.find_first_of(String("\\:\0", 3)) != String::npos) {
+		return false;
+	}
+
+	// no empty, current or parent directory components
+	String::size_type start = 0;
+	for (;;) {
+		String::size_type end = name.find('/', start);
+		String part = name.substr(start,
+							(end == String::npos) ? end : end - start);
+		if (part.empty() || part == "." || part == "..") {
+			return false;
+		}
+		if (end == String::npos) {
+			return true;
+		}
+		start = end + 1;
+	}
+}
+
+void
+FileSetReceiver::reset()
+{
+	for (FileMap::iterator i = m_files.begin(); i != m_files.end(); ++i) {
+		fail(i->second, "transfer restarted");
+		delete i->second;
+	}
+	m_files.clear();
+	m_names.clear();
+	m_fileCount   = 0;
+	m_failedCount = 0;
+	m_complete    = false;
+
+	if (!m_directory.empty()) {
+		removeTree(m_directory);
+	}
+	ARCH->makeDirectory(m_directory);
+}
+
+int
+FileSetReceiver::startEntry(const FileSetChunk& chunk)
+{
+	if (m_files.count(chunk.m_id) != 0) {
+		LOG((CLOG_ERR "file set entry %d started twice", chunk.m_id));
+		return kError;
+	}
+
+	// directories have a trailing slash and no content
+	String name = chunk.m_path;
+	if (!name.empty() && name[name.size() - 1] == '/') {
+		name.erase(name.size() - 1);
+		if (!isSafeName(name)) {
+			LOG((CLOG_ERR "rejected directory \"%s\"", name.c_str()));
+			return kError;
+		}
+		if (m_directory.empty() ||
+			!ARCH->makeDirectory(getLocalPath(name, true))) {
+			LOG((CLOG_ERR "cannot create directory \"%s\"", name.c_str()));
+			return kNotFinish;
+		}
+		addName(name);
+		return kNotFinish;
+	}
+
+	PartialFile* file = new PartialFile(name);
+	m_files[chunk.m_id] = file;
+	if (!isSafeName(name)) {
+		fail(file, "unsafe name");
+		return kNotFinish;
+	}
+	if (m_directory.empty()) {
+		fail(file, "no staging directory");
+		return kNotFinish;
+	}
+
+	file->m_size     = synergy::string::stringToSizeType(chunk.m_data);
+	file->m_path     = getLocalPath(name, true);
+	file->m_partPath = file->m_path + s_partSuffix;
+	file->m_file.open(file->m_partPath.c_str(),
+						std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file->m_file.is_open()) {
+		fail(file, "cannot create file");
+		return kNotFinish;
+	}
+
+	LOG((CLOG_DEBUG "start receiving %s size=%s", name.c_str(), chunk.m_data.c_str()));
+	return kNotFinish;
+}
+
+int
+FileSetReceiver::appendData(const FileSetChunk& chunk)
+{
+	FileMap::iterator i = m_files.find(chunk.m_id);
+	if (i == m_files.end()) {
+		LOG((CLOG_ERR "data for unknown file set entry %d", chunk.m_id));
+		return kError;
+	}
+
+	PartialFile* file = i->second;
+	if (file->m_failed) {
+		return kNotFinish;
+	}
+	size_t size = chunk.m_data.size();
+	if (size == 0) {
+		return kNotFinish;
+	}
+	if (size > file->m_size - file->m_received) {
+		fail(file, "more data than announced");
+		return kNotFinish;
+	}
+
+	file->m_file.write(chunk.m_data.data(), size);
+	if (!file->m_file) {
+		fail(file, "write failed");
+		return kNotFinish;
+	}
+	file->m_crc       = FileSetChunk::checksum(file->m_crc, chunk.m_data.data(), size);
+	file->m_received += size;
+
+	int progress = static_cast<int>(10.0 * file->m_received / file->m_size);
+	if (progress > file->m_progress) {
+		file->m_progress = progress;
+		LOG((CLOG_DEBUG1 "receiving \"%s\": %d%%", file->m_name.c_str(), 10 * progress));
+	}
+	return kNotFinish;
+}
+
+int
+FileSetReceiver::endEntry(const FileSetChunk& chunk)
+{
+	FileMap::iterator i = m_files.find(chunk.m_id);
+	if (i == m_files.end()) {
+		LOG((CLOG_ERR "end of unknown file set entry %d", chunk.m_id));
+		return kError;
+	}
+
+	PartialFile* file = i->second;
+	m_files.erase(i);
+	if (!file->m_failed) {
+		file->m_file.close();
+		if (file->m_received != file->m_size) {
+			fail(file, "size mismatch");
+		}
+		else if (FileSetChunk::formatChecksum(file->m_crc) != chunk.m_data) {
+			fail(file, "checksum mismatch");
+		}
+		else if (!ARCH->movePath(file->m_partPath, file->m_path)) {
+			fail(file, "cannot rename file");
+		}
+		else {
+			++m_fileCount;
+			addName(file->m_name);
+			LOG((CLOG_DEBUG "received %s", file->m_name.c_str()));
+		}
+	}
+	delete file;
+	return kNotFinish;
+}
+
+void
+FileSetReceiver::fail(PartialFile* file, const char* reason)
+{
+	if (file->m_failed) {
+		return;
+	}
+	LOG((CLOG_ERR "file transfer failed: %s: %s", file->m_name.c_str(), reason));
+	if (file->m_file.is_open()) {
+		file->m_file.close();
+	}
+	if (!file->m_partPath.empty()) {
+		remove(file->m_partPath.c_str());
+	}
+	file->m_failed = true;
+	++m_failedCount;
+}
+
+void
+FileSetReceiver::addName(const String& name)
+{
+	String top = name.substr(0, name.find('/'));
+	for (size_t i = 0; i < m_names.size(); ++i) {
+		if (m_names[i] == top) {
+			return;
+		}
+	}
+	m_names.push_back(top);
+}
+
+String
+FileSetReceiver::getLocalPath(const String& name, bool makeParents) const
+{
+	String path = m_directory;
+	String::size_type start = 0;
+	String::size_type end;
+	while ((end = name.find('/', start)) != String::npos) {
+		path = ARCH->concatPath(path, name.substr(start, end - start));
+		if (makeParents) {
+			ARCH->makeDirectory(path);
+		}
+		start = end + 1;
+	}
+	return ARCH->concatPath(path, name.substr(start));
+}
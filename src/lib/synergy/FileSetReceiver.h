@@ -0,0 +1,120 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/String.h"
+#include "common/basic_types.h"
+#include "common/stdmap.h"
+#include "common/stdvector.h"
+
+class FileSetChunk;
+
+//! File set receiver
+/*!
+Receives the kMsgDFileSetTransfer messages of one file set into a
+staging directory.  Each file is written to a temporary name, checked
+against its size and checksum and only then renamed into place, so
+the staging directory only ever holds complete files.  Once the set
+has arrived moveTo() moves its top level entries into the drop
+directory.
+*/
+class FileSetReceiver {
+public:
+	FileSetReceiver(const String& directory);
+	~FileSetReceiver();
+
+	//! @name manipulators
+	//@{
+
+	//! Handle a message
+	/*!
+	Returns kStart when a set starts, kFinish when it ends, kError for
+	a malformed message and kNotFinish otherwise.  A set start discards
+	anything received before.  A file that fails its checks is
+	discarded and counted in getFailedCount().
+	*/
+	int					handle(const FileSetChunk&);
+
+	//! Move to drop directory
+	/*!
+	Moves the received top level entries into \c directory, replacing
+	files of the same name and merging into existing directories.
+	Returns false if any entry couldn't be moved.
+	*/
+	bool				moveTo(const String& directory);
+
+	//! Create staging directory
+	/*!
+	Returns a new, empty directory for receiving a set into, or an
+	empty string if one can't be created.
+	*/
+	static String		newStagingDirectory();
+
+	//! Remove file or directory tree
+	static void			removeTree(const String& path);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Test for complete set
+	bool				isComplete() const;
+
+	//! Get number of files received
+	UInt32				getFileCount() const;
+
+	//! Get number of files rejected
+	UInt32				getFailedCount() const;
+
+	//! Get top level entries received
+	const std::vector<String>&
+						getNames() const;
+
+	//! Get staging directory
+	const String&		getDirectory() const;
+
+	//! Test entry name
+	/*!
+	Returns true iff \c name is a relative path that stays inside the
+	directory it's received into.
+	*/
+	static bool			isSafeName(const String& name);
+
+	//@}
+
+private:
+	class PartialFile;
+	typedef std::map<UInt32, PartialFile*> FileMap;
+
+	void				reset();
+	int					startEntry(const FileSetChunk&);
+	int					appendData(const FileSetChunk&);
+	int					endEntry(const FileSetChunk&);
+	void				fail(PartialFile*, const char* reason);
+	void				addName(const String& name);
+	String				getLocalPath(const String& name,
+							bool makeParents) const;
+
+private:
+	String				m_directory;
+	FileMap				m_files;
+	std::vector<String>	m_names;
+	UInt32				m_fileCount;
+	UInt32				m_failedCount;
+	bool				m_complete;
+};
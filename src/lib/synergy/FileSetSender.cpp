@@ -0,0 +1,308 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/FileSetSender.h"
+
+#include "synergy/FileSetChunk.h"
+#include "synergy/protocol_types.h"
+#include "arch/Arch.h"
+#include "mt/Lock.h"
+#include "mt/Thread.h"
+#include "base/IEventQueue.h"
+#include "base/TMethodJob.h"
+#include "base/Log.h"
+
+#include <algorithm>
+#include <fstream>
+
+// size of a data chunk.  smaller than the file packet limit so chunks
+// of different files interleave finely.
+static const size_t		s_chunkSize    = 256 * 1024;
+
+// number of files read at the same time
+static const size_t		s_maxOpenFiles = 4;
+
+// number of messages posted but not yet written
+static const UInt32		s_maxPending   = 8;
+
+// directories nested deeper than this are skipped (guards against
+// symbolic link cycles)
+static const int		s_maxDepth     = 32;
+
+static void
+addEntries(const String& path, const String& name,
+				FileSetSender::EntryList& entries, int depth)
+{
+	FileSetSender::Entry entry;
+	entry.m_path = path;
+	entry.m_name = name;
+
+	if (ARCH->isDirectory(path)) {
+		if (depth > s_maxDepth) {
+			LOG((CLOG_WARN "skipping \"%s\": too deeply nested", path.c_str()));
+			return;
+		}
+		std::vector<std::string> children;
+		if (!ARCH->getDirectoryEntries(path, children)) {
+			LOG((CLOG_WARN "cannot read directory \"%s\"", path.c_str()));
+			return;
+		}
+		entry.m_isDirectory = true;
+		entries.push_back(entry);
+
+		std::sort(children.begin(), children.end());
+		for (size_t i = 0; i < children.size(); ++i) {
+			addEntries(ARCH->concatPath(path, children[i]),
+						name + "/" + children[i], entries, depth + 1);
+		}
+	}
+	else {
+		std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+		if (!file.is_open()) {
+			LOG((CLOG_WARN "cannot read \"%s\"", path.c_str()));
+			return;
+		}
+		file.seekg(0, std::ios::end);
+		entry.m_size = static_cast<size_t>(file.tellg());
+		entries.push_back(entry);
+	}
+}
+
+//
+// FileSetSender::OpenFile
+//
+
+class FileSetSender::OpenFile {
+public:
+	OpenFile(UInt32 id, const Entry& entry) :
+		m_id(id),
+		m_entry(entry),
+		m_file(entry.m_path.c_str(), std::ios::in | std::ios::binary),
+		m_sent(0),
+		m_crc(0),
+		m_progress(0) { }
+
+public:
+	UInt32				m_id;
+	const Entry&		m_entry;
+	std::ifstream		m_file;
+	size_t				m_sent;
+	UInt32				m_crc;
+	int					m_progress;
+};
+
+//
+// FileSetSender
+//
+
+FileSetSender::FileSetSender(IEventQueue* events, void* eventTarget) :
+	m_events(events),
+	m_eventTarget(eventTarget),
+	m_thread(NULL),
+	m_pending(&m_mutex, 0),
+	m_interrupted(false),
+	m_sending(false)
+{
+	// do nothing
+}
+
+FileSetSender::~FileSetSender()
+{
+	interrupt();
+}
+
+void
+FileSetSender::start(const std::vector<String>& paths)
+{
+	interrupt();
+
+	m_paths = paths;
+	{
+		Lock lock(&m_mutex);
+		m_sending = true;
+	}
+	m_thread = new Thread(new TMethodJob<FileSetSender>(
+								this, &FileSetSender::sendThread));
+}
+
+void
+FileSetSender::interrupt()
+{
+	if (m_thread == NULL) {
+		return;
+	}
+
+	{
+		Lock lock(&m_mutex);
+		m_interrupted = true;
+		m_pending.broadcast();
+	}
+	m_thread->wait();
+	delete m_thread;
+	m_thread = NULL;
+
+	// messages already posted are still written and acknowledged so
+	// m_pending stays as it is
+	Lock lock(&m_mutex);
+	m_interrupted = false;
+}
+
+void
+FileSetSender::chunkSent()
+{
+	Lock lock(&m_mutex);
+	if (m_pending > 0) {
+		m_pending = m_pending - 1;
+		m_pending.broadcast();
+	}
+}
+
+bool
+FileSetSender::isSending() const
+{
+	Lock lock(&m_mutex);
+	return m_sending;
+}
+
+void
+FileSetSender::expand(const std::vector<String>& paths, EntryList& entries)
+{
+	entries.clear();
+	for (size_t i = 0; i < paths.size(); ++i) {
+		// drop trailing separators so the base name is the last component
+		String path = paths[i];
+		while (path.size() > 1 &&
+				(path[path.size() - 1] == '/' || path[path.size() - 1] == '\\')) {
+			path.erase(path.size() - 1);
+		}
+		String name = ARCH->getBasename(path.c_str());
+		if (name.empty()) {
+			continue;
+		}
+		addEntries(path, name, entries, 0);
+	}
+}
+
+void
+FileSetSender::sendThread(void*)
+{
+	EntryList entries;
+	expand(m_paths, entries);
+	LOG((CLOG_DEBUG "sending file set: entries=%d", entries.size()));
+
+	std::vector<OpenFile*> open;
+	std::vector<char> buffer(s_chunkSize);
+	size_t next = 0;
+	bool ok = post(FileSetChunk::set(kDataStart,
+							static_cast<UInt32>(entries.size())));
+	while (ok) {
+		// start entries until enough files are open
+		while (ok && open.size() < s_maxOpenFiles && next < entries.size()) {
+			const Entry& entry = entries[next];
+			UInt32 id = static_cast<UInt32>(++next);
+			if (entry.m_isDirectory) {
+				ok = post(FileSetChunk::start(id, entry.m_name + "/", ""));
+				continue;
+			}
+
+			OpenFile* file = new OpenFile(id, entry);
+			if (!file->m_file.is_open()) {
+				LOG((CLOG_WARN "cannot read \"%s\"", entry.m_path.c_str()));
+				delete file;
+				continue;
+			}
+			open.push_back(file);
+			ok = post(FileSetChunk::start(id, entry.m_name,
+							synergy::string::sizeTypeToString(entry.m_size)));
+		}
+		if (open.empty()) {
+			break;
+		}
+
+		// send a chunk of each open file in turn
+		for (size_t i = 0; ok && i < open.size(); ) {
+			OpenFile* file = open[i];
+			size_t size = file->m_entry.m_size;
+			size_t n = std::min(s_chunkSize, size - file->m_sent);
+			if (n > 0) {
+				file->m_file.read(&buffer[0], n);
+				n = static_cast<size_t>(file->m_file.gcount());
+			}
+			if (n > 0) {
+				file->m_crc   = FileSetChunk::checksum(file->m_crc, &buffer[0], n);
+				file->m_sent += n;
+				ok = post(FileSetChunk::data(file->m_id, String(&buffer[0], n)));
+
+				int progress = static_cast<int>(10.0 * file->m_sent / size);
+				if (progress > file->m_progress) {
+					file->m_progress = progress;
+					LOG((CLOG_DEBUG1 "sending \"%s\": %d%%",
+						file->m_entry.m_name.c_str(), 10 * progress));
+				}
+			}
+
+			// a file that shrank while being read ends early and the
+			// receiver rejects it
+			if (n == 0 || file->m_sent == size) {
+				ok = ok && post(FileSetChunk::end(file->m_id, file->m_crc));
+				delete file;
+				open.erase(open.begin() + i);
+			}
+			else {
+				++i;
+			}
+		}
+
+		m_events->addEvent(Event(m_events->forFile().keepAlive(), m_eventTarget));
+	}
+
+	if (ok) {
+		post(FileSetChunk::set(kDataEnd, static_cast<UInt32>(entries.size())));
+		LOG((CLOG_DEBUG "file set sent"));
+	}
+	else {
+		LOG((CLOG_DEBUG "file set transmission interrupted"));
+	}
+
+	for (size_t i = 0; i < open.size(); ++i) {
+		delete open[i];
+	}
+
+	Lock lock(&m_mutex);
+	m_sending = false;
+}
+
+bool
+FileSetSender::post(FileSetChunk* chunk)
+{
+	{
+		Lock lock(&m_mutex);
+		while (m_pending >= s_maxPending && !m_interrupted) {
+			m_pending.wait();
+		}
+		if (m_interrupted) {
+			delete chunk;
+			return false;
+		}
+		m_pending = m_pending + 1;
+	}
+
+	Event event(m_events->forFile().fileSetChunkSending(), m_eventTarget);
+	event.setDataObject(chunk);
+	m_events->addEvent(event);
+	return true;
+}
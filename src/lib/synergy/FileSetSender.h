@@ -0,0 +1,118 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "mt/CondVar.h"
+#include "mt/Mutex.h"
+#include "base/String.h"
+#include "common/stdvector.h"
+
+class FileSetChunk;
+class IEventQueue;
+class Thread;
+
+//! File set sender
+/*!
+Sends the files and directories of a drag as kMsgDFileSetTransfer
+messages.  Directories are walked recursively.  Several files are read
+at once and their chunks are interleaved so that small files aren't
+held up behind large ones.
+
+Each message is posted to the event target as a \c fileSetChunkSending
+event whose data object is a FileSetChunk.  The target must call
+chunkSent() once it has written the message;  only a few messages are
+outstanding at any time so a large drag doesn't pile up in the event
+queue.
+*/
+class FileSetSender {
+public:
+	//! File set entry
+	class Entry {
+	public:
+		Entry() : m_isDirectory(false), m_size(0) { }
+
+	public:
+		//! Local path
+		String			m_path;
+		//! Path relative to the drop directory, '/' separated
+		String			m_name;
+		bool			m_isDirectory;
+		size_t			m_size;
+	};
+	typedef std::vector<Entry> EntryList;
+
+	FileSetSender(IEventQueue* events, void* eventTarget);
+	~FileSetSender();
+
+	//! @name manipulators
+	//@{
+
+	//! Send files
+	/*!
+	Starts sending \c paths and everything below them on a new thread.
+	A transfer in progress is interrupted first.
+	*/
+	void				start(const std::vector<String>& paths);
+
+	//! Interrupt sending
+	/*!
+	Stops the transfer and waits for the sending thread to finish.  The
+	receiver discards the partial set.
+	*/
+	void				interrupt();
+
+	//! Note message written
+	/*!
+	Must be called once for each posted message after writing it.
+	*/
+	void				chunkSent();
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Test for transfer in progress
+	bool				isSending() const;
+
+	//! Expand paths
+	/*!
+	Replaces \c entries with \c paths and, for directories, everything
+	below them.  Parents come before their children.  Paths that can't
+	be read are skipped.
+	*/
+	static void			expand(const std::vector<String>& paths,
+							EntryList& entries);
+
+	//@}
+
+private:
+	void				sendThread(void*);
+	bool				post(FileSetChunk*);
+
+private:
+	class OpenFile;
+
+	IEventQueue*		m_events;
+	void*				m_eventTarget;
+	std::vector<String>	m_paths;
+	Thread*				m_thread;
+	Mutex				m_mutex;
+	CondVar<UInt32>		m_pending;
+	bool				m_interrupted;
+	bool				m_sending;
+};
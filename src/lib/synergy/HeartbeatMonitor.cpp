@@ -0,0 +1,315 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/HeartbeatMonitor.h"
+
+#include "arch/Arch.h"
+#include "base/IEventQueue.h"
+#include "base/IEventJob.h"
+#include "base/Event.h"
+#include "base/TMethodEventJob.h"
+
+#include <algorithm>
+
+//
+// HeartbeatMonitor::Peer
+//
+
+HeartbeatMonitor::Peer::Peer(double alarm, double keepAliveRate,
+				IEventJob* flatline, IEventJob* keepAlive) :
+	m_alarm(alarm),
+	m_keepAliveRate(keepAliveRate),
+	m_flatline(flatline),
+	m_keepAlive(keepAlive),
+	m_dead(false),
+	m_removed(false),
+	m_lastSeen(-1.0),
+	m_nextKeepAlive(-1.0)
+{
+	// deadlines are stamped on the next sweep
+}
+
+HeartbeatMonitor::Peer::~Peer()
+{
+	delete m_flatline;
+	delete m_keepAlive;
+}
+
+void
+HeartbeatMonitor::Peer::touch()
+{
+	touch(ARCH->time());
+}
+
+void
+HeartbeatMonitor::Peer::touch(double now)
+{
+	m_lastSeen = now;
+	m_dead     = false;
+}
+
+
+//
+// HeartbeatMonitor
+//
+
+const double			HeartbeatMonitor::s_minPeriod = 0.01;
+const double			HeartbeatMonitor::s_maxPeriod = 1.0;
+
+HeartbeatMonitor::MonitorMap	HeartbeatMonitor::s_monitors;
+
+HeartbeatMonitor::HeartbeatMonitor(IEventQueue* events) :
+	m_events(events),
+	m_refCount(0),
+	m_timer(NULL),
+	m_period(0.0),
+	m_sweeping(false),
+	m_changed(false)
+{
+	m_events->adoptHandler(Event::kTimer, this,
+							new TMethodEventJob<HeartbeatMonitor>(this,
+								&HeartbeatMonitor::handleTimer));
+}
+
+HeartbeatMonitor::~HeartbeatMonitor()
+{
+	s_monitors.erase(m_events);
+
+	m_events->removeHandler(Event::kTimer, this);
+	if (m_timer != NULL) {
+		m_events->deleteTimer(m_timer);
+	}
+
+	for (PeerList::iterator i = m_peers.begin(); i != m_peers.end(); ++i) {
+		delete *i;
+	}
+}
+
+HeartbeatMonitor*
+HeartbeatMonitor::acquire(IEventQueue* events)
+{
+	HeartbeatMonitor* monitor;
+	MonitorMap::iterator i = s_monitors.find(events);
+	if (i != s_monitors.end()) {
+		monitor = i->second;
+	}
+	else {
+		monitor = new HeartbeatMonitor(events);
+		s_monitors.insert(std::make_pair(events, monitor));
+	}
+	++monitor->m_refCount;
+	return monitor;
+}
+
+void
+HeartbeatMonitor::release()
+{
+	assert(m_refCount > 0);
+
+	// if we're sweeping then sweep() will finish the job
+	if (--m_refCount == 0 && !m_sweeping) {
+		delete this;
+	}
+}
+
+HeartbeatMonitor::Peer*
+HeartbeatMonitor::add(double alarm, double keepAliveRate,
+				IEventJob* flatline, IEventJob* keepAlive)
+{
+	Peer* peer = new Peer(alarm, keepAliveRate, flatline, keepAlive);
+	m_peers.push_back(peer);
+	updateTimer();
+	return peer;
+}
+
+void
+HeartbeatMonitor::remove(Peer* peer)
+{
+	assert(peer != NULL);
+	assert(!peer->m_removed);
+
+	if (m_sweeping) {
+		// the sweep may still hold it
+		peer->m_removed = true;
+		m_removed.push_back(peer);
+		m_changed = true;
+	}
+	else {
+		erase(peer);
+		updateTimer();
+	}
+}
+
+void
+HeartbeatMonitor::setRates(Peer* peer, double alarm, double keepAliveRate)
+{
+	assert(peer != NULL);
+
+	peer->m_alarm         = alarm;
+	peer->m_keepAliveRate = keepAliveRate;
+	peer->m_dead          = false;
+	peer->m_lastSeen      = -1.0;
+	peer->m_nextKeepAlive = -1.0;
+	updateTimer();
+}
+
+void
+HeartbeatMonitor::sweep(double now)
+{
+	m_sweeping = true;
+
+	// find expired deadlines.  jobs aren't run until we're done
+	// because they may add or remove peers.
+	for (size_t i = 0; i < m_peers.size(); ++i) {
+		Peer* peer = m_peers[i];
+		if (peer->m_removed) {
+			continue;
+		}
+
+		if (peer->m_lastSeen < 0.0) {
+			peer->m_lastSeen = now;
+		}
+
+		if (peer->m_keepAliveRate > 0.0 && peer->m_keepAlive != NULL) {
+			if (peer->m_nextKeepAlive < 0.0) {
+				peer->m_nextKeepAlive = now + peer->m_keepAliveRate;
+			}
+			else if (now >= peer->m_nextKeepAlive) {
+				m_dueKeepAlive.push_back(peer);
+
+				// don't try to catch up if we fell behind
+				peer->m_nextKeepAlive += peer->m_keepAliveRate;
+				if (peer->m_nextKeepAlive <= now) {
+					peer->m_nextKeepAlive = now + peer->m_keepAliveRate;
+				}
+			}
+		}
+
+		if (peer->m_alarm > 0.0 && peer->m_flatline != NULL &&
+			!peer->m_dead && now - peer->m_lastSeen >= peer->m_alarm) {
+			// only report a death once until we hear from it again
+			peer->m_dead = true;
+			m_dueFlatline.push_back(peer);
+		}
+	}
+
+	// send keep alives before declaring anyone dead
+	for (size_t i = 0; i < m_dueKeepAlive.size(); ++i) {
+		Peer* peer = m_dueKeepAlive[i];
+		if (!peer->m_removed) {
+			peer->m_keepAlive->run(Event());
+		}
+	}
+	for (size_t i = 0; i < m_dueFlatline.size(); ++i) {
+		Peer* peer = m_dueFlatline[i];
+		if (!peer->m_removed) {
+			peer->m_flatline->run(Event());
+		}
+	}
+	m_dueKeepAlive.clear();
+	m_dueFlatline.clear();
+
+	m_sweeping = false;
+
+	// now it's safe to delete what the jobs removed
+	for (PeerList::iterator i = m_removed.begin(); i != m_removed.end(); ++i) {
+		erase(*i);
+	}
+	m_removed.clear();
+
+	if (m_refCount == 0) {
+		delete this;
+		return;
+	}
+
+	if (m_changed) {
+		m_changed = false;
+		updateTimer();
+	}
+}
+
+UInt32
+HeartbeatMonitor::getPeerCount() const
+{
+	return static_cast<UInt32>(m_peers.size() - m_removed.size());
+}
+
+double
+HeartbeatMonitor::getPeriod() const
+{
+	return m_period;
+}
+
+void
+HeartbeatMonitor::erase(Peer* peer)
+{
+	PeerList::iterator i = std::find(m_peers.begin(), m_peers.end(), peer);
+	assert(i != m_peers.end());
+
+	// order doesn't matter so avoid shifting the tail
+	*i = m_peers.back();
+	m_peers.pop_back();
+	delete peer;
+}
+
+void
+HeartbeatMonitor::updateTimer()
+{
+	// don't touch the timer while it may be dispatching to us
+	if (m_sweeping) {
+		m_changed = true;
+		return;
+	}
+
+	// sweep often enough to catch the shortest deadline
+	double shortest = 0.0;
+	for (PeerList::const_iterator i = m_peers.begin(); i != m_peers.end(); ++i) {
+		const Peer* peer = *i;
+		if (peer->m_alarm > 0.0 &&
+			(shortest == 0.0 || peer->m_alarm < shortest)) {
+			shortest = peer->m_alarm;
+		}
+		if (peer->m_keepAliveRate > 0.0 &&
+			(shortest == 0.0 || peer->m_keepAliveRate < shortest)) {
+			shortest = peer->m_keepAliveRate;
+		}
+	}
+
+	double period = 0.0;
+	if (shortest > 0.0) {
+		period = std::max(s_minPeriod, std::min(s_maxPeriod, 0.25 * shortest));
+	}
+
+	// only recreate the timer if the period changed
+	if (period == m_period) {
+		return;
+	}
+	if (m_timer != NULL) {
+		m_events->deleteTimer(m_timer);
+		m_timer = NULL;
+	}
+	m_period = period;
+	if (m_period > 0.0) {
+		m_timer = m_events->newTimer(m_period, this);
+	}
+}
+
+void
+HeartbeatMonitor::handleTimer(const Event&, void*)
+{
+	sweep(ARCH->time());
+}
@@ -0,0 +1,161 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/basic_types.h"
+#include "common/stdmap.h"
+#include "common/stdvector.h"
+
+class Event;
+class EventQueueTimer;
+class IEventJob;
+class IEventQueue;
+
+//! Shared liveness sweeper
+/*!
+Tracks when every connection on an event queue last heard from its peer
+and when it's due to send a keep alive.  A single periodic timer sweeps
+all of them, so noting that a message arrived is just a clock read and
+a store rather than deleting and re-creating a timer.
+
+Deadlines are measured from when the peer was last touched but are only
+checked on each sweep, so a peer is declared dead at most one sweep
+period late and never early.  The period is a quarter of
+the shortest rate being watched.
+
+All methods must be called on the event queue's thread.
+*/
+class HeartbeatMonitor {
+public:
+	//! A watched connection
+	class Peer {
+	public:
+		//! Note that a message arrived from the peer
+		void			touch();
+
+		//! Note that a message arrived from the peer at time \p now
+		void			touch(double now);
+
+	private:
+		friend class HeartbeatMonitor;
+
+		Peer(double alarm, double keepAliveRate,
+							IEventJob* flatline, IEventJob* keepAlive);
+		~Peer();
+
+		double			m_alarm;
+		double			m_keepAliveRate;
+		IEventJob*		m_flatline;
+		IEventJob*		m_keepAlive;
+		bool			m_dead;
+		bool			m_removed;
+		double			m_lastSeen;
+		double			m_nextKeepAlive;
+	};
+
+	//! @name manipulators
+	//@{
+
+	//! Get the monitor for an event queue
+	/*!
+	Returns the monitor shared by all connections on \p events, creating
+	it if necessary.  Each call must be balanced by a call to release().
+	*/
+	static HeartbeatMonitor*
+						acquire(IEventQueue* events);
+
+	//! Release the monitor
+	/*!
+	Destroys the monitor when the last reference is released.
+	*/
+	void				release();
+
+	//! Watch a connection
+	/*!
+	Runs \p flatline once if nothing is heard for \p alarm seconds and
+	runs \p keepAlive every \p keepAliveRate seconds.  Either rate may
+	be non-positive to disable it.  Adopts both jobs, which may be NULL.
+	The returned peer is valid until passed to remove().
+	*/
+	Peer*				add(double alarm, double keepAliveRate,
+							IEventJob* flatline, IEventJob* keepAlive);
+
+	//! Stop watching a connection
+	/*!
+	Safe to call from within a job run by the sweep.
+	*/
+	void				remove(Peer*);
+
+	//! Change a connection's rates
+	/*!
+	Also restarts both the alarm and the keep alive interval.
+	*/
+	void				setRates(Peer*, double alarm, double keepAliveRate);
+
+	//! Check every connection
+	/*!
+	Runs the jobs of every connection whose deadline has passed at time
+	\p now.  This is normally called by the monitor's own timer.
+	*/
+	void				sweep(double now);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get the number of watched connections
+	UInt32				getPeerCount() const;
+
+	//! Get the sweep period
+	/*!
+	Returns the current sweep period in seconds, or 0 if there's
+	nothing to watch and no timer is running.
+	*/
+	double				getPeriod() const;
+
+	//@}
+
+	// shortest and longest sweep period
+	static const double	s_minPeriod;
+	static const double	s_maxPeriod;
+
+private:
+	HeartbeatMonitor(IEventQueue* events);
+	~HeartbeatMonitor();
+
+	void				erase(Peer*);
+	void				updateTimer();
+	void				handleTimer(const Event&, void*);
+
+private:
+	typedef std::vector<Peer*> PeerList;
+	typedef std::map<IEventQueue*, HeartbeatMonitor*> MonitorMap;
+
+	IEventQueue*		m_events;
+	int					m_refCount;
+	PeerList			m_peers;
+	EventQueueTimer*	m_timer;
+	double				m_period;
+	bool				m_sweeping;
+	bool				m_changed;
+	PeerList			m_removed;
+	PeerList			m_dueKeepAlive;
+	PeerList			m_dueFlatline;
+
+	static MonitorMap	s_monitors;
+};
@@ -17,7 +17,6 @@
  */
 
 #include "synergy/IClipboard.h"
-#include "common/stdvector.h"
 
 //
 // IClipboard
@@ -77,36 +76,27 @@ IClipboard::marshall(const IClipboard* clipboard)
 
 	String data;
 
-	std::vector<String> formatData;
-	formatData.resize(IClipboard::kNumFormats);
 	// FIXME -- use current time
 	if (clipboard->open(0)) {
-
-		// compute size of marshalled data
-		UInt32 size = 4;
+		// get each format once, straight into the buffer.  the number
+		// of formats is filled in at the end.
+		writeUInt32(&data, 0);
 		UInt32 numFormats = 0;
 		for (UInt32 format = 0; format != IClipboard::kNumFormats; ++format) {
 			if (clipboard->has(static_cast<IClipboard::EFormat>(format))) {
 				++numFormats;
-				formatData[format] =
+				String formatData =
 					clipboard->get(static_cast<IClipboard::EFormat>(format));
-				size += 4 + 4 + (UInt32)formatData[format].size();
-			}
-		}
-
-		// allocate space
-		data.reserve(size);
-
-		// marshall the data
-		writeUInt32(&data, numFormats);
-		for (UInt32 format = 0; format != IClipboard::kNumFormats; ++format) {
-			if (clipboard->has(static_cast<IClipboard::EFormat>(format))) {
 				writeUInt32(&data, format);
-				writeUInt32(&data, (UInt32)formatData[format].size());
-				data += formatData[format];
+				writeUInt32(&data, (UInt32)formatData.size());
+				data += formatData;
 			}
 		}
 		clipboard->close();
+
+		String count;
+		writeUInt32(&count, numFormats);
+		data.replace(0, 4, count);
 	}
 
 	return data;
@@ -0,0 +1,265 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/InputCapture.h"
+
+#include "mt/Thread.h"
+#include "arch/Arch.h"
+#include "base/Event.h"
+#include "base/EventTypes.h"
+#include "base/IEventQueue.h"
+#include "base/Log.h"
+#include "base/TMethodJob.h"
+
+#if defined(_MSC_VER)
+#	include <intrin.h>
+#endif
+
+// the ring is shared by exactly two threads.  input arrives at a few
+// hundred events a second at most so every access is sequentially
+// consistent rather than being clever about ordering.
+static
+UInt32
+atomicLoad(const UInt32* p)
+{
+#if defined(_MSC_VER)
+	_ReadWriteBarrier();
+	UInt32 v = *static_cast<const volatile UInt32*>(p);
+	_ReadWriteBarrier();
+	return v;
+#else
+	return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static
+void
+atomicStore(UInt32* p, UInt32 v)
+{
+#if defined(_MSC_VER)
+	_InterlockedExchange(reinterpret_cast<volatile long*>(p), v);
+#else
+	__atomic_store_n(p, v, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static
+UInt32
+atomicExchange(UInt32* p, UInt32 v)
+{
+#if defined(_MSC_VER)
+	return _InterlockedExchange(reinterpret_cast<volatile long*>(p), v);
+#else
+	return __atomic_exchange_n(p, v, __ATOMIC_SEQ_CST);
+#endif
+}
+
+// how long capture() waits before checking for cancellation
+static const double		s_captureTimeout = 0.1;
+
+// how long capture() waits while records are held back for the ring
+static const double		s_heldTimeout = 0.01;
+
+// priority of the capture thread relative to normal
+static const int		s_capturePriority = -2;
+
+//
+// InputCapture
+//
+
+InputCapture::InputCapture(
+		IEventQueue* events, void* eventTarget, UInt32 capacity) :
+	m_events(events),
+	m_eventTarget(eventTarget),
+	m_thread(NULL),
+	m_mask(0),
+	m_head(0),
+	m_generation(0),
+	m_tail(0),
+	m_dropped(0),
+	m_idle(1)
+{
+	// round the capacity up to a power of two
+	UInt32 size = 1;
+	while (size < capacity) {
+		size <<= 1;
+	}
+	m_records.resize(size);
+	m_mask = size - 1;
+}
+
+InputCapture::~InputCapture()
+{
+	assert(m_thread == NULL);
+}
+
+void
+InputCapture::start()
+{
+	assert(m_thread == NULL);
+
+	m_thread = new Thread(new TMethodJob<InputCapture>(
+								this, &InputCapture::captureThread));
+	m_thread->setPriority(s_capturePriority);
+}
+
+void
+InputCapture::stop()
+{
+	if (m_thread != NULL) {
+		m_thread->cancel();
+		m_thread->wait();
+		delete m_thread;
+		m_thread = NULL;
+	}
+}
+
+bool
+InputCapture::take(InputRecord& record)
+{
+	return next(record, true);
+}
+
+bool
+InputCapture::peek(InputRecord& record)
+{
+	return next(record, false);
+}
+
+void
+InputCapture::invalidate()
+{
+	atomicStore(&m_generation, m_generation + 1);
+}
+
+bool
+InputCapture::isRunning() const
+{
+	return (m_thread != NULL);
+}
+
+UInt32
+InputCapture::getDropped() const
+{
+	return atomicLoad(&m_dropped);
+}
+
+UInt32
+InputCapture::getGeneration() const
+{
+	return atomicLoad(&m_generation);
+}
+
+void
+InputCapture::post(InputRecord& record)
+{
+	record.m_captured = ARCH->time();
+
+	// stay behind anything already held back
+	flush();
+	if (!m_held.empty() || !push(record)) {
+		hold(record);
+	}
+}
+
+void
+InputCapture::captureThread(void*)
+{
+	LOG((CLOG_DEBUG "input capture thread started"));
+	for (;;) {
+		Thread::testCancel();
+
+		// come back soon to hand over held records even if no more
+		// input arrives
+		flush();
+		capture(m_held.empty() ? s_captureTimeout : s_heldTimeout);
+	}
+}
+
+bool
+InputCapture::push(const InputRecord& record)
+{
+	UInt32 tail = m_tail;
+	if (tail - atomicLoad(&m_head) > m_mask) {
+		return false;
+	}
+	m_records[tail & m_mask] = record;
+	atomicStore(&m_tail, tail + 1);
+
+	// wake the main thread if it went idle
+	if (atomicExchange(&m_idle, 0) != 0) {
+		m_events->addEvent(Event(
+			m_events->forIPrimaryScreen().inputCaptured(), m_eventTarget));
+	}
+	return true;
+}
+
+void
+InputCapture::hold(const InputRecord& record)
+{
+	// the main thread has fallen behind.  a later position supersedes
+	// an earlier one but a lost button release would leave the button
+	// stuck down.
+	if (record.m_type == InputRecord::kMotion &&
+		!m_held.empty() && m_held.back().m_type == InputRecord::kMotion) {
+		m_held.back() = record;
+		if (atomicExchange(&m_dropped, m_dropped + 1) == 0) {
+			LOG((CLOG_WARN "input capture queue is full, merging motion"));
+		}
+	}
+	else {
+		m_held.push_back(record);
+	}
+}
+
+void
+InputCapture::flush()
+{
+	RecordList::iterator i = m_held.begin();
+	while (i != m_held.end() && push(*i)) {
+		++i;
+	}
+	m_held.erase(m_held.begin(), i);
+}
+
+bool
+InputCapture::next(InputRecord& record, bool remove)
+{
+	for (;;) {
+		if (m_head == atomicLoad(&m_tail)) {
+			// going idle so the capture thread wakes us with its next
+			// record.  check again in case it posted one before it
+			// could see we were idle.
+			atomicStore(&m_idle, 1);
+			if (m_head == atomicLoad(&m_tail)) {
+				return false;
+			}
+		}
+
+		record = m_records[m_head & m_mask];
+		if (record.m_type == InputRecord::kMotion &&
+			record.m_generation != m_generation) {
+			// captured before the last invalidate()
+			atomicStore(&m_head, m_head + 1);
+			continue;
+		}
+		if (remove) {
+			atomicStore(&m_head, m_head + 1);
+		}
+		return true;
+	}
+}
@@ -0,0 +1,169 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/basic_types.h"
+#include "common/stdvector.h"
+
+class IEventQueue;
+class Thread;
+
+//! Captured input event
+/*!
+A compact record of one input event read by an InputCapture.  Apart
+from the type and the capture time the meaning of each field is up to
+the platform.
+*/
+class InputRecord {
+public:
+	enum EType {
+		kMotion,
+		kButtonDown,
+		kButtonUp
+	};
+
+	EType				m_type;
+	SInt32				m_x;
+	SInt32				m_y;
+	UInt32				m_button;
+	UInt32				m_state;
+	UInt32				m_time;
+	UInt32				m_generation;
+	double				m_captured;
+};
+
+//! Input capture thread
+/*!
+Reads input on a dedicated thread of raised priority so slow handlers
+on the main thread can't delay it.  Subclasses implement capture() to
+read platform input and pass each event to post().  Records reach the
+main thread through a lock-free single producer, single consumer ring
+and an \c IPrimaryScreen::inputCaptured event is sent to the event
+target whenever records arrive after the main thread has drained them
+all, so a burst of input costs one event rather than one per record.
+
+Records that don't fit in the ring are held back on the capture thread
+until there's room.  Consecutive motion held back is merged so only the
+latest position is kept but every button transition gets through.
+*/
+class InputCapture {
+public:
+	InputCapture(IEventQueue* events, void* eventTarget, UInt32 capacity);
+	virtual ~InputCapture();
+
+	//! @name manipulators
+	//@{
+
+	//! Start the capture thread
+	void				start();
+
+	//! Stop the capture thread
+	/*!
+	Waits for the thread to exit.  Subclasses must call this from their
+	destructor because the thread calls capture().
+	*/
+	void				stop();
+
+	//! Take the oldest record
+	/*!
+	Removes the oldest record and returns true, or returns false if
+	there are none.  Motion from before the last invalidate() is
+	discarded.  Main thread only.
+	*/
+	bool				take(InputRecord&);
+
+	//! Get the oldest record
+	/*!
+	Like take() but leaves the record in place.
+	*/
+	bool				peek(InputRecord&);
+
+	//! Discard captured positions
+	/*!
+	Call after warping the cursor, once the warp has taken effect.
+	Every motion record stamped with an earlier generation is discarded
+	so a position read before the warp isn't mistaken for motion.
+	Button records are always kept.
+	*/
+	void				invalidate();
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Test if the capture thread is running
+	bool				isRunning() const;
+
+	//! Get the number of motion records merged because the ring was full
+	UInt32				getDropped() const;
+
+	//@}
+
+protected:
+	//! Capture input
+	/*!
+	Called repeatedly on the capture thread.  Should wait up to
+	\p timeout seconds for input and post() each event that arrives.
+	*/
+	virtual void		capture(double timeout) = 0;
+
+	//! Get the current generation
+	/*!
+	Capture thread only.  Read it before sampling the cursor position
+	and store it in the record.
+	*/
+	UInt32				getGeneration() const;
+
+	//! Queue a record
+	/*!
+	Capture thread only.  Stamps the capture time and wakes the main
+	thread if it's idle.
+	*/
+	void				post(InputRecord&);
+
+private:
+	void				captureThread(void*);
+	bool				next(InputRecord&, bool remove);
+	bool				push(const InputRecord&);
+	void				hold(const InputRecord&);
+	void				flush();
+
+private:
+	typedef std::vector<InputRecord> RecordList;
+
+	IEventQueue*		m_events;
+	void*				m_eventTarget;
+	Thread*				m_thread;
+	RecordList			m_records;
+	UInt32				m_mask;
+
+	// written by the main thread
+	UInt32				m_head;
+	UInt32				m_generation;
+
+	// written by the capture thread
+	UInt32				m_tail;
+	UInt32				m_dropped;
+
+	// capture thread only.  records waiting for room in the ring.
+	RecordList			m_held;
+
+	// set by the main thread when it finds the ring empty and cleared
+	// by the capture thread when it wakes it
+	UInt32				m_idle;
+};
@@ -17,24 +17,50 @@
  */
 
 #include "synergy/PacketStreamFilter.h"
+#include "synergy/protocol_types.h"
 #include "base/IEventQueue.h"
-#include "mt/Lock.h"
+#include "base/Log.h"
 #include "base/TMethodEventJob.h"
 
 #include <cstring>
 #include <memory>
 
+// how much to read from the stream at a time
+static const UInt32		kReadSize = 4096;
+
+// give back memory used by long packets once the buffer drains
+static const UInt32		kMaxIdleBuffer = 64 * 1024;
+
+static
+UInt32
+packCode(const void* code)
+{
+	const UInt8* c = static_cast<const UInt8*>(code);
+	return ((UInt32)c[0] << 24) |
+		   ((UInt32)c[1] << 16) |
+		   ((UInt32)c[2] <<  8) |
+			(UInt32)c[3];
+}
+
 //
 // PacketStreamFilter
 //
 
 PacketStreamFilter::PacketStreamFilter(IEventQueue* events, synergy::IStream* stream, bool adoptStream) :
 	StreamFilter(events, stream, adoptStream),
+	m_state(kReadingLength),
 	m_size(0),
+	m_head(0),
+	m_tail(0),
+	m_defaultLimit(kMaxPacketLength),
+	m_largestLimit(kMaxPacketLength),
 	m_inputShutdown(false),
 	m_events(events)
 {
-	// do nothing
+	setMaxPacketLength(kMsgDClipboard, kMaxClipboardPacketLength);
+	setMaxPacketLength(kMsgDFileTransfer, kMaxFilePacketLength);
+	setMaxPacketLength(kMsgDDragInfo, kMaxFilePacketLength);
+	setMaxPacketLength(kMsgDFileSetTransfer, kMaxFilePacketLength);
 }
 
 PacketStreamFilter::~PacketStreamFilter()
@@ -42,12 +68,38 @@ PacketStreamFilter::~PacketStreamFilter()
 	// do nothing
 }
 
+void
+PacketStreamFilter::setMaxPacketLength(const char* code, UInt32 maxLength)
+{
+	if (code == NULL) {
+		m_defaultLimit = maxLength;
+	}
+	else {
+		m_limits[packCode(code)] = maxLength;
+	}
+
+	m_largestLimit = m_defaultLimit;
+	for (LimitMap::const_iterator i = m_limits.begin();
+							i != m_limits.end(); ++i) {
+		if (i->second > m_largestLimit) {
+			m_largestLimit = i->second;
+		}
+	}
+}
+
+UInt32
+PacketStreamFilter::getMaxPacketLength(const char* code) const
+{
+	if (code == NULL) {
+		return m_defaultLimit;
+	}
+	return getLimit(reinterpret_cast<const UInt8*>(code), 4);
+}
+
 void
 PacketStreamFilter::close()
 {
-	Lock lock(&m_mutex);
-	m_size = 0;
-	m_buffer.pop(m_buffer.getSize());
+	reset();
 	StreamFilter::close();
 }
 
@@ -58,10 +110,8 @@ PacketStreamFilter::read(void* buffer, UInt32 n)
 		return 0;
 	}
 
-	Lock lock(&m_mutex);
-
 	// if not enough data yet then give up
-	if (!isReadyNoLock()) {
+	if (!isReady()) {
 		return 0;
 	}
 
@@ -70,16 +120,19 @@ PacketStreamFilter::read(void* buffer, UInt32 n)
 		n = m_size;
 	}
 
-	// read it
+	// read it straight out of the receive buffer
 	if (buffer != NULL) {
-		memcpy(buffer, m_buffer.peek(n), n);
+		memcpy(buffer, &m_buffer[m_head], n);
 	}
-	m_buffer.pop(n);
+	m_head += n;
 	m_size -= n;
 
-	// get next packet's size if we've finished with this packet and
-	// there's enough data to do so.
-	readPacketSize();
+	// start on the next packet if we've finished with this one.  it
+	// may already be buffered.
+	if (m_size == 0) {
+		m_state = kReadingLength;
+		parse();
+	}
 
 	if (m_inputShutdown && m_size == 0) {
 		m_events->addEvent(Event(m_events->forIStream().inputShutdown(),
@@ -107,45 +160,117 @@ PacketStreamFilter::write(const void* buffer, UInt32 count)
 void
 PacketStreamFilter::shutdownInput()
 {
-	Lock lock(&m_mutex);
-	m_size = 0;
-	m_buffer.pop(m_buffer.getSize());
+	reset();
 	StreamFilter::shutdownInput();
 }
 
+const UInt8*
+PacketStreamFilter::lendFrame(UInt32& size)
+{
+	if (!isReady()) {
+		size = 0;
+		return NULL;
+	}
+
+	// the packet is contiguous in the receive buffer
+	size = m_size;
+	return &m_buffer[m_head];
+}
+
+void
+PacketStreamFilter::releaseFrame(UInt32 n)
+{
+	read(NULL, n);
+}
+
 bool
 PacketStreamFilter::isReady() const
 {
-	Lock lock(&m_mutex);
-	return isReadyNoLock();
+	return (m_state == kReadingPacket && getBuffered() >= m_size);
 }
 
 UInt32
 PacketStreamFilter::getSize() const
 {
-	Lock lock(&m_mutex);
-	return isReadyNoLock() ? m_size : 0;
+	return isReady() ? m_size : 0;
 }
 
-bool
-PacketStreamFilter::isReadyNoLock() const
+void
+PacketStreamFilter::reset()
+{
+	if (m_state != kRejected) {
+		m_state = kReadingLength;
+	}
+	m_size = 0;
+	m_head = 0;
+	m_tail = 0;
+	if (m_buffer.size() > kMaxIdleBuffer) {
+		std::vector<UInt8>().swap(m_buffer);
+	}
+}
+
+UInt32
+PacketStreamFilter::getBuffered() const
 {
-	return (m_size != 0 && m_buffer.getSize() >= m_size);
+	return m_tail - m_head;
+}
+
+UInt32
+PacketStreamFilter::getLimit(const UInt8* code, UInt32 n) const
+{
+	if (n < 4) {
+		return m_defaultLimit;
+	}
+	LimitMap::const_iterator i = m_limits.find(packCode(code));
+	if (i == m_limits.end()) {
+		return m_defaultLimit;
+	}
+	return i->second;
 }
 
 void
-PacketStreamFilter::readPacketSize()
+PacketStreamFilter::parse()
 {
-	// note -- m_mutex must be locked on entry
+	// advance as far as the buffered data allows
+	for (;;) {
+		switch (m_state) {
+		case kReadingLength:
+			if (getBuffered() < 4) {
+				return;
+			}
+			m_size  = packCode(&m_buffer[m_head]);
+			m_head += 4;
+			if (m_size == 0) {
+				// nothing to read in an empty packet
+				break;
+			}
 
-	if (m_size == 0 && m_buffer.getSize() >= 4) {
-		UInt8 buffer[4];
-		memcpy(buffer, m_buffer.peek(sizeof(buffer)), sizeof(buffer));
-		m_buffer.pop(sizeof(buffer));
-		m_size = ((UInt32)buffer[0] << 24) |
-				 ((UInt32)buffer[1] << 16) |
-				 ((UInt32)buffer[2] <<  8) |
-				  (UInt32)buffer[3];
+			// don't wait for the code if no message may be this long
+			if (m_size > m_largestLimit) {
+				reject();
+				return;
+			}
+			m_state = kReadingCode;
+			break;
+
+		case kReadingCode: {
+			// the limit depends on the message code
+			UInt32 n = (m_size < 4) ? m_size : 4;
+			if (getBuffered() < n) {
+				return;
+			}
+			if (m_size > getLimit(&m_buffer[m_head], n)) {
+				reject();
+				return;
+			}
+			m_state = kReadingPacket;
+			return;
+		}
+
+		case kReadingPacket:
+		case kRejected:
+			return;
+		}
 	}
 }
 
@@ -153,42 +278,76 @@ bool
 PacketStreamFilter::readMore()
 {
 	// note if we have whole packet
-	bool wasReady = isReadyNoLock();
+	bool wasReady = isReady();
 
-	// read more data
-	char buffer[4096];
-	UInt32 n = getStream()->read(buffer, sizeof(buffer));
-	while (n > 0) {
-		m_buffer.write(buffer, n);
-		n = getStream()->read(buffer, sizeof(buffer));
-	}
+	// read more data directly into the receive buffer, parsing as we go
+	// so a bad length is caught before we buffer the packet
+	for (;;) {
+		if (m_state == kRejected) {
+			// drain and discard anything else the peer sends
+			m_head = m_tail = 0;
+		}
+		else if (m_head == m_tail) {
+			m_head = m_tail = 0;
+			if (m_buffer.size() > kMaxIdleBuffer) {
+				std::vector<UInt8>().swap(m_buffer);
+			}
+		}
+		if (m_buffer.size() - m_tail < kReadSize) {
+			// slide what's left to the front before growing
+			if (m_head > 0) {
+				memmove(&m_buffer[0], &m_buffer[m_head], getBuffered());
+				m_tail -= m_head;
+				m_head  = 0;
+			}
+			if (m_buffer.size() - m_tail < kReadSize) {
+				m_buffer.resize(m_tail + kReadSize);
+			}
+		}
 
-	// if we don't yet have the next packet size then get it,
-	// if possible.
-	readPacketSize();
+		UInt32 n = getStream()->read(&m_buffer[m_tail], kReadSize);
+		if (n == 0) {
+			break;
+		}
+		m_tail += n;
+		parse();
+	}
 
 	// note if we now have a whole packet
-	bool isReady = isReadyNoLock();
+	bool isReady = this->isReady();
 
 	// if we weren't ready before but now we are then send a
 	// input ready event apparently from the filtered stream.
 	return (wasReady != isReady);
 }
 
+void
+PacketStreamFilter::reject()
+{
+	LOG((CLOG_WARN "peer sent a packet of %u bytes, disconnecting", m_size));
+
+	// stop buffering and tell our owner the input is gone
+	m_state = kRejected;
+	reset();
+	m_inputShutdown = true;
+	m_events->addEvent(Event(m_events->forIStream().inputShutdown(),
+						getEventTarget(), NULL));
+}
+
 void
 PacketStreamFilter::filterEvent(const Event& event)
 {
 	if (event.getType() == m_events->forIStream().inputReady()) {
-		Lock lock(&m_mutex);
 		if (!readMore()) {
 			return;
 		}
 	}
 	else if (event.getType() == m_events->forIStream().inputShutdown()) {
-		// discard this if we have buffered data
-		Lock lock(&m_mutex);
+		// discard this if we have a buffered packet (read() will send
+		// it once the packet is consumed) or if we already sent it
+		bool wasShutdown = m_inputShutdown;
 		m_inputShutdown = true;
-		if (m_size != 0) {
+		if (isReady() || wasShutdown) {
 			return;
 		}
 	}
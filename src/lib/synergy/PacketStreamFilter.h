@@ -19,25 +19,60 @@
 #pragma once
 
 #include "io/StreamFilter.h"
-#include "io/StreamBuffer.h"
-#include "mt/Mutex.h"
+#include "common/stdmap.h"
+#include "common/stdvector.h"
 
 class IEventQueue;
 
 //! Packetizing stream filter 
 /*!
-Filters a stream to read and write packets.
+Filters a stream to read and write packets.  Each packet is preceded by
+its 4 byte big-endian length.  Incoming packets are parsed in place in
+the receive buffer as data arrives and a peer that announces a packet
+longer than the limit for its message is disconnected before the packet
+is buffered.
+
+A complete packet can be decoded in place with lendFrame().
+
+Reading, and the events that drive it, must all happen on the thread
+dispatching the stream's events so no locking is done.
 */
 class PacketStreamFilter : public StreamFilter {
 public:
 	PacketStreamFilter(IEventQueue* events, synergy::IStream* stream, bool adoptStream = true);
 	~PacketStreamFilter();
 
+	//! @name manipulators
+	//@{
+
+	//! Set the maximum packet length
+	/*!
+	Sets the maximum length of packets starting with the 4 byte message
+	\p code, or of packets for which no limit is set if \p code is NULL.
+	*/
+	void				setMaxPacketLength(const char* code, UInt32 maxLength);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get the maximum packet length
+	/*!
+	Returns the maximum length of packets starting with the 4 byte
+	message \p code, or of packets for which no limit is set if \p code
+	is NULL.
+	*/
+	UInt32				getMaxPacketLength(const char* code) const;
+
+	//@}
+
 	// IStream overrides
 	virtual void		close();
 	virtual UInt32		read(void* buffer, UInt32 n);
 	virtual void		write(const void* buffer, UInt32 n);
 	virtual void		shutdownInput();
+	virtual const UInt8*	lendFrame(UInt32& size);
+	virtual void		releaseFrame(UInt32 n);
 	virtual bool		isReady() const;
 	virtual UInt32		getSize() const;
 
@@ -46,14 +81,31 @@ protected:
 	virtual void		filterEvent(const Event&);
 
 private:
-	bool				isReadyNoLock() const;
-	void				readPacketSize();
+	enum EState {
+		kReadingLength,		// waiting for the packet length
+		kReadingCode,		// waiting for the message code
+		kReadingPacket,		// waiting for the rest of the packet
+		kRejected			// peer sent a packet that's too long
+	};
+
+	void				reset();
+	UInt32				getBuffered() const;
+	UInt32				getLimit(const UInt8* code, UInt32 n) const;
+	void				parse();
 	bool				readMore();
+	void				reject();
 
 private:
-	Mutex				m_mutex;
+	typedef std::map<UInt32, UInt32> LimitMap;
+
+	EState				m_state;
 	UInt32				m_size;
-	StreamBuffer		m_buffer;
+	std::vector<UInt8>	m_buffer;
+	UInt32				m_head;
+	UInt32				m_tail;
+	UInt32				m_defaultLimit;
+	UInt32				m_largestLimit;
+	LimitMap			m_limits;
 	bool				m_inputShutdown;
 	IEventQueue*		m_events;
 };
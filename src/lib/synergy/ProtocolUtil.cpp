@@ -24,6 +24,105 @@
 #include <cctype>
 #include <cstring>
 
+//
+// ProtocolUtil::StreamReader
+//
+
+// reads each field from the stream
+class ProtocolUtil::StreamReader {
+public:
+	enum { kLogFields = true };
+
+	StreamReader(synergy::IStream* stream) : m_stream(stream) { }
+
+	void				read(void* buffer, UInt32 n)
+	{
+		ProtocolUtil::read(m_stream, buffer, n);
+	}
+
+	void				readString(String& dst, UInt32 len)
+	{
+		// use a fixed size buffer if its big enough
+		UInt8 buffer[128];
+		const bool useFixed = (len <= sizeof(buffer));
+
+		// allocate a buffer to read the data
+		UInt8* sBuffer = buffer;
+		if (!useFixed) {
+			sBuffer = new UInt8[len];
+		}
+
+		// read the data
+		try {
+			read(sBuffer, len);
+		}
+		catch (...) {
+			if (!useFixed) {
+				delete[] sBuffer;
+			}
+			throw;
+		}
+
+		// save the data
+		dst.assign((const char*)sBuffer, len);
+
+		// release the buffer
+		if (!useFixed) {
+			delete[] sBuffer;
+		}
+	}
+
+private:
+	synergy::IStream*	m_stream;
+};
+
+
+//
+// ProtocolUtil::FrameReader
+//
+
+// decodes fields straight out of a buffered frame
+class ProtocolUtil::FrameReader {
+public:
+	enum { kLogFields = false };
+
+	FrameReader(const UInt8* frame, UInt32 size) :
+		m_frame(frame), m_size(size), m_used(0) { }
+
+	void				read(void* buffer, UInt32 n)
+	{
+		memcpy(buffer, take(n), n);
+	}
+
+	void				readString(String& dst, UInt32 len)
+	{
+		dst.assign(reinterpret_cast<const char*>(take(len)), len);
+	}
+
+	UInt32				getUsed() const
+	{
+		return m_used;
+	}
+
+private:
+	const UInt8*		take(UInt32 n)
+	{
+		if (n > m_size - m_used) {
+			LOG((CLOG_DEBUG2 "unexpected end of frame in readf(), %d bytes left", n));
+			throw XIOEndOfStream();
+		}
+		const UInt8* data = m_frame + m_used;
+		m_used += n;
+		return data;
+	}
+
+private:
+	const UInt8*		m_frame;
+	UInt32				m_size;
+	UInt32				m_used;
+};
+
+
 //
 // ProtocolUtil
 //
@@ -54,17 +153,54 @@ ProtocolUtil::readf(synergy::IStream* stream, const char* fmt, ...)
 	bool result;
 	va_list args;
 	va_start(args, fmt);
-	try {
-		vreadf(stream, fmt, args);
-		result = true;
+
+	// decode in place if the stream lends us a frame
+	UInt32 size;
+	const UInt8* frame = stream->lendFrame(size);
+	if (frame != NULL) {
+		FrameReader reader(frame, size);
+		try {
+			vreadf(reader, fmt, args);
+			result = true;
+		}
+		catch (XIO&) {
+			result = false;
+		}
+		stream->releaseFrame(reader.getUsed());
 	}
-	catch (XIO&) {
-		result = false;
+	else {
+		StreamReader reader(stream);
+		try {
+			vreadf(reader, fmt, args);
+			result = true;
+		}
+		catch (XIO&) {
+			result = false;
+		}
 	}
 	va_end(args);
 	return result;
 }
 
+UInt32
+ProtocolUtil::readCode(synergy::IStream* stream, UInt8* code)
+{
+	assert(stream != NULL);
+	assert(code != NULL);
+
+	UInt32 size;
+	const UInt8* frame = stream->lendFrame(size);
+	if (frame == NULL) {
+		return stream->read(code, 4);
+	}
+
+	// a code never spans frames
+	UInt32 n = (size < 4) ? size : 4;
+	memcpy(code, frame, n);
+	stream->releaseFrame(n);
+	return n;
+}
+
 void
 ProtocolUtil::vwritef(synergy::IStream* stream,
 				const char* fmt, UInt32 size, va_list args)
@@ -94,10 +230,10 @@ ProtocolUtil::vwritef(synergy::IStream* stream,
 	}
 }
 
+template <class Reader>
 void
-ProtocolUtil::vreadf(synergy::IStream* stream, const char* fmt, va_list args)
+ProtocolUtil::vreadf(Reader& reader, const char* fmt, va_list args)
 {
-	assert(stream != NULL);
 	assert(fmt != NULL);
 
 	// begin scanning
@@ -113,7 +249,7 @@ ProtocolUtil::vreadf(synergy::IStream* stream, const char* fmt, va_list args)
 
 				// read the data
 				UInt8 buffer[4];
-				read(stream, buffer, len);
+				reader.read(buffer, len);
 
 				// convert it
 				void* v = va_arg(args, void*);
@@ -121,7 +257,9 @@ ProtocolUtil::vreadf(synergy::IStream* stream, const char* fmt, va_list args)
 				case 1:
 					// 1 byte integer
 					*static_cast<UInt8*>(v) = buffer[0];
-					LOG((CLOG_DEBUG2 "readf: read %d byte integer: %d (0x%x)", len, *static_cast<UInt8*>(v), *static_cast<UInt8*>(v)));
+					if (Reader::kLogFields) {
+						LOG((CLOG_DEBUG2 "readf: read %d byte integer: %d (0x%x)", len, *static_cast<UInt8*>(v), *static_cast<UInt8*>(v)));
+					}
 					break;
 
 				case 2:
@@ -130,7 +268,9 @@ ProtocolUtil::vreadf(synergy::IStream* stream, const char* fmt, va_list args)
 						static_cast<UInt16>(
 						(static_cast<UInt16>(buffer[0]) << 8) |
 						 static_cast<UInt16>(buffer[1]));
-					LOG((CLOG_DEBUG2 "readf: read %d byte integer: %d (0x%x)", len, *static_cast<UInt16*>(v), *static_cast<UInt16*>(v)));
+					if (Reader::kLogFields) {
+						LOG((CLOG_DEBUG2 "readf: read %d byte integer: %d (0x%x)", len, *static_cast<UInt16*>(v), *static_cast<UInt16*>(v)));
+					}
 					break;
 
 				case 4:
@@ -140,7 +280,9 @@ ProtocolUtil::vreadf(synergy::IStream* stream, const char* fmt, va_list args)
 						(static_cast<UInt32>(buffer[1]) << 16) |
 						(static_cast<UInt32>(buffer[2]) <<  8) |
 						 static_cast<UInt32>(buffer[3]);
-					LOG((CLOG_DEBUG2 "readf: read %d byte integer: %d (0x%x)", len, *static_cast<UInt32*>(v), *static_cast<UInt32*>(v)));
+					if (Reader::kLogFields) {
+						LOG((CLOG_DEBUG2 "readf: read %d byte integer: %d (0x%x)", len, *static_cast<UInt32*>(v), *static_cast<UInt32*>(v)));
+					}
 					break;
 				}
 				break;
@@ -152,7 +294,7 @@ ProtocolUtil::vreadf(synergy::IStream* stream, const char* fmt, va_list args)
 
 				// read the vector length
 				UInt8 buffer[4];
-				read(stream, buffer, 4);
+				reader.read(buffer, 4);
 				UInt32 n = (static_cast<UInt32>(buffer[0]) << 24) |
 						   (static_cast<UInt32>(buffer[1]) << 16) |
 						   (static_cast<UInt32>(buffer[2]) <<  8) |
@@ -164,35 +306,41 @@ ProtocolUtil::vreadf(synergy::IStream* stream, const char* fmt, va_list args)
 				case 1:
 					// 1 byte integer
 					for (UInt32 i = 0; i < n; ++i) {
-						read(stream, buffer, 1);
+						reader.read(buffer, 1);
 						static_cast<std::vector<UInt8>*>(v)->push_back(
 							buffer[0]);
-						LOG((CLOG_DEBUG2 "readf: read %d byte integer[%d]: %d (0x%x)", len, i, static_cast<std::vector<UInt8>*>(v)->back(), static_cast<std::vector<UInt8>*>(v)->back()));
+						if (Reader::kLogFields) {
+							LOG((CLOG_DEBUG2 "readf: read %d byte integer[%d]: %d (0x%x)", len, i, static_cast<std::vector<UInt8>*>(v)->back(), static_cast<std::vector<UInt8>*>(v)->back()));
+						}
 					}
 					break;
 
 				case 2:
 					// 2 byte integer
 					for (UInt32 i = 0; i < n; ++i) {
-						read(stream, buffer, 2);
+						reader.read(buffer, 2);
 						static_cast<std::vector<UInt16>*>(v)->push_back(
 							static_cast<UInt16>(
 							(static_cast<UInt16>(buffer[0]) << 8) |
 							 static_cast<UInt16>(buffer[1])));
-						LOG((CLOG_DEBUG2 "readf: read %d byte integer[%d]: %d (0x%x)", len, i, static_cast<std::vector<UInt16>*>(v)->back(), static_cast<std::vector<UInt16>*>(v)->back()));
+						if (Reader::kLogFields) {
+							LOG((CLOG_DEBUG2 "readf: read %d byte integer[%d]: %d (0x%x)", len, i, static_cast<std::vector<UInt16>*>(v)->back(), static_cast<std::vector<UInt16>*>(v)->back()));
+						}
 					}
 					break;
 
 				case 4:
 					// 4 byte integer
 					for (UInt32 i = 0; i < n; ++i) {
-						read(stream, buffer, 4);
+						reader.read(buffer, 4);
 						static_cast<std::vector<UInt32>*>(v)->push_back(
 							(static_cast<UInt32>(buffer[0]) << 24) |
 							(static_cast<UInt32>(buffer[1]) << 16) |
 							(static_cast<UInt32>(buffer[2]) <<  8) |
 							 static_cast<UInt32>(buffer[3]));
-						LOG((CLOG_DEBUG2 "readf: read %d byte integer[%d]: %d (0x%x)", len, i, static_cast<std::vector<UInt32>*>(v)->back(), static_cast<std::vector<UInt32>*>(v)->back()));
+						if (Reader::kLogFields) {
+							LOG((CLOG_DEBUG2 "readf: read %d byte integer[%d]: %d (0x%x)", len, i, static_cast<std::vector<UInt32>*>(v)->back(), static_cast<std::vector<UInt32>*>(v)->back()));
+						}
 					}
 					break;
 				}
@@ -203,42 +351,18 @@ ProtocolUtil::vreadf(synergy::IStream* stream, const char* fmt, va_list args)
 				assert(len == 0);
 
 				// read the string length
-				UInt8 buffer[128];
-				read(stream, buffer, 4);
+				UInt8 buffer[4];
+				reader.read(buffer, 4);
 				UInt32 len = (static_cast<UInt32>(buffer[0]) << 24) |
 							 (static_cast<UInt32>(buffer[1]) << 16) |
 							 (static_cast<UInt32>(buffer[2]) <<  8) |
 							  static_cast<UInt32>(buffer[3]);
 
-				// use a fixed size buffer if its big enough
-				const bool useFixed = (len <= sizeof(buffer));
-
-				// allocate a buffer to read the data
-				UInt8* sBuffer = buffer;
-				if (!useFixed) {
-					sBuffer = new UInt8[len];
-				}
-
 				// read the data
-				try {
-					read(stream, sBuffer, len);
-				}
-				catch (...) {
-					if (!useFixed) {
-						delete[] sBuffer;
-					}
-					throw;
-				}
-
-				LOG((CLOG_DEBUG2 "readf: read %d byte string", len));
-
-				// save the data
 				String* dst = va_arg(args, String*);
-				dst->assign((const char*)sBuffer, len);
-
-				// release the buffer
-				if (!useFixed) {
-					delete[] sBuffer;
+				reader.readString(*dst, len);
+				if (Reader::kLogFields) {
+					LOG((CLOG_DEBUG2 "readf: read %d byte string", len));
 				}
 				break;
 			}
@@ -257,7 +381,7 @@ ProtocolUtil::vreadf(synergy::IStream* stream, const char* fmt, va_list args)
 		else {
 			// read next character
 			char buffer[1];
-			read(stream, buffer, 1);
+			reader.read(buffer, 1);
 
 			// verify match
 			if (buffer[0] != *fmt) {
@@ -306,7 +430,6 @@ ProtocolUtil::getLength(const char* fmt, va_list args)
 			case 's':
 				assert(len == 0);
 				len = (UInt32)(va_arg(args, String*))->size() + 4;
-				(void)va_arg(args, UInt8*);
 				break;
 
 			case 'S':
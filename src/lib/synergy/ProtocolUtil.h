@@ -68,15 +68,30 @@ public:
 	- \%2I  -- reads NBO 2 byte integers;  arg is std::vector<UInt16>*
 	- \%4I  -- reads NBO 4 byte integers;  arg is std::vector<UInt32>*
 	- \%s   -- reads bytes;  argument must be a String*, \b not a char*
+
+	If the stream has a complete frame buffered (see
+	IStream::lendFrame()) the data is decoded straight from it.
 	*/
 	static bool			readf(synergy::IStream*,
 							const char* fmt, ...);
 
+	//! Read a message code
+	/*!
+	Reads the 4 byte code that starts a message into \p code, from the
+	stream's buffered frame if it has one.  Returns the number of bytes
+	read, which is less than 4 if the message is truncated and 0 if
+	there's no message.
+	*/
+	static UInt32		readCode(synergy::IStream*, UInt8* code);
+
 private:
+	class StreamReader;
+	class FrameReader;
+
 	static void			vwritef(synergy::IStream*,
 							const char* fmt, UInt32 size, va_list);
-	static void			vreadf(synergy::IStream*,
-							const char* fmt, va_list);
+	template <class Reader>
+	static void			vreadf(Reader&, const char* fmt, va_list);
 
 	static UInt32		getLength(const char* fmt, va_list);
 	static void			writef(void*, const char* fmt, va_list);
@@ -19,6 +19,7 @@
 #include "synergy/ServerApp.h"
 
 #include "server/Server.h"
+#include "server/ConfigCache.h"
 #include "server/ClientListener.h"
 #include "server/ClientProxy.h"
 #include "server/PrimaryClient.h"
@@ -57,6 +58,7 @@
 #endif
 
 #include <iostream>
+#include <sstream>
 #include <stdio.h>
 #include <fstream>
 
@@ -126,6 +128,8 @@ ServerApp::help()
 		"Usage: %s"
 		" [--address <address>]"
 		" [--config <pathname>]"
+		" [--socket-threads <count>]"
+		" [--config-cache]"
 		WINAPI_ARGS
 		HELP_SYS_ARGS
 		HELP_COMMON_ARGS
@@ -134,6 +138,13 @@ ServerApp::help()
 		"\n"
 		"  -a, --address <address>  listen for clients on the given address.\n"
 		"  -c, --config <pathname>  use the named configuration file instead.\n"
+		"      --socket-threads <count>\n"
+		"                           service client sockets on <count> threads.\n"
+		"                             this helps with very many clients.\n"
+		"      --config-cache       keep a compiled copy of the configuration in\n"
+		"                             <pathname>.cache so large configurations\n"
+		"                             load faster.  only use this with a\n"
+		"                             configuration file that persists.\n"
 		HELP_COMMON_INFO_1
 		WINAPI_INFO
 		HELP_SYS_INFO
@@ -236,8 +247,31 @@ ServerApp::loadConfig(const String& pathname)
 				pathname.c_str()));
 			return false;
 		}
-		configStream >> *args().m_config;
+		std::ostringstream text;
+		text << configStream.rdbuf();
+		String source = text.str();
+
+		// use the compiled configuration if it's up to date.  the
+		// cache is only touched when asked for since a configuration
+		// that doesn't persist, like the GUI's temporary one, would
+		// leave a new cache behind on every start.  a cache we weren't
+		// asked to use may belong to another instance so leave it be.
+		String cachePath = ConfigCache::getCachePath(pathname);
+		if (args().m_configCache &&
+			ConfigCache::load(cachePath, source, *args().m_config)) {
+			LOG((CLOG_DEBUG "configuration read from cache"));
+			return true;
+		}
+
+		std::istringstream sourceStream(source);
+		sourceStream >> *args().m_config;
 		LOG((CLOG_DEBUG "configuration read successfully"));
+
+		if (args().m_configCache &&
+			!ConfigCache::save(cachePath, source, *args().m_config)) {
+			LOG((CLOG_DEBUG "cannot write configuration cache \"%s\"",
+				cachePath.c_str()));
+		}
 		return true;
 	}
 	catch (XConfigRead& e) {
@@ -681,7 +715,9 @@ ServerApp::mainLoop()
 {
 	// create socket multiplexer.  this must happen after daemonization
 	// on unix because threads evaporate across a fork().
-	SocketMultiplexer multiplexer;
+	SocketMultiplexer multiplexer(argsBase().m_enableIOUring ?
+		SocketMultiplexer::kIOUringBackend : SocketMultiplexer::kPollBackend,
+		args().m_socketThreads);
 	setSocketMultiplexer(&multiplexer);
 
 	// if configuration has no screens then add this system
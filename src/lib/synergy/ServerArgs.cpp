@@ -20,7 +20,9 @@
 ServerArgs::ServerArgs() :
 	m_configFile(),
 	m_serial(),
-	m_config(NULL)
+	m_config(NULL),
+	m_socketThreads(1),
+	m_configCache(false)
 {
 }
 
@@ -31,4 +31,6 @@ public:
 	String				m_configFile;
 	SerialKey			m_serial;
 	Config*				m_config;
+	int					m_socketThreads;
+	bool				m_configCache;
 };
@@ -25,6 +25,7 @@ const char*				kMsgCClose 			= "CBYE";
 const char*				kMsgCEnter 			= "CINN%2i%2i%4i%2i";
 const char*				kMsgCLeave 			= "COUT";
 const char*				kMsgCClipboard 		= "CCLP%1i%4i";
+const char*				kMsgCClipboardAck	= "CCAK%1i%4i%1i";
 const char*				kMsgCScreenSaver 	= "CSEC%1i";
 const char*				kMsgCResetOptions	= "CROP";
 const char*				kMsgCInfoAck		= "CIAK";
@@ -46,6 +47,7 @@ const char*				kMsgDInfo			= "DINF%2i%2i%2i%2i%2i%2i%2i";
 const char*				kMsgDSetOptions		= "DSOP%4I";
 const char*				kMsgDFileTransfer	= "DFTR%1i%s";
 const char*				kMsgDDragInfo		= "DDRG%2i%s";
+const char*				kMsgDFileSetTransfer	= "DFST%1i%4i%s%s";
 const char*				kMsgQInfo			= "QINF";
 const char*				kMsgEIncompatible	= "EICV%2i%2i";
 const char*				kMsgEBusy 			= "EBSY";
@@ -29,9 +29,11 @@
 // 1.4:  adds crypto support
 // 1.5:  adds file transfer and removes home brew crypto
 // 1.6:  adds clipboard streaming
+// 1.7:  adds file set transfer
+// 1.8:  adds delta clipboard updates
 // NOTE: with new version, synergy minor version should increment
 static const SInt16		kProtocolMajorVersion = 1;
-static const SInt16		kProtocolMinorVersion = 6;
+static const SInt16		kProtocolMinorVersion = 8;
 
 // default contact port number
 static const UInt16		kDefaultPort = 24800;
@@ -39,6 +41,17 @@ static const UInt16		kDefaultPort = 24800;
 // maximum total length for greeting returned by client
 static const UInt32		kMaxHelloLength = 1024;
 
+// maximum length of a packet.  a peer that announces a longer one is
+// disconnected.  the data messages have their own, larger limits.
+static const UInt32		kMaxPacketLength = 64 * 1024;
+
+// maximum length of a clipboard packet.  clients before protocol 1.6
+// send the whole clipboard in one packet.
+static const UInt32		kMaxClipboardPacketLength = 32 * 1024 * 1024;
+
+// maximum length of file transfer and drag info packets
+static const UInt32		kMaxFilePacketLength = 1024 * 1024;
+
 // time between kMsgCKeepAlive (in seconds).  a non-positive value disables
 // keep alives.  this is the default rate that can be overridden using an
 // option.
@@ -148,6 +161,13 @@ extern const char*		kMsgCLeave;
 // most recent kMsgCEnter.  the primary always sends 0.
 extern const char*		kMsgCClipboard;
 
+// clipboard update acknowledgement:  primary <-> secondary
+// sent for each kMsgDClipboard received from a 1.8 or later peer.
+// $1 = clipboard identifier, $2 = update number, $3 = 1 if the
+// update was applied or 0 if it couldn't be, in which case the
+// sender resends the whole clipboard.
+extern const char*		kMsgCClipboardAck;
+
 // screensaver change:  primary -> secondary
 // screensaver on primary has started ($1 == 1) or closed ($1 == 0)
 extern const char*		kMsgCScreenSaver;
@@ -236,7 +256,9 @@ extern const char*		kMsgDMouseWheel1_0;
 // $2 = sequence number, $3 = mark $4 = clipboard data.  the sequence number
 // is 0 when sent by the primary.  secondary screens should use the
 // sequence number from the most recent kMsgCEnter.  $1 = clipboard
-// identifier.
+// identifier.  from 1.8 the data is a ClipboardDelta update carrying
+// only the formats changed since the previous update, not the whole
+// marshalled clipboard.
 extern const char*		kMsgDClipboard;
 
 // client data:  secondary -> primary
@@ -273,6 +295,17 @@ extern const char*		kMsgDFileTransfer;
 // of each object's directory.
 extern const char*		kMsgDDragInfo;
 
+// file set data:  primary <-> secondary
+// transfer the files and directories of a drag.  $1 = mark (as in
+// kMsgDFileTransfer), $2 = entry id, $3 = path relative to the drop
+// directory using '/' separators, $4 = content.  entry 0 is the set:
+// its start and end carry the number of entries.  an entry's start
+// carries its path and size, or an empty size for a directory whose
+// path ends in '/'.  chunks carry file data and the end carries the
+// CRC-32 of the file in hex.  chunks of several files may be
+// interleaved.
+extern const char*		kMsgDFileSetTransfer;
+
 //
 // query codes
 //
@@ -221,7 +221,6 @@ static void sProcessMessage(uSynergyContext *context, const uint8_t *message)
 			// Send reply failed, let's try to reconnect
 			sTrace(context, "SendReply failed, trying to reconnect in a second");
 			context->m_connected = USYNERGY_FALSE;
-			context->m_sleepFunc(context->m_cookie, 1000);
 		}
 		else
 		{
@@ -230,6 +229,7 @@ static void sProcessMessage(uSynergyContext *context, const uint8_t *message)
 			sprintf(buffer, "Connected as client \"%s\"", context->m_clientName);
 			sTrace(context, buffer);
 			context->m_hasReceivedHello = USYNERGY_TRUE;
+			context->m_lastMessageTime = context->m_getTimeFunc();
 		}
 		return;
 	}
@@ -466,6 +466,141 @@ static void sSetDisconnected(uSynergyContext *context)
 	context->m_isCaptured		= USYNERGY_FALSE;
 	context->m_replyCur			= context->m_replyBuffer + 4;
 	context->m_sequenceNumber	= 0;
+	context->m_receiveHead		= 0;
+	context->m_receiveCount		= 0;
+	context->m_discardCount		= 0;
+}
+
+
+
+/**
+@brief Read byte at offset from the start of unprocessed data in the receive ring
+**/
+static uint8_t sRingByte(const uSynergyContext *context, int offset)
+{
+	return context->m_receiveBuffer[(context->m_receiveHead + offset) % USYNERGY_RECEIVE_BUFFER_SIZE];
+}
+
+
+
+/**
+@brief Drop processed bytes from the front of the receive ring
+**/
+static void sRingConsume(uSynergyContext *context, int length)
+{
+	context->m_receiveHead = (context->m_receiveHead + length) % USYNERGY_RECEIVE_BUFFER_SIZE;
+	context->m_receiveCount -= length;
+
+	/* Restart at the front when empty so that later packets are less likely to wrap */
+	if (context->m_receiveCount == 0)
+		context->m_receiveHead = 0;
+}
+
+
+
+/**
+@brief Get offset and size of the contiguous free space at the back of the receive ring
+**/
+static int sRingFreeSpan(const uSynergyContext *context, int *outOffset)
+{
+	int tail = (context->m_receiveHead + context->m_receiveCount) % USYNERGY_RECEIVE_BUFFER_SIZE;
+	*outOffset = tail;
+	if (context->m_receiveCount == USYNERGY_RECEIVE_BUFFER_SIZE)
+		return 0;
+	if (tail >= context->m_receiveHead)
+		return USYNERGY_RECEIVE_BUFFER_SIZE - tail;
+	return context->m_receiveHead - tail;
+}
+
+
+
+/**
+@brief Reverse a range of the receive buffer in place
+**/
+static void sReverse(uint8_t *begin, uint8_t *end)
+{
+	while (begin < --end)
+	{
+		uint8_t tmp = *begin;
+		*begin++ = *end;
+		*end = tmp;
+	}
+}
+
+
+
+/**
+@brief Rotate the receive ring in place so that unprocessed data starts at offset 0
+
+Only needed when a packet straddles the end of the ring, which happens at most once for each
+pass through the buffer. Uses the three-reversal rotation so no scratch memory is needed.
+**/
+static void sRingLinearize(uSynergyContext *context)
+{
+	uint8_t *buffer = context->m_receiveBuffer;
+	sReverse(buffer, buffer + context->m_receiveHead);
+	sReverse(buffer + context->m_receiveHead, buffer + USYNERGY_RECEIVE_BUFFER_SIZE);
+	sReverse(buffer, buffer + USYNERGY_RECEIVE_BUFFER_SIZE);
+	context->m_receiveHead = 0;
+}
+
+
+
+/**
+@brief Process all complete packets in the receive ring
+
+Packets are parsed in place. Oversized packets that can never fit in the ring are skipped as
+their bytes arrive.
+**/
+static void sProcessReceived(uSynergyContext *context)
+{
+	while (context->m_connected)
+	{
+		uint32_t packlen;
+
+		/* Throw away the rest of an oversized packet */
+		if (context->m_discardCount != 0)
+		{
+			int ditch = context->m_receiveCount;
+			if ((uint32_t)ditch > context->m_discardCount)
+				ditch = (int)context->m_discardCount;
+			sRingConsume(context, ditch);
+			context->m_discardCount -= ditch;
+			if (context->m_discardCount != 0)
+				break;
+			continue;
+		}
+
+		/* Grab packet length and bail out if the packet isn't complete yet */
+		if (context->m_receiveCount < 4)
+			break;
+		packlen = ((uint32_t)sRingByte(context, 0) << 24) | ((uint32_t)sRingByte(context, 1) << 16) |
+			((uint32_t)sRingByte(context, 2) << 8) | (uint32_t)sRingByte(context, 3);
+		if (packlen > USYNERGY_RECEIVE_BUFFER_SIZE - 4)
+		{
+			/* Oversized packet, ditch it */
+			char buffer[128];
+			sprintf(buffer, "Oversized packet (length %u)", packlen);
+			sTrace(context, buffer);
+			context->m_discardCount = packlen + 4;
+			continue;
+		}
+		if ((int)packlen + 4 > context->m_receiveCount)
+			break;
+
+		/* Make packet contiguous if it wraps around the end of the ring */
+		if (context->m_receiveHead + (int)packlen + 4 > USYNERGY_RECEIVE_BUFFER_SIZE)
+			sRingLinearize(context);
+
+		/* Process message */
+		sProcessMessage(context, context->m_receiveBuffer + context->m_receiveHead);
+		if (!context->m_connected)
+		{
+			sSetDisconnected(context);
+			break;
+		}
+		sRingConsume(context, (int)packlen + 4);
+	}
 }
 
 
@@ -475,11 +610,11 @@ static void sSetDisconnected(uSynergyContext *context)
 **/
 static void sUpdateContext(uSynergyContext *context)
 {
-	/* Receive data (blocking) */
-	int receive_size = USYNERGY_RECEIVE_BUFFER_SIZE - context->m_receiveOfs;
+	/* Receive data (blocking) straight into the free part of the ring */
+	int receive_ofs;
+	int receive_size = sRingFreeSpan(context, &receive_ofs);
 	int num_received = 0;
-	int packlen = 0;
-	if (context->m_receiveFunc(context->m_cookie, context->m_receiveBuffer + context->m_receiveOfs, receive_size, &num_received) == USYNERGY_FALSE)
+	if (context->m_receiveFunc(context->m_cookie, context->m_receiveBuffer + receive_ofs, receive_size, &num_received) == USYNERGY_FALSE)
 	{
 		/* Receive failed, let's try to reconnect */
 		char buffer[128];
@@ -489,7 +624,7 @@ static void sUpdateContext(uSynergyContext *context)
 		context->m_sleepFunc(context->m_cookie, 1000);
 		return;
 	}
-	context->m_receiveOfs += num_received;
+	context->m_receiveCount += num_received;
 
 	/*	If we didn't receive any data then we're probably still polling to get connected and
 		therefore not getting any data back. To avoid overloading the system with a Synergy
@@ -511,49 +646,12 @@ static void sUpdateContext(uSynergyContext *context)
 			context->m_lastMessageTime = cur_time;
 	}
 
-	/* Eat packets */
-	for (;;)
-	{
-		/* Grab packet length and bail out if the packet goes beyond the end of the buffer */
-		packlen = sNetToNative32(context->m_receiveBuffer);
-		if (packlen+4 > context->m_receiveOfs)
-			break;
-
-		/* Process message */
-		sProcessMessage(context, context->m_receiveBuffer);
-
-		/* Move packet to front of buffer */
-		memmove(context->m_receiveBuffer, context->m_receiveBuffer+packlen+4, context->m_receiveOfs-packlen-4);
-		context->m_receiveOfs -= packlen+4;
-	}
-
-	/* Throw away over-sized packets */
-	if (packlen > USYNERGY_RECEIVE_BUFFER_SIZE)
+	/* Eat packets, backing off before reconnecting if replying failed */
+	if (context->m_connected)
 	{
-		/* Oversized packet, ditch tail end */
-		char buffer[128];
-		sprintf(buffer, "Oversized packet: '%c%c%c%c' (length %d)", context->m_receiveBuffer[4], context->m_receiveBuffer[5], context->m_receiveBuffer[6], context->m_receiveBuffer[7], packlen);
-		sTrace(context, buffer);
-		num_received = context->m_receiveOfs-4; // 4 bytes for the size field
-		while (num_received != packlen)
-		{
-			int buffer_left = packlen - num_received;
-			int to_receive = buffer_left < USYNERGY_RECEIVE_BUFFER_SIZE ? buffer_left : USYNERGY_RECEIVE_BUFFER_SIZE;
-			int ditch_received = 0;
-			if (context->m_receiveFunc(context->m_cookie, context->m_receiveBuffer, to_receive, &ditch_received) == USYNERGY_FALSE)
-			{
-				/* Receive failed, let's try to reconnect */
-				sTrace(context, "Receive failed, trying to reconnect in a second");
-				sSetDisconnected(context);
-				context->m_sleepFunc(context->m_cookie, 1000);
-				break;
-			}
-			else
-			{
-				num_received += ditch_received;
-			}
-		}
-		context->m_receiveOfs = 0;
+		sProcessReceived(context);
+		if (!context->m_connected)
+			context->m_sleepFunc(context->m_cookie, 1000);
 	}
 }
 
@@ -597,6 +695,82 @@ void uSynergyUpdate(uSynergyContext *context)
 
 
 
+/**
+@brief Push received data into uSynergy
+**/
+uSynergyBool uSynergyPushData(uSynergyContext *context, const uint8_t *data, int length)
+{
+	/* The application owns the connection, data arriving means it's up */
+	if (!context->m_connected)
+		context->m_connected = USYNERGY_TRUE;
+
+	if (context->m_hasReceivedHello && length > 0)
+		context->m_lastMessageTime = context->m_getTimeFunc();
+
+	/*	Copy as much as fits into the ring and process it. Processing always leaves less than
+		a full ring behind, so this makes progress until all data has been consumed. */
+	while (length > 0 && context->m_connected)
+	{
+		int offset;
+		int span = sRingFreeSpan(context, &offset);
+		if (span > length)
+			span = length;
+		memcpy(context->m_receiveBuffer + offset, data, span);
+		context->m_receiveCount += span;
+		data += span;
+		length -= span;
+		sProcessReceived(context);
+	}
+
+	return context->m_connected;
+}
+
+
+
+/**
+@brief Get time until next deadline
+**/
+int32_t uSynergyGetNextDeadline(uSynergyContext *context)
+{
+	uint32_t elapsed;
+	if (!context->m_connected || !context->m_hasReceivedHello)
+		return -1;
+
+	elapsed = context->m_getTimeFunc() - context->m_lastMessageTime;
+	if (elapsed > USYNERGY_IDLE_TIMEOUT)
+		return 0;
+	return (int32_t)(USYNERGY_IDLE_TIMEOUT - elapsed) + 1;
+}
+
+
+
+/**
+@brief Check deadlines
+**/
+uSynergyBool uSynergyPoll(uSynergyContext *context)
+{
+	if (uSynergyGetNextDeadline(context) == 0)
+	{
+		/* Timeout after 2 secs of inactivity (we received no CALV) */
+		sTrace(context, "Server timed out");
+		sSetDisconnected(context);
+		return USYNERGY_FALSE;
+	}
+	return context->m_connected;
+}
+
+
+
+/**
+@brief Reset connection state
+**/
+void uSynergyDisconnect(uSynergyContext *context)
+{
+	sSetDisconnected(context);
+}
+
+
+
 /**
 @brief Send clipboard data
 **/
@@ -46,7 +46,7 @@ extern "C" {
 	#error "Can't define both USYNERGY_LITTLE_ENDIAN and USYNERGY_BIG_ENDIAN"
 #elif !defined(USYNERGY_LITTLE_ENDIAN) && !defined(USYNERGY_BIG_ENDIAN)
 	/* Attempt to auto detect */
-	#if defined(__LITTLE_ENDIAN__) || defined(LITTLE_ENDIAN) 
+	#if defined(__LITTLE_ENDIAN__) || defined(LITTLE_ENDIAN) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
 		#define USYNERGY_LITTLE_ENDIAN
 	#elif defined(__BIG_ENDIAN__) || defined(BIG_ENDIAN) || (_BYTE_ORDER == _BIG_ENDIAN)
 		#define USYNERGY_BIG_ENDIAN
@@ -342,8 +342,10 @@ typedef struct
 	uSynergyBool					m_isCaptured;									/* Is Synergy active (i.e. this client is receiving input messages?) */
 	uint32_t						m_lastMessageTime;								/* Time at which last message was received */
 	uint32_t						m_sequenceNumber;								/* Packet sequence number */
-	uint8_t							m_receiveBuffer[USYNERGY_RECEIVE_BUFFER_SIZE];	/* Receive buffer */
-	int								m_receiveOfs;									/* Receive buffer offset */
+	uint8_t							m_receiveBuffer[USYNERGY_RECEIVE_BUFFER_SIZE];	/* Receive buffer, used as a ring */
+	int								m_receiveHead;									/* Offset of first unprocessed byte in ring */
+	int								m_receiveCount;									/* Number of unprocessed bytes in ring */
+	uint32_t						m_discardCount;									/* Bytes of an oversized packet still to be thrown away */
 	uint8_t							m_replyBuffer[USYNERGY_REPLY_BUFFER_SIZE];		/* Reply buffer */
 	uint8_t*						m_replyCur;										/* Write offset into reply buffer */
 	uint16_t						m_mouseX;										/* Mouse X position */
@@ -398,6 +400,68 @@ extern void		uSynergyUpdate(uSynergyContext *context);
 
 
 
+/**
+@brief Push received data into uSynergy
+
+Event-driven alternative to uSynergyUpdate. Instead of letting uSynergy pull data through
+the blocking receive callback, the application owns the socket and hands over whatever bytes
+it read whenever the socket becomes readable. The data may contain any number of partial or
+complete packets; it is appended to the receive ring and every complete packet is processed
+straight from the ring, calling callbacks and sending replies as usual.
+
+The connect, receive and sleep callbacks are never called in this mode, so they may be left
+NULL. The first call after uSynergyInit or uSynergyDisconnect marks the context as connected.
+This function never blocks (unless the send callback does).
+
+@param context	Context to push data into
+@param data		Received data
+@param length	Number of bytes in @a data
+@returns		USYNERGY_FALSE if the connection should be closed (e.g. a reply could not be sent)
+**/
+extern uSynergyBool	uSynergyPushData(uSynergyContext *context, const uint8_t *data, int length);
+
+
+
+/**
+@brief Get time until next deadline
+
+Returns the number of milliseconds until uSynergyPoll must be called to detect that the server
+stopped sending keep-alives. The value is meant to be used directly as the timeout of poll()
+or select(). Returns -1 if there is currently no deadline (not connected, or the server has
+not said hello yet).
+
+@param context	Context to query
+@returns		Milliseconds until the next deadline, 0 if it has passed, or -1 if there is none
+**/
+extern int32_t		uSynergyGetNextDeadline(uSynergyContext *context);
+
+
+
+/**
+@brief Check deadlines
+
+Call when the timeout returned by uSynergyGetNextDeadline expires. If the server has been
+silent for longer than USYNERGY_IDLE_TIMEOUT the context is marked as disconnected.
+
+@param context	Context to check
+@returns		USYNERGY_FALSE if the connection timed out and should be closed
+**/
+extern uSynergyBool	uSynergyPoll(uSynergyContext *context);
+
+
+
+/**
+@brief Reset connection state
+
+Call when the application closes or loses its connection so that buffered data and protocol
+state from the old connection are thrown away.
+
+@param context	Context to reset
+**/
+extern void			uSynergyDisconnect(uSynergyContext *context);
+
+
+
 /**
 @brief Send clipboard data
 
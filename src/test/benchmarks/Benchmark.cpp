@@ -0,0 +1,316 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test/benchmarks/Benchmark.h"
+
+#include "arch/Arch.h"
+#include "base/XBase.h"
+#include "common/Version.h"
+
+#include <algorithm>
+#include <exception>
+
+// how many times more iterations a calibration run may ask for
+static const double		s_maxGrowth = 100.0;
+
+// aim past the minimum time so calibration usually ends in one step
+static const double		s_overshoot = 1.2;
+
+class BenchmarkEntry {
+public:
+	String				m_name;
+	Benchmark::Function	m_function;
+};
+
+typedef std::vector<BenchmarkEntry> EntryList;
+
+static
+EntryList&
+getEntries()
+{
+	// constructed on first use since benchmarks register during
+	// static initialization
+	static EntryList s_entries;
+	return s_entries;
+}
+
+//
+// BenchmarkRun
+//
+
+BenchmarkRun::BenchmarkRun(UInt32 iterations) :
+	m_iterations(iterations),
+	m_start(-1.0),
+	m_elapsed(0.0),
+	m_bytes(0.0),
+	m_items(0.0),
+	m_sink(0)
+{
+	// do nothing
+}
+
+void
+BenchmarkRun::pauseTiming()
+{
+	if (m_start >= 0.0) {
+		m_elapsed += ARCH->time() - m_start;
+		m_start    = -1.0;
+	}
+}
+
+void
+BenchmarkRun::resumeTiming()
+{
+	if (m_start < 0.0) {
+		m_start = ARCH->time();
+	}
+}
+
+void
+BenchmarkRun::setBytes(double bytes)
+{
+	m_bytes = bytes;
+}
+
+void
+BenchmarkRun::setItems(double items)
+{
+	m_items = items;
+}
+
+void
+BenchmarkRun::keep(UInt32 value)
+{
+	m_sink = m_sink + value;
+}
+
+UInt32
+BenchmarkRun::getIterations() const
+{
+	return m_iterations;
+}
+
+double
+BenchmarkRun::getElapsed() const
+{
+	if (m_start >= 0.0) {
+		return m_elapsed + (ARCH->time() - m_start);
+	}
+	return m_elapsed;
+}
+
+double
+BenchmarkRun::getBytes() const
+{
+	return m_bytes;
+}
+
+double
+BenchmarkRun::getItems() const
+{
+	return m_items;
+}
+
+//
+// Benchmark::Result
+//
+
+Benchmark::Result::Result() :
+	m_iterations(0),
+	m_nsPerOp(0.0),
+	m_minNsPerOp(0.0),
+	m_maxNsPerOp(0.0),
+	m_bytesPerSecond(0.0),
+	m_itemsPerSecond(0.0)
+{
+	// do nothing
+}
+
+//
+// Benchmark
+//
+
+void
+Benchmark::add(const char* group, const char* name, Function function)
+{
+	BenchmarkEntry entry;
+	// ARCH doesn't exist yet so no sprintf()
+	entry.m_name     = String(group) + "." + name;
+	entry.m_function = function;
+	getEntries().push_back(entry);
+}
+
+bool
+Benchmark::run(const String& filter, double minTime,
+				int repetitions, ResultList& results)
+{
+	bool ok = true;
+	const EntryList& entries = getEntries();
+	for (EntryList::const_iterator i = entries.begin();
+							i != entries.end(); ++i) {
+		if (i->m_name.find(filter) == String::npos) {
+			continue;
+		}
+		results.push_back(measure(i->m_name, i->m_function,
+							minTime, repetitions));
+		if (!results.back().m_error.empty()) {
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+void
+Benchmark::list(std::ostream& out)
+{
+	const EntryList& entries = getEntries();
+	for (EntryList::const_iterator i = entries.begin();
+							i != entries.end(); ++i) {
+		out << i->m_name << std::endl;
+	}
+}
+
+void
+Benchmark::report(std::ostream& out, EFormat format,
+				const ResultList& results, double minTime, int repetitions)
+{
+	if (format == kJSON) {
+		// names are C++ identifiers joined by a dot so need no escaping
+		out << "{\n";
+		out << "  \"version\": \"" << kVersion << "\",\n";
+		out << synergy::string::sprintf(
+				"  \"minTime\": %g,\n  \"repetitions\": %d,\n",
+				minTime, repetitions);
+		out << "  \"benchmarks\": [";
+		for (ResultList::const_iterator i = results.begin();
+							i != results.end(); ++i) {
+			out << (i == results.begin() ? "\n" : ",\n");
+			out << "    { \"name\": \"" << i->m_name << "\"";
+			if (!i->m_error.empty()) {
+				out << ", \"error\": true }";
+				continue;
+			}
+			out << synergy::string::sprintf(
+				", \"iterations\": %u, \"nsPerOp\": %.3f"
+				", \"minNsPerOp\": %.3f, \"maxNsPerOp\": %.3f"
+				", \"bytesPerSecond\": %.0f, \"itemsPerSecond\": %.0f }",
+				i->m_iterations, i->m_nsPerOp,
+				i->m_minNsPerOp, i->m_maxNsPerOp,
+				i->m_bytesPerSecond, i->m_itemsPerSecond);
+		}
+		out << "\n  ]\n}" << std::endl;
+		return;
+	}
+
+	out << synergy::string::sprintf("%-44s %12s %12s %12s %14s\n",
+				"benchmark", "iterations", "ns/op", "spread %",
+				"throughput");
+	for (ResultList::const_iterator i = results.begin();
+							i != results.end(); ++i) {
+		if (!i->m_error.empty()) {
+			out << synergy::string::sprintf("%-44s failed: %s\n",
+				i->m_name.c_str(), i->m_error.c_str());
+			continue;
+		}
+
+		String throughput;
+		if (i->m_bytesPerSecond > 0.0) {
+			throughput = synergy::string::sprintf("%.1f MB/s",
+				i->m_bytesPerSecond / 1.0e6);
+		}
+		else if (i->m_itemsPerSecond > 0.0) {
+			throughput = synergy::string::sprintf("%.0f/s",
+				i->m_itemsPerSecond);
+		}
+		double spread = 0.0;
+		if (i->m_nsPerOp > 0.0) {
+			spread = 100.0 * (i->m_maxNsPerOp - i->m_minNsPerOp) /
+							i->m_nsPerOp;
+		}
+		out << synergy::string::sprintf("%-44s %12u %12.1f %12.1f %14s\n",
+				i->m_name.c_str(), i->m_iterations, i->m_nsPerOp,
+				spread, throughput.c_str());
+	}
+	out.flush();
+}
+
+Benchmark::Result
+Benchmark::measure(const String& name, Function function,
+				double minTime, int repetitions)
+{
+	Result result;
+	result.m_name = name;
+
+	try {
+		// find an iteration count that takes at least minTime.  this
+		// also warms up caches and allocators.
+		UInt32 iterations = 1;
+		for (;;) {
+			BenchmarkRun run(iterations);
+			double elapsed = time(function, run);
+			if (elapsed >= minTime || iterations >= 0x40000000u) {
+				break;
+			}
+			double growth = s_maxGrowth;
+			if (elapsed > 0.0) {
+				growth = std::min(growth, s_overshoot * minTime / elapsed);
+			}
+			growth     = std::max(growth, 2.0);
+			iterations = static_cast<UInt32>(
+							std::min(iterations * growth, 1073741824.0));
+		}
+
+		std::vector<double> times;
+		double bytes = 0.0, items = 0.0;
+		for (int i = 0; i < repetitions; ++i) {
+			BenchmarkRun run(iterations);
+			times.push_back(time(function, run));
+			bytes = run.getBytes();
+			items = run.getItems();
+		}
+		std::sort(times.begin(), times.end());
+		double median = times[times.size() / 2];
+		if (times.size() % 2 == 0) {
+			median = 0.5 * (median + times[times.size() / 2 - 1]);
+		}
+
+		result.m_iterations = iterations;
+		result.m_nsPerOp    = 1.0e9 * median / iterations;
+		result.m_minNsPerOp = 1.0e9 * times.front() / iterations;
+		result.m_maxNsPerOp = 1.0e9 * times.back() / iterations;
+		if (median > 0.0) {
+			result.m_bytesPerSecond = bytes / median;
+			result.m_itemsPerSecond = items / median;
+		}
+	}
+	catch (XBase& e) {
+		result.m_error = e.what();
+	}
+	catch (std::exception& e) {
+		result.m_error = e.what();
+	}
+	return result;
+}
+
+double
+Benchmark::time(Function function, BenchmarkRun& run)
+{
+	run.resumeTiming();
+	function(run);
+	run.pauseTiming();
+	return run.getElapsed();
+}
@@ -0,0 +1,178 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/String.h"
+#include "common/basic_types.h"
+#include "common/stdvector.h"
+
+#include <ostream>
+
+//! One measurement of a benchmark
+/*!
+A benchmark function is called with a run and must do its operation
+getIterations() times.  Setup that shouldn't count goes between
+pauseTiming() and resumeTiming().  Benchmarks that move data call
+setBytes() or setItems() with the total for all iterations so that
+throughput can be reported.
+*/
+class BenchmarkRun {
+public:
+	BenchmarkRun(UInt32 iterations);
+
+	//! @name manipulators
+	//@{
+
+	//! Stop the clock
+	void				pauseTiming();
+
+	//! Restart the clock
+	void				resumeTiming();
+
+	//! Set the bytes processed by all iterations
+	void				setBytes(double bytes);
+
+	//! Set the items processed by all iterations
+	void				setItems(double items);
+
+	//! Use a result
+	/*!
+	Keeps the compiler from optimizing away work whose result is
+	otherwise unused.
+	*/
+	void				keep(UInt32 value);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! Get the number of iterations to run
+	UInt32				getIterations() const;
+
+	//! Get the time measured so far
+	double				getElapsed() const;
+
+	//! Get the bytes processed
+	double				getBytes() const;
+
+	//! Get the items processed
+	double				getItems() const;
+
+	//@}
+
+private:
+	UInt32				m_iterations;
+	double				m_start;
+	double				m_elapsed;
+	double				m_bytes;
+	double				m_items;
+	volatile UInt32		m_sink;
+};
+
+//! Benchmark registry and runner
+/*!
+Benchmarks register themselves with BENCHMARK().  Each is calibrated
+until one run takes at least the minimum time, then measured that many
+iterations at a time for each repetition.  The median time per
+iteration is reported along with the fastest and slowest repetitions.
+*/
+class Benchmark {
+public:
+	typedef void (*Function)(BenchmarkRun&);
+
+	//! Report format
+	enum EFormat {
+		kText,							//!< Aligned table
+		kJSON							//!< One JSON document
+	};
+
+	//! Benchmark results
+	class Result {
+	public:
+		Result();
+
+		String			m_name;
+		UInt32			m_iterations;
+		double			m_nsPerOp;
+		double			m_minNsPerOp;
+		double			m_maxNsPerOp;
+		double			m_bytesPerSecond;
+		double			m_itemsPerSecond;
+		String			m_error;
+	};
+	typedef std::vector<Result> ResultList;
+
+	//! @name manipulators
+	//@{
+
+	//! Register a benchmark
+	static void			add(const char* group, const char* name, Function);
+
+	//! Run benchmarks
+	/*!
+	Runs every benchmark whose \c group.name contains \p filter and
+	appends a result for each to \p results.  Returns false if any
+	benchmark threw.
+	*/
+	static bool			run(const String& filter, double minTime,
+							int repetitions, ResultList& results);
+
+	//@}
+	//! @name accessors
+	//@{
+
+	//! List benchmark names
+	static void			list(std::ostream&);
+
+	//! Write results
+	static void			report(std::ostream&, EFormat,
+							const ResultList&, double minTime,
+							int repetitions);
+
+	//@}
+
+private:
+	static Result		measure(const String& name, Function,
+							double minTime, int repetitions);
+	static double		time(Function, BenchmarkRun&);
+};
+
+//! Benchmark registration
+/*!
+BENCHMARK() defines a static one of these to register a benchmark
+before main() runs.
+*/
+class BenchmarkRegistration {
+public:
+	BenchmarkRegistration(const char* group, const char* name,
+							Benchmark::Function function)
+	{
+		Benchmark::add(group, name, function);
+	}
+};
+
+//! Define a benchmark
+/*!
+Defines and registers a benchmark named \c group.name.  The body
+follows the macro and has a BenchmarkRun& named \c run.
+*/
+#define BENCHMARK(group, name) \
+	static void group##_##name##_benchmark(BenchmarkRun&); \
+	static BenchmarkRegistration group##_##name##_registration( \
+		#group, #name, &group##_##name##_benchmark); \
+	static void group##_##name##_benchmark(BenchmarkRun& run)
@@ -0,0 +1,118 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test/benchmarks/Benchmark.h"
+#include "arch/Arch.h"
+#include "base/Log.h"
+
+#if SYSAPI_WIN32
+#include "arch/win32/ArchMiscWindows.h"
+#endif
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+static const char*		s_usage =
+"Usage: benchmarks [--filter <text>] [--min-time <seconds>]\n"
+"                  [--repetitions <n>] [--format text|json]\n"
+"                  [--output <file>] [--list]\n"
+"\n"
+"  --filter       only run benchmarks whose name contains <text>.\n"
+"  --min-time     run each benchmark for at least this long (0.2).\n"
+"  --repetitions  measure each benchmark this many times (5).\n"
+"  --format       write an aligned table or a JSON document that can\n"
+"                 be compared between builds (text).\n"
+"  --output       write results to <file> instead of stdout.\n"
+"  --list         list benchmark names and exit.\n";
+
+int
+main(int argc, char** argv)
+{
+#if SYSAPI_WIN32
+	ArchMiscWindows::setInstanceWin32(GetModuleHandle(NULL));
+#endif
+
+	Arch arch;
+	arch.init();
+
+	// keep logging out of the measurements
+	Log log;
+	log.setFilter(kWARNING);
+
+	String filter;
+	String output;
+	double minTime  = 0.2;
+	int repetitions = 5;
+	Benchmark::EFormat format = Benchmark::kText;
+	for (int i = 1; i < argc; ++i) {
+		bool hasValue = (i + 1 < argc);
+		if (strcmp(argv[i], "--list") == 0) {
+			Benchmark::list(cout);
+			return 0;
+		}
+		else if (strcmp(argv[i], "--filter") == 0 && hasValue) {
+			filter = argv[++i];
+		}
+		else if (strcmp(argv[i], "--min-time") == 0 && hasValue) {
+			minTime = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--repetitions") == 0 && hasValue) {
+			repetitions = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--format") == 0 && hasValue) {
+			String name(argv[++i]);
+			if (name == "json") {
+				format = Benchmark::kJSON;
+			}
+			else if (name != "text") {
+				cerr << s_usage;
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--output") == 0 && hasValue) {
+			output = argv[++i];
+		}
+		else {
+			cerr << s_usage;
+			return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+		}
+	}
+	if (minTime <= 0.0 || repetitions < 1) {
+		cerr << s_usage;
+		return 1;
+	}
+
+	Benchmark::ResultList results;
+	bool ok = Benchmark::run(filter, minTime, repetitions, results);
+
+	if (output.empty()) {
+		Benchmark::report(cout, format, results, minTime, repetitions);
+	}
+	else {
+		ofstream file(output.c_str());
+		if (!file) {
+			cerr << "cannot write " << output << endl;
+			return 1;
+		}
+		Benchmark::report(file, format, results, minTime, repetitions);
+	}
+	return ok ? 0 : 1;
+}
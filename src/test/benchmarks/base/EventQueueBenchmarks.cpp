@@ -0,0 +1,92 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test/benchmarks/Benchmark.h"
+#include "test/global/TestEventQueue.h"
+#include "base/EventTypes.h"
+#include "base/TMethodEventJob.h"
+
+#include <algorithm>
+
+// posts events in batches and quits when all have been dispatched
+class EventPump {
+public:
+	EventPump(IEventQueue* events, UInt32 total, UInt32 batch) :
+		m_events(events),
+		m_type(events->forIStream().inputReady()),
+		m_total(total),
+		m_batch(batch),
+		m_posted(0),
+		m_count(0) { }
+
+	void				post()
+	{
+		UInt32 n = std::min(m_batch, m_total - m_posted);
+		for (UInt32 i = 0; i < n; ++i) {
+			m_events->addEvent(Event(m_type, this));
+		}
+		m_posted += n;
+	}
+
+	void				handle(const Event&, void*)
+	{
+		if (++m_count == m_total) {
+			m_events->addEvent(Event(Event::kQuit));
+		}
+		else if (m_count == m_posted) {
+			post();
+		}
+	}
+
+public:
+	IEventQueue*		m_events;
+	Event::Type			m_type;
+	UInt32				m_total;
+	UInt32				m_batch;
+	UInt32				m_posted;
+	UInt32				m_count;
+};
+
+// dispatches events through the event loop \p batch at a time
+static
+void
+dispatchEvents(BenchmarkRun& run, UInt32 batch)
+{
+	run.pauseTiming();
+	TestEventQueue events;
+	EventPump pump(&events, run.getIterations(), batch);
+	events.adoptHandler(pump.m_type, &pump,
+		new TMethodEventJob<EventPump>(&pump, &EventPump::handle));
+	run.resumeTiming();
+
+	pump.post();
+	events.loop();
+
+	run.pauseTiming();
+	run.setItems(pump.m_count);
+	events.removeHandlers(&pump);
+}
+
+BENCHMARK(EventQueue, dispatch_single)
+{
+	dispatchEvents(run, 1);
+}
+
+BENCHMARK(EventQueue, dispatch_batch64)
+{
+	dispatchEvents(run, 64);
+}
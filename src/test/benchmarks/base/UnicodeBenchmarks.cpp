@@ -0,0 +1,71 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test/benchmarks/Benchmark.h"
+#include "base/Unicode.h"
+
+// about 4kB of UTF-8 that is ascii or, if \p international, mixes in
+// two, three and four byte sequences
+static
+String
+makeText(bool international)
+{
+	const char* word = international ?
+		"gr\xc3\xbc\xc3\x9f \xe6\x97\xa5\xe6\x9c\xac \xf0\x9f\x98\x80 " :
+		"hello world ";
+	String text;
+	while (text.size() < 4096) {
+		text += word;
+	}
+	return text;
+}
+
+BENCHMARK(Unicode, UTF8ToUTF16_ascii)
+{
+	String text = makeText(false);
+	for (UInt32 i = 0; i < run.getIterations(); ++i) {
+		run.keep(static_cast<UInt32>(Unicode::UTF8ToUTF16(text).size()));
+	}
+	run.setBytes(static_cast<double>(text.size()) * run.getIterations());
+}
+
+BENCHMARK(Unicode, UTF8ToUTF16_international)
+{
+	String text = makeText(true);
+	for (UInt32 i = 0; i < run.getIterations(); ++i) {
+		run.keep(static_cast<UInt32>(Unicode::UTF8ToUTF16(text).size()));
+	}
+	run.setBytes(static_cast<double>(text.size()) * run.getIterations());
+}
+
+BENCHMARK(Unicode, UTF16ToUTF8_international)
+{
+	String text = Unicode::UTF8ToUTF16(makeText(true));
+	for (UInt32 i = 0; i < run.getIterations(); ++i) {
+		run.keep(static_cast<UInt32>(Unicode::UTF16ToUTF8(text).size()));
+	}
+	run.setBytes(static_cast<double>(text.size()) * run.getIterations());
+}
+
+BENCHMARK(Unicode, UTF8ToText_ascii)
+{
+	String text = makeText(false);
+	for (UInt32 i = 0; i < run.getIterations(); ++i) {
+		run.keep(static_cast<UInt32>(Unicode::UTF8ToText(text).size()));
+	}
+	run.setBytes(static_cast<double>(text.size()) * run.getIterations());
+}
@@ -0,0 +1,67 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test/benchmarks/Benchmark.h"
+#include "io/StreamBuffer.h"
+
+#include <algorithm>
+
+// writes \p writeSize bytes then drains them \p readSize at a time
+static
+void
+churn(BenchmarkRun& run, UInt32 writeSize, UInt32 readSize)
+{
+	std::vector<UInt8> data(writeSize, 0x5a);
+	StreamBuffer buffer;
+	for (UInt32 i = 0; i < run.getIterations(); ++i) {
+		buffer.write(&data[0], writeSize);
+		while (buffer.getSize() > 0) {
+			UInt32 n = std::min(readSize, buffer.getSize());
+			run.keep(*static_cast<const UInt8*>(buffer.peek(n)));
+			buffer.pop(n);
+		}
+	}
+	run.setBytes(static_cast<double>(writeSize) * run.getIterations());
+}
+
+BENCHMARK(StreamBuffer, churn_packet)
+{
+	// a typical input message
+	churn(run, 12, 12);
+}
+
+BENCHMARK(StreamBuffer, churn_largeWriteSmallReads)
+{
+	// clipboard data read back in socket sized pieces
+	churn(run, 64 * 1024, 1024);
+}
+
+BENCHMARK(StreamBuffer, churn_smallWritesBacklog)
+{
+	// many small writes queued behind a slow reader
+	StreamBuffer buffer;
+	UInt8 data[12] = { 0 };
+	for (UInt32 i = 0; i < run.getIterations(); ++i) {
+		buffer.write(data, sizeof(data));
+		if (buffer.getSize() >= 64 * 1024) {
+			UInt32 n = buffer.getSize();
+			run.keep(*static_cast<const UInt8*>(buffer.peek(n)));
+			buffer.pop(n);
+		}
+	}
+	run.setBytes(static_cast<double>(sizeof(data)) * run.getIterations());
+}
@@ -0,0 +1,220 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test/benchmarks/Benchmark.h"
+#include "test/global/TestEventQueue.h"
+#include "net/TCPSocket.h"
+#include "net/TCPListenSocket.h"
+#include "net/SocketMultiplexer.h"
+#include "net/NetworkAddress.h"
+#include "base/TMethodEventJob.h"
+
+#define BENCHMARK_PORT 24807
+#define BENCHMARK_HOST "localhost"
+
+// give up on a run that stops making progress
+static const double		s_timeout = 30.0;
+
+// bounces a message between two connected loopback sockets
+class PingPong {
+public:
+	PingPong(UInt32 size);
+	~PingPong();
+
+	//! Connect the sockets
+	void				connect();
+
+	//! Send \p count messages to the server and wait for each reply
+	void				run(UInt32 count);
+
+private:
+	void				handleConnecting(const Event&, void*);
+	void				handleConnected(const Event&, void*);
+	void				handleServerInputReady(const Event&, void*);
+	void				handleClientInputReady(const Event&, void*);
+
+	void				ping();
+
+private:
+	TestEventQueue		m_events;
+	SocketMultiplexer	m_multiplexer;
+	TCPListenSocket*	m_listen;
+	TCPSocket*			m_client;
+	IDataSocket*		m_server;
+	std::vector<UInt8>	m_message;
+	std::vector<UInt8>	m_buffer;
+	UInt32				m_received;
+	UInt32				m_remaining;
+	bool				m_connected;
+};
+
+PingPong::PingPong(UInt32 size) :
+	m_listen(NULL),
+	m_client(NULL),
+	m_server(NULL),
+	m_message(size, 0x5a),
+	m_buffer(size),
+	m_received(0),
+	m_remaining(0),
+	m_connected(false)
+{
+	// do nothing
+}
+
+PingPong::~PingPong()
+{
+	m_events.removeHandlers(m_listen);
+	if (m_client != NULL) {
+		m_events.removeHandlers(m_client->getEventTarget());
+	}
+	if (m_server != NULL) {
+		m_events.removeHandlers(m_server->getEventTarget());
+	}
+	delete m_client;
+	delete m_server;
+	delete m_listen;
+}
+
+void
+PingPong::connect()
+{
+	NetworkAddress address(BENCHMARK_HOST, BENCHMARK_PORT);
+	address.resolve();
+
+	m_listen = new TCPListenSocket(&m_events, &m_multiplexer);
+	m_events.adoptHandler(
+		m_events.forIListenSocket().connecting(), m_listen,
+		new TMethodEventJob<PingPong>(
+			this, &PingPong::handleConnecting));
+	m_listen->bind(address);
+
+	m_client = new TCPSocket(&m_events, &m_multiplexer);
+	m_events.adoptHandler(
+		m_events.forIDataSocket().connected(), m_client->getEventTarget(),
+		new TMethodEventJob<PingPong>(
+			this, &PingPong::handleConnected));
+	m_events.adoptHandler(
+		m_events.forIStream().inputReady(), m_client->getEventTarget(),
+		new TMethodEventJob<PingPong>(
+			this, &PingPong::handleClientInputReady));
+	m_client->connect(address);
+
+	m_events.initQuitTimeout(s_timeout);
+	m_events.loop();
+	m_events.cleanupQuitTimeout();
+}
+
+void
+PingPong::run(UInt32 count)
+{
+	m_remaining = count;
+	ping();
+
+	m_events.initQuitTimeout(s_timeout);
+	m_events.loop();
+	m_events.cleanupQuitTimeout();
+}
+
+void
+PingPong::ping()
+{
+	m_received = 0;
+	m_client->write(&m_message[0], static_cast<UInt32>(m_message.size()));
+}
+
+void
+PingPong::handleConnecting(const Event&, void*)
+{
+	m_server = m_listen->accept();
+	if (m_server == NULL) {
+		return;
+	}
+	m_events.adoptHandler(
+		m_events.forIStream().inputReady(), m_server->getEventTarget(),
+		new TMethodEventJob<PingPong>(
+			this, &PingPong::handleServerInputReady));
+
+	if (m_connected) {
+		m_events.raiseQuitEvent();
+	}
+}
+
+void
+PingPong::handleConnected(const Event&, void*)
+{
+	m_connected = true;
+	if (m_server != NULL) {
+		m_events.raiseQuitEvent();
+	}
+}
+
+void
+PingPong::handleServerInputReady(const Event&, void*)
+{
+	// echo everything back
+	UInt32 n;
+	while ((n = m_server->read(&m_buffer[0],
+							static_cast<UInt32>(m_buffer.size()))) > 0) {
+		m_server->write(&m_buffer[0], n);
+	}
+}
+
+void
+PingPong::handleClientInputReady(const Event&, void*)
+{
+	UInt32 n;
+	while ((n = m_client->read(&m_buffer[0],
+							static_cast<UInt32>(m_buffer.size()))) > 0) {
+		m_received += n;
+	}
+	if (m_received < m_message.size()) {
+		return;
+	}
+
+	if (--m_remaining == 0) {
+		m_events.raiseQuitEvent();
+	}
+	else {
+		ping();
+	}
+}
+
+// round trips \p size byte messages
+static
+void
+roundTrip(BenchmarkRun& run, UInt32 size)
+{
+	run.pauseTiming();
+	PingPong pingPong(size);
+	pingPong.connect();
+	run.resumeTiming();
+
+	pingPong.run(run.getIterations());
+
+	run.pauseTiming();
+	run.setBytes(2.0 * size * run.getIterations());
+}
+
+BENCHMARK(TCPSocket, roundTrip_small)
+{
+	roundTrip(run, 16);
+}
+
+BENCHMARK(TCPSocket, roundTrip_64k)
+{
+	roundTrip(run, 64 * 1024);
+}
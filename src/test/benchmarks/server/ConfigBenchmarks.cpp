@@ -0,0 +1,88 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test/benchmarks/Benchmark.h"
+#include "server/Config.h"
+#include "base/EventQueue.h"
+
+static const int		s_gridSize = 4;
+
+static
+String
+screenName(int x, int y)
+{
+	return synergy::string::sprintf("screen-%d-%d", x, y);
+}
+
+// lays out a square grid of screens.  every right edge is split in
+// two so lookups have to pick between links.
+static
+void
+makeGrid(Config& config)
+{
+	for (int y = 0; y < s_gridSize; ++y) {
+		for (int x = 0; x < s_gridSize; ++x) {
+			config.addScreen(screenName(x, y));
+		}
+	}
+	for (int y = 0; y < s_gridSize; ++y) {
+		for (int x = 0; x < s_gridSize; ++x) {
+			String name = screenName(x, y);
+			if (x + 1 < s_gridSize) {
+				config.connect(name, kRight, 0.0f, 0.5f,
+							screenName(x + 1, y), 0.0f, 1.0f);
+				config.connect(name, kRight, 0.5f, 1.0f,
+							screenName(x + 1, (y + 1) % s_gridSize),
+							0.0f, 1.0f);
+				config.connect(screenName(x + 1, y), kLeft, 0.0f, 1.0f,
+							name, 0.0f, 1.0f);
+			}
+			if (y + 1 < s_gridSize) {
+				config.connect(name, kBottom, 0.0f, 1.0f,
+							screenName(x, y + 1), 0.0f, 1.0f);
+				config.connect(screenName(x, y + 1), kTop, 0.0f, 1.0f,
+							name, 0.0f, 1.0f);
+			}
+		}
+	}
+}
+
+BENCHMARK(Config, getNeighbor)
+{
+	run.pauseTiming();
+	EventQueue events;
+	Config config(&events);
+	makeGrid(config);
+	std::vector<String> names;
+	for (int y = 0; y < s_gridSize; ++y) {
+		for (int x = 0; x < s_gridSize; ++x) {
+			names.push_back(screenName(x, y));
+		}
+	}
+	run.resumeTiming();
+
+	float position;
+	for (UInt32 i = 0; i < run.getIterations(); ++i) {
+		const String& name = names[i % names.size()];
+		EDirection dir = static_cast<EDirection>(
+							kFirstDirection + i % kNumDirections);
+		String neighbor = config.getNeighbor(name, dir,
+							(i % 100) / 100.0f, &position);
+		run.keep(static_cast<UInt32>(neighbor.size()));
+	}
+	run.setItems(run.getIterations());
+}
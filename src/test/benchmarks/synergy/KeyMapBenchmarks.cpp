@@ -0,0 +1,105 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test/benchmarks/Benchmark.h"
+#include "synergy/KeyMap.h"
+
+using synergy::KeyMap;
+
+static const char*		s_text = "The quick brown fox jumps over the lazy dog, "
+							"THEN 42 MORE DOGS!";
+
+static
+void
+addKey(KeyMap& keyMap, KeyID id, KeyButton button,
+				KeyModifierMask required, KeyModifierMask sensitive,
+				KeyModifierMask generates)
+{
+	KeyMap::KeyItem item;
+	item.m_id        = id;
+	item.m_group     = 0;
+	item.m_button    = button;
+	item.m_required  = required;
+	item.m_sensitive = sensitive;
+	item.m_generates = generates;
+	item.m_dead      = false;
+	item.m_lock      = false;
+	item.m_client    = 0;
+	keyMap.addKeyEntry(item);
+}
+
+// fills a key map like a US keyboard's printable keys
+static
+void
+makeKeyMap(KeyMap& keyMap)
+{
+	KeyButton button = 10;
+	for (char c = 'a'; c <= 'z'; ++c, ++button) {
+		addKey(keyMap, c, button, 0, KeyModifierShift, 0);
+		addKey(keyMap, c - 'a' + 'A', button,
+							KeyModifierShift, KeyModifierShift, 0);
+	}
+	const char* plain   = "1234567890-=[];',./ ";
+	const char* shifted = "!@#$%^&*()_+{}:\"<>? ";
+	for (int i = 0; plain[i] != '\0'; ++i, ++button) {
+		addKey(keyMap, plain[i], button, 0, KeyModifierShift, 0);
+		if (shifted[i] != plain[i]) {
+			addKey(keyMap, shifted[i], button,
+							KeyModifierShift, KeyModifierShift, 0);
+		}
+	}
+	addKey(keyMap, kKeyShift_L, button, 0, 0, KeyModifierShift);
+	keyMap.finish();
+}
+
+// maps each character in \p text in turn
+static
+void
+mapText(BenchmarkRun& run, const char* text)
+{
+	run.pauseTiming();
+	KeyMap keyMap;
+	makeKeyMap(keyMap);
+	run.resumeTiming();
+
+	KeyMap::Keystrokes keys;
+	KeyMap::ModifierToKeys activeModifiers;
+	const char* next = text;
+	for (UInt32 i = 0; i < run.getIterations(); ++i) {
+		if (*next == '\0') {
+			next = text;
+		}
+		KeyID id = static_cast<unsigned char>(*next++);
+		KeyModifierMask currentState = 0;
+		keys.clear();
+		activeModifiers.clear();
+		const KeyMap::KeyItem* item = keyMap.mapKey(keys, id, 0,
+							activeModifiers, currentState, 0, false);
+		run.keep(item != NULL ? item->m_button : 0);
+	}
+	run.setItems(run.getIterations());
+}
+
+BENCHMARK(KeyMap, mapKey_lowercase)
+{
+	mapText(run, "abcdefghijklmnopqrstuvwxyz");
+}
+
+BENCHMARK(KeyMap, mapKey_mixedText)
+{
+	mapText(run, s_text);
+}
@@ -0,0 +1,146 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test/benchmarks/Benchmark.h"
+#include "synergy/ProtocolUtil.h"
+#include "synergy/protocol_types.h"
+#include "io/IStream.h"
+#include "io/StreamBuffer.h"
+#include "base/String.h"
+
+#include <algorithm>
+#include <cstring>
+
+// keeps everything written and serves it back, lending it as one
+// frame if asked to
+class BufferStream : public synergy::IStream {
+public:
+	BufferStream(bool lend) : m_lend(lend) { }
+
+	virtual void		close() { }
+	virtual UInt32		read(void* buffer, UInt32 n)
+	{
+		n = std::min(n, m_buffer.getSize());
+		if (buffer != NULL && n > 0) {
+			memcpy(buffer, m_buffer.peek(n), n);
+		}
+		m_buffer.pop(n);
+		return n;
+	}
+	virtual void		write(const void* buffer, UInt32 n)
+	{
+		m_buffer.write(buffer, n);
+	}
+	virtual void		flush() { }
+	virtual void		shutdownInput() { }
+	virtual void		shutdownOutput() { }
+	virtual const UInt8*	lendFrame(UInt32& size)
+	{
+		size = m_buffer.getSize();
+		if (!m_lend || size == 0) {
+			return NULL;
+		}
+		return static_cast<const UInt8*>(m_buffer.peek(size));
+	}
+	virtual void		releaseFrame(UInt32 n) { m_buffer.pop(n); }
+	virtual void*		getEventTarget() const { return NULL; }
+	virtual bool		isReady() const { return m_buffer.getSize() != 0; }
+	virtual UInt32		getSize() const { return m_buffer.getSize(); }
+
+	void				clear() { m_buffer.pop(m_buffer.getSize()); }
+
+private:
+	bool				m_lend;
+	StreamBuffer		m_buffer;
+};
+
+BENCHMARK(ProtocolUtil, writef_mouseMove)
+{
+	BufferStream stream(false);
+	for (UInt32 i = 0; i < run.getIterations(); ++i) {
+		ProtocolUtil::writef(&stream, kMsgDMouseMove, i & 0x7fff, 100);
+		stream.clear();
+	}
+	run.setBytes(8.0 * run.getIterations());
+}
+
+BENCHMARK(ProtocolUtil, writef_clipboardChunk)
+{
+	String data(4096, 'x');
+	BufferStream stream(false);
+	for (UInt32 i = 0; i < run.getIterations(); ++i) {
+		ProtocolUtil::writef(&stream, kMsgDClipboard, 0, i, 1, &data);
+		stream.clear();
+	}
+	run.setBytes((10.0 + data.size()) * run.getIterations());
+}
+
+BENCHMARK(ProtocolUtil, readf_mouseMove_lent)
+{
+	BufferStream stream(true);
+	run.pauseTiming();
+	for (UInt32 i = 0; i < run.getIterations(); ++i) {
+		ProtocolUtil::writef(&stream, kMsgDMouseMove, i & 0x7fff, 100);
+	}
+	run.resumeTiming();
+
+	UInt8 code[4];
+	SInt16 x, y;
+	for (UInt32 i = 0; i < run.getIterations(); ++i) {
+		ProtocolUtil::readCode(&stream, code);
+		ProtocolUtil::readf(&stream, kMsgDMouseMove + 4, &x, &y);
+		run.keep(x);
+	}
+	run.setBytes(8.0 * run.getIterations());
+}
+
+BENCHMARK(ProtocolUtil, readf_mouseMove_unframed)
+{
+	BufferStream stream(false);
+	run.pauseTiming();
+	for (UInt32 i = 0; i < run.getIterations(); ++i) {
+		ProtocolUtil::writef(&stream, kMsgDMouseMove, i & 0x7fff, 100);
+	}
+	run.resumeTiming();
+
+	UInt8 code[4];
+	SInt16 x, y;
+	for (UInt32 i = 0; i < run.getIterations(); ++i) {
+		ProtocolUtil::readCode(&stream, code);
+		ProtocolUtil::readf(&stream, kMsgDMouseMove + 4, &x, &y);
+		run.keep(x);
+	}
+	run.setBytes(8.0 * run.getIterations());
+}
+
+BENCHMARK(ProtocolUtil, roundTrip_clipboardChunk)
+{
+	String data(4096, 'x');
+	BufferStream stream(true);
+	UInt8 code[4];
+	UInt8 id, mark;
+	UInt32 seq;
+	String chunk;
+	for (UInt32 i = 0; i < run.getIterations(); ++i) {
+		ProtocolUtil::writef(&stream, kMsgDClipboard, 0, i, 1, &data);
+		ProtocolUtil::readCode(&stream, code);
+		ProtocolUtil::readf(&stream, kMsgDClipboard + 4,
+							&id, &seq, &mark, &chunk);
+		run.keep(seq);
+	}
+	run.setBytes((10.0 + data.size()) * run.getIterations());
+}
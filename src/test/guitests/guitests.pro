@@ -7,9 +7,11 @@ CONFIG -= app_bundle
 TEMPLATE = app
 INCLUDEPATH += ../../gui/src
 SOURCES += src/main.cpp \
-    src/VersionCheckerTests.cpp
+    src/VersionCheckerTests.cpp \
+    src/LogBufferTests.cpp
 HEADERS += src/VersionCheckerTests.h \
-    src/VersionChecker.h
+    src/VersionChecker.h \
+    src/LogBufferTests.h
 win32 { 
     Debug:DESTDIR = ../../../bin/Debug
     Release:DESTDIR = ../../../bin/Release
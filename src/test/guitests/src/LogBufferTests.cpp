@@ -0,0 +1,85 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "LogBufferTests.h"
+#include "LogBuffer.cpp"
+#include "../../gui/tmp/debug/moc_LogBuffer.cpp"
+
+#include <QtTest/QTest>
+#include <QtTest/QSignalSpy>
+#include <QElapsedTimer>
+
+void LogBufferTests::appendManyLines_flushedOnceWithinTick()
+{
+	const int total = 100000;
+	const int maxLines = 10000;
+	LogBuffer buffer(maxLines, 50);
+	QSignalSpy spy(&buffer, SIGNAL(flushed(const QStringList&)));
+
+	QElapsedTimer timer;
+	timer.start();
+	for (int i = 0; i < total; i++) {
+		buffer.append(QString("line %1").arg(i));
+	}
+
+	// all lines from one burst are delivered in a single batch
+	QVERIFY(spy.wait(1000));
+	QVERIFY(timer.elapsed() < 1000);
+	QCOMPARE(spy.count(), 1);
+
+	// and only the newest lines that the widget would keep are rendered
+	QStringList lines = spy.at(0).at(0).toStringList();
+	QCOMPARE(lines.size(), maxLines);
+	QCOMPARE(lines.first(), QString("line %1").arg(total - maxLines));
+	QCOMPARE(lines.last(), QString("line %1").arg(total - 1));
+	QCOMPARE(buffer.pendingLines(), 0);
+}
+
+void LogBufferTests::flush_keepsOrderAcrossWrap()
+{
+	LogBuffer buffer(4, 1000);
+	QSignalSpy spy(&buffer, SIGNAL(flushed(const QStringList&)));
+
+	for (int i = 0; i < 6; i++) {
+		buffer.append(QString::number(i));
+	}
+	QCOMPARE(buffer.droppedLines(), 2);
+	buffer.flush();
+
+	QCOMPARE(spy.count(), 1);
+	QCOMPARE(spy.at(0).at(0).toStringList(),
+		QStringList() << "2" << "3" << "4" << "5");
+
+	// an empty buffer has nothing to render
+	buffer.flush();
+	QCOMPARE(spy.count(), 1);
+}
+
+void LogBufferTests::clear_dropsPendingLines()
+{
+	LogBuffer buffer(4, 10);
+	QSignalSpy spy(&buffer, SIGNAL(flushed(const QStringList&)));
+
+	buffer.append("stale");
+	buffer.clear();
+	QVERIFY(!spy.wait(100));
+
+	buffer.append("fresh");
+	QVERIFY(spy.wait(1000));
+	QCOMPARE(spy.at(0).at(0).toStringList(), QStringList() << "fresh");
+}
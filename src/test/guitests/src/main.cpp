@@ -17,10 +17,22 @@
  */
 
 #include <QtTest/QTest>
+#include <QCoreApplication>
 #include "VersionCheckerTests.h"
+#include "LogBufferTests.h"
 
 int main(int argc, char *argv[])
 {
+	// timers used by some of the tested classes need an event loop
+	QCoreApplication app(argc, argv);
+
+	int result = 0;
+
 	VersionCheckerTests versionCheckerTests;
-	QTest::qExec(&versionCheckerTests, argc, argv);
+	result |= QTest::qExec(&versionCheckerTests, argc, argv);
+
+	LogBufferTests logBufferTests;
+	result |= QTest::qExec(&logBufferTests, argc, argv);
+
+	return result;
 }
@@ -30,13 +30,17 @@
 #include "server/ClientProxy.h"
 #include "client/Client.h"
 #include "synergy/FileChunk.h"
+#include "synergy/FileSetReceiver.h"
 #include "synergy/StreamChunker.h"
 #include "net/SocketMultiplexer.h"
+#include "net/IOUringSocketPoller.h"
 #include "net/NetworkAddress.h"
 #include "net/TCPSocketFactory.h"
 #include "mt/Thread.h"
+#include "arch/Arch.h"
 #include "base/TMethodEventJob.h"
 #include "base/TMethodJob.h"
+#include "base/Stopwatch.h"
 #include "base/Log.h"
 #include "common/stdexcept.h"
 
@@ -45,6 +49,7 @@
 #include <fstream>
 #include <iostream>
 #include <stdio.h>
+#include <stdlib.h>
 
 using namespace std;
 using ::testing::_;
@@ -59,13 +64,17 @@ const size_t kMockDataSize = 1024 * 1024 * 10; // 10MB
 const UInt16 kMockDataChunkIncrement = 1024; // 1KB
 const char* kMockFilename = "NetworkTests.mock";
 const size_t kMockFileSize = 1024 * 1024 * 10; // 10MB
+const char* kMockSetDirectory = "NetworkTests.set";
+const size_t kMockSetFileSize = 1024 * 1024; // 1MB
 
 void getScreenShape(SInt32& x, SInt32& y, SInt32& w, SInt32& h);
 void getCursorPos(SInt32& x, SInt32& y);
 UInt8* newMockData(size_t size);
 void createFile(fstream& file, const char* filename, size_t size);
+String readFile(const String& filename);
 
-class NetworkTests : public ::testing::Test
+class NetworkTests :
+	public ::testing::TestWithParam<SocketMultiplexer::EPollBackend>
 {
 public:
 	NetworkTests() :
@@ -96,6 +105,20 @@ public:
 
 	void				sendToServer_mockFile_handleClientConnected(const Event&, void* vlistener);
 	void				sendToServer_mockFile_fileRecieveCompleted(const Event& event, void*);
+
+	void				sendToClient_fileSet_handleClientConnected(const Event&, void* vlistener);
+	void				sendToClient_fileSet_fileRecieveCompleted(const Event& event, void*);
+
+	void				sendToServer_fileSet_handleClientConnected(const Event&, void* vclient);
+	void				sendToServer_fileSet_fileRecieveCompleted(const Event& event, void*);
+
+	void				connect_failover_handleClientConnected(const Event&, void* vlistener);
+	void				connect_serverLost_handlePreferredConnected(const Event&, void* vlistener);
+	void				connect_serverLost_handleDisconnected(const Event&, void* vclient);
+
+	void				createMockFileSet();
+	void				removeMockFileSet();
+	void				checkReceivedFileSet(FileSetReceiver* fileSet);
 	
 public:
 	TestEventQueue		m_events;
@@ -103,9 +126,13 @@ public:
 	size_t				m_mockDataSize;
 	fstream				m_mockFile;
 	size_t				m_mockFileSize;
+	std::vector<String>	m_mockFileSet;
+	String				m_fileSetDir;
+	String				m_oldProfileDir;
+	Stopwatch			m_failoverTime;
 };
 
-TEST_F(NetworkTests, sendToClient_mockData)
+TEST_P(NetworkTests, sendToClient_mockData)
 {
 	// server and client
 	NetworkAddress serverAddress(TEST_HOST, TEST_PORT);
@@ -113,7 +140,7 @@ TEST_F(NetworkTests, sendToClient_mockData)
 	serverAddress.resolve();
 	
 	// server
-	SocketMultiplexer serverSocketMultiplexer;
+	SocketMultiplexer serverSocketMultiplexer(GetParam());
 	TCPSocketFactory* serverSocketFactory = new TCPSocketFactory(&m_events, &serverSocketMultiplexer);
 	ClientListener listener(serverAddress, serverSocketFactory, &m_events, false);
 	NiceMock<MockScreen> serverScreen;
@@ -137,7 +164,7 @@ TEST_F(NetworkTests, sendToClient_mockData)
 
 	// client
 	NiceMock<MockScreen> clientScreen;
-	SocketMultiplexer clientSocketMultiplexer;
+	SocketMultiplexer clientSocketMultiplexer(GetParam());
 	TCPSocketFactory* clientSocketFactory = new TCPSocketFactory(&m_events, &clientSocketMultiplexer);
 	
 	ON_CALL(clientScreen, getShape(_, _, _, _)).WillByDefault(Invoke(getScreenShape));
@@ -163,7 +190,7 @@ TEST_F(NetworkTests, sendToClient_mockData)
 	m_events.cleanupQuitTimeout();
 }
 
-TEST_F(NetworkTests, sendToClient_mockFile)
+TEST_P(NetworkTests, sendToClient_mockFile)
 {
 	// server and client
 	NetworkAddress serverAddress(TEST_HOST, TEST_PORT);
@@ -171,7 +198,7 @@ TEST_F(NetworkTests, sendToClient_mockFile)
 	serverAddress.resolve();
 	
 	// server
-	SocketMultiplexer serverSocketMultiplexer;
+	SocketMultiplexer serverSocketMultiplexer(GetParam());
 	TCPSocketFactory* serverSocketFactory = new TCPSocketFactory(&m_events, &serverSocketMultiplexer);
 	ClientListener listener(serverAddress, serverSocketFactory, &m_events, false);
 	NiceMock<MockScreen> serverScreen;
@@ -195,7 +222,7 @@ TEST_F(NetworkTests, sendToClient_mockFile)
 
 	// client
 	NiceMock<MockScreen> clientScreen;
-	SocketMultiplexer clientSocketMultiplexer;
+	SocketMultiplexer clientSocketMultiplexer(GetParam());
 	TCPSocketFactory* clientSocketFactory = new TCPSocketFactory(&m_events, &clientSocketMultiplexer);
 	
 	ON_CALL(clientScreen, getShape(_, _, _, _)).WillByDefault(Invoke(getScreenShape));
@@ -221,14 +248,14 @@ TEST_F(NetworkTests, sendToClient_mockFile)
 	m_events.cleanupQuitTimeout();
 }
 
-TEST_F(NetworkTests, sendToServer_mockData)
+TEST_P(NetworkTests, sendToServer_mockData)
 {
 	// server and client
 	NetworkAddress serverAddress(TEST_HOST, TEST_PORT);
 	serverAddress.resolve();
 
 	// server
-	SocketMultiplexer serverSocketMultiplexer;
+	SocketMultiplexer serverSocketMultiplexer(GetParam());
 	TCPSocketFactory* serverSocketFactory = new TCPSocketFactory(&m_events, &serverSocketMultiplexer);
 	ClientListener listener(serverAddress, serverSocketFactory, &m_events, false);
 	NiceMock<MockScreen> serverScreen;
@@ -247,7 +274,7 @@ TEST_F(NetworkTests, sendToServer_mockData)
 
 	// client
 	NiceMock<MockScreen> clientScreen;
-	SocketMultiplexer clientSocketMultiplexer;
+	SocketMultiplexer clientSocketMultiplexer(GetParam());
 	TCPSocketFactory* clientSocketFactory = new TCPSocketFactory(&m_events, &clientSocketMultiplexer);
 	
 	ON_CALL(clientScreen, getShape(_, _, _, _)).WillByDefault(Invoke(getScreenShape));
@@ -277,7 +304,7 @@ TEST_F(NetworkTests, sendToServer_mockData)
 	m_events.cleanupQuitTimeout();
 }
 
-TEST_F(NetworkTests, sendToServer_mockFile)
+TEST_P(NetworkTests, sendToServer_mockFile)
 {
 	// server and client
 	NetworkAddress serverAddress(TEST_HOST, TEST_PORT);
@@ -285,7 +312,7 @@ TEST_F(NetworkTests, sendToServer_mockFile)
 	serverAddress.resolve();
 
 	// server
-	SocketMultiplexer serverSocketMultiplexer;
+	SocketMultiplexer serverSocketMultiplexer(GetParam());
 	TCPSocketFactory* serverSocketFactory = new TCPSocketFactory(&m_events, &serverSocketMultiplexer);
 	ClientListener listener(serverAddress, serverSocketFactory, &m_events, false);
 	NiceMock<MockScreen> serverScreen;
@@ -304,7 +331,7 @@ TEST_F(NetworkTests, sendToServer_mockFile)
 
 	// client
 	NiceMock<MockScreen> clientScreen;
-	SocketMultiplexer clientSocketMultiplexer;
+	SocketMultiplexer clientSocketMultiplexer(GetParam());
 	TCPSocketFactory* clientSocketFactory = new TCPSocketFactory(&m_events, &clientSocketMultiplexer);
 	
 	ON_CALL(clientScreen, getShape(_, _, _, _)).WillByDefault(Invoke(getScreenShape));
@@ -334,6 +361,279 @@ TEST_F(NetworkTests, sendToServer_mockFile)
 	m_events.cleanupQuitTimeout();
 }
 
+TEST_P(NetworkTests, sendToClient_fileSet)
+{
+	createMockFileSet();
+
+	// server and client
+	NetworkAddress serverAddress(TEST_HOST, TEST_PORT);
+	serverAddress.resolve();
+
+	// server
+	SocketMultiplexer serverSocketMultiplexer(GetParam());
+	TCPSocketFactory* serverSocketFactory = new TCPSocketFactory(&m_events, &serverSocketMultiplexer);
+	ClientListener listener(serverAddress, serverSocketFactory, &m_events, false);
+	NiceMock<MockScreen> serverScreen;
+	NiceMock<MockPrimaryClient> primaryClient;
+	NiceMock<MockConfig> serverConfig;
+	NiceMock<MockInputFilter> serverInputFilter;
+
+	m_events.adoptHandler(
+		m_events.forClientListener().connected(), &listener,
+		new TMethodEventJob<NetworkTests>(
+			this, &NetworkTests::sendToClient_fileSet_handleClientConnected, &listener));
+
+	ON_CALL(serverConfig, isScreen(_)).WillByDefault(Return(true));
+	ON_CALL(serverConfig, getInputFilter()).WillByDefault(Return(&serverInputFilter));
+
+	ServerArgs serverArgs;
+	serverArgs.m_enableDragDrop = true;
+	Server server(serverConfig, &primaryClient, &serverScreen, &m_events, serverArgs);
+	server.m_mock = true;
+	listener.setServer(&server);
+
+	// client
+	NiceMock<MockScreen> clientScreen;
+	SocketMultiplexer clientSocketMultiplexer(GetParam());
+	TCPSocketFactory* clientSocketFactory = new TCPSocketFactory(&m_events, &clientSocketMultiplexer);
+
+	ON_CALL(clientScreen, getShape(_, _, _, _)).WillByDefault(Invoke(getScreenShape));
+	ON_CALL(clientScreen, getCursorPos(_, _)).WillByDefault(Invoke(getCursorPos));
+
+	ClientArgs clientArgs;
+	clientArgs.m_enableDragDrop = true;
+	clientArgs.m_enableCrypto = false;
+	Client client(&m_events, "stub", serverAddress, clientSocketFactory, &clientScreen, clientArgs);
+
+	m_events.adoptHandler(
+		m_events.forFile().fileRecieveCompleted(), &client,
+		new TMethodEventJob<NetworkTests>(
+			this, &NetworkTests::sendToClient_fileSet_fileRecieveCompleted));
+
+	client.connect();
+
+	m_events.initQuitTimeout(10);
+	m_events.loop();
+	m_events.removeHandler(m_events.forClientListener().connected(), &listener);
+	m_events.removeHandler(m_events.forFile().fileRecieveCompleted(), &client);
+	m_events.cleanupQuitTimeout();
+
+	removeMockFileSet();
+}
+
+TEST_P(NetworkTests, sendToServer_fileSet)
+{
+	createMockFileSet();
+
+	// server and client
+	NetworkAddress serverAddress(TEST_HOST, TEST_PORT);
+	serverAddress.resolve();
+
+	// server
+	SocketMultiplexer serverSocketMultiplexer(GetParam());
+	TCPSocketFactory* serverSocketFactory = new TCPSocketFactory(&m_events, &serverSocketMultiplexer);
+	ClientListener listener(serverAddress, serverSocketFactory, &m_events, false);
+	NiceMock<MockScreen> serverScreen;
+	NiceMock<MockPrimaryClient> primaryClient;
+	NiceMock<MockConfig> serverConfig;
+	NiceMock<MockInputFilter> serverInputFilter;
+
+	ON_CALL(serverConfig, isScreen(_)).WillByDefault(Return(true));
+	ON_CALL(serverConfig, getInputFilter()).WillByDefault(Return(&serverInputFilter));
+
+	ServerArgs serverArgs;
+	serverArgs.m_enableDragDrop = true;
+	Server server(serverConfig, &primaryClient, &serverScreen, &m_events, serverArgs);
+	server.m_mock = true;
+	listener.setServer(&server);
+
+	// client
+	NiceMock<MockScreen> clientScreen;
+	SocketMultiplexer clientSocketMultiplexer(GetParam());
+	TCPSocketFactory* clientSocketFactory = new TCPSocketFactory(&m_events, &clientSocketMultiplexer);
+
+	ON_CALL(clientScreen, getShape(_, _, _, _)).WillByDefault(Invoke(getScreenShape));
+	ON_CALL(clientScreen, getCursorPos(_, _)).WillByDefault(Invoke(getCursorPos));
+
+	ClientArgs clientArgs;
+	clientArgs.m_enableDragDrop = true;
+	clientArgs.m_enableCrypto = false;
+	Client client(&m_events, "stub", serverAddress, clientSocketFactory, &clientScreen, clientArgs);
+
+	m_events.adoptHandler(
+		m_events.forClientListener().connected(), &listener,
+		new TMethodEventJob<NetworkTests>(
+			this, &NetworkTests::sendToServer_fileSet_handleClientConnected, &client));
+
+	m_events.adoptHandler(
+		m_events.forFile().fileRecieveCompleted(), &server,
+		new TMethodEventJob<NetworkTests>(
+			this, &NetworkTests::sendToServer_fileSet_fileRecieveCompleted));
+
+	client.connect();
+
+	m_events.initQuitTimeout(10);
+	m_events.loop();
+	m_events.removeHandler(m_events.forClientListener().connected(), &listener);
+	m_events.removeHandler(m_events.forFile().fileRecieveCompleted(), &server);
+	m_events.cleanupQuitTimeout();
+
+	removeMockFileSet();
+}
+
+TEST_P(NetworkTests, connect_firstServerDown_failsOver)
+{
+	// nothing listens on the preferred server
+	NetworkAddress deadAddress(TEST_HOST, TEST_PORT + 1);
+	NetworkAddress serverAddress(TEST_HOST, TEST_PORT);
+
+	serverAddress.resolve();
+
+	// standby server
+	SocketMultiplexer serverSocketMultiplexer(GetParam());
+	TCPSocketFactory* serverSocketFactory = new TCPSocketFactory(&m_events, &serverSocketMultiplexer);
+	ClientListener listener(serverAddress, serverSocketFactory, &m_events, false);
+	NiceMock<MockScreen> serverScreen;
+	NiceMock<MockPrimaryClient> primaryClient;
+	NiceMock<MockConfig> serverConfig;
+	NiceMock<MockInputFilter> serverInputFilter;
+
+	m_events.adoptHandler(
+		m_events.forClientListener().connected(), &listener,
+		new TMethodEventJob<NetworkTests>(
+			this, &NetworkTests::connect_failover_handleClientConnected, &listener));
+
+	ON_CALL(serverConfig, isScreen(_)).WillByDefault(Return(true));
+	ON_CALL(serverConfig, getInputFilter()).WillByDefault(Return(&serverInputFilter));
+
+	ServerArgs serverArgs;
+	Server server(serverConfig, &primaryClient, &serverScreen, &m_events, serverArgs);
+	server.m_mock = true;
+	listener.setServer(&server);
+
+	// client
+	NiceMock<MockScreen> clientScreen;
+	SocketMultiplexer clientSocketMultiplexer(GetParam());
+	TCPSocketFactory* clientSocketFactory = new TCPSocketFactory(&m_events, &clientSocketMultiplexer);
+
+	ON_CALL(clientScreen, getShape(_, _, _, _)).WillByDefault(Invoke(getScreenShape));
+	ON_CALL(clientScreen, getCursorPos(_, _)).WillByDefault(Invoke(getCursorPos));
+
+	ClientArgs clientArgs;
+	clientArgs.m_enableCrypto = false;
+	Client client(&m_events, "stub", deadAddress, clientSocketFactory, &clientScreen, clientArgs);
+	client.addServerAddress(serverAddress);
+	EXPECT_EQ(2u, client.getNumServerAddresses());
+
+	client.connect();
+
+	m_events.initQuitTimeout(10);
+	m_events.loop();
+	m_events.removeHandler(m_events.forClientListener().connected(), &listener);
+	m_events.cleanupQuitTimeout();
+
+	EXPECT_EQ(TEST_PORT, client.getServerAddress().getPort());
+}
+
+TEST_P(NetworkTests, connect_serverLost_reconnectsToStandby)
+{
+	// ports of their own.  a closed listen socket can linger until the
+	// multiplexer thread's next pass, so rebinding one straight away may
+	// fail.
+	NetworkAddress preferredAddress(TEST_HOST, TEST_PORT + 2);
+	NetworkAddress standbyAddress(TEST_HOST, TEST_PORT + 3);
+
+	preferredAddress.resolve();
+	standbyAddress.resolve();
+
+	// both servers.  the preferred one is shut down once the client has
+	// connected to it.
+	SocketMultiplexer serverSocketMultiplexer(GetParam());
+	ClientListener* preferred = new ClientListener(preferredAddress,
+							new TCPSocketFactory(&m_events, &serverSocketMultiplexer),
+							&m_events, false);
+	ClientListener standby(standbyAddress,
+							new TCPSocketFactory(&m_events, &serverSocketMultiplexer),
+							&m_events, false);
+	NiceMock<MockScreen> serverScreen;
+	NiceMock<MockPrimaryClient> primaryClient;
+	NiceMock<MockConfig> serverConfig;
+	NiceMock<MockInputFilter> serverInputFilter;
+
+	m_events.adoptHandler(
+		m_events.forClientListener().connected(), preferred,
+		new TMethodEventJob<NetworkTests>(
+			this, &NetworkTests::connect_serverLost_handlePreferredConnected, preferred));
+	m_events.adoptHandler(
+		m_events.forClientListener().connected(), &standby,
+		new TMethodEventJob<NetworkTests>(
+			this, &NetworkTests::connect_failover_handleClientConnected, &standby));
+
+	ON_CALL(serverConfig, isScreen(_)).WillByDefault(Return(true));
+	ON_CALL(serverConfig, getInputFilter()).WillByDefault(Return(&serverInputFilter));
+
+	ServerArgs serverArgs;
+	Server server(serverConfig, &primaryClient, &serverScreen, &m_events, serverArgs);
+	server.m_mock = true;
+	preferred->setServer(&server);
+	standby.setServer(&server);
+
+	// client
+	NiceMock<MockScreen> clientScreen;
+	SocketMultiplexer clientSocketMultiplexer(GetParam());
+	TCPSocketFactory* clientSocketFactory = new TCPSocketFactory(&m_events, &clientSocketMultiplexer);
+
+	ON_CALL(clientScreen, getShape(_, _, _, _)).WillByDefault(Invoke(getScreenShape));
+	ON_CALL(clientScreen, getCursorPos(_, _)).WillByDefault(Invoke(getCursorPos));
+
+	ClientArgs clientArgs;
+	clientArgs.m_enableCrypto = false;
+	Client client(&m_events, "stub", preferredAddress, clientSocketFactory, &clientScreen, clientArgs);
+	client.addServerAddress(standbyAddress);
+
+	// reconnect as soon as the server goes, like ClientApp does
+	m_events.adoptHandler(
+		m_events.forClient().disconnected(), client.getEventTarget(),
+		new TMethodEventJob<NetworkTests>(
+			this, &NetworkTests::connect_serverLost_handleDisconnected, &client));
+
+	client.connect();
+
+	m_events.initQuitTimeout(10);
+	m_events.loop();
+	m_events.removeHandler(m_events.forClientListener().connected(), preferred);
+	m_events.removeHandler(m_events.forClientListener().connected(), &standby);
+	m_events.removeHandler(m_events.forClient().disconnected(), client.getEventTarget());
+	m_events.cleanupQuitTimeout();
+
+	EXPECT_EQ(TEST_PORT + 3, client.getServerAddress().getPort());
+	EXPECT_LT(m_failoverTime.getTime(), 2.0);
+}
+
+// run every test against each readiness backend.  the io_uring backend
+// falls back to poll on kernels that lack it so it's only instantiated
+// where it's available, rather than quietly testing poll twice.
+static std::vector<SocketMultiplexer::EPollBackend>
+getAvailableBackends()
+{
+	std::vector<SocketMultiplexer::EPollBackend> backends;
+	backends.push_back(SocketMultiplexer::kPollBackend);
+
+	IOUringSocketPoller* poller = IOUringSocketPoller::create();
+	if (poller != NULL) {
+		delete poller;
+		backends.push_back(SocketMultiplexer::kIOUringBackend);
+	}
+	else {
+		LOG((CLOG_WARN "io_uring is not available, not testing its backend"));
+	}
+	return backends;
+}
+
+INSTANTIATE_TEST_CASE_P(
+	Backends, NetworkTests,
+	::testing::ValuesIn(getAvailableBackends()));
+
 void 
 NetworkTests::sendToClient_mockData_handleClientConnected(const Event&, void* vlistener)
 {
@@ -420,6 +720,124 @@ NetworkTests::sendToServer_mockFile_fileRecieveCompleted(const Event& event, voi
 	m_events.raiseQuitEvent();
 }
 
+void 
+NetworkTests::sendToClient_fileSet_handleClientConnected(const Event&, void* vlistener)
+{
+	ClientListener* listener = static_cast<ClientListener*>(vlistener);
+	Server* server = listener->getServer();
+
+	ClientProxy* client = listener->getNextClient();
+	if (client == NULL) {
+		throw runtime_error("client is null");
+	}
+
+	BaseClientProxy* bcp = client;
+	server->adoptClient(bcp);
+	server->setActive(bcp);
+
+	EXPECT_TRUE(server->sendFilesToClient(m_mockFileSet));
+}
+
+void 
+NetworkTests::sendToClient_fileSet_fileRecieveCompleted(const Event& event, void*)
+{
+	Client* client = static_cast<Client*>(event.getTarget());
+	checkReceivedFileSet(client->getReceivedFileSet());
+
+	m_events.raiseQuitEvent();
+}
+
+void 
+NetworkTests::sendToServer_fileSet_handleClientConnected(const Event&, void* vclient)
+{
+	Client* client = static_cast<Client*>(vclient);
+	EXPECT_TRUE(client->sendFilesToServer(m_mockFileSet));
+}
+
+void 
+NetworkTests::sendToServer_fileSet_fileRecieveCompleted(const Event& event, void*)
+{
+	Server* server = static_cast<Server*>(event.getTarget());
+	checkReceivedFileSet(server->getReceivedFileSet());
+
+	m_events.raiseQuitEvent();
+}
+
+void
+NetworkTests::createMockFileSet()
+{
+	// the set, the profile directory that received sets are staged
+	// under and the drop directory all live in a private directory
+	char dirTemplate[] = "/tmp/synergy-setXXXXXX";
+	ASSERT_TRUE(mkdtemp(dirTemplate) != NULL);
+	m_fileSetDir = dirTemplate;
+	m_oldProfileDir = ARCH->getProfileDirectory();
+	ARCH->setProfileDirectory(ARCH->concatPath(m_fileSetDir, "profile"));
+
+	String set = ARCH->concatPath(m_fileSetDir, kMockSetDirectory);
+	String sub = ARCH->concatPath(set, "sub");
+	String deeper = ARCH->concatPath(sub, "deeper");
+	ARCH->makeDirectory(set);
+	ARCH->makeDirectory(sub);
+	ARCH->makeDirectory(deeper);
+	ARCH->makeDirectory(ARCH->concatPath(set, "empty"));
+
+	fstream file;
+	createFile(file, ARCH->concatPath(set, "small").c_str(), 100);
+	createFile(file, ARCH->concatPath(sub, "large").c_str(), kMockSetFileSize);
+	file.open(ARCH->concatPath(deeper, "zero").c_str(), ios::out | ios::binary);
+	file.close();
+
+	m_mockFileSet.clear();
+	m_mockFileSet.push_back(set);
+	m_mockFileSet.push_back(kMockFilename);
+}
+
+void
+NetworkTests::removeMockFileSet()
+{
+	ARCH->setProfileDirectory(m_oldProfileDir);
+	if (!m_fileSetDir.empty()) {
+		FileSetReceiver::removeTree(m_fileSetDir);
+		m_fileSetDir.clear();
+	}
+}
+
+void
+NetworkTests::checkReceivedFileSet(FileSetReceiver* fileSet)
+{
+	ASSERT_TRUE(fileSet != NULL);
+	EXPECT_TRUE(fileSet->isComplete());
+	EXPECT_EQ(4U, fileSet->getFileCount());
+	EXPECT_EQ(0U, fileSet->getFailedCount());
+	ASSERT_EQ(2U, fileSet->getNames().size());
+
+	String drop = ARCH->concatPath(m_fileSetDir, "drop");
+	ARCH->makeDirectory(drop);
+	EXPECT_TRUE(fileSet->moveTo(drop));
+
+	EXPECT_TRUE(ARCH->isDirectory(ARCH->concatPath(
+		ARCH->concatPath(drop, kMockSetDirectory), "empty")));
+
+	// relative to the directory holding each copy of the set
+	const char* files[] = {
+		"NetworkTests.set/small",
+		"NetworkTests.set/sub/large",
+		"NetworkTests.set/sub/deeper/zero"
+	};
+	for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); ++i) {
+		String original = readFile(ARCH->concatPath(m_fileSetDir, files[i]));
+		String received = readFile(ARCH->concatPath(drop, files[i]));
+		EXPECT_EQ(original.size(), received.size()) << files[i];
+		EXPECT_TRUE(original == received) << files[i];
+	}
+
+	String original = readFile(kMockFilename);
+	String received = readFile(ARCH->concatPath(drop, kMockFilename));
+	EXPECT_EQ(original.size(), received.size()) << kMockFilename;
+	EXPECT_TRUE(original == received) << kMockFilename;
+}
+
 void 
 NetworkTests::sendMockData(void* eventTarget)
 {
@@ -458,6 +876,40 @@ NetworkTests::sendMockData(void* eventTarget)
 	m_events.addEvent(Event(m_events.forFile().fileChunkSending(), eventTarget, transferFinished));
 }
 
+void
+NetworkTests::connect_failover_handleClientConnected(const Event&, void* vlistener)
+{
+	ClientListener* listener = static_cast<ClientListener*>(vlistener);
+	Server* server = listener->getServer();
+
+	ClientProxy* client = listener->getNextClient();
+	if (client == NULL) {
+		throw runtime_error("client is null");
+	}
+
+	BaseClientProxy* bcp = client;
+	server->adoptClient(bcp);
+
+	m_events.raiseQuitEvent();
+}
+
+void
+NetworkTests::connect_serverLost_handlePreferredConnected(const Event&, void* vlistener)
+{
+	// drop the client and stop listening
+	ClientListener* listener = static_cast<ClientListener*>(vlistener);
+	delete listener->getNextClient();
+	delete listener;
+}
+
+void
+NetworkTests::connect_serverLost_handleDisconnected(const Event&, void* vclient)
+{
+	Client* client = static_cast<Client*>(vclient);
+	m_failoverTime.reset();
+	client->connect();
+}
+
 UInt8*
 newMockData(size_t size)
 {
@@ -506,6 +958,15 @@ createFile(fstream& file, const char* filename, size_t size)
 	delete[] buffer;
 }
 
+String
+readFile(const String& filename)
+{
+	ifstream file(filename.c_str(), ios::in | ios::binary);
+	ostringstream data;
+	data << file.rdbuf();
+	return data.str();
+}
+
 void
 getScreenShape(SInt32& x, SInt32& y, SInt32& w, SInt32& h)
 {
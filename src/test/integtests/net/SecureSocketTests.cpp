@@ -0,0 +1,288 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_ENV
+
+#include "test/global/TestEventQueue.h"
+#include "net/SecureSocket.h"
+#include "net/SocketMultiplexer.h"
+#include "net/NetworkAddress.h"
+#include "net/TCPSocketFactory.h"
+#include "net/IListenSocket.h"
+#include "arch/Arch.h"
+#include "base/TMethodEventJob.h"
+#include "base/String.h"
+
+#include "test/global/gtest.h"
+
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/rsa.h>
+#include <openssl/x509.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <fstream>
+#include <vector>
+#include <cstring>
+
+#define TEST_PORT 24804
+#define TEST_HOST "localhost"
+
+const size_t kPayloadSize = 256 * 1024;
+
+// parameters are kernel tls enabled on the server and the client
+class SecureSocketTests :
+	public ::testing::TestWithParam< ::std::tr1::tuple<bool, bool> >
+{
+public:
+	SecureSocketTests() :
+		m_listen(NULL),
+		m_server(NULL),
+		m_client(NULL),
+		m_received(0)
+	{
+	}
+
+	virtual void		SetUp();
+	virtual void		TearDown();
+
+	void				handleConnecting(const Event&, void*);
+	void				handleSecureConnected(const Event&, void*);
+	void				handleServerInputReady(const Event&, void*);
+	void				checkKernelTls(IDataSocket* socket, bool enabled,
+							const char* side);
+
+public:
+	TestEventQueue		m_events;
+	String				m_oldProfileDir;
+	String				m_profileDir;
+	IListenSocket*		m_listen;
+	IDataSocket*		m_server;
+	IDataSocket*		m_client;
+	std::vector<UInt8>	m_payload;
+	size_t				m_received;
+	bool				m_mismatch;
+};
+
+// writes a self signed certificate to <profile>/SSL/Synergy.pem and trusts
+// it from <profile>/SSL/Fingerprints/TrustedServers.txt
+static void
+createTestCertificate(const String& profileDir)
+{
+	String sslDir = profileDir + "/SSL";
+	String fingerprintDir = sslDir + "/Fingerprints";
+	mkdir(sslDir.c_str(), 0700);
+	mkdir(fingerprintDir.c_str(), 0700);
+
+	EVP_PKEY* key = NULL;
+	EVP_PKEY_CTX* keyContext = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, NULL);
+	EVP_PKEY_keygen_init(keyContext);
+	EVP_PKEY_CTX_set_rsa_keygen_bits(keyContext, 2048);
+	EVP_PKEY_keygen(keyContext, &key);
+	EVP_PKEY_CTX_free(keyContext);
+
+	X509* cert = X509_new();
+	ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+	X509_gmtime_adj(X509_get_notBefore(cert), 0);
+	X509_gmtime_adj(X509_get_notAfter(cert), 60 * 60);
+	X509_set_pubkey(cert, key);
+	X509_NAME* name = X509_get_subject_name(cert);
+	X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+		reinterpret_cast<const unsigned char*>("Synergy"), -1, -1, 0);
+	X509_set_issuer_name(cert, name);
+	X509_sign(cert, key, EVP_sha256());
+
+	String pemFilename = sslDir + "/Synergy.pem";
+	FILE* pem = fopen(pemFilename.c_str(), "w");
+	ASSERT_TRUE(pem != NULL);
+	PEM_write_PrivateKey(pem, key, NULL, NULL, 0, NULL, NULL);
+	PEM_write_X509(pem, cert);
+	fclose(pem);
+
+	unsigned char digest[EVP_MAX_MD_SIZE];
+	unsigned int digestLen = 0;
+	X509_digest(cert, EVP_sha1(), digest, &digestLen);
+
+	String fingerprint;
+	for (unsigned int i = 0; i < digestLen; ++i) {
+		if (i != 0) {
+			fingerprint += ":";
+		}
+		fingerprint += synergy::string::sprintf("%02X", digest[i]);
+	}
+
+	std::ofstream trusted((fingerprintDir + "/TrustedServers.txt").c_str());
+	trusted << fingerprint << std::endl;
+
+	X509_free(cert);
+	EVP_PKEY_free(key);
+}
+
+void
+SecureSocketTests::SetUp()
+{
+	char dirTemplate[] = "/tmp/synergy-sslXXXXXX";
+	ASSERT_TRUE(mkdtemp(dirTemplate) != NULL);
+	m_profileDir = dirTemplate;
+	m_oldProfileDir = ARCH->getProfileDirectory();
+	ARCH->setProfileDirectory(m_profileDir);
+	createTestCertificate(m_profileDir);
+
+	m_payload.resize(kPayloadSize);
+	for (size_t i = 0; i < kPayloadSize; ++i) {
+		m_payload[i] = static_cast<UInt8>(i * 31 + (i >> 8));
+	}
+	m_mismatch = false;
+}
+
+void
+SecureSocketTests::TearDown()
+{
+	ARCH->setProfileDirectory(m_oldProfileDir);
+	SecureSocket::setKernelTlsEnabled(true);
+
+	String sslDir = m_profileDir + "/SSL";
+	remove((sslDir + "/Fingerprints/TrustedServers.txt").c_str());
+	rmdir((sslDir + "/Fingerprints").c_str());
+	remove((sslDir + "/Synergy.pem").c_str());
+	rmdir(sslDir.c_str());
+	rmdir(m_profileDir.c_str());
+}
+
+TEST_P(SecureSocketTests, sendToServer_payloadIntact)
+{
+	NetworkAddress address(TEST_HOST, TEST_PORT);
+	address.resolve();
+
+	SocketMultiplexer multiplexer;
+	TCPSocketFactory factory(&m_events, &multiplexer);
+
+	m_listen = factory.createListen(true);
+	m_events.adoptHandler(
+		m_events.forIListenSocket().connecting(), m_listen,
+		new TMethodEventJob<SecureSocketTests>(
+			this, &SecureSocketTests::handleConnecting));
+	m_listen->bind(address);
+
+	// the setting is read when a socket initializes its context
+	SecureSocket::setKernelTlsEnabled(::std::tr1::get<1>(GetParam()));
+	m_client = factory.create(true);
+	m_events.adoptHandler(
+		m_events.forIDataSocket().secureConnected(),
+		m_client->getEventTarget(),
+		new TMethodEventJob<SecureSocketTests>(
+			this, &SecureSocketTests::handleSecureConnected));
+	m_client->connect(address);
+
+	m_events.initQuitTimeout(10);
+	m_events.loop();
+	m_events.cleanupQuitTimeout();
+
+	m_events.removeHandler(
+		m_events.forIListenSocket().connecting(), m_listen);
+	m_events.removeHandler(
+		m_events.forIDataSocket().secureConnected(),
+		m_client->getEventTarget());
+	if (m_server != NULL) {
+		m_events.removeHandler(
+			m_events.forIStream().inputReady(),
+			m_server->getEventTarget());
+	}
+
+	EXPECT_EQ(kPayloadSize, m_received);
+	EXPECT_FALSE(m_mismatch);
+
+	bool serverEnabled = ::std::tr1::get<0>(GetParam());
+	bool clientEnabled = ::std::tr1::get<1>(GetParam());
+	ASSERT_TRUE(m_server != NULL);
+	checkKernelTls(m_server, serverEnabled, "server");
+	checkKernelTls(m_client, clientEnabled, "client");
+
+	// both ends run on the same kernel so where both asked for offload
+	// they either both got it or neither did
+	if (serverEnabled && clientEnabled) {
+		EXPECT_EQ(
+			static_cast<SecureSocket*>(m_server)->isKernelTlsSend(),
+			static_cast<SecureSocket*>(m_client)->isKernelTlsSend());
+	}
+
+	// the listen socket owns the sockets it accepted
+	delete m_client;
+	delete m_listen;
+}
+
+INSTANTIATE_TEST_CASE_P(
+	KernelTls, SecureSocketTests,
+	::testing::Combine(::testing::Bool(), ::testing::Bool()));
+
+void
+SecureSocketTests::checkKernelTls(IDataSocket* socket, bool enabled,
+				const char* side)
+{
+	SecureSocket* secure = dynamic_cast<SecureSocket*>(socket);
+	ASSERT_TRUE(secure != NULL) << side;
+
+	// whether enabled offload is used depends on the kernel and openssl
+	// so only report it, but it must never be used when disabled
+	String prefix(side);
+	RecordProperty((prefix + "KernelTlsSend").c_str(),
+		secure->isKernelTlsSend() ? 1 : 0);
+	RecordProperty((prefix + "KernelTlsRecv").c_str(),
+		secure->isKernelTlsRecv() ? 1 : 0);
+	if (!enabled) {
+		EXPECT_FALSE(secure->isKernelTlsSend()) << side;
+		EXPECT_FALSE(secure->isKernelTlsRecv()) << side;
+	}
+}
+
+void
+SecureSocketTests::handleConnecting(const Event&, void*)
+{
+	SecureSocket::setKernelTlsEnabled(::std::tr1::get<0>(GetParam()));
+	m_server = m_listen->accept();
+	ASSERT_TRUE(m_server != NULL);
+
+	m_events.adoptHandler(
+		m_events.forIStream().inputReady(), m_server->getEventTarget(),
+		new TMethodEventJob<SecureSocketTests>(
+			this, &SecureSocketTests::handleServerInputReady));
+}
+
+void
+SecureSocketTests::handleSecureConnected(const Event&, void*)
+{
+	m_client->write(&m_payload[0], static_cast<UInt32>(m_payload.size()));
+}
+
+void
+SecureSocketTests::handleServerInputReady(const Event&, void*)
+{
+	UInt8 buffer[4096];
+	UInt32 n;
+	while ((n = m_server->read(buffer, sizeof(buffer))) > 0) {
+		if (m_received + n > kPayloadSize ||
+			memcmp(buffer, &m_payload[m_received], n) != 0) {
+			m_mismatch = true;
+		}
+		m_received += n;
+	}
+
+	if (m_received >= kPayloadSize) {
+		m_events.raiseQuitEvent();
+	}
+}
@@ -0,0 +1,204 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_ENV
+
+#include "test/global/TestEventQueue.h"
+#include "net/TCPSocket.h"
+#include "net/TCPListenSocket.h"
+#include "net/SocketMultiplexer.h"
+#include "net/NetworkAddress.h"
+#include "base/TMethodEventJob.h"
+#include "base/Stopwatch.h"
+#include "base/Log.h"
+#include "common/stdmap.h"
+#include "common/stdvector.h"
+
+#include "test/global/gtest.h"
+
+#define TEST_PORT 24806
+#define TEST_HOST "localhost"
+
+const int kShards = 4;
+const int kRounds = 4;
+const int kConnectionsPerRound = 64;
+const UInt32 kMessagesPerConnection = 256;
+
+class SocketMultiplexerTests : public ::testing::Test {
+public:
+	SocketMultiplexerTests() :
+		m_listen(NULL),
+		m_completed(0),
+		m_outOfOrder(0)
+	{
+	}
+
+	void				runRound(SocketMultiplexer& multiplexer, const NetworkAddress&);
+
+	void				handleConnecting(const Event&, void*);
+	void				handleClientConnected(const Event&, void*);
+	void				handleServerInputReady(const Event&, void*);
+
+public:
+	struct Connection {
+	public:
+		Connection() : m_socket(NULL), m_next(0) { }
+
+	public:
+		IDataSocket*		m_socket;
+		UInt32				m_next;
+		std::vector<UInt8>	m_partial;
+	};
+	typedef std::map<void*, Connection> Connections;
+	typedef std::map<void*, IDataSocket*> Clients;
+
+	TestEventQueue		m_events;
+	TCPListenSocket*	m_listen;
+	Connections			m_servers;
+	Clients				m_clients;
+	int					m_completed;
+	int					m_outOfOrder;
+};
+
+TEST_F(SocketMultiplexerTests, shards_churnConnections_allDataInOrder)
+{
+	NetworkAddress address(TEST_HOST, TEST_PORT);
+	address.resolve();
+
+	SocketMultiplexer multiplexer(SocketMultiplexer::kPollBackend, kShards);
+	EXPECT_EQ(kShards, multiplexer.getShards());
+
+	m_listen = new TCPListenSocket(&m_events, &multiplexer);
+	m_events.adoptHandler(
+		m_events.forIListenSocket().connecting(), m_listen,
+		new TMethodEventJob<SocketMultiplexerTests>(
+			this, &SocketMultiplexerTests::handleConnecting));
+	m_listen->bind(address);
+
+	Stopwatch stopwatch;
+	for (int round = 0; round < kRounds; ++round) {
+		runRound(multiplexer, address);
+		ASSERT_EQ(kConnectionsPerRound, m_completed);
+	}
+	double elapsed = stopwatch.getTime();
+
+	EXPECT_EQ(0, m_outOfOrder);
+	LOG((CLOG_INFO "%d connections, %.0f messages/s",
+		kRounds * kConnectionsPerRound,
+		kRounds * kConnectionsPerRound * kMessagesPerConnection / elapsed));
+
+	m_events.removeHandlers(m_listen);
+	delete m_listen;
+}
+
+void
+SocketMultiplexerTests::runRound(SocketMultiplexer& multiplexer,
+				const NetworkAddress& address)
+{
+	m_completed = 0;
+
+	for (int i = 0; i < kConnectionsPerRound; ++i) {
+		IDataSocket* client = new TCPSocket(&m_events, &multiplexer);
+		m_clients[client->getEventTarget()] = client;
+		m_events.adoptHandler(
+			m_events.forIDataSocket().connected(), client->getEventTarget(),
+			new TMethodEventJob<SocketMultiplexerTests>(
+				this, &SocketMultiplexerTests::handleClientConnected));
+		client->connect(address);
+	}
+
+	m_events.initQuitTimeout(10);
+	m_events.loop();
+	m_events.cleanupQuitTimeout();
+
+	// tear the round down so the next one reuses the sockets' slots
+	for (Clients::iterator i = m_clients.begin(); i != m_clients.end(); ++i) {
+		m_events.removeHandlers(i->first);
+		delete i->second;
+	}
+	m_clients.clear();
+	for (Connections::iterator i = m_servers.begin(); i != m_servers.end(); ++i) {
+		m_events.removeHandlers(i->first);
+		delete i->second.m_socket;
+	}
+	m_servers.clear();
+}
+
+void
+SocketMultiplexerTests::handleConnecting(const Event&, void*)
+{
+	IDataSocket* socket = m_listen->accept();
+	if (socket == NULL) {
+		return;
+	}
+
+	m_servers[socket->getEventTarget()].m_socket = socket;
+	m_events.adoptHandler(
+		m_events.forIStream().inputReady(), socket->getEventTarget(),
+		new TMethodEventJob<SocketMultiplexerTests>(
+			this, &SocketMultiplexerTests::handleServerInputReady));
+}
+
+void
+SocketMultiplexerTests::handleClientConnected(const Event& event, void*)
+{
+	IDataSocket* client = m_clients[event.getTarget()];
+
+	// one write per message so each is queued separately
+	for (UInt32 i = 0; i < kMessagesPerConnection; ++i) {
+		UInt8 message[4];
+		message[0] = static_cast<UInt8>((i >> 24) & 0xff);
+		message[1] = static_cast<UInt8>((i >> 16) & 0xff);
+		message[2] = static_cast<UInt8>((i >>  8) & 0xff);
+		message[3] = static_cast<UInt8>( i        & 0xff);
+		client->write(message, sizeof(message));
+	}
+}
+
+void
+SocketMultiplexerTests::handleServerInputReady(const Event& event, void*)
+{
+	Connection& connection = m_servers[event.getTarget()];
+
+	UInt8 buffer[512];
+	UInt32 n;
+	while ((n = connection.m_socket->read(buffer, sizeof(buffer))) > 0) {
+		connection.m_partial.insert(connection.m_partial.end(), buffer, buffer + n);
+	}
+
+	size_t offset = 0;
+	while (connection.m_partial.size() - offset >= 4) {
+		const UInt8* message = &connection.m_partial[offset];
+		UInt32 value = (static_cast<UInt32>(message[0]) << 24) |
+						(static_cast<UInt32>(message[1]) << 16) |
+						(static_cast<UInt32>(message[2]) <<  8) |
+						 static_cast<UInt32>(message[3]);
+		if (value != connection.m_next) {
+			++m_outOfOrder;
+		}
+		++connection.m_next;
+		offset += 4;
+
+		if (connection.m_next == kMessagesPerConnection) {
+			if (++m_completed == kConnectionsPerRound) {
+				m_events.raiseQuitEvent();
+			}
+		}
+	}
+	connection.m_partial.erase(connection.m_partial.begin(),
+						connection.m_partial.begin() + offset);
+}
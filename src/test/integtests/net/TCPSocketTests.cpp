@@ -0,0 +1,164 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_ENV
+
+#include "test/global/TestEventQueue.h"
+#include "net/TCPSocket.h"
+#include "net/TCPListenSocket.h"
+#include "net/SocketMultiplexer.h"
+#include "net/NetworkAddress.h"
+#include "synergy/PacketStreamFilter.h"
+#include "mt/Lock.h"
+#include "arch/Arch.h"
+#include "base/TMethodEventJob.h"
+
+#include "test/global/gtest.h"
+
+#define TEST_PORT 24805
+#define TEST_HOST "localhost"
+
+const UInt32 kPacketCount = 20;
+const UInt32 kPacketSize = 10;
+
+// counts the socket writes that actually send data
+class CountingTCPSocket : public TCPSocket {
+public:
+	CountingTCPSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer) :
+		TCPSocket(events, socketMultiplexer),
+		m_writes(0) { }
+
+	int					getWrites()
+	{
+		Lock lock(&getMutex());
+		return m_writes;
+	}
+
+protected:
+	virtual EJobResult	doWrite()
+	{
+		// called with the mutex locked
+		if (m_outputBuffer.getSize() > 0) {
+			++m_writes;
+		}
+		return TCPSocket::doWrite();
+	}
+
+private:
+	int					m_writes;
+};
+
+class TCPSocketTests : public ::testing::Test {
+public:
+	TCPSocketTests() :
+		m_listen(NULL),
+		m_server(NULL),
+		m_filter(NULL),
+		m_received(0)
+	{
+	}
+
+	void				handleConnecting(const Event&, void*);
+	void				handleConnected(const Event&, void*);
+	void				handleServerInputReady(const Event&, void*);
+
+public:
+	TestEventQueue		m_events;
+	TCPListenSocket*	m_listen;
+	IDataSocket*		m_server;
+	PacketStreamFilter*	m_filter;
+	UInt32				m_received;
+};
+
+TEST_F(TCPSocketTests, write_packetsInOneDispatch_sentTogether)
+{
+	NetworkAddress address(TEST_HOST, TEST_PORT);
+	address.resolve();
+
+	SocketMultiplexer multiplexer;
+	m_listen = new TCPListenSocket(&m_events, &multiplexer);
+	m_events.adoptHandler(
+		m_events.forIListenSocket().connecting(), m_listen,
+		new TMethodEventJob<TCPSocketTests>(
+			this, &TCPSocketTests::handleConnecting));
+	m_listen->bind(address);
+
+	CountingTCPSocket* client = new CountingTCPSocket(&m_events, &multiplexer);
+	m_filter = new PacketStreamFilter(&m_events, client, false);
+	m_events.adoptHandler(
+		m_events.forIDataSocket().connected(), m_filter->getEventTarget(),
+		new TMethodEventJob<TCPSocketTests>(
+			this, &TCPSocketTests::handleConnected));
+	client->connect(address);
+
+	m_events.initQuitTimeout(5);
+	m_events.loop();
+	m_events.cleanupQuitTimeout();
+
+	// each packet is a length and a payload, which used to be written
+	// (and with TCP_NODELAY, sent) separately
+	EXPECT_EQ(kPacketCount * (4 + kPacketSize), m_received);
+	EXPECT_EQ(1, client->getWrites());
+
+	m_events.removeHandlers(m_filter->getEventTarget());
+	m_events.removeHandlers(m_listen);
+	if (m_server != NULL) {
+		m_events.removeHandlers(m_server->getEventTarget());
+	}
+	delete m_filter;
+	delete client;
+	delete m_server;
+	delete m_listen;
+}
+
+void
+TCPSocketTests::handleConnecting(const Event&, void*)
+{
+	m_server = m_listen->accept();
+	ASSERT_TRUE(m_server != NULL);
+
+	m_events.adoptHandler(
+		m_events.forIStream().inputReady(), m_server->getEventTarget(),
+		new TMethodEventJob<TCPSocketTests>(
+			this, &TCPSocketTests::handleServerInputReady));
+}
+
+void
+TCPSocketTests::handleConnected(const Event&, void*)
+{
+	// pause between packets, as a handler doing real work would, so
+	// the multiplexer thread has every chance to send early
+	UInt8 payload[kPacketSize] = { 0 };
+	for (UInt32 i = 0; i < kPacketCount; ++i) {
+		m_filter->write(payload, sizeof(payload));
+		ARCH->sleep(0.005);
+	}
+}
+
+void
+TCPSocketTests::handleServerInputReady(const Event&, void*)
+{
+	UInt8 buffer[256];
+	UInt32 n;
+	while ((n = m_server->read(buffer, sizeof(buffer))) > 0) {
+		m_received += n;
+	}
+
+	if (m_received >= kPacketCount * (4 + kPacketSize)) {
+		m_events.raiseQuitEvent();
+	}
+}
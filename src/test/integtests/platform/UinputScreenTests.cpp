@@ -0,0 +1,215 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test/mock/synergy/MockEventQueue.h"
+#include "platform/UinputScreen.h"
+#include "platform/UinputDevice.h"
+#include "synergy/XScreen.h"
+
+#include "test/global/gtest.h"
+
+#include <linux/input.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <vector>
+
+using ::testing::NiceMock;
+
+// the pipe stands in for /dev/uinput, so events can be read back
+class UinputScreenTests : public ::testing::Test {
+public:
+	virtual void		SetUp()
+	{
+		ASSERT_EQ(0, pipe(m_pipe));
+		fcntl(m_pipe[0], F_SETFL, O_NONBLOCK);
+		m_screen = new UinputScreen(
+			new UinputDevice(m_pipe[1], 800, 600), &m_eventQueue);
+	}
+
+	virtual void		TearDown()
+	{
+		// closes the write end
+		delete m_screen;
+		close(m_pipe[0]);
+	}
+
+	std::vector<input_event>
+						readEvents(UInt16 type)
+	{
+		std::vector<input_event> events;
+		input_event event;
+		while (read(m_pipe[0], &event, sizeof(event)) == sizeof(event)) {
+			if (event.type == type) {
+				events.push_back(event);
+			}
+		}
+		return events;
+	}
+
+	int					m_pipe[2];
+	NiceMock<MockEventQueue> m_eventQueue;
+	UinputScreen*		m_screen;
+};
+
+TEST_F(UinputScreenTests, fakeMouseMove_writesAbsolutePositionAndSync)
+{
+	m_screen->fakeMouseMove(10, 20);
+
+	input_event events[3];
+	ASSERT_EQ((ssize_t)sizeof(events), read(m_pipe[0], events, sizeof(events)));
+	EXPECT_EQ(EV_ABS, events[0].type);
+	EXPECT_EQ(ABS_X, events[0].code);
+	EXPECT_EQ(10, events[0].value);
+	EXPECT_EQ(EV_ABS, events[1].type);
+	EXPECT_EQ(ABS_Y, events[1].code);
+	EXPECT_EQ(20, events[1].value);
+	EXPECT_EQ(EV_SYN, events[2].type);
+	EXPECT_EQ(SYN_REPORT, events[2].code);
+
+	SInt32 x, y;
+	m_screen->getCursorPos(x, y);
+	EXPECT_EQ(10, x);
+	EXPECT_EQ(20, y);
+}
+
+TEST_F(UinputScreenTests, fakeMouseRelativeMove_clampsToShape)
+{
+	m_screen->fakeMouseMove(790, 10);
+	m_screen->fakeMouseRelativeMove(50, -50);
+
+	std::vector<input_event> events = readEvents(EV_ABS);
+	ASSERT_EQ(4, events.size());
+	EXPECT_EQ(799, events[2].value);
+	EXPECT_EQ(0, events[3].value);
+}
+
+TEST_F(UinputScreenTests, fakeMouseButton_right_writesBtnRight)
+{
+	m_screen->fakeMouseButton(kButtonRight, true);
+
+	UInt32 button;
+	EXPECT_TRUE(m_screen->isAnyMouseButtonDown(button));
+	EXPECT_EQ(kButtonRight, button);
+
+	m_screen->fakeMouseButton(kButtonRight, false);
+	EXPECT_FALSE(m_screen->isAnyMouseButtonDown(button));
+
+	std::vector<input_event> events = readEvents(EV_KEY);
+	ASSERT_EQ(2, events.size());
+	EXPECT_EQ(BTN_RIGHT, events[0].code);
+	EXPECT_EQ(1, events[0].value);
+	EXPECT_EQ(BTN_RIGHT, events[1].code);
+	EXPECT_EQ(0, events[1].value);
+}
+
+TEST_F(UinputScreenTests, fakeMouseWheel_partialNotches_carriedOver)
+{
+	m_screen->fakeMouseWheel(0, 60);
+	std::vector<input_event> events = readEvents(EV_REL);
+	for (size_t i = 0; i < events.size(); ++i) {
+		EXPECT_NE(REL_WHEEL, events[i].code);
+	}
+
+	m_screen->fakeMouseWheel(0, 60);
+	events = readEvents(EV_REL);
+	ASSERT_FALSE(events.empty());
+	EXPECT_EQ(REL_WHEEL, events.back().code);
+	EXPECT_EQ(1, events.back().value);
+}
+
+TEST_F(UinputScreenTests, fakeKeyDown_upperCase_pressesShiftThenKey)
+{
+	m_screen->updateKeyMap();
+	m_screen->updateKeyState();
+
+	m_screen->fakeKeyDown('A', 0, 1);
+	m_screen->fakeKeyUp(1);
+
+	std::vector<input_event> events = readEvents(EV_KEY);
+	ASSERT_LE(3, events.size());
+	EXPECT_TRUE(events[0].code == KEY_LEFTSHIFT || events[0].code == KEY_RIGHTSHIFT);
+	EXPECT_EQ(1, events[0].value);
+	EXPECT_EQ(KEY_A, events[1].code);
+	EXPECT_EQ(1, events[1].value);
+
+	bool released = false;
+	for (size_t i = 2; i < events.size(); ++i) {
+		released |= (events[i].code == KEY_A && events[i].value == 0);
+	}
+	EXPECT_TRUE(released);
+}
+
+TEST_F(UinputScreenTests, fakeKeyDown_keypadWithoutNumLock_pressesKeypadKey)
+{
+	m_screen->updateKeyMap();
+	m_screen->updateKeyState();
+
+	m_screen->fakeKeyDown(kKeyKP_Home, 0, 1);
+
+	std::vector<input_event> events = readEvents(EV_KEY);
+	ASSERT_EQ(1, events.size());
+	EXPECT_EQ(KEY_KP7, events[0].code);
+}
+
+// injects through the real /dev/uinput and reads the key back through
+// the evdev node the kernel created for it.  skipped when uinput isn't
+// available (e.g. in containers or without permission).
+TEST(UinputDeviceTests, key_realDevice_readBackThroughEvdev)
+{
+	UinputDevice* device;
+	try {
+		device = new UinputDevice(800, 600);
+	}
+	catch (XScreenOpenFailure&) {
+		return;
+	}
+
+	// find the evdev node under the device's sysfs directory
+	String eventPath;
+	String sysPath = "/sys/devices/virtual/input/" + device->getSysName();
+	DIR* dir = opendir(sysPath.c_str());
+	if (dir != NULL) {
+		struct dirent* entry;
+		while ((entry = readdir(dir)) != NULL) {
+			if (strncmp(entry->d_name, "event", 5) == 0) {
+				eventPath = String("/dev/input/") + entry->d_name;
+			}
+		}
+		closedir(dir);
+	}
+
+	int fd = eventPath.empty() ? -1 : open(eventPath.c_str(), O_RDONLY);
+	if (fd == -1) {
+		delete device;
+		return;
+	}
+
+	device->key(KEY_A, true);
+	device->key(KEY_A, false);
+
+	input_event event;
+	bool pressed = false;
+	while (!pressed && read(fd, &event, sizeof(event)) == sizeof(event)) {
+		pressed = (event.type == EV_KEY && event.code == KEY_A && event.value == 1);
+	}
+	EXPECT_TRUE(pressed);
+
+	close(fd);
+	delete device;
+}
@@ -155,3 +155,106 @@ TEST_F(CXWindowsClipboardTests, get_withFormatAdded_returnsExpected)
 }
 
 #endif
+
+// gtest must come before X11, which defines None
+#include "test/global/gtest.h"
+
+#include "platform/XWindowsClipboard.h"
+#include "platform/XWindowsServerTime.h"
+#include "platform/XWindowsUtil.h"
+
+#include <algorithm>
+
+// serves selection requests from a requestor window on the same display
+class XWindowsClipboardRequestTests : public ::testing::Test {
+protected:
+	virtual void
+	SetUp()
+	{
+		m_display    = XOpenDisplay(NULL);
+		m_owner      = createWindow();
+		m_requestor  = createWindow();
+		m_serverTime = new XWindowsServerTime(m_display);
+		m_target     = XInternAtom(m_display, "UTF8_STRING", False);
+		m_property   = XInternAtom(m_display, "SYNERGY_PASTE", False);
+	}
+
+	virtual void
+	TearDown()
+	{
+		delete m_serverTime;
+		XDestroyWindow(m_display, m_requestor);
+		XDestroyWindow(m_display, m_owner);
+		XCloseDisplay(m_display);
+	}
+
+	Window
+	createWindow()
+	{
+		XSetWindowAttributes attr;
+		attr.override_redirect = True;
+		return XCreateWindow(m_display, DefaultRootWindow(m_display),
+							0, 0, 1, 1, 0, 0, InputOnly, CopyFromParent,
+							CWOverrideRedirect, &attr);
+	}
+
+	// take ownership of the clipboard with \p text on it
+	void
+	own(XWindowsClipboard& clipboard, const String& text)
+	{
+		clipboard.open(m_serverTime->get());
+		clipboard.empty();
+		clipboard.add(IClipboard::kText, text);
+		clipboard.close();
+	}
+
+	// request the text as a pasting application would and read it back
+	String
+	paste(XWindowsClipboard& clipboard)
+	{
+		clipboard.addRequest(m_owner, m_requestor,
+							m_target, CurrentTime, m_property);
+		String data;
+		XWindowsUtil::getWindowProperty(m_display, m_requestor,
+							m_property, &data, NULL, NULL, true);
+		return data;
+	}
+
+	Display*			m_display;
+	Window				m_owner;
+	Window				m_requestor;
+	XWindowsServerTime*	m_serverTime;
+	Atom				m_target;
+	Atom				m_property;
+};
+
+TEST_F(XWindowsClipboardRequestTests, addRequest_repeatedPaste_convertsOnce)
+{
+	XWindowsClipboard clipboard(m_display, m_owner, kClipboardClipboard);
+
+	// as large as a single (non-INCR) reply can be, up to 4MB.  that's
+	// 4MB with BIG-REQUESTS and the core request limit without.
+	size_t maxReply = 3 * static_cast<size_t>(
+							XWindowsUtil::getMaxRequestSize(m_display));
+	String text(std::min(maxReply, static_cast<size_t>(4 * 1024 * 1024)), 'x');
+	own(clipboard, text);
+
+	for (int i = 0; i < 3; ++i) {
+		EXPECT_EQ(text.size(), paste(clipboard).size());
+	}
+
+	// converted once and each paste is a single write
+	EXPECT_EQ(1, clipboard.getConversions());
+	EXPECT_EQ(3, clipboard.getPropertyWrites());
+}
+
+TEST_F(XWindowsClipboardRequestTests, addRequest_ownedAgain_convertsNewData)
+{
+	XWindowsClipboard clipboard(m_display, m_owner, kClipboardClipboard);
+	own(clipboard, "synergy rocks!");
+	EXPECT_EQ("synergy rocks!", paste(clipboard));
+
+	own(clipboard, "and rolls");
+	EXPECT_EQ("and rolls", paste(clipboard));
+	EXPECT_EQ(2, clipboard.getConversions());
+}
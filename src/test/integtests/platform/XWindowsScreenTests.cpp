@@ -17,11 +17,107 @@
  */
 
 #include "test/mock/synergy/MockEventQueue.h"
+#include "test/global/TestEventQueue.h"
 #include "platform/XWindowsScreen.h"
+#include "platform/XWindowsServerTime.h"
+#include "synergy/Clipboard.h"
+#include "synergy/IPrimaryScreen.h"
+#include "arch/Arch.h"
+#include "base/TMethodEventJob.h"
 
 #include "test/global/gtest.h"
 
+#include <X11/extensions/XTest.h>
+#include <vector>
+
 using ::testing::_;
+using ::testing::NiceMock;
+
+// stands in for the X server's answer to XQueryPointer and counts
+// the round trips made for it
+class QueryCountingXWindowsScreen : public XWindowsScreen {
+public:
+	QueryCountingXWindowsScreen(bool isPrimary, IEventQueue* events) :
+		XWindowsScreen(":0.0", isPrimary, false, 0, events),
+		m_queries(0),
+		m_serverX(0),
+		m_serverY(0) { }
+
+protected:
+	virtual bool		queryPointer(SInt32& x, SInt32& y,
+							unsigned int& state) const
+	{
+		++m_queries;
+		x = m_serverX;
+		y = m_serverY;
+		state = 0;
+		return true;
+	}
+
+public:
+	mutable int			m_queries;
+	SInt32				m_serverX;
+	SInt32				m_serverY;
+};
+
+// counts the X requests made by switching screens
+class SwitchCountingXWindowsScreen : public XWindowsScreen {
+public:
+	SwitchCountingXWindowsScreen(IEventQueue* events) :
+		XWindowsScreen(":0.0", false, false, 0, events) { }
+
+	// takes the clipboard, as on leaving, then sets it, as on entering
+	unsigned long		switchRequests()
+	{
+		Clipboard clipboard;
+		unsigned long before = NextRequest(getDisplay());
+		getClipboard(kClipboardClipboard, &clipboard);
+		setClipboard(kClipboardClipboard, &clipboard);
+		return NextRequest(getDisplay()) - before;
+	}
+
+	UInt32				getRoundTrips() const
+	{
+		return getServerTime()->getRoundTrips();
+	}
+};
+
+// records the button events a primary screen sends
+class ButtonRecorder {
+public:
+	ButtonRecorder(TestEventQueue* events, void* target) :
+		m_events(events),
+		m_target(target)
+	{
+		m_events->adoptHandler(m_events->forIPrimaryScreen().buttonDown(),
+			m_target, new TMethodEventJob<ButtonRecorder>(
+				this, &ButtonRecorder::handleButton));
+		m_events->adoptHandler(m_events->forIPrimaryScreen().buttonUp(),
+			m_target, new TMethodEventJob<ButtonRecorder>(
+				this, &ButtonRecorder::handleButton));
+	}
+
+	~ButtonRecorder()
+	{
+		m_events->removeHandler(
+			m_events->forIPrimaryScreen().buttonDown(), m_target);
+		m_events->removeHandler(
+			m_events->forIPrimaryScreen().buttonUp(), m_target);
+	}
+
+	void				handleButton(const Event& event, void*)
+	{
+		m_types.push_back(event.getType());
+		if (event.getType() == m_events->forIPrimaryScreen().buttonUp()) {
+			m_events->raiseQuitEvent();
+		}
+	}
+
+	TestEventQueue*		m_events;
+	void*				m_target;
+	std::vector<Event::Type>
+						m_types;
+};
 
 TEST(CXWindowsScreenTests, fakeMouseMove_nonPrimary_getCursorPosValuesCorrect)
 {
@@ -39,3 +135,119 @@ TEST(CXWindowsScreenTests, fakeMouseMove_nonPrimary_getCursorPosValuesCorrect)
 	ASSERT_EQ(10, x);
 	ASSERT_EQ(20, y);
 }
+
+TEST(CXWindowsScreenTests, getCursorPos_primaryOffScreen_noRoundTrips)
+{
+	NiceMock<MockEventQueue> eventQueue;
+	QueryCountingXWindowsScreen screen(true, &eventQueue);
+	if (!screen.leave()) {
+		// couldn't grab the pointer; nothing to test
+		return;
+	}
+
+	// leaving warped to the center, so that's where the pointer is
+	SInt32 x, y, xCenter, yCenter;
+	screen.getCursorCenter(xCenter, yCenter);
+	for (int i = 0; i < 3; ++i) {
+		screen.getCursorPos(x, y);
+		EXPECT_EQ(xCenter, x);
+		EXPECT_EQ(yCenter, y);
+	}
+	EXPECT_EQ(0, screen.m_queries);
+
+	screen.enter();
+}
+
+TEST(CXWindowsScreenTests, getCursorPos_primaryAfterEnter_queriesServer)
+{
+	NiceMock<MockEventQueue> eventQueue;
+	QueryCountingXWindowsScreen screen(true, &eventQueue);
+	if (!screen.leave()) {
+		return;
+	}
+	screen.enter();
+
+	// the pointer may have moved while it was grabbed
+	screen.m_serverX = 12;
+	screen.m_serverY = 34;
+
+	SInt32 x, y;
+	screen.getCursorPos(x, y);
+	EXPECT_EQ(12, x);
+	EXPECT_EQ(34, y);
+	EXPECT_EQ(1, screen.m_queries);
+}
+
+TEST(CXWindowsScreenTests, getCursorPos_nonPrimary_alwaysQueriesServer)
+{
+	NiceMock<MockEventQueue> eventQueue;
+	QueryCountingXWindowsScreen screen(false, &eventQueue);
+	screen.fakeMouseMove(10, 20);
+
+	// the local mouse moved it behind our back
+	screen.m_serverX = 30;
+	screen.m_serverY = 40;
+
+	SInt32 x, y;
+	screen.getCursorPos(x, y);
+	EXPECT_EQ(30, x);
+	EXPECT_EQ(40, y);
+	EXPECT_EQ(1, screen.m_queries);
+}
+
+TEST(CXWindowsScreenTests, switch_recentServerTime_noTimestampRequests)
+{
+	NiceMock<MockEventQueue> eventQueue;
+	SwitchCountingXWindowsScreen screen(&eventQueue);
+
+	// nothing has told us the server time yet so the first switch asks
+	screen.switchRequests();
+	EXPECT_EQ(1, screen.getRoundTrips());
+
+	// that answer is recent so switching again doesn't
+	unsigned long recent = screen.switchRequests();
+	EXPECT_EQ(1, screen.getRoundTrips());
+
+	// once it's stale a switch costs exactly one more request
+	ARCH->sleep(2.5);
+	unsigned long stale = screen.switchRequests();
+	EXPECT_EQ(2, screen.getRoundTrips());
+	EXPECT_EQ(recent + 1, stale);
+}
+
+TEST(CXWindowsScreenTests, captureInput_mainThreadStalled_buttonEdgesDelivered)
+{
+	TestEventQueue events;
+	XWindowsScreen screen(":0.0", true, false, 0, &events);
+	if (!screen.leave()) {
+		// couldn't grab the pointer; nothing to test
+		return;
+	}
+	ButtonRecorder recorder(&events, screen.getEventTarget());
+
+	// click in the middle of far more motion than the capture queue
+	// holds while the main thread isn't dispatching
+	Display* display = XOpenDisplay(":0.0");
+	ASSERT_TRUE(display != NULL);
+	for (int i = 0; i < 3000; ++i) {
+		XTestFakeRelativeMotionEvent(display, (i & 1) ? 1 : -1, 0, CurrentTime);
+		if (i == 1000) {
+			XTestFakeButtonEvent(display, 1, True, CurrentTime);
+		}
+		if (i == 2000) {
+			XTestFakeButtonEvent(display, 1, False, CurrentTime);
+		}
+	}
+	XSync(display, False);
+	ARCH->sleep(0.5);
+
+	events.initQuitTimeout(5);
+	events.loop();
+	events.cleanupQuitTimeout();
+	XCloseDisplay(display);
+	screen.enter();
+
+	ASSERT_EQ(2, recorder.m_types.size());
+	EXPECT_EQ(events.forIPrimaryScreen().buttonDown(), recorder.m_types[0]);
+	EXPECT_EQ(events.forIPrimaryScreen().buttonUp(), recorder.m_types[1]);
+}
@@ -28,13 +28,24 @@ class MockPrimaryClient : public PrimaryClient
 {
 public:
 	MOCK_CONST_METHOD0(getEventTarget, void*());
+	MOCK_CONST_METHOD0(getName, String());
+	MOCK_CONST_METHOD2(getClipboard, bool(ClipboardID, IClipboard*));
+	MOCK_CONST_METHOD4(getShape, void(SInt32&, SInt32&, SInt32&, SInt32&));
 	MOCK_CONST_METHOD2(getCursorPos, void(SInt32&, SInt32&));
+	MOCK_CONST_METHOD2(getCursorCenter, void(SInt32&, SInt32&));
+	MOCK_CONST_METHOD0(getJumpZoneSize, SInt32());
+	MOCK_CONST_METHOD0(isLockedToScreen, bool());
 	MOCK_CONST_METHOD2(setJumpCursorPos, void(SInt32, SInt32));
 	MOCK_METHOD1(reconfigure, void(UInt32));
 	MOCK_METHOD0(resetOptions, void());
 	MOCK_METHOD1(setOptions, void(const OptionsList&));
 	MOCK_METHOD0(enable, void());
 	MOCK_METHOD0(disable, void());
+	MOCK_METHOD5(enter, void(SInt32, SInt32, UInt32, KeyModifierMask, bool));
+	MOCK_METHOD0(leave, bool());
+	MOCK_METHOD2(setClipboard, void(ClipboardID, const IClipboard*));
+	MOCK_METHOD1(grabClipboard, void(ClipboardID));
+	MOCK_METHOD2(mouseMove, void(SInt32, SInt32));
 	MOCK_METHOD2(registerHotKey, UInt32(KeyID, KeyModifierMask));
 	MOCK_CONST_METHOD0(getToggleMask, KeyModifierMask());
 	MOCK_METHOD1(unregisterHotKey, void(UInt32));
@@ -30,8 +30,10 @@ public:
 	MOCK_METHOD2(newTimer, EventQueueTimer*(double, void*));
 	MOCK_METHOD2(getEvent, bool(Event&, double));
 	MOCK_METHOD1(adoptBuffer, void(IEventQueueBuffer*));
-	MOCK_METHOD2(registerTypeOnce, Event::Type(Event::Type&, const char*));
+	MOCK_METHOD3(registerTypeOnce, Event::Type(Event::Type&, const char*, Event::EPriority));
 	MOCK_METHOD1(removeHandlers, void(void*));
+	MOCK_METHOD2(adoptDispatchEndJob, void(void*, IEventJob*));
+	MOCK_METHOD1(removeDispatchEndJobs, void(void*));
 	MOCK_METHOD1(registerType, Event::Type(const char*));
 	MOCK_CONST_METHOD0(isEmpty, bool());
 	MOCK_METHOD3(adoptHandler, void(Event::Type, void*, IEventJob*));
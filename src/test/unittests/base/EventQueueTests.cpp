@@ -0,0 +1,279 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test/global/TestEventQueue.h"
+#include "base/SimpleEventQueueBuffer.h"
+#include "base/TMethodEventJob.h"
+#include "base/TMethodJob.h"
+#include "mt/CondVar.h"
+#include "mt/Lock.h"
+#include "mt/Mutex.h"
+#include "mt/Thread.h"
+#include "arch/Arch.h"
+
+#include "test/global/gtest.h"
+
+#include <vector>
+
+class EventQueueTests : public ::testing::Test {
+public:
+	EventQueueTests() :
+		m_inputType(Event::kUnknown),
+		m_bulkType(Event::kUnknown),
+		m_expected(0),
+		m_injectAt(-1),
+		m_adoptAt(-1)
+	{
+		m_events.registerTypeOnce(m_inputType, "input", Event::kInputPriority);
+		m_events.registerTypeOnce(m_bulkType, "bulk", Event::kBulkPriority);
+		m_events.adoptHandler(m_inputType, this,
+			new TMethodEventJob<EventQueueTests>(
+				this, &EventQueueTests::handleEvent));
+		m_events.adoptHandler(m_bulkType, this,
+			new TMethodEventJob<EventQueueTests>(
+				this, &EventQueueTests::handleEvent));
+	}
+
+	~EventQueueTests()
+	{
+		m_events.removeHandlers(this);
+	}
+
+	void				add(Event::Type type, int count)
+	{
+		for (int i = 0; i < count; ++i) {
+			m_events.addEvent(Event(type, this));
+		}
+		m_expected += count;
+	}
+
+	void				run()
+	{
+		m_events.initQuitTimeout(5);
+		m_events.loop();
+		m_events.cleanupQuitTimeout();
+	}
+
+	// position in dispatch order of the first event of \p type
+	// dispatched at or after \p start
+	int					findFrom(Event::Type type, int start)
+	{
+		for (size_t i = start; i < m_order.size(); ++i) {
+			if (m_order[i] == type) {
+				return static_cast<int>(i) - start;
+			}
+		}
+		return -1;
+	}
+
+	void				handleEvent(const Event& event, void*)
+	{
+		m_order.push_back(event.getType());
+		if (static_cast<int>(m_order.size()) == m_injectAt) {
+			add(m_inputType, 1);
+		}
+		if (static_cast<int>(m_order.size()) == m_adoptAt) {
+			// events still in the old buffer are discarded
+			m_events.adoptBuffer(new SimpleEventQueueBuffer);
+			m_expected = m_adoptAt;
+			add(m_bulkType, 1);
+			add(m_inputType, 1);
+		}
+		if (static_cast<int>(m_order.size()) == m_expected) {
+			m_events.raiseQuitEvent();
+		}
+	}
+
+public:
+	TestEventQueue		m_events;
+	Event::Type			m_inputType;
+	Event::Type			m_bulkType;
+	std::vector<Event::Type>
+						m_order;
+	int					m_expected;
+	int					m_injectAt;
+	int					m_adoptAt;
+};
+
+// dispatch-end jobs adopted or removed by a thread other than the one
+// running the event loop
+class DispatchEndJobTests : public ::testing::Test {
+public:
+	typedef void (DispatchEndJobTests::*Handler)(const Event&, void*);
+
+	DispatchEndJobTests() :
+		m_type(Event::kUnknown),
+		m_thread(NULL),
+		m_inHandler(false),
+		m_ranInHandler(false),
+		m_jobStarted(&m_mutex, false),
+		m_jobFinished(false),
+		m_finishedOnRemove(false)
+	{
+		m_events.registerTypeOnce(m_type, "test", Event::kControlPriority);
+	}
+
+	~DispatchEndJobTests()
+	{
+		m_events.removeHandlers(this);
+		delete m_thread;
+	}
+
+	void				run(Handler handler)
+	{
+		m_events.adoptHandler(m_type, this,
+			new TMethodEventJob<DispatchEndJobTests>(this, handler));
+		m_events.addEvent(Event(m_type, this));
+		m_events.initQuitTimeout(5);
+		m_events.loop();
+		m_events.cleanupQuitTimeout();
+	}
+
+	// adopts a job from another thread while this handler runs
+	void				handleAdoptFromThread(const Event&, void*)
+	{
+		m_inHandler = true;
+		Thread thread(new TMethodJob<DispatchEndJobTests>(
+							this, &DispatchEndJobTests::adoptRecordJob));
+		thread.wait();
+		m_inHandler = false;
+		m_events.raiseQuitEvent();
+	}
+
+	void				adoptRecordJob(void*)
+	{
+		m_events.adoptDispatchEndJob(this,
+			new TMethodEventJob<DispatchEndJobTests>(
+				this, &DispatchEndJobTests::recordJob));
+	}
+
+	void				recordJob(const Event&, void*)
+	{
+		m_ranInHandler = m_inHandler;
+	}
+
+	// defers a slow job and has another thread remove it once it starts
+	void				handleRemoveWhileRunning(const Event&, void*)
+	{
+		m_thread = new Thread(new TMethodJob<DispatchEndJobTests>(
+							this, &DispatchEndJobTests::removeSlowJob));
+		m_events.adoptDispatchEndJob(this,
+			new TMethodEventJob<DispatchEndJobTests>(
+				this, &DispatchEndJobTests::slowJob));
+		m_events.raiseQuitEvent();
+	}
+
+	void				slowJob(const Event&, void*)
+	{
+		{
+			Lock lock(&m_mutex);
+			m_jobStarted = true;
+			m_jobStarted.broadcast();
+		}
+		ARCH->sleep(0.1);
+		m_jobFinished = true;
+	}
+
+	void				removeSlowJob(void*)
+	{
+		{
+			Lock lock(&m_mutex);
+			while (!m_jobStarted) {
+				if (!m_jobStarted.wait(5)) {
+					return;
+				}
+			}
+		}
+		m_events.removeDispatchEndJobs(this);
+		m_finishedOnRemove = m_jobFinished;
+	}
+
+public:
+	TestEventQueue		m_events;
+	Event::Type			m_type;
+	Thread*				m_thread;
+	bool				m_inHandler;
+	bool				m_ranInHandler;
+	Mutex				m_mutex;
+	CondVar<bool>		m_jobStarted;
+	bool				m_jobFinished;
+	bool				m_finishedOnRemove;
+};
+
+TEST_F(EventQueueTests, getEvent_bulkFlood_inputDispatchedFirst)
+{
+	add(m_bulkType, 1000);
+	add(m_inputType, 1);
+
+	run();
+
+	ASSERT_EQ(1001, static_cast<int>(m_order.size()));
+	EXPECT_EQ(0, findFrom(m_inputType, 0));
+}
+
+TEST_F(EventQueueTests, getEvent_inputDuringBulkFlood_delayBounded)
+{
+	// input arrives while a bulk backlog is being dispatched
+	add(m_bulkType, 1000);
+	m_injectAt = 100;
+
+	run();
+
+	ASSERT_EQ(1001, static_cast<int>(m_order.size()));
+	EXPECT_EQ(0, findFrom(m_inputType, m_injectAt));
+}
+
+TEST_F(EventQueueTests, getEvent_inputFlood_bulkNotStarved)
+{
+	add(m_bulkType, 1);
+	add(m_inputType, 1000);
+
+	run();
+
+	ASSERT_EQ(1001, static_cast<int>(m_order.size()));
+	int bulk = findFrom(m_bulkType, 0);
+	EXPECT_GT(bulk, 0);
+	EXPECT_LE(bulk, 16);
+}
+
+TEST_F(EventQueueTests, adoptBuffer_pendingEvents_newEventsDispatched)
+{
+	add(m_bulkType, 10);
+	m_adoptAt = 1;
+
+	run();
+
+	ASSERT_EQ(3, static_cast<int>(m_order.size()));
+	EXPECT_EQ(m_inputType, m_order[1]);
+	EXPECT_EQ(m_bulkType, m_order[2]);
+}
+
+TEST_F(DispatchEndJobTests, adoptDispatchEndJob_otherThread_runsImmediately)
+{
+	run(&DispatchEndJobTests::handleAdoptFromThread);
+
+	EXPECT_TRUE(m_ranInHandler);
+}
+
+TEST_F(DispatchEndJobTests, removeDispatchEndJobs_jobRunning_waitsForJob)
+{
+	run(&DispatchEndJobTests::handleRemoveWhileRunning);
+	m_thread->wait();
+
+	EXPECT_TRUE(m_jobStarted);
+	EXPECT_TRUE(m_finishedOnRemove);
+}
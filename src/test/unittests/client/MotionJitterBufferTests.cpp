@@ -0,0 +1,164 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "client/MotionJitterBuffer.h"
+
+#include "test/global/gtest.h"
+
+#include <vector>
+
+// the server sends motion every 8ms (125Hz)
+const double kSendInterval = 0.008;
+
+// one delivered position
+class Delivery {
+public:
+	Delivery(SInt32 x, double time) : m_x(x), m_time(time) { }
+
+	SInt32				m_x;
+	double				m_time;
+};
+typedef std::vector<Delivery> Deliveries;
+
+// replay motion sent every kSendInterval, position i arriving at
+// arrivals[i], and record when each position is delivered.  the
+// buffer is polled every millisecond as its timer would fire.
+static Deliveries
+replay(MotionJitterBuffer& buffer, const std::vector<double>& arrivals)
+{
+	Deliveries deliveries;
+	size_t next = 0;
+	double end  = arrivals.back() + 1.0;
+	for (int tick = 0; tick / 1000.0 < end; ++tick) {
+		double now = tick / 1000.0;
+		SInt32 x, y;
+		while (next < arrivals.size() && arrivals[next] <= now) {
+			if (buffer.add(static_cast<SInt32>(next), 0, arrivals[next])) {
+				deliveries.push_back(Delivery(static_cast<SInt32>(next), now));
+			}
+			++next;
+		}
+		while (buffer.next(now, x, y)) {
+			deliveries.push_back(Delivery(x, now));
+		}
+	}
+	return deliveries;
+}
+
+// sent every kSendInterval but delivered in bursts of burstSize
+static std::vector<double>
+burstyTrace(int count, int burstSize)
+{
+	std::vector<double> arrivals;
+	for (int i = 0; i < count; ++i) {
+		int burstEnd = (i / burstSize + 1) * burstSize - 1;
+		arrivals.push_back(burstEnd * kSendInterval + 0.002);
+	}
+	return arrivals;
+}
+
+TEST(MotionJitterBufferTests, add_cleanLink_deliversImmediately)
+{
+	MotionJitterBuffer buffer;
+	std::vector<double> arrivals;
+	for (int i = 0; i < 100; ++i) {
+		// steady arrivals with a little scheduling noise
+		arrivals.push_back(i * kSendInterval + ((i % 2) ? 0.0005 : 0.0));
+	}
+
+	Deliveries deliveries = replay(buffer, arrivals);
+
+	EXPECT_TRUE(buffer.isClean());
+	ASSERT_EQ(arrivals.size(), deliveries.size());
+	for (size_t i = 0; i < deliveries.size(); ++i) {
+		EXPECT_EQ(static_cast<SInt32>(i), deliveries[i].m_x);
+		EXPECT_NEAR(arrivals[i], deliveries[i].m_time, 0.001);
+	}
+}
+
+TEST(MotionJitterBufferTests, next_burstyLink_pacesOutput)
+{
+	MotionJitterBuffer buffer;
+	std::vector<double> arrivals = burstyTrace(200, 4);
+
+	Deliveries deliveries = replay(buffer, arrivals);
+
+	EXPECT_FALSE(buffer.isClean());
+	EXPECT_NEAR(kSendInterval, buffer.getInterval(), 0.003);
+
+	// once the statistics settle no two positions are delivered at the
+	// same time, unlike the arrivals, and none is delivered late
+	size_t settled = deliveries.size() / 4;
+	double maxGap = 0.0;
+	for (size_t i = settled; i < deliveries.size(); ++i) {
+		SInt32 x = deliveries[i].m_x;
+		EXPECT_LE(deliveries[i].m_time - arrivals[x],
+					MotionJitterBuffer::kMaxDelay + 0.001);
+		if (i > settled) {
+			double gap = deliveries[i].m_time - deliveries[i - 1].m_time;
+			EXPECT_GE(gap, 0.004);
+			if (gap > maxGap) {
+				maxGap = gap;
+			}
+		}
+	}
+
+	// the largest gap is well under the burst period
+	EXPECT_LT(maxGap, 4 * kSendInterval * 0.75);
+
+	// positions are delivered in order
+	for (size_t i = 1; i < deliveries.size(); ++i) {
+		EXPECT_GT(deliveries[i].m_x, deliveries[i - 1].m_x);
+	}
+}
+
+TEST(MotionJitterBufferTests, next_longBurst_respectsLatencyCeiling)
+{
+	MotionJitterBuffer buffer;
+
+	// bursts of 10 positions, 80ms apart, more than the ceiling allows
+	// to pace out;  overdue positions are dropped, the newest never
+	std::vector<double> arrivals = burstyTrace(200, 10);
+	Deliveries deliveries = replay(buffer, arrivals);
+
+	for (size_t i = 0; i < deliveries.size(); ++i) {
+		SInt32 x = deliveries[i].m_x;
+		EXPECT_LE(deliveries[i].m_time - arrivals[x],
+					MotionJitterBuffer::kMaxDelay + 0.001);
+	}
+	EXPECT_LT(deliveries.size(), arrivals.size());
+	EXPECT_EQ(199, deliveries.back().m_x);
+}
+
+TEST(MotionJitterBufferTests, flush_buffered_returnsNewest)
+{
+	MotionJitterBuffer buffer;
+	std::vector<double> arrivals = burstyTrace(40, 4);
+	replay(buffer, arrivals);
+
+	// a burst arrives and a click follows it
+	double now = 1.0;
+	EXPECT_TRUE(buffer.add(100, 0, now));
+	EXPECT_FALSE(buffer.add(101, 0, now));
+	EXPECT_FALSE(buffer.add(102, 0, now));
+
+	SInt32 x, y;
+	EXPECT_TRUE(buffer.flush(x, y));
+	EXPECT_EQ(102, x);
+	EXPECT_FALSE(buffer.flush(x, y));
+	EXPECT_LT(buffer.getNextTime(), 0.0);
+}
@@ -0,0 +1,246 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "micro/uSynergy.h"
+
+#include "test/global/gtest.h"
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct MouseMove {
+	uint16_t		m_x;
+	uint16_t		m_y;
+};
+
+struct FakeHost {
+	std::vector<std::string>	m_replies;
+	std::vector<MouseMove>		m_moves;
+	bool						m_sendFails;
+};
+
+static uint32_t		s_now = 1000;
+
+static FakeHost*
+host(uSynergyCookie cookie)
+{
+	return reinterpret_cast<FakeHost*>(cookie);
+}
+
+static uSynergyBool
+fakeSend(uSynergyCookie cookie, const uint8_t* buffer, int length)
+{
+	if (host(cookie)->m_sendFails) {
+		return USYNERGY_FALSE;
+	}
+	// skip the length prefix, keep the message id and body
+	host(cookie)->m_replies.push_back(
+		std::string(reinterpret_cast<const char*>(buffer) + 4, length - 4));
+	return USYNERGY_TRUE;
+}
+
+static uint32_t
+fakeGetTime()
+{
+	return s_now;
+}
+
+static void
+fakeMouse(uSynergyCookie cookie, uint16_t x, uint16_t y, int16_t, int16_t,
+			uSynergyBool, uSynergyBool, uSynergyBool)
+{
+	MouseMove move = { x, y };
+	host(cookie)->m_moves.push_back(move);
+}
+
+static void
+appendUInt16(std::string& out, uint16_t value)
+{
+	out += static_cast<char>(value >> 8);
+	out += static_cast<char>(value & 0xff);
+}
+
+static void
+appendPacket(std::string& out, const std::string& body)
+{
+	uint32_t size = static_cast<uint32_t>(body.size());
+	out += static_cast<char>(size >> 24);
+	out += static_cast<char>((size >> 16) & 0xff);
+	out += static_cast<char>((size >> 8) & 0xff);
+	out += static_cast<char>(size & 0xff);
+	out += body;
+}
+
+static void
+appendHello(std::string& out)
+{
+	std::string body("Synergy");
+	appendUInt16(body, 1);
+	appendUInt16(body, 6);
+	appendPacket(out, body);
+}
+
+static void
+appendMouseMove(std::string& out, uint16_t x, uint16_t y)
+{
+	std::string body("DMMV");
+	appendUInt16(body, x);
+	appendUInt16(body, y);
+	appendPacket(out, body);
+}
+
+class uSynergyTests : public ::testing::Test {
+public:
+	virtual void		SetUp()
+	{
+		m_host.m_sendFails = false;
+		s_now = 1000;
+
+		uSynergyInit(&m_context);
+		m_context.m_sendFunc = &fakeSend;
+		m_context.m_getTimeFunc = &fakeGetTime;
+		m_context.m_clientName = "micro";
+		m_context.m_clientWidth = 800;
+		m_context.m_clientHeight = 600;
+		m_context.m_cookie = reinterpret_cast<uSynergyCookie>(&m_host);
+		m_context.m_mouseCallback = &fakeMouse;
+	}
+
+	// pushes the stream in chunks of chunkSize bytes
+	bool				push(const std::string& stream, size_t chunkSize)
+	{
+		const uint8_t* data = reinterpret_cast<const uint8_t*>(stream.data());
+		for (size_t i = 0; i < stream.size(); i += chunkSize) {
+			size_t size = stream.size() - i < chunkSize ? stream.size() - i : chunkSize;
+			if (!uSynergyPushData(&m_context, data + i, static_cast<int>(size))) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void				expectMoves(size_t count)
+	{
+		ASSERT_EQ(count, m_host.m_moves.size());
+		for (size_t i = 0; i < count; ++i) {
+			EXPECT_EQ(i, m_host.m_moves[i].m_x);
+			EXPECT_EQ(i * 2, m_host.m_moves[i].m_y);
+		}
+	}
+
+	FakeHost			m_host;
+	uSynergyContext		m_context;
+};
+
+TEST_F(uSynergyTests, pushData_fragmented_processesEveryPacket)
+{
+	std::string stream;
+	appendHello(stream);
+	for (uint16_t i = 0; i < 10; ++i) {
+		appendMouseMove(stream, i, i * 2);
+	}
+
+	EXPECT_TRUE(push(stream, 1));
+
+	EXPECT_TRUE(m_context.m_hasReceivedHello == USYNERGY_TRUE);
+	ASSERT_EQ(11, m_host.m_replies.size());
+	EXPECT_EQ(0, m_host.m_replies[0].compare(0, 7, "Synergy"));
+	EXPECT_EQ("CNOP", m_host.m_replies[10]);
+	expectMoves(10);
+	EXPECT_EQ(0, m_context.m_receiveCount);
+}
+
+TEST_F(uSynergyTests, pushData_coalesced_processesEveryPacket)
+{
+	std::string stream;
+	appendHello(stream);
+	for (uint16_t i = 0; i < 10; ++i) {
+		appendMouseMove(stream, i, i * 2);
+	}
+
+	EXPECT_TRUE(push(stream, stream.size()));
+
+	ASSERT_EQ(11, m_host.m_replies.size());
+	expectMoves(10);
+}
+
+TEST_F(uSynergyTests, pushData_packetsWrapRing_parsedIntact)
+{
+	// enough 12 byte packets in odd sized chunks to wrap the ring several times
+	std::string stream;
+	appendHello(stream);
+	const uint16_t count = 3 * USYNERGY_RECEIVE_BUFFER_SIZE / 12;
+	for (uint16_t i = 0; i < count; ++i) {
+		appendMouseMove(stream, i, i * 2);
+	}
+
+	EXPECT_TRUE(push(stream, 7));
+	expectMoves(count);
+
+	m_host.m_moves.clear();
+	EXPECT_TRUE(push(stream.substr(stream.find("DMMV") - 4), USYNERGY_RECEIVE_BUFFER_SIZE + 5));
+	expectMoves(count);
+}
+
+TEST_F(uSynergyTests, pushData_oversizedPacket_skippedAndStreamResyncs)
+{
+	std::string stream;
+	appendHello(stream);
+	appendPacket(stream, "DCLP" + std::string(USYNERGY_RECEIVE_BUFFER_SIZE * 2, 'x'));
+	appendMouseMove(stream, 0, 0);
+	appendMouseMove(stream, 1, 2);
+
+	EXPECT_TRUE(push(stream, 1000));
+
+	expectMoves(2);
+}
+
+TEST_F(uSynergyTests, pushData_replyFails_returnsFalse)
+{
+	std::string stream;
+	appendHello(stream);
+	m_host.m_sendFails = true;
+
+	EXPECT_FALSE(push(stream, stream.size()));
+	EXPECT_FALSE(m_context.m_connected == USYNERGY_TRUE);
+}
+
+TEST_F(uSynergyTests, getNextDeadline_tracksKeepAlive)
+{
+	EXPECT_EQ(-1, uSynergyGetNextDeadline(&m_context));
+
+	std::string hello;
+	appendHello(hello);
+	push(hello, hello.size());
+	EXPECT_EQ(USYNERGY_IDLE_TIMEOUT + 1, uSynergyGetNextDeadline(&m_context));
+
+	s_now += 1500;
+	EXPECT_EQ(USYNERGY_IDLE_TIMEOUT - 1500 + 1, uSynergyGetNextDeadline(&m_context));
+	EXPECT_TRUE(uSynergyPoll(&m_context));
+
+	// keep-alive from the server pushes the deadline out again
+	std::string keepAlive;
+	appendPacket(keepAlive, "CALV");
+	push(keepAlive, keepAlive.size());
+	EXPECT_EQ(USYNERGY_IDLE_TIMEOUT + 1, uSynergyGetNextDeadline(&m_context));
+
+	s_now += USYNERGY_IDLE_TIMEOUT + 1;
+	EXPECT_EQ(0, uSynergyGetNextDeadline(&m_context));
+	EXPECT_FALSE(uSynergyPoll(&m_context));
+	EXPECT_EQ(-1, uSynergyGetNextDeadline(&m_context));
+}
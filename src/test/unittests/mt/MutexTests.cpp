@@ -0,0 +1,265 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mt/Mutex.h"
+#include "mt/MutexProfiler.h"
+#include "mt/Lock.h"
+#include "mt/CondVar.h"
+#include "mt/Thread.h"
+#include "arch/Arch.h"
+#include "base/TMethodJob.h"
+
+#include "test/global/gtest.h"
+
+// locks a mutex from another thread
+class MutexHolder {
+public:
+	MutexHolder(Mutex* mutex) :
+		m_mutex(mutex),
+		m_locked(false),
+		m_hold(0.0),
+		m_count(0) { }
+
+	// holds the mutex for \p hold seconds
+	void				hold(double hold)
+	{
+		start(hold);
+		while (!m_locked) {
+			ARCH->sleep(0.001);
+		}
+	}
+
+	// holds the mutex for \p hold seconds once it's free
+	void				start(double hold)
+	{
+		m_hold  = hold;
+		m_count = 0;
+		run(&MutexHolder::holdThread);
+	}
+
+	bool				hasLocked() const { return m_locked; }
+
+	// locks and unlocks the mutex \p count times
+	void				hammer(int count)
+	{
+		m_count = count;
+		run(&MutexHolder::hammerThread);
+	}
+
+	void				wait()
+	{
+		m_thread->wait();
+		delete m_thread;
+		m_thread = NULL;
+	}
+
+private:
+	void				run(void (MutexHolder::*method)(void*))
+	{
+		m_thread = new Thread(new TMethodJob<MutexHolder>(this, method));
+	}
+
+	void				holdThread(void*)
+	{
+		Lock lock(m_mutex, "holder");
+		m_locked = true;
+		ARCH->sleep(m_hold);
+	}
+
+	void				hammerThread(void*)
+	{
+		for (int i = 0; i < m_count; ++i) {
+			Lock lock(m_mutex, "hammer");
+		}
+	}
+
+private:
+	Mutex*				m_mutex;
+	Thread*				m_thread;
+	volatile bool		m_locked;
+	double				m_hold;
+	int					m_count;
+};
+
+class MutexTests : public ::testing::Test {
+protected:
+	virtual void		SetUp()
+	{
+		MutexProfiler::setEnabled(true);
+		MutexProfiler::reset();
+	}
+
+	virtual void		TearDown()
+	{
+		Mutex::setSpinning(false);
+		MutexProfiler::setEnabled(false);
+		MutexProfiler::reset();
+	}
+};
+
+TEST_F(MutexTests, lock_uncontended_countedPerSite)
+{
+	Mutex mutex("MutexTests.uncontended");
+	for (int i = 0; i < 10; ++i) {
+		Lock lock(&mutex, "first");
+	}
+	for (int i = 0; i < 5; ++i) {
+		Lock lock(&mutex, "second");
+	}
+	{
+		Lock lock(&mutex);
+	}
+
+	MutexStats stats;
+	ASSERT_TRUE(MutexProfiler::getStats("MutexTests.uncontended", stats));
+	EXPECT_EQ(16, stats.m_acquisitions);
+	EXPECT_EQ(0, stats.m_contended);
+	EXPECT_EQ(10, stats.m_sites["first"].m_acquisitions);
+	EXPECT_EQ(5, stats.m_sites["second"].m_acquisitions);
+	EXPECT_EQ(1, stats.m_sites["unknown"].m_acquisitions);
+}
+
+TEST_F(MutexTests, lock_heldByOtherThread_waitAndHoldTimed)
+{
+	Mutex mutex("MutexTests.held");
+	MutexHolder holder(&mutex);
+	holder.hold(0.05);
+	{
+		Lock lock(&mutex, "waiter");
+	}
+	holder.wait();
+
+	MutexStats stats;
+	ASSERT_TRUE(MutexProfiler::getStats("MutexTests.held", stats));
+	EXPECT_EQ(2, stats.m_acquisitions);
+	EXPECT_EQ(1, stats.m_contended);
+	EXPECT_EQ(1, stats.m_sites["waiter"].m_contended);
+	EXPECT_LE(0.02, stats.m_sites["waiter"].m_waitTime);
+	EXPECT_LE(0.02, stats.m_maxWait);
+	EXPECT_LE(0.04, stats.m_maxHold);
+	EXPECT_LE(stats.m_maxHold, stats.m_holdTime);
+}
+
+TEST_F(MutexTests, wait_heldByOtherThread_holdTimed)
+{
+	Mutex mutex("MutexTests.condVar");
+	CondVar<bool> cond(&mutex, false);
+	MutexHolder holder(&mutex);
+	{
+		Lock lock(&mutex, "waiter");
+
+		// the holder can only get the lock while we wait
+		holder.start(0.05);
+		while (!holder.hasLocked()) {
+			cond.wait(0.01);
+		}
+	}
+	holder.wait();
+
+	MutexStats stats;
+	ASSERT_TRUE(MutexProfiler::getStats("MutexTests.condVar", stats));
+	EXPECT_EQ(2, stats.m_acquisitions);
+	EXPECT_EQ(1, stats.m_sites["holder"].m_acquisitions);
+	EXPECT_LE(0.04, stats.m_maxHold);
+	EXPECT_LE(stats.m_maxHold, stats.m_holdTime);
+}
+
+TEST_F(MutexTests, lock_heldLongWhileSpinning_blocks)
+{
+	Mutex::setSpinning(true);
+	Mutex mutex("MutexTests.spinHeld");
+	MutexHolder holder(&mutex);
+	holder.hold(0.05);
+	{
+		Lock lock(&mutex, "waiter");
+	}
+	holder.wait();
+
+	MutexStats stats;
+	ASSERT_TRUE(MutexProfiler::getStats("MutexTests.spinHeld", stats));
+	EXPECT_EQ(2, stats.m_acquisitions);
+	EXPECT_EQ(1, stats.m_contended);
+	EXPECT_EQ(0, stats.m_spun);
+	EXPECT_LE(0.02, stats.m_maxWait);
+}
+
+TEST_F(MutexTests, lock_hammeredByTwoThreads_allCounted)
+{
+	const int count = 20000;
+	Mutex::setSpinning(true);
+	Mutex mutex("MutexTests.hammered");
+	MutexHolder holder(&mutex);
+	holder.hammer(count);
+	for (int i = 0; i < count; ++i) {
+		Lock lock(&mutex, "main");
+	}
+	holder.wait();
+
+	MutexStats stats;
+	ASSERT_TRUE(MutexProfiler::getStats("MutexTests.hammered", stats));
+	EXPECT_EQ(2 * count, stats.m_acquisitions);
+	EXPECT_EQ(count, stats.m_sites["main"].m_acquisitions);
+	EXPECT_EQ(count, stats.m_sites["hammer"].m_acquisitions);
+	EXPECT_LE(stats.m_spun, stats.m_contended);
+}
+
+TEST_F(MutexTests, getAllStats_longestWaitFirst)
+{
+	Mutex quiet("MutexTests.quiet");
+	Mutex busy("MutexTests.busy");
+	{
+		Lock lock(&quiet);
+	}
+	MutexHolder holder(&busy);
+	holder.hold(0.02);
+	{
+		Lock lock(&busy);
+	}
+	holder.wait();
+
+	MutexProfiler::StatsList all = MutexProfiler::getAllStats();
+	ASSERT_FALSE(all.empty());
+	EXPECT_EQ("MutexTests.busy", all.front().m_name);
+	EXPECT_NE(String::npos, MutexProfiler::format().find("MutexTests.quiet"));
+}
+
+TEST_F(MutexTests, reset_clearsStatistics)
+{
+	Mutex mutex("MutexTests.reset");
+	{
+		Lock lock(&mutex, "site");
+	}
+	MutexProfiler::reset();
+
+	MutexStats stats;
+	ASSERT_TRUE(MutexProfiler::getStats("MutexTests.reset", stats));
+	EXPECT_EQ(0, stats.m_acquisitions);
+	EXPECT_TRUE(stats.m_sites.empty());
+}
+
+TEST_F(MutexTests, lock_disabled_notCounted)
+{
+	MutexProfiler::setEnabled(false);
+	Mutex mutex("MutexTests.disabled");
+	{
+		Lock lock(&mutex);
+	}
+
+	MutexStats stats;
+	MutexProfiler::getStats("MutexTests.disabled", stats);
+	EXPECT_EQ(0, stats.m_acquisitions);
+}
@@ -0,0 +1,181 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_ENV
+
+#include "test/mock/io/MockStream.h"
+#include "test/mock/server/MockServer.h"
+#include "server/ClientProxyUnknown.h"
+#include "server/ClientProxy.h"
+#include "test/global/TestEventQueue.h"
+#include "base/TMethodEventJob.h"
+#include "base/String.h"
+
+#include "test/global/gtest.h"
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+// serves reads from a string and collects writes in another
+class StreamData {
+public:
+	UInt32				read(void* buffer, UInt32 n)
+	{
+		if (n > m_input.size()) {
+			n = static_cast<UInt32>(m_input.size());
+		}
+		memcpy(buffer, m_input.data(), n);
+		m_input.erase(0, n);
+		return n;
+	}
+
+	void				write(const void* buffer, UInt32 n)
+	{
+		m_output.append(static_cast<const char*>(buffer), n);
+	}
+
+	UInt32				getSize() const
+	{
+		return static_cast<UInt32>(m_input.size());
+	}
+
+	void				add16(SInt16 value)
+	{
+		m_input += static_cast<char>((value >> 8) & 0xff);
+		m_input += static_cast<char>( value       & 0xff);
+	}
+
+	void				addHelloBack(SInt16 major, SInt16 minor, const String& name)
+	{
+		m_input += "Synergy";
+		add16(major);
+		add16(minor);
+		m_input += String(3, '\0');
+		m_input += static_cast<char>(name.size());
+		m_input += name;
+	}
+
+public:
+	String				m_input;
+	String				m_output;
+};
+
+class ClientProxyUnknownTests : public ::testing::Test {
+public:
+	ClientProxyUnknownTests() :
+		m_stream(new NiceMock<MockStream>),
+		m_received(false)
+	{
+		ON_CALL(*m_stream, getEventTarget()).WillByDefault(Return(m_stream));
+		ON_CALL(*m_stream, read(_, _)).WillByDefault(Invoke(&m_data, &StreamData::read));
+		ON_CALL(*m_stream, write(_, _)).WillByDefault(Invoke(&m_data, &StreamData::write));
+		ON_CALL(*m_stream, getSize()).WillByDefault(Invoke(&m_data, &StreamData::getSize));
+	}
+
+	void				inputReady()
+	{
+		m_events.dispatchEvent(Event(m_events.forIStream().inputReady(), m_stream));
+	}
+
+	// run the event loop until an event of \p type for \p target
+	bool				waitFor(Event::Type type, void* target)
+	{
+		m_received = false;
+		m_events.adoptHandler(type, target,
+			new TMethodEventJob<ClientProxyUnknownTests>(
+				this, &ClientProxyUnknownTests::handleEvent));
+		m_events.initQuitTimeout(5);
+		m_events.loop();
+		m_events.cleanupQuitTimeout();
+		m_events.removeHandler(type, target);
+		return m_received;
+	}
+
+	void				handleEvent(const Event&, void*)
+	{
+		m_received = true;
+		m_events.raiseQuitEvent();
+	}
+
+public:
+	TestEventQueue		m_events;
+	MockServer			m_server;
+	StreamData			m_data;
+	NiceMock<MockStream>*	m_stream;
+	bool				m_received;
+};
+
+TEST_F(ClientProxyUnknownTests, handshake_validClient_success)
+{
+	ClientProxyUnknown unknown(m_stream, 30.0, &m_server, &m_events);
+	EXPECT_EQ(String("Synergy\0\1\0\10", 11), m_data.m_output);
+
+	m_data.m_output.clear();
+	m_data.addHelloBack(1, 0, "stub");
+	inputReady();
+
+	// the protocol 1.0 proxy has taken over and asks for screen info
+	EXPECT_EQ("QINF", m_data.m_output);
+	EXPECT_TRUE(unknown.orphanClientProxy() == NULL);
+
+	m_data.m_input = "DINF";
+	m_data.add16(0);
+	m_data.add16(0);
+	m_data.add16(1024);
+	m_data.add16(768);
+	m_data.add16(0);
+	m_data.add16(0);
+	m_data.add16(0);
+	inputReady();
+
+	EXPECT_TRUE(waitFor(
+		m_events.forClientProxyUnknown().success(), &unknown));
+	ClientProxy* proxy = unknown.orphanClientProxy();
+	ASSERT_TRUE(proxy != NULL);
+	EXPECT_EQ("stub", proxy->getName());
+	delete proxy;
+}
+
+TEST_F(ClientProxyUnknownTests, handshake_badReply_failure)
+{
+	ClientProxyUnknown unknown(m_stream, 30.0, &m_server, &m_events);
+
+	m_data.m_output.clear();
+	m_data.m_input = "Bogus reply";
+	inputReady();
+
+	EXPECT_EQ("EBAD", m_data.m_output);
+	EXPECT_TRUE(waitFor(
+		m_events.forClientProxyUnknown().failure(), &unknown));
+	EXPECT_TRUE(unknown.orphanClientProxy() == NULL);
+}
+
+TEST_F(ClientProxyUnknownTests, handshake_unknownVersion_incompatible)
+{
+	ClientProxyUnknown unknown(m_stream, 30.0, &m_server, &m_events);
+
+	m_data.m_output.clear();
+	m_data.addHelloBack(2, 0, "stub");
+	inputReady();
+
+	EXPECT_EQ(String("EICV\0\1\0\10", 8), m_data.m_output);
+	EXPECT_TRUE(waitFor(
+		m_events.forClientProxyUnknown().failure(), &unknown));
+	EXPECT_TRUE(unknown.orphanClientProxy() == NULL);
+}
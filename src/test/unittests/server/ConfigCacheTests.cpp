@@ -0,0 +1,179 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "server/ConfigCache.h"
+#include "server/Config.h"
+#include "test/global/TestEventQueue.h"
+#include "base/String.h"
+
+#include "test/global/gtest.h"
+
+#include <cstdio>
+#include <sstream>
+
+// a grid of screens with fractional links, aliases, options and hot keys
+static String
+makeSource(int width, int height)
+{
+	std::ostringstream s;
+	s << "section: screens\n";
+	for (int i = 0; i < width * height; ++i) {
+		s << "\tscreen" << i << ":\n";
+		if (i % 3 == 0) {
+			s << "\t\thalfDuplexCapsLock = true\n";
+			s << "\t\tswitchCorners = none +top-left +bottom-right\n";
+		}
+	}
+	s << "end\n";
+
+	s << "section: links\n";
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			int i = y * width + x;
+			s << "\tscreen" << i << ":\n";
+			if (x + 1 < width) {
+				s << "\t\tright(0,50) = screen" << (i + 1) << "(25,75)\n";
+				s << "\t\tright(50,100) = screen" << (i + 1) << "\n";
+			}
+			if (x > 0) {
+				s << "\t\tleft = screen" << (i - 1) << "(0,33)\n";
+			}
+			if (y + 1 < height) {
+				s << "\t\tdown(10,90) = screen" << (i + width) << "\n";
+			}
+		}
+	}
+	s << "end\n";
+
+	s << "section: aliases\n";
+	for (int i = 0; i < width * height; i += 2) {
+		s << "\tscreen" << i << ":\n";
+		s << "\t\thost" << i << ".example.com\n";
+	}
+	s << "end\n";
+
+	s << "section: options\n";
+	s << "\theartbeat = 5000\n";
+	s << "\tswitchDelay = 250\n";
+	s << "\taddress = 127.0.0.1:24801\n";
+	s << "\tkeystroke(alt+left) = switchInDirection(left)\n";
+	s << "\tkeystroke(control+alt+1) = switchToScreen(screen1)\n";
+	s << "\tmousebutton(shift+2) = lockCursorToScreen(toggle)\n";
+	s << "end\n";
+	return s.str();
+}
+
+class ConfigCacheTests : public ::testing::Test {
+public:
+	void				parse(const String& source, Config& config)
+	{
+		std::istringstream s(source);
+		s >> config;
+	}
+
+public:
+	TestEventQueue		m_events;
+};
+
+TEST_F(ConfigCacheTests, decode_encodedConfig_equalsParsedConfig)
+{
+	String source = makeSource(20, 15);
+	Config parsed(&m_events);
+	parse(source, parsed);
+
+	Config cached(&m_events);
+	ASSERT_TRUE(ConfigCache::decode(
+		ConfigCache::encode(source, parsed), source, cached));
+
+	EXPECT_TRUE(cached == parsed);
+	EXPECT_TRUE(cached.hasLockToScreenAction());
+	EXPECT_EQ("screen0", cached.getCanonicalName("HOST0.example.com"));
+
+	std::ostringstream parsedText, cachedText;
+	parsedText << parsed;
+	cachedText << cached;
+	EXPECT_EQ(parsedText.str(), cachedText.str());
+}
+
+TEST_F(ConfigCacheTests, decode_emptyConfig_equalsParsedConfig)
+{
+	String source;
+	Config parsed(&m_events);
+	parse(source, parsed);
+
+	Config cached(&m_events);
+	ASSERT_TRUE(ConfigCache::decode(
+		ConfigCache::encode(source, parsed), source, cached));
+
+	// neither has an address so compare their text
+	std::ostringstream parsedText, cachedText;
+	parsedText << parsed;
+	cachedText << cached;
+	EXPECT_EQ(parsedText.str(), cachedText.str());
+}
+
+TEST_F(ConfigCacheTests, decode_sourceChanged_configUnchanged)
+{
+	String source = makeSource(3, 2);
+	Config parsed(&m_events);
+	parse(source, parsed);
+	String image = ConfigCache::encode(source, parsed);
+
+	Config cached(&m_events);
+	String edited = source;
+	edited.replace(edited.find("5000"), 4, "6000");
+	EXPECT_FALSE(ConfigCache::decode(image, edited, cached));
+	EXPECT_FALSE(ConfigCache::decode(image, source + "\n", cached));
+	EXPECT_EQ(cached.end(), cached.begin());
+}
+
+TEST_F(ConfigCacheTests, decode_corruptImage_fails)
+{
+	String source = makeSource(3, 2);
+	Config parsed(&m_events);
+	parse(source, parsed);
+	String image = ConfigCache::encode(source, parsed);
+
+	Config cached(&m_events);
+	for (String::size_type i = 0; i < image.size(); i += 7) {
+		String corrupt = image;
+		corrupt[i] = static_cast<char>(corrupt[i] ^ 0x5a);
+		EXPECT_FALSE(ConfigCache::decode(corrupt, source, cached)) << i;
+	}
+	EXPECT_FALSE(ConfigCache::decode(
+		image.substr(0, image.size() - 1), source, cached));
+	EXPECT_FALSE(ConfigCache::decode(image + '\0', source, cached));
+	EXPECT_EQ(cached.end(), cached.begin());
+}
+
+TEST_F(ConfigCacheTests, load_savedCache_equalsParsedConfig)
+{
+	String source = makeSource(4, 4);
+	Config parsed(&m_events);
+	parse(source, parsed);
+
+	String path = ConfigCache::getCachePath("ConfigCacheTests.conf");
+	ASSERT_TRUE(ConfigCache::save(path, source, parsed));
+
+	Config cached(&m_events);
+	EXPECT_TRUE(ConfigCache::load(path, source, cached));
+	EXPECT_TRUE(cached == parsed);
+	EXPECT_FALSE(ConfigCache::load(path, makeSource(4, 3), cached));
+
+	remove(path.c_str());
+	EXPECT_FALSE(ConfigCache::load(path, source, cached));
+}
@@ -0,0 +1,375 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#define TEST_ENV
+
+#include "server/Server.h"
+#include "server/Config.h"
+#include "server/SwitchRetry.h"
+#include "test/mock/server/MockClientProxy.h"
+#include "test/mock/server/MockPrimaryClient.h"
+#include "test/mock/synergy/MockScreen.h"
+#include "test/global/TestEventQueue.h"
+#include "synergy/IPrimaryScreen.h"
+#include "synergy/ServerArgs.h"
+#include "base/TMethodEventJob.h"
+
+#include "test/global/gtest.h"
+#include "test/global/gmock.h"
+
+#include <algorithm>
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+static const SInt32		s_size = 1000;
+
+static
+void
+getScreenShape(SInt32& x, SInt32& y, SInt32& w, SInt32& h)
+{
+	x = 0;
+	y = 0;
+	w = s_size;
+	h = s_size;
+}
+
+static
+void
+getCursorCenter(SInt32& x, SInt32& y)
+{
+	x = s_size / 2;
+	y = s_size / 2;
+}
+
+// what a client proxy does with the clipboards the server gives it
+class ClipboardTracker {
+public:
+	ClipboardTracker() : m_entered(false)
+	{
+		for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
+			m_dirty[id]       = true;
+			m_prefetched[id]  = 0;
+			m_sentOnEnter[id] = 0;
+		}
+	}
+
+	void				enter(SInt32, SInt32, UInt32, KeyModifierMask, bool)
+	{
+		m_entered = true;
+	}
+
+	void				setClipboardDirty(ClipboardID id, bool dirty)
+	{
+		m_dirty[id] = dirty;
+	}
+
+	void				setClipboard(ClipboardID id, const IClipboard*)
+	{
+		// only dirty clipboards are sent
+		if (m_dirty[id]) {
+			m_dirty[id] = false;
+			++(m_entered ? m_sentOnEnter[id] : m_prefetched[id]);
+		}
+	}
+
+	bool				m_entered;
+	bool				m_dirty[kClipboardEnd];
+	int					m_prefetched[kClipboardEnd];
+	int					m_sentOnEnter[kClipboardEnd];
+};
+
+// a primary screen with a client screen to its right and another below
+// it.  the cursor is moved on the primary screen by a timer while the
+// event loop runs.
+class ServerTests : public ::testing::Test {
+public:
+	ServerTests() :
+		m_config(&m_events),
+		m_client(NULL),
+		m_client2(NULL),
+		m_server(NULL),
+		m_moveTimer(NULL),
+		m_x(s_size / 2),
+		m_y(s_size / 2),
+		m_step(0),
+		m_moving(true),
+		m_switched(false),
+		m_ticks(0),
+		m_quitAfterTicks(-1),
+		m_leaveFailures(0),
+		m_leaves(0),
+		m_ticksWhileWaiting(0),
+		m_retargetX(-1),
+		m_retargetY(-1),
+		m_switchBack(false)
+	{
+		m_config.addScreen("primary");
+		m_config.addScreen("client");
+		m_config.addScreen("client2");
+		m_config.connect("primary", kRight, 0.0f, 1.0f, "client", 0.0f, 1.0f);
+		m_config.connect("client", kLeft, 0.0f, 1.0f, "primary", 0.0f, 1.0f);
+		m_config.connect("primary", kBottom, 0.0f, 1.0f, "client2", 0.0f, 1.0f);
+		m_config.connect("client2", kTop, 0.0f, 1.0f, "primary", 0.0f, 1.0f);
+
+		ON_CALL(m_primary, getName()).WillByDefault(Return(String("primary")));
+		ON_CALL(m_primary, getEventTarget()).WillByDefault(Return(&m_primary));
+		ON_CALL(m_primary, getShape(_, _, _, _))
+			.WillByDefault(Invoke(getScreenShape));
+		ON_CALL(m_primary, getCursorCenter(_, _))
+			.WillByDefault(Invoke(getCursorCenter));
+		ON_CALL(m_primary, getJumpZoneSize()).WillByDefault(Return(1));
+		ON_CALL(m_primary, leave())
+			.WillByDefault(Invoke(this, &ServerTests::leave));
+		ON_CALL(m_primary, getClipboard(_, _))
+			.WillByDefault(Invoke(this, &ServerTests::getClipboard));
+	}
+
+	virtual void		SetUp()
+	{
+		m_server = new Server(m_config, &m_primary, &m_screen,
+							&m_events, m_args);
+
+		m_client = new NiceMock<MockClientProxy>("client");
+		ON_CALL(*m_client, getShape(_, _, _, _))
+			.WillByDefault(Invoke(getScreenShape));
+		ON_CALL(*m_client, getCursorPos(_, _))
+			.WillByDefault(Invoke(getCursorCenter));
+		ON_CALL(*m_client, enter(_, _, _, _, _))
+			.WillByDefault(Invoke(&m_clipboards, &ClipboardTracker::enter));
+		ON_CALL(*m_client, setClipboardDirty(_, _))
+			.WillByDefault(Invoke(&m_clipboards,
+								&ClipboardTracker::setClipboardDirty));
+		ON_CALL(*m_client, setClipboard(_, _))
+			.WillByDefault(Invoke(this, &ServerTests::setClipboard));
+		m_server->adoptClient(m_client);
+
+		m_client2 = new NiceMock<MockClientProxy>("client2");
+		ON_CALL(*m_client2, getShape(_, _, _, _))
+			.WillByDefault(Invoke(getScreenShape));
+		ON_CALL(*m_client2, getCursorPos(_, _))
+			.WillByDefault(Invoke(getCursorCenter));
+		m_server->adoptClient(m_client2);
+
+		m_events.adoptHandler(Event::kTimer, this,
+			new TMethodEventJob<ServerTests>(this, &ServerTests::handleMove));
+		m_events.adoptHandler(m_events.forServer().screenSwitched(), m_server,
+			new TMethodEventJob<ServerTests>(this,
+								&ServerTests::handleSwitched));
+		m_clipboardText = "text";
+		m_changeOnPrefetch = false;
+	}
+
+	virtual void		TearDown()
+	{
+		if (m_moveTimer != NULL) {
+			m_events.deleteTimer(m_moveTimer);
+		}
+		m_events.removeHandler(Event::kTimer, this);
+		m_events.removeHandler(m_events.forServer().screenSwitched(), m_server);
+		delete m_server;
+		delete m_client2;
+		delete m_client;
+	}
+
+	// moves the cursor \p step pixels right every 5ms until the server
+	// switches screens or \p timeout seconds pass
+	void				moveRight(SInt32 step, double timeout)
+	{
+		m_step      = step;
+		m_moveTimer = m_events.newTimer(0.005, this);
+		m_events.initQuitTimeout(timeout);
+		m_events.loop();
+		m_events.cleanupQuitTimeout();
+		m_events.deleteTimer(m_moveTimer);
+		m_moveTimer = NULL;
+	}
+
+	void				handleMove(const Event&, void*)
+	{
+		if (m_leaves > 0 && !m_switched) {
+			++m_ticksWhileWaiting;
+		}
+		if (m_moving) {
+			m_x = std::min(m_x + m_step, s_size - 1);
+			m_events.addEvent(Event(
+							m_events.forIPrimaryScreen().motionOnPrimary(),
+							m_primary.getEventTarget(),
+							IPrimaryScreen::MotionInfo::alloc(m_x, m_y)));
+		}
+		if (++m_ticks == m_quitAfterTicks) {
+			m_events.raiseQuitEvent();
+		}
+	}
+
+	// fails the first m_leaveFailures times, as if another program
+	// held a grab.  the first failure can move the cursor elsewhere.
+	bool				leave()
+	{
+		if (++m_leaves > m_leaveFailures) {
+			return true;
+		}
+		if (m_leaves == 1 && m_retargetX >= 0) {
+			m_x    = m_retargetX;
+			m_y    = m_retargetY;
+			m_step = 0;
+		}
+		if (m_leaves == 1 && m_switchBack) {
+			m_moving = false;
+			m_events.addEvent(Event(m_events.forServer().switchToScreen(),
+							m_config.getInputFilter(),
+							Server::SwitchToScreenInfo::alloc("primary")));
+		}
+		return false;
+	}
+
+	void				handleSwitched(const Event&, void*)
+	{
+		m_switched = true;
+		m_events.raiseQuitEvent();
+	}
+
+	bool				getClipboard(ClipboardID, IClipboard* clipboard)
+	{
+		clipboard->open(0);
+		clipboard->empty();
+		clipboard->add(IClipboard::kText, m_clipboardText);
+		clipboard->close();
+		return true;
+	}
+
+	void				setClipboard(ClipboardID id, const IClipboard* clipboard)
+	{
+		m_clipboards.setClipboard(id, clipboard);
+
+		// the user copies something else after the prefetch
+		if (m_changeOnPrefetch && !m_clipboards.m_entered) {
+			m_clipboardText = "changed";
+		}
+	}
+
+	TestEventQueue		m_events;
+	Config				m_config;
+	ServerArgs			m_args;
+	NiceMock<MockScreen>
+						m_screen;
+	NiceMock<MockPrimaryClient>
+						m_primary;
+	NiceMock<MockClientProxy>*
+						m_client;
+	NiceMock<MockClientProxy>*
+						m_client2;
+	Server*				m_server;
+	ClipboardTracker	m_clipboards;
+	String				m_clipboardText;
+	bool				m_changeOnPrefetch;
+	EventQueueTimer*	m_moveTimer;
+	SInt32				m_x;
+	SInt32				m_y;
+	SInt32				m_step;
+	bool				m_moving;
+	bool				m_switched;
+	int					m_ticks;
+	int					m_quitAfterTicks;
+	int					m_leaveFailures;
+	int					m_leaves;
+	int					m_ticksWhileWaiting;
+	SInt32				m_retargetX;
+	SInt32				m_retargetY;
+	bool				m_switchBack;
+};
+
+TEST_F(ServerTests, clipboardPrefetch_approachingEdge_switchSendsNothing)
+{
+	moveRight(20, 5.0);
+
+	ASSERT_TRUE(m_switched);
+	for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
+		EXPECT_EQ(1, m_clipboards.m_prefetched[id]) << "clipboard " << id;
+		EXPECT_EQ(0, m_clipboards.m_sentOnEnter[id]) << "clipboard " << id;
+		EXPECT_FALSE(m_clipboards.m_dirty[id]) << "clipboard " << id;
+	}
+}
+
+TEST_F(ServerTests, clipboardPrefetch_changedAfterPrefetch_resentOnSwitch)
+{
+	m_changeOnPrefetch = true;
+	moveRight(20, 5.0);
+
+	ASSERT_TRUE(m_switched);
+	for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
+		EXPECT_EQ(1, m_clipboards.m_prefetched[id]) << "clipboard " << id;
+		EXPECT_EQ(1, m_clipboards.m_sentOnEnter[id]) << "clipboard " << id;
+	}
+}
+
+TEST_F(ServerTests, switchRetry_leaveFails_eventsAndTimersRun)
+{
+	m_leaveFailures = 3;
+	EXPECT_CALL(*m_client, enter(_, _, _, _, _)).Times(1);
+
+	moveRight(500, 5.0);
+
+	ASSERT_TRUE(m_switched);
+	EXPECT_EQ(4, m_leaves);
+
+	// the move timer and its motion kept running between the retries
+	EXPECT_GT(m_ticksWhileWaiting, m_leaveFailures);
+}
+
+TEST_F(ServerTests, switchRetry_movedToOtherEdge_switchesToNewTarget)
+{
+	m_leaveFailures = 3;
+	m_retargetX     = s_size / 2;
+	m_retargetY     = s_size - 1;
+	EXPECT_CALL(*m_client, enter(_, _, _, _, _)).Times(0);
+	EXPECT_CALL(*m_client2, enter(_, _, _, _, _)).Times(1);
+
+	moveRight(500, 5.0);
+
+	ASSERT_TRUE(m_switched);
+	EXPECT_EQ(4, m_leaves);
+}
+
+TEST_F(ServerTests, switchRetry_movedOffEdge_retryCancelled)
+{
+	m_leaveFailures  = 1000;
+	m_retargetX      = s_size / 2;
+	m_retargetY      = s_size / 2;
+	m_quitAfterTicks = static_cast<int>(4 * SwitchRetry::kInterval / 0.005);
+
+	moveRight(500, 5.0);
+
+	EXPECT_FALSE(m_switched);
+	EXPECT_EQ(1, m_leaves);
+}
+
+TEST_F(ServerTests, switchRetry_switchToActiveScreen_retryCancelled)
+{
+	m_leaveFailures  = 1000;
+	m_switchBack     = true;
+	m_quitAfterTicks = static_cast<int>(4 * SwitchRetry::kInterval / 0.005);
+	EXPECT_CALL(m_primary, mouseMove(_, _)).Times(1);
+
+	moveRight(500, 5.0);
+
+	EXPECT_FALSE(m_switched);
+	EXPECT_EQ(1, m_leaves);
+}
@@ -0,0 +1,148 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "server/SwitchPredictor.h"
+
+#include "test/global/gtest.h"
+
+#include <algorithm>
+
+// a 1920x1080 screen with a 1 pixel jump zone
+const SInt32 kScreenW = 1920;
+const SInt32 kScreenH = 1080;
+const SInt32 kZoneSize = 1;
+const double kHorizon = 0.25;
+
+// feed motion from x,y at vx,vy pixels per second sampled at rate Hz
+static void
+moveSteadily(SwitchPredictor& predictor, SInt32 x, SInt32 y,
+				double vx, double vy, double rate, int samples)
+{
+	for (int i = 0; i < samples; ++i) {
+		double t = i / rate;
+		predictor.addMotion(x + static_cast<SInt32>(vx * t),
+							y + static_cast<SInt32>(vy * t), t);
+	}
+}
+
+TEST(SwitchPredictorTests, addMotion_steadyMotion_estimatesVelocity)
+{
+	SwitchPredictor predictor;
+	moveSteadily(predictor, 100, 500, 1000.0, -500.0, 125.0, 20);
+
+	EXPECT_NEAR(1000.0, predictor.getXVelocity(), 20.0);
+	EXPECT_NEAR(-500.0, predictor.getYVelocity(), 20.0);
+}
+
+TEST(SwitchPredictorTests, addMotion_afterRest_velocityCleared)
+{
+	SwitchPredictor predictor;
+	moveSteadily(predictor, 100, 500, 1000.0, 0.0, 125.0, 20);
+	predictor.addMotion(300, 500, 10.0);
+
+	EXPECT_EQ(0.0, predictor.getXVelocity());
+	EXPECT_EQ(0.0, predictor.getYVelocity());
+}
+
+TEST(SwitchPredictorTests, predict_approachingRight_returnsRight)
+{
+	SwitchPredictor predictor;
+	moveSteadily(predictor, 1500, 500, 1000.0, 100.0, 125.0, 25);
+
+	SInt32 x, y;
+	EDirection dir = predictor.predict(1700, 520, 0, 0, kScreenW, kScreenH,
+							kZoneSize, kHorizon, x, y);
+
+	EXPECT_EQ(kRight, dir);
+	EXPECT_EQ(kScreenW, x);
+	EXPECT_NEAR(542, y, 5);
+}
+
+TEST(SwitchPredictorTests, predict_approachingTop_returnsTop)
+{
+	SwitchPredictor predictor;
+	moveSteadily(predictor, 900, 400, 0.0, -2000.0, 125.0, 10);
+
+	SInt32 x, y;
+	EDirection dir = predictor.predict(900, 220, 0, 0, kScreenW, kScreenH,
+							kZoneSize, kHorizon, x, y);
+
+	EXPECT_EQ(kTop, dir);
+	EXPECT_EQ(900, x);
+	EXPECT_EQ(-1, y);
+}
+
+TEST(SwitchPredictorTests, predict_farOrMovingAway_returnsNone)
+{
+	SwitchPredictor predictor;
+	SInt32 x, y;
+
+	moveSteadily(predictor, 200, 500, 200.0, 0.0, 125.0, 25);
+	EXPECT_EQ(kNoDirection, predictor.predict(300, 500, 0, 0,
+							kScreenW, kScreenH, kZoneSize, kHorizon, x, y));
+
+	predictor.reset();
+	moveSteadily(predictor, 1800, 500, -1000.0, 0.0, 125.0, 10);
+	EXPECT_EQ(kNoDirection, predictor.predict(1720, 500, 0, 0,
+							kScreenW, kScreenH, kZoneSize, kHorizon, x, y));
+}
+
+TEST(SwitchPredictorTests, predict_simulatedMotion_leadCoversTransfer)
+{
+	// a cursor flicked towards the right edge at 2000 pixels per second,
+	// sampled at 125Hz, with a 4MB clipboard to send over 100Mbit/s.
+	// without prefetch the first input on the new screen waits for the
+	// whole clipboard;  with it only for what's left at the switch.
+	// the latencies are modelled from the prediction lead, not measured.
+	const double kRate      = 125.0;
+	const double kSpeed     = 2000.0;
+	const double kClipboard = 4.0 * 1024 * 1024;
+	const double kBandwidth = 100.0e6 / 8;
+
+	SwitchPredictor predictor;
+	double prefetchTime = -1.0, switchTime = -1.0;
+	for (int i = 0; switchTime < 0.0; ++i) {
+		double t = i / kRate;
+		SInt32 x = 200 + static_cast<SInt32>(kSpeed * t);
+		if (x >= kScreenW - kZoneSize) {
+			switchTime = t;
+			break;
+		}
+		predictor.addMotion(x, 540, t);
+
+		SInt32 xn, yn;
+		if (prefetchTime < 0.0 &&
+			predictor.predict(x, 540, 0, 0, kScreenW, kScreenH,
+							kZoneSize, kHorizon, xn, yn) == kRight) {
+			prefetchTime = t;
+		}
+	}
+	ASSERT_GE(prefetchTime, 0.0);
+
+	double lead        = switchTime - prefetchTime;
+	double sentAhead   = std::min(kClipboard, lead * kBandwidth);
+	double latency     = kClipboard / kBandwidth;
+	double prefetched  = (kClipboard - sentAhead) / kBandwidth;
+
+	EXPECT_GT(lead, 0.8 * kHorizon);
+	EXPECT_LT(prefetched, 0.5 * latency);
+
+	RecordProperty("predictionLeadMs", static_cast<int>(lead * 1000));
+	RecordProperty("modelledSwitchLatencyMs", static_cast<int>(latency * 1000));
+	RecordProperty("modelledPrefetchSwitchLatencyMs",
+							static_cast<int>(prefetched * 1000));
+}
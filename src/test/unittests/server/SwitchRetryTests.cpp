@@ -0,0 +1,181 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "server/SwitchRetry.h"
+#include "test/global/TestEventQueue.h"
+#include "base/TMethodEventJob.h"
+#include "base/TMethodJob.h"
+#include "base/Stopwatch.h"
+
+#include "test/global/gtest.h"
+
+// the retry never dereferences the screen so any address will do
+static BaseClientProxy*
+fakeScreen(int& id)
+{
+	return reinterpret_cast<BaseClientProxy*>(&id);
+}
+
+class SwitchRetryTests : public ::testing::Test {
+public:
+	SwitchRetryTests() :
+		m_retry(NULL),
+		m_failures(0),
+		m_attempts(0),
+		m_ticks(0),
+		m_switched(false),
+		m_switchedTo(NULL),
+		m_x(0),
+		m_y(0),
+		m_forScreensaver(false),
+		m_ticker(NULL)
+	{
+		m_retry = new SwitchRetry(&m_events,
+							new TMethodJob<SwitchRetryTests>(
+								this, &SwitchRetryTests::attempt));
+	}
+
+	~SwitchRetryTests()
+	{
+		delete m_retry;
+	}
+
+	// stands in for Server::switchScreen.  leaving the screen fails
+	// m_failures times before it succeeds.
+	void				attempt(void*)
+	{
+		EXPECT_TRUE(m_retry->isRetrying());
+		if (++m_attempts <= m_failures) {
+			return;
+		}
+		m_switched   = true;
+		m_switchedTo = m_retry->getScreen();
+		m_retry->getPosition(m_x, m_y);
+		m_forScreensaver = m_retry->isForScreensaver();
+		m_retry->stop();
+	}
+
+	// run the event loop, with an unrelated periodic timer, until the
+	// retry stops waiting
+	void				run()
+	{
+		m_ticker = m_events.newTimer(0.01, NULL);
+		m_events.adoptHandler(Event::kTimer, m_ticker,
+							new TMethodEventJob<SwitchRetryTests>(
+								this, &SwitchRetryTests::tick));
+		m_events.initQuitTimeout(5);
+		m_events.loop();
+		m_events.cleanupQuitTimeout();
+		m_events.removeHandler(Event::kTimer, m_ticker);
+		m_events.deleteTimer(m_ticker);
+	}
+
+	void				tick(const Event&, void*)
+	{
+		++m_ticks;
+		if (!m_retry->isWaiting()) {
+			m_events.raiseQuitEvent();
+		}
+	}
+
+public:
+	TestEventQueue		m_events;
+	SwitchRetry*		m_retry;
+	int					m_failures;
+	int					m_attempts;
+	int					m_ticks;
+	bool				m_switched;
+	BaseClientProxy*	m_switchedTo;
+	SInt32				m_x, m_y;
+	bool				m_forScreensaver;
+	EventQueueTimer*	m_ticker;
+	int					m_screenA;
+	int					m_screenB;
+};
+
+TEST_F(SwitchRetryTests, start_grabReleased_retriesUntilSwitched)
+{
+	m_failures = 3;
+	m_retry->start(fakeScreen(m_screenA), 10, 20, false);
+	EXPECT_TRUE(m_retry->isWaiting());
+	EXPECT_FALSE(m_retry->isRetrying());
+
+	run();
+
+	EXPECT_TRUE(m_switched);
+	EXPECT_EQ(4, m_attempts);
+	EXPECT_EQ(fakeScreen(m_screenA), m_switchedTo);
+	EXPECT_EQ(10, m_x);
+	EXPECT_EQ(20, m_y);
+	EXPECT_FALSE(m_retry->isWaiting());
+	EXPECT_FALSE(m_retry->isRetrying());
+}
+
+TEST_F(SwitchRetryTests, start_grabHeld_eventLoopKeepsRunning)
+{
+	m_failures = 5;
+	m_retry->start(fakeScreen(m_screenA), 0, 0, false);
+
+	run();
+
+	// the other timer fired while we were waiting for the grab
+	EXPECT_TRUE(m_switched);
+	EXPECT_GT(m_ticks, m_failures);
+}
+
+TEST_F(SwitchRetryTests, start_whileWaiting_updatesTarget)
+{
+	m_retry->start(fakeScreen(m_screenA), 1, 2, false);
+	m_retry->start(fakeScreen(m_screenB), 3, 4, true);
+	EXPECT_EQ(fakeScreen(m_screenB), m_retry->getScreen());
+
+	run();
+
+	EXPECT_EQ(1, m_attempts);
+	EXPECT_EQ(fakeScreen(m_screenB), m_switchedTo);
+	EXPECT_EQ(3, m_x);
+	EXPECT_EQ(4, m_y);
+	EXPECT_TRUE(m_forScreensaver);
+}
+
+TEST_F(SwitchRetryTests, start_grabNeverReleased_givesUp)
+{
+	m_failures = 1000000;
+	m_retry->start(fakeScreen(m_screenA), 0, 0, false);
+
+	Stopwatch timer;
+	run();
+
+	EXPECT_FALSE(m_switched);
+	EXPECT_FALSE(m_retry->isWaiting());
+	EXPECT_EQ(NULL, m_retry->getScreen());
+	EXPECT_GE(timer.getTime(), SwitchRetry::kTimeout);
+	EXPECT_GT(m_attempts, 1);
+}
+
+TEST_F(SwitchRetryTests, stop_whileWaiting_noRetry)
+{
+	m_retry->start(fakeScreen(m_screenA), 0, 0, false);
+	m_retry->stop();
+
+	EXPECT_FALSE(m_retry->isWaiting());
+	EXPECT_EQ(NULL, m_retry->getScreen());
+
+	run();
+
+	EXPECT_EQ(0, m_attempts);
+}
@@ -51,6 +51,20 @@ TEST(ClientArgsParsingTests, parseClientArgs_yScrollArg_setYScroll)
 	EXPECT_EQ(1, clientArgs.m_yscroll);
 }
 
+TEST(ClientArgsParsingTests, parseClientArgs_smoothMotionArg_setSmoothMotion)
+{
+	NiceMock<MockArgParser> argParser;
+	ON_CALL(argParser, parseGenericArgs(_, _, _)).WillByDefault(Invoke(client_stubParseGenericArgs));
+	ON_CALL(argParser, checkUnexpectedArgs()).WillByDefault(Invoke(client_stubCheckUnexpectedArgs));
+	ClientArgs clientArgs;
+	const int argc = 2;
+	const char* kSmoothMotionCmd[argc] = { "stub", "--smooth-motion" };
+
+	argParser.parseClientArgs(clientArgs, argc, kSmoothMotionCmd);
+
+	EXPECT_TRUE(clientArgs.m_smoothMotion);
+}
+
 TEST(ClientArgsParsingTests, parseClientArgs_addressArg_setSynergyAddress)
 {
 	NiceMock<MockArgParser> argParser;
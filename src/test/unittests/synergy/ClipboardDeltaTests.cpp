@@ -0,0 +1,276 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/ClipboardDelta.h"
+#include "synergy/Clipboard.h"
+
+#include "test/global/gtest.h"
+
+// deterministic text that doesn't repeat itself
+static String
+makeText(size_t size, UInt32 seed)
+{
+	static const char s_letters[] = "abcdefghijklmnopqrstuvwxyz ,.\n";
+	String text;
+	text.reserve(size);
+	for (size_t i = 0; i < size; ++i) {
+		seed = seed * 1103515245 + 12345;
+		text += s_letters[(seed >> 16) % (sizeof(s_letters) - 1)];
+	}
+	return text;
+}
+
+static void
+setFormat(Clipboard& clipboard, IClipboard::EFormat format, const String& data)
+{
+	Clipboard copy;
+	IClipboard::copy(&copy, &clipboard);
+	clipboard.open(0);
+	clipboard.empty();
+	for (int i = 0; i < IClipboard::kNumFormats; ++i) {
+		IClipboard::EFormat other = static_cast<IClipboard::EFormat>(i);
+		copy.open(0);
+		if (other != format && copy.has(other)) {
+			clipboard.add(other, copy.get(other));
+		}
+		copy.close();
+	}
+	clipboard.add(format, data);
+	clipboard.close();
+}
+
+static String
+getFormat(const IClipboard& clipboard, IClipboard::EFormat format)
+{
+	clipboard.open(0);
+	String data = clipboard.has(format) ? clipboard.get(format) : "<none>";
+	clipboard.close();
+	return data;
+}
+
+static void
+expectDelta(const String& base, const String& target)
+{
+	String delta = ClipboardDelta::diff(base, target);
+	String patched;
+	EXPECT_TRUE(ClipboardDelta::patch(base, delta, patched));
+	EXPECT_TRUE(patched == target);
+}
+
+class ClipboardDeltaTests : public ::testing::Test {
+public:
+	// send the clipboard and return the size of the update
+	size_t				send(const IClipboard& clipboard)
+	{
+		String update = m_sender.makeUpdate(&clipboard);
+		UInt32 version;
+		EXPECT_TRUE(m_receiver.applyUpdate(update, &m_received, version));
+		EXPECT_TRUE(m_sender.acknowledge(version, true));
+		return update.size();
+	}
+
+public:
+	ClipboardDelta		m_sender;
+	ClipboardDelta		m_receiver;
+	Clipboard			m_received;
+};
+
+TEST_F(ClipboardDeltaTests, makeUpdate_first_sendsAllFormats)
+{
+	Clipboard clipboard;
+	setFormat(clipboard, IClipboard::kText, "synergy rocks!");
+	setFormat(clipboard, IClipboard::kHTML, "<b>synergy rocks!</b>");
+
+	send(clipboard);
+
+	EXPECT_EQ("synergy rocks!", getFormat(m_received, IClipboard::kText));
+	EXPECT_EQ("<b>synergy rocks!</b>", getFormat(m_received, IClipboard::kHTML));
+	EXPECT_EQ("<none>", getFormat(m_received, IClipboard::kBitmap));
+	EXPECT_EQ(1, m_sender.getAcknowledgedVersion());
+}
+
+TEST_F(ClipboardDeltaTests, makeUpdate_unchanged_sendsNoFormats)
+{
+	Clipboard clipboard;
+	setFormat(clipboard, IClipboard::kText, makeText(100000, 1));
+	send(clipboard);
+
+	// just the versions and a zero count
+	EXPECT_EQ(12, send(clipboard));
+	EXPECT_EQ(makeText(100000, 1), getFormat(m_received, IClipboard::kText));
+}
+
+TEST_F(ClipboardDeltaTests, makeUpdate_formatAdded_sendsOnlyNewFormat)
+{
+	Clipboard clipboard;
+	setFormat(clipboard, IClipboard::kText, makeText(100000, 1));
+	send(clipboard);
+
+	setFormat(clipboard, IClipboard::kHTML, "<i>new</i>");
+	EXPECT_GT(100, send(clipboard));
+
+	EXPECT_EQ(makeText(100000, 1), getFormat(m_received, IClipboard::kText));
+	EXPECT_EQ("<i>new</i>", getFormat(m_received, IClipboard::kHTML));
+}
+
+TEST_F(ClipboardDeltaTests, makeUpdate_formatRemoved_receiverDropsIt)
+{
+	Clipboard clipboard;
+	setFormat(clipboard, IClipboard::kText, makeText(100000, 1));
+	setFormat(clipboard, IClipboard::kHTML, "<i>old</i>");
+	send(clipboard);
+
+	Clipboard textOnly;
+	setFormat(textOnly, IClipboard::kText, makeText(100000, 1));
+	EXPECT_GT(100, send(textOnly));
+
+	EXPECT_EQ(makeText(100000, 1), getFormat(m_received, IClipboard::kText));
+	EXPECT_EQ("<none>", getFormat(m_received, IClipboard::kHTML));
+}
+
+TEST_F(ClipboardDeltaTests, makeUpdate_smallEditToLargeText_sendsDelta)
+{
+	String text = makeText(200000, 2);
+	Clipboard clipboard;
+	setFormat(clipboard, IClipboard::kText, text);
+	send(clipboard);
+
+	text.insert(123457, "an edit in the middle");
+	text.erase(5000, 10);
+	setFormat(clipboard, IClipboard::kText, text);
+	EXPECT_GT(1000, send(clipboard));
+
+	EXPECT_TRUE(getFormat(m_received, IClipboard::kText) == text);
+}
+
+TEST_F(ClipboardDeltaTests, makeUpdate_largeRewrite_sendsWholeFormat)
+{
+	Clipboard clipboard;
+	setFormat(clipboard, IClipboard::kText, makeText(50000, 3));
+	send(clipboard);
+
+	setFormat(clipboard, IClipboard::kText, makeText(50000, 4));
+	EXPECT_LT(50000, send(clipboard));
+
+	EXPECT_TRUE(getFormat(m_received, IClipboard::kText) == makeText(50000, 4));
+}
+
+TEST_F(ClipboardDeltaTests, applyUpdate_missedUpdate_resyncRecovers)
+{
+	Clipboard clipboard;
+	setFormat(clipboard, IClipboard::kText, makeText(10000, 5));
+	m_sender.makeUpdate(&clipboard);
+
+	// the receiver never got the first update so can't apply the second
+	setFormat(clipboard, IClipboard::kText, makeText(10000, 6));
+	UInt32 version;
+	EXPECT_FALSE(m_receiver.applyUpdate(m_sender.makeUpdate(&clipboard),
+							&m_received, version));
+	EXPECT_EQ(2, version);
+	EXPECT_FALSE(m_sender.acknowledge(version, false));
+
+	EXPECT_TRUE(m_receiver.applyUpdate(m_sender.makeResync(),
+							&m_received, version));
+	EXPECT_EQ(3, version);
+	EXPECT_TRUE(getFormat(m_received, IClipboard::kText) == makeText(10000, 6));
+
+	// deltas carry on from the resync
+	setFormat(clipboard, IClipboard::kText, makeText(10000, 6) + "!");
+	EXPECT_GT(100, send(clipboard));
+	EXPECT_TRUE(getFormat(m_received, IClipboard::kText) == makeText(10000, 6) + "!");
+}
+
+TEST_F(ClipboardDeltaTests, acknowledge_failureBeforeResync_ignored)
+{
+	Clipboard clipboard;
+	setFormat(clipboard, IClipboard::kText, "one");
+	m_sender.makeUpdate(&clipboard);
+	setFormat(clipboard, IClipboard::kText, "two");
+	m_sender.makeUpdate(&clipboard);
+
+	EXPECT_FALSE(m_sender.acknowledge(1, false));
+	m_sender.makeResync();
+
+	// already made good by the resync
+	EXPECT_TRUE(m_sender.acknowledge(2, false));
+}
+
+TEST_F(ClipboardDeltaTests, applyUpdate_corrupt_fails)
+{
+	String text = makeText(20000, 7);
+	Clipboard clipboard;
+	setFormat(clipboard, IClipboard::kText, text);
+	send(clipboard);
+
+	text[100] = '#';
+	setFormat(clipboard, IClipboard::kText, text);
+	String update = m_sender.makeUpdate(&clipboard);
+
+	// damage the literal in the delta;  the checksum catches it
+	String damaged = update;
+	damaged[damaged.size() - 1] ^= 0x20;
+	UInt32 version;
+	Clipboard result;
+	EXPECT_FALSE(m_receiver.applyUpdate(damaged, &result, version));
+	EXPECT_FALSE(m_receiver.applyUpdate(update.substr(0, 20), &result, version));
+	EXPECT_FALSE(m_receiver.applyUpdate(update + "x", &result, version));
+
+	// and none of that touched our copy
+	EXPECT_TRUE(m_receiver.applyUpdate(update, &result, version));
+	EXPECT_TRUE(getFormat(result, IClipboard::kText) == text);
+}
+
+TEST(ClipboardDeltaDiffTests, diff_edits_patchRestoresTarget)
+{
+	String base = makeText(50000, 8);
+
+	expectDelta(base, base);
+	expectDelta(base, "");
+	expectDelta("", base);
+	expectDelta(base, "prefix" + base);
+	expectDelta(base, base + "suffix");
+	expectDelta(base, base.substr(0, 20000) + base.substr(20100));
+	expectDelta(base, base.substr(30000) + base.substr(0, 30000));
+	expectDelta(base, base.substr(0, 1000) + makeText(5000, 9) + base.substr(1000));
+	expectDelta(base, makeText(50000, 10));
+	expectDelta("short", "shorter");
+}
+
+TEST(ClipboardDeltaDiffTests, diff_smallEdit_deltaIsSmall)
+{
+	String base   = makeText(100000, 11);
+	String target = base;
+	target.replace(70000, 5, "12345678");
+
+	EXPECT_GT(200, ClipboardDelta::diff(base, target).size());
+}
+
+TEST(ClipboardDeltaDiffTests, patch_malformed_returnsFalse)
+{
+	String base = makeText(1000, 12);
+	String delta = ClipboardDelta::diff(base, base);
+	String target;
+
+	// copy past the end of the base
+	EXPECT_FALSE(ClipboardDelta::patch("short", delta, target));
+
+	// truncated
+	EXPECT_FALSE(ClipboardDelta::patch(base, delta.substr(0, delta.size() - 1), target));
+
+	// unknown operation
+	EXPECT_FALSE(ClipboardDelta::patch(base, delta.substr(0, 4) + "\x7f", target));
+}
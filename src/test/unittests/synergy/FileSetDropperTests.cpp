@@ -0,0 +1,76 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "synergy/FileSetDropper.h"
+#include "synergy/FileSetReceiver.h"
+#include "synergy/FileSetChunk.h"
+#include "synergy/protocol_types.h"
+#include "test/global/TestEventQueue.h"
+
+#include "test/global/gtest.h"
+
+static void
+receiveFile(FileSetDropper& dropper, UInt32 id, const String& name,
+				const String& data)
+{
+	UInt32 crc = FileSetChunk::checksum(0, data.data(), data.size());
+	dropper.handle(FileSetChunk(kDataStart, id, name,
+							synergy::string::sizeTypeToString(data.size())));
+	dropper.handle(FileSetChunk(kDataChunk, id, "", data));
+	dropper.handle(FileSetChunk(kDataEnd, id, "",
+							FileSetChunk::formatChecksum(crc)));
+}
+
+TEST(FileSetDropperTests, handle_completeSet_received)
+{
+	TestEventQueue events;
+	FileSetDropper dropper(&events, &events, NULL);
+
+	dropper.handle(FileSetChunk(kDataStart, 0, "", "1"));
+	receiveFile(dropper, 1, "file", "mock data");
+	EXPECT_TRUE(dropper.getReceived() == NULL);
+
+	dropper.handle(FileSetChunk(kDataEnd, 0, "", ""));
+	ASSERT_TRUE(dropper.getReceived() != NULL);
+	EXPECT_EQ(1U, dropper.getReceived()->getFileCount());
+}
+
+TEST(FileSetDropperTests, handle_malformedMessage_setDiscarded)
+{
+	TestEventQueue events;
+	FileSetDropper dropper(&events, &events, NULL);
+
+	dropper.handle(FileSetChunk(kDataStart, 0, "", "1"));
+	receiveFile(dropper, 1, "file", "mock data");
+
+	// data for an entry that never started
+	dropper.handle(FileSetChunk(kDataChunk, 7, "", "x"));
+
+	// the end of the set only completes an empty one
+	dropper.handle(FileSetChunk(kDataEnd, 0, "", ""));
+	ASSERT_TRUE(dropper.getReceived() != NULL);
+	EXPECT_EQ(0U, dropper.getReceived()->getFileCount());
+}
+
+TEST(FileSetDropperTests, drop_nothingReceived_returnsFalse)
+{
+	TestEventQueue events;
+	FileSetDropper dropper(&events, &events, NULL);
+
+	EXPECT_FALSE(dropper.drop());
+}
@@ -0,0 +1,175 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/FileSetReceiver.h"
+#include "synergy/FileSetChunk.h"
+#include "synergy/protocol_types.h"
+#include "arch/Arch.h"
+
+#include "test/global/gtest.h"
+
+#include <fstream>
+#include <stdlib.h>
+
+const char* kStagingDirectory = "FileSetReceiverTests.staging";
+
+static bool
+fileExists(const String& path)
+{
+	std::ifstream file(path.c_str());
+	return file.is_open();
+}
+
+static void
+receiveFile(FileSetReceiver& receiver, UInt32 id, const String& name,
+				const String& data, UInt32 checksum)
+{
+	receiver.handle(FileSetChunk(kDataStart, id, name,
+							synergy::string::sizeTypeToString(data.size())));
+	receiver.handle(FileSetChunk(kDataChunk, id, "", data));
+	receiver.handle(FileSetChunk(kDataEnd, id, "",
+							FileSetChunk::formatChecksum(checksum)));
+}
+
+TEST(FileSetReceiverTests, isSafeName_relativePath_accepted)
+{
+	EXPECT_TRUE(FileSetReceiver::isSafeName("file"));
+	EXPECT_TRUE(FileSetReceiver::isSafeName("dir/file.txt"));
+	EXPECT_TRUE(FileSetReceiver::isSafeName("dir/..file"));
+}
+
+TEST(FileSetReceiverTests, isSafeName_escapingPath_rejected)
+{
+	EXPECT_FALSE(FileSetReceiver::isSafeName(""));
+	EXPECT_FALSE(FileSetReceiver::isSafeName("/etc/passwd"));
+	EXPECT_FALSE(FileSetReceiver::isSafeName("../file"));
+	EXPECT_FALSE(FileSetReceiver::isSafeName("dir/../../file"));
+	EXPECT_FALSE(FileSetReceiver::isSafeName("dir/./file"));
+	EXPECT_FALSE(FileSetReceiver::isSafeName("dir\\file"));
+	EXPECT_FALSE(FileSetReceiver::isSafeName("c:file"));
+	EXPECT_FALSE(FileSetReceiver::isSafeName(String("file\0x", 6)));
+}
+
+TEST(FileSetReceiverTests, checksum_knownValue)
+{
+	// standard CRC-32 check value
+	EXPECT_EQ(0xcbf43926U, FileSetChunk::checksum(0, "123456789", 9));
+	EXPECT_EQ("cbf43926", FileSetChunk::formatChecksum(0xcbf43926U));
+}
+
+TEST(FileSetReceiverTests, handle_validSet_filesKept)
+{
+	FileSetReceiver receiver(kStagingDirectory);
+	String data("mock data");
+	UInt32 crc = FileSetChunk::checksum(0, data.data(), data.size());
+
+	EXPECT_EQ(kStart, receiver.handle(FileSetChunk(kDataStart, 0, "", "3")));
+	EXPECT_EQ(kNotFinish, receiver.handle(FileSetChunk(kDataStart, 1, "dir/", "")));
+	receiveFile(receiver, 2, "dir/file", data, crc);
+	receiveFile(receiver, 3, "top", "", 0);
+	EXPECT_FALSE(receiver.isComplete());
+	EXPECT_EQ(kFinish, receiver.handle(FileSetChunk(kDataEnd, 0, "", "3")));
+
+	EXPECT_TRUE(receiver.isComplete());
+	EXPECT_EQ(2U, receiver.getFileCount());
+	EXPECT_EQ(0U, receiver.getFailedCount());
+	ASSERT_EQ(2U, receiver.getNames().size());
+	EXPECT_EQ("dir", receiver.getNames()[0]);
+	EXPECT_EQ("top", receiver.getNames()[1]);
+
+	String path = ARCH->concatPath(ARCH->concatPath(kStagingDirectory, "dir"), "file");
+	std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+	String received((std::istreambuf_iterator<char>(file)),
+					std::istreambuf_iterator<char>());
+	EXPECT_EQ(data, received);
+}
+
+TEST(FileSetReceiverTests, handle_badFiles_discarded)
+{
+	FileSetReceiver receiver(kStagingDirectory);
+	String data("mock data");
+	UInt32 crc = FileSetChunk::checksum(0, data.data(), data.size());
+
+	receiver.handle(FileSetChunk(kDataStart, 0, "", "4"));
+	receiveFile(receiver, 1, "corrupt", data, crc + 1);
+	receiveFile(receiver, 2, "../escape", data, crc);
+	receiver.handle(FileSetChunk(kDataStart, 3, "truncated", "100"));
+	receiver.handle(FileSetChunk(kDataChunk, 3, "", data));
+	receiver.handle(FileSetChunk(kDataEnd, 3, "",
+							FileSetChunk::formatChecksum(crc)));
+	receiver.handle(FileSetChunk(kDataStart, 4, "unfinished", "9"));
+	receiver.handle(FileSetChunk(kDataEnd, 0, "", "4"));
+
+	EXPECT_TRUE(receiver.isComplete());
+	EXPECT_EQ(0U, receiver.getFileCount());
+	EXPECT_EQ(4U, receiver.getFailedCount());
+	EXPECT_TRUE(receiver.getNames().empty());
+	EXPECT_FALSE(fileExists(ARCH->concatPath(kStagingDirectory, "corrupt")));
+	EXPECT_FALSE(fileExists(ARCH->concatPath(kStagingDirectory, "truncated")));
+}
+
+TEST(FileSetReceiverTests, moveTo_existingDirectory_merged)
+{
+	const char* dropDirectory = "FileSetReceiverTests.drop";
+	String dropDir = ARCH->concatPath(dropDirectory, "dir");
+	FileSetReceiver::removeTree(dropDirectory);
+	ARCH->makeDirectory(dropDirectory);
+	ARCH->makeDirectory(dropDir);
+	std::ofstream(ARCH->concatPath(dropDir, "old").c_str()) << "old";
+
+	FileSetReceiver receiver(kStagingDirectory);
+	String data("mock data");
+	UInt32 crc = FileSetChunk::checksum(0, data.data(), data.size());
+	receiver.handle(FileSetChunk(kDataStart, 0, "", "2"));
+	receiver.handle(FileSetChunk(kDataStart, 1, "dir/", ""));
+	receiveFile(receiver, 2, "dir/new", data, crc);
+	receiver.handle(FileSetChunk(kDataEnd, 0, "", "2"));
+
+	EXPECT_TRUE(receiver.moveTo(dropDirectory));
+	EXPECT_TRUE(fileExists(ARCH->concatPath(dropDir, "old")));
+	EXPECT_TRUE(fileExists(ARCH->concatPath(dropDir, "new")));
+	EXPECT_FALSE(fileExists(ARCH->concatPath(dropDir, "new.synergy-part")));
+	EXPECT_FALSE(ARCH->isDirectory(dropDir + ".synergy-part"));
+
+	FileSetReceiver::removeTree(dropDirectory);
+}
+
+TEST(FileSetReceiverTests, newStagingDirectory_sharedProfile_othersKept)
+{
+	char dirTemplate[] = "/tmp/synergy-profileXXXXXX";
+	ASSERT_TRUE(mkdtemp(dirTemplate) != NULL);
+	String oldProfileDir = ARCH->getProfileDirectory();
+	ARCH->setProfileDirectory(dirTemplate);
+
+	// another instance's staging directory, mid transfer
+	String other = FileSetReceiver::newStagingDirectory();
+	String otherFile = ARCH->concatPath(other, "partial");
+	std::ofstream(otherFile.c_str()) << "partial";
+
+	String first = FileSetReceiver::newStagingDirectory();
+	String second = FileSetReceiver::newStagingDirectory();
+
+	EXPECT_FALSE(first.empty());
+	EXPECT_NE(other, first);
+	EXPECT_NE(first, second);
+	EXPECT_TRUE(ARCH->isDirectory(first));
+	EXPECT_TRUE(ARCH->isDirectory(second));
+	EXPECT_TRUE(fileExists(otherFile));
+
+	ARCH->setProfileDirectory(oldProfileDir);
+	FileSetReceiver::removeTree(dirTemplate);
+}
@@ -313,3 +313,51 @@ TEST(GenericArgsParsingTests, parseGenericArgs_dragDropCmdOnLinux_enableDragDrop
 	EXPECT_EQ(1, i);
 }
 #endif
+
+TEST(GenericArgsParsingTests, parseGenericArgs_ioUringCmd_enableIOUringTrue)
+{
+	int i = 1;
+	const int argc = 2;
+	const char* kIOUringCmd[argc] = { "stub", "--enable-io-uring" };
+
+	ArgParser argParser(NULL);
+	ArgsBase argsBase;
+	argParser.setArgsBase(argsBase);
+
+	argParser.parseGenericArgs(argc, kIOUringCmd, i);
+
+	EXPECT_TRUE(argsBase.m_enableIOUring);
+	EXPECT_EQ(1, i);
+}
+
+TEST(GenericArgsParsingTests, parseGenericArgs_profileLocksCmd_profileLocksTrue)
+{
+	int i = 1;
+	const int argc = 2;
+	const char* kProfileLocksCmd[argc] = { "stub", "--profile-locks" };
+
+	ArgParser argParser(NULL);
+	ArgsBase argsBase;
+	argParser.setArgsBase(argsBase);
+
+	argParser.parseGenericArgs(argc, kProfileLocksCmd, i);
+
+	EXPECT_TRUE(argsBase.m_profileLocks);
+	EXPECT_EQ(1, i);
+}
+
+TEST(GenericArgsParsingTests, parseGenericArgs_spinLocksCmd_spinLocksTrue)
+{
+	int i = 1;
+	const int argc = 2;
+	const char* kSpinLocksCmd[argc] = { "stub", "--spin-locks" };
+
+	ArgParser argParser(NULL);
+	ArgsBase argsBase;
+	argParser.setArgsBase(argsBase);
+
+	argParser.parseGenericArgs(argc, kSpinLocksCmd, i);
+
+	EXPECT_TRUE(argsBase.m_spinLocks);
+	EXPECT_EQ(1, i);
+}
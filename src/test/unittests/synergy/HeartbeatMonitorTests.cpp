@@ -0,0 +1,265 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/HeartbeatMonitor.h"
+#include "test/mock/synergy/MockEventQueue.h"
+#include "base/EventTypes.h"
+#include "base/IEventJob.h"
+
+#include "test/global/gtest.h"
+#include "test/global/gmock.h"
+
+#include <vector>
+
+using ::testing::_;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+// records the time at which it's run
+class RecordingJob : public IEventJob {
+public:
+	RecordingJob(const double* now, std::vector<double>* runs) :
+		m_now(now), m_runs(runs) { }
+
+	virtual void		run(const Event&) { m_runs->push_back(*m_now); }
+
+private:
+	const double*		m_now;
+	std::vector<double>* m_runs;
+};
+
+// removes a peer when run
+class RemovingJob : public IEventJob {
+public:
+	RemovingJob(HeartbeatMonitor* monitor, HeartbeatMonitor::Peer** peer) :
+		m_monitor(monitor), m_peer(peer) { }
+
+	virtual void		run(const Event&)
+	{
+		m_monitor->remove(*m_peer);
+		*m_peer = NULL;
+	}
+
+private:
+	HeartbeatMonitor*	m_monitor;
+	HeartbeatMonitor::Peer** m_peer;
+};
+
+class HeartbeatMonitorTests : public ::testing::Test {
+public:
+	virtual void		SetUp()
+	{
+		ON_CALL(m_events, newTimer(_, _))
+			.WillByDefault(Return(reinterpret_cast<EventQueueTimer*>(&m_timer)));
+		m_now = 0.0;
+	}
+
+	NiceMock<MockEventQueue> m_events;
+	char				m_timer;
+	double				m_now;
+};
+
+TEST_F(HeartbeatMonitorTests, sweep_hundredsOfPeers_expireWithinOnePeriod)
+{
+	const int kPeers = 300;
+	const double kAlarm = 9.0;
+	HeartbeatMonitor* monitor = HeartbeatMonitor::acquire(&m_events);
+
+	std::vector<HeartbeatMonitor::Peer*> peers(kPeers);
+	std::vector<std::vector<double> > runs(kPeers);
+	for (int i = 0; i < kPeers; ++i) {
+		peers[i] = monitor->add(kAlarm, 0.0,
+							new RecordingJob(&m_now, &runs[i]), NULL);
+	}
+	const double period = monitor->getPeriod();
+	ASSERT_LT(0.0, period);
+
+	// peer i is last heard from just before the i'th sweep
+	const int kSweeps = kPeers + static_cast<int>(kAlarm / period) + 2;
+	std::vector<double> lastHeard(kPeers, 0.0);
+	for (int sweep = 0; sweep < kSweeps; ++sweep) {
+		m_now = sweep * period;
+		for (int i = sweep; i < kPeers; ++i) {
+			peers[i]->touch(m_now);
+			lastHeard[i] = m_now;
+		}
+		monitor->sweep(m_now);
+	}
+
+	for (int i = 0; i < kPeers; ++i) {
+		ASSERT_EQ(1, runs[i].size()) << "peer " << i;
+		EXPECT_LE(lastHeard[i] + kAlarm, runs[i][0]) << "peer " << i;
+		EXPECT_GE(lastHeard[i] + kAlarm + period, runs[i][0]) << "peer " << i;
+	}
+
+	for (int i = 0; i < kPeers; ++i) {
+		monitor->remove(peers[i]);
+	}
+	monitor->release();
+}
+
+TEST_F(HeartbeatMonitorTests, touch_hundredsOfPeers_noTimerChurn)
+{
+	EXPECT_CALL(m_events, newTimer(_, _)).Times(1);
+	EXPECT_CALL(m_events, newOneShotTimer(_, _)).Times(0);
+	EXPECT_CALL(m_events, deleteTimer(_)).Times(1);
+
+	HeartbeatMonitor* monitor = HeartbeatMonitor::acquire(&m_events);
+	std::vector<HeartbeatMonitor::Peer*> peers;
+	for (int i = 0; i < 500; ++i) {
+		peers.push_back(monitor->add(9.0, 3.0, NULL, NULL));
+	}
+
+	for (int message = 0; message < 100; ++message) {
+		for (size_t i = 0; i < peers.size(); ++i) {
+			peers[i]->touch(message * 0.1);
+		}
+		monitor->sweep(message * 0.1);
+	}
+
+	for (size_t i = 0; i < peers.size(); ++i) {
+		monitor->remove(peers[i]);
+	}
+	EXPECT_EQ(0, monitor->getPeerCount());
+	EXPECT_EQ(0.0, monitor->getPeriod());
+	monitor->release();
+}
+
+TEST_F(HeartbeatMonitorTests, touch_everySweep_neverFlatlines)
+{
+	HeartbeatMonitor* monitor = HeartbeatMonitor::acquire(&m_events);
+	std::vector<double> runs;
+	HeartbeatMonitor::Peer* peer = monitor->add(1.0, 0.0,
+							new RecordingJob(&m_now, &runs), NULL);
+
+	for (int sweep = 0; sweep < 100; ++sweep) {
+		m_now = sweep * monitor->getPeriod();
+		peer->touch(m_now);
+		monitor->sweep(m_now);
+	}
+	EXPECT_TRUE(runs.empty());
+
+	monitor->remove(peer);
+	monitor->release();
+}
+
+TEST_F(HeartbeatMonitorTests, sweep_silentPeer_flatlinesOnceUntilTouched)
+{
+	HeartbeatMonitor* monitor = HeartbeatMonitor::acquire(&m_events);
+	std::vector<double> runs;
+	HeartbeatMonitor::Peer* peer = monitor->add(1.0, 0.0,
+							new RecordingJob(&m_now, &runs), NULL);
+
+	for (m_now = 0.0; m_now < 5.0; m_now += 0.25) {
+		monitor->sweep(m_now);
+	}
+	EXPECT_EQ(1, runs.size());
+
+	peer->touch(m_now);
+	for (; m_now < 10.0; m_now += 0.25) {
+		monitor->sweep(m_now);
+	}
+	EXPECT_EQ(2, runs.size());
+
+	monitor->remove(peer);
+	monitor->release();
+}
+
+TEST_F(HeartbeatMonitorTests, touch_betweenSweeps_flatlinesFromTouchTime)
+{
+	HeartbeatMonitor* monitor = HeartbeatMonitor::acquire(&m_events);
+	std::vector<double> runs;
+	HeartbeatMonitor::Peer* peer = monitor->add(1.0, 0.0,
+							new RecordingJob(&m_now, &runs), NULL);
+
+	// heard from just after a sweep
+	monitor->sweep(0.0);
+	peer->touch(0.01);
+	for (m_now = 0.25; m_now <= 1.0; m_now += 0.25) {
+		monitor->sweep(m_now);
+	}
+	EXPECT_TRUE(runs.empty());
+
+	// the deadline runs from the touch, not from the following sweep
+	m_now = 1.02;
+	monitor->sweep(m_now);
+	ASSERT_EQ(1, runs.size());
+	EXPECT_EQ(1.02, runs[0]);
+
+	monitor->remove(peer);
+	monitor->release();
+}
+
+TEST_F(HeartbeatMonitorTests, sweep_keepAlive_runsEveryRate)
+{
+	HeartbeatMonitor* monitor = HeartbeatMonitor::acquire(&m_events);
+	std::vector<double> runs;
+	HeartbeatMonitor::Peer* peer = monitor->add(0.0, 3.0,
+							NULL, new RecordingJob(&m_now, &runs));
+	EXPECT_EQ(0.75, monitor->getPeriod());
+
+	for (m_now = 0.0; m_now <= 12.0; m_now += 0.75) {
+		monitor->sweep(m_now);
+	}
+
+	ASSERT_EQ(4, runs.size());
+	EXPECT_EQ(3.0, runs[0]);
+	EXPECT_EQ(6.0, runs[1]);
+	EXPECT_EQ(9.0, runs[2]);
+	EXPECT_EQ(12.0, runs[3]);
+
+	monitor->remove(peer);
+	monitor->release();
+}
+
+TEST_F(HeartbeatMonitorTests, sweep_flatlineRemovesPeers_otherJobsSkipped)
+{
+	HeartbeatMonitor* monitor = HeartbeatMonitor::acquire(&m_events);
+
+	// the first to flatline removes itself and the second
+	HeartbeatMonitor::Peer* first;
+	HeartbeatMonitor::Peer* second;
+	std::vector<double> runs;
+	first = monitor->add(1.0, 0.0, new RemovingJob(monitor, &second), NULL);
+	second = monitor->add(1.0, 0.0, new RecordingJob(&m_now, &runs), NULL);
+	monitor->add(1.0, 0.0, new RemovingJob(monitor, &first), NULL);
+
+	monitor->sweep(0.0);
+	monitor->sweep(1.0);
+
+	EXPECT_TRUE(runs.empty());
+	EXPECT_EQ(NULL, first);
+	EXPECT_EQ(NULL, second);
+	EXPECT_EQ(1, monitor->getPeerCount());
+
+	monitor->release();
+}
+
+TEST_F(HeartbeatMonitorTests, acquire_sameQueue_sharesMonitor)
+{
+	HeartbeatMonitor* first = HeartbeatMonitor::acquire(&m_events);
+	HeartbeatMonitor* second = HeartbeatMonitor::acquire(&m_events);
+	EXPECT_EQ(first, second);
+
+	NiceMock<MockEventQueue> otherEvents;
+	HeartbeatMonitor* other = HeartbeatMonitor::acquire(&otherEvents);
+	EXPECT_NE(first, other);
+
+	other->release();
+	second->release();
+	first->release();
+}
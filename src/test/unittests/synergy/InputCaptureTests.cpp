@@ -0,0 +1,381 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/InputCapture.h"
+#include "synergy/IPrimaryScreen.h"
+#include "test/global/TestEventQueue.h"
+#include "test/mock/synergy/MockEventQueue.h"
+#include "arch/Arch.h"
+#include "base/TMethodEventJob.h"
+
+#include "test/global/gtest.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+using ::testing::_;
+using ::testing::NiceMock;
+using ::testing::ReturnRef;
+
+// produces motion from a script instead of a platform
+class ScriptedInputCapture : public InputCapture {
+public:
+	ScriptedInputCapture(IEventQueue* events, void* target, UInt32 capacity) :
+		InputCapture(events, target, capacity),
+		m_count(0),
+		m_limit(0),
+		m_interval(0.0),
+		m_downAt(-1),
+		m_upAt(-1) { }
+
+	~ScriptedInputCapture()
+	{
+		stop();
+	}
+
+	// posts \p count motions, one every \p interval seconds
+	void				script(int count, double interval)
+	{
+		m_limit    = count;
+		m_interval = interval;
+	}
+
+	// presses a button after motion \p down and releases it after
+	// motion \p up
+	void				scriptButton(int down, int up)
+	{
+		m_downAt = down;
+		m_upAt   = up;
+	}
+
+	void				postMotion(SInt32 x)
+	{
+		post(InputRecord::kMotion, x);
+	}
+
+	void				postButton(InputRecord::EType type, SInt32 x)
+	{
+		post(type, x);
+	}
+
+protected:
+	virtual void		capture(double timeout)
+	{
+		if (m_count == m_limit) {
+			ARCH->sleep(timeout);
+			return;
+		}
+		ARCH->sleep(m_interval);
+		postMotion(m_count);
+		if (m_count == m_downAt) {
+			postButton(InputRecord::kButtonDown, m_count);
+		}
+		if (m_count == m_upAt) {
+			postButton(InputRecord::kButtonUp, m_count);
+		}
+		++m_count;
+	}
+
+private:
+	void				post(InputRecord::EType type, SInt32 x)
+	{
+		InputRecord record;
+		record.m_type       = type;
+		record.m_x          = x;
+		record.m_y          = 0;
+		record.m_button     = 0;
+		record.m_state      = 0;
+		record.m_time       = 0;
+		record.m_generation = getGeneration();
+		InputCapture::post(record);
+	}
+
+private:
+	int					m_count;
+	int					m_limit;
+	double				m_interval;
+	int					m_downAt;
+	int					m_upAt;
+};
+
+class InputCaptureTests : public ::testing::Test {
+public:
+	InputCaptureTests()
+	{
+		m_primaryScreenEvents.setEvents(&m_mockEvents);
+		ON_CALL(m_mockEvents, forIPrimaryScreen())
+			.WillByDefault(ReturnRef(m_primaryScreenEvents));
+	}
+
+	NiceMock<MockEventQueue>	m_mockEvents;
+	IPrimaryScreenEvents		m_primaryScreenEvents;
+};
+
+TEST_F(InputCaptureTests, take_posted_inOrder)
+{
+	ScriptedInputCapture capture(&m_mockEvents, this, 8);
+	capture.postMotion(1);
+	capture.postMotion(2);
+	capture.postMotion(3);
+
+	InputRecord record;
+	for (SInt32 x = 1; x <= 3; ++x) {
+		ASSERT_TRUE(capture.take(record));
+		EXPECT_EQ(x, record.m_x);
+	}
+	EXPECT_FALSE(capture.take(record));
+}
+
+TEST_F(InputCaptureTests, post_burst_wakesOncePerDrain)
+{
+	ScriptedInputCapture capture(&m_mockEvents, this, 8);
+	EXPECT_CALL(m_mockEvents, addEvent(_)).Times(2);
+
+	capture.postMotion(1);
+	capture.postMotion(2);
+	capture.postMotion(3);
+
+	InputRecord record;
+	while (capture.take(record)) {
+		// drain
+	}
+	capture.postMotion(4);
+}
+
+TEST_F(InputCaptureTests, post_ringFull_motionMerged)
+{
+	ScriptedInputCapture capture(&m_mockEvents, this, 4);
+	for (SInt32 x = 0; x < 6; ++x) {
+		capture.postMotion(x);
+	}
+
+	EXPECT_EQ(1, capture.getDropped());
+	InputRecord record;
+	for (SInt32 x = 0; x < 4; ++x) {
+		ASSERT_TRUE(capture.take(record));
+		EXPECT_EQ(x, record.m_x);
+	}
+	EXPECT_FALSE(capture.take(record));
+
+	// the held motion goes ahead of the next
+	capture.postMotion(6);
+	ASSERT_TRUE(capture.take(record));
+	EXPECT_EQ(5, record.m_x);
+	ASSERT_TRUE(capture.take(record));
+	EXPECT_EQ(6, record.m_x);
+	EXPECT_FALSE(capture.take(record));
+}
+
+TEST_F(InputCaptureTests, post_ringFull_buttonEdgesKept)
+{
+	ScriptedInputCapture capture(&m_mockEvents, this, 4);
+	for (SInt32 x = 0; x < 5; ++x) {
+		capture.postMotion(x);
+	}
+	capture.postButton(InputRecord::kButtonDown, 5);
+	capture.postMotion(6);
+	capture.postMotion(7);
+	capture.postButton(InputRecord::kButtonUp, 8);
+	capture.postMotion(9);
+	EXPECT_EQ(1, capture.getDropped());
+
+	InputRecord record;
+	for (SInt32 x = 0; x < 4; ++x) {
+		ASSERT_TRUE(capture.take(record));
+	}
+	EXPECT_FALSE(capture.take(record));
+
+	// motion between the edges was merged but the edges weren't
+	capture.postMotion(10);
+	const InputRecord::EType types[] = {
+		InputRecord::kMotion, InputRecord::kButtonDown,
+		InputRecord::kMotion, InputRecord::kButtonUp
+	};
+	const SInt32 xs[] = { 4, 5, 7, 8 };
+	for (int i = 0; i < 4; ++i) {
+		ASSERT_TRUE(capture.take(record));
+		EXPECT_EQ(types[i], record.m_type);
+		EXPECT_EQ(xs[i], record.m_x);
+	}
+	EXPECT_FALSE(capture.take(record));
+
+	capture.postMotion(11);
+	ASSERT_TRUE(capture.take(record));
+	EXPECT_EQ(10, record.m_x);
+	ASSERT_TRUE(capture.take(record));
+	EXPECT_EQ(11, record.m_x);
+	EXPECT_EQ(2, capture.getDropped());
+}
+
+TEST_F(InputCaptureTests, invalidate_staleMotion_discardedButtonsKept)
+{
+	ScriptedInputCapture capture(&m_mockEvents, this, 8);
+	capture.postMotion(1);
+	capture.postButton(InputRecord::kButtonDown, 2);
+	capture.invalidate();
+	capture.postMotion(3);
+
+	InputRecord record;
+	ASSERT_TRUE(capture.take(record));
+	EXPECT_EQ(InputRecord::kButtonDown, record.m_type);
+	ASSERT_TRUE(capture.peek(record));
+	EXPECT_EQ(3, record.m_x);
+	ASSERT_TRUE(capture.take(record));
+	EXPECT_EQ(3, record.m_x);
+	EXPECT_FALSE(capture.take(record));
+}
+
+// a headless primary screen.  captured motion is forwarded the way a
+// platform screen does it while the main thread is kept busy with slow
+// bulk events.
+class InputCaptureLoadTests : public ::testing::Test {
+public:
+	InputCaptureLoadTests() :
+		m_loadType(Event::kUnknown),
+		m_loadTime(s_loadTime),
+		m_capture(&m_events, this, 64),
+		m_received(0),
+		m_expected(0),
+		m_last(-1),
+		m_inOrder(true),
+		m_maxLatency(0.0)
+	{
+		m_events.registerTypeOnce(m_loadType, "load", Event::kBulkPriority);
+		m_events.adoptHandler(m_loadType, this,
+			new TMethodEventJob<InputCaptureLoadTests>(
+				this, &InputCaptureLoadTests::handleLoad));
+		m_events.adoptHandler(m_events.forIPrimaryScreen().inputCaptured(),
+			this, new TMethodEventJob<InputCaptureLoadTests>(
+				this, &InputCaptureLoadTests::handleInputCaptured));
+		m_events.adoptHandler(m_events.forIPrimaryScreen().motionOnPrimary(),
+			this, new TMethodEventJob<InputCaptureLoadTests>(
+				this, &InputCaptureLoadTests::handleMotion));
+	}
+
+	~InputCaptureLoadTests()
+	{
+		m_capture.stop();
+		m_events.removeHandlers(this);
+	}
+
+	void				handleLoad(const Event&, void*)
+	{
+		// a slow handler, say a clipboard conversion
+		ARCH->sleep(m_loadTime);
+	}
+
+	void				handleInputCaptured(const Event&, void*)
+	{
+		InputRecord record;
+		while (m_capture.take(record)) {
+			if (record.m_type != InputRecord::kMotion) {
+				m_edges.push_back(record.m_type);
+				continue;
+			}
+			m_captured[record.m_x] = record.m_captured;
+			m_events.addEvent(Event(
+				m_events.forIPrimaryScreen().motionOnPrimary(), this,
+				IPrimaryScreen::MotionInfo::alloc(record.m_x, 0)));
+		}
+	}
+
+	void				handleMotion(const Event& event, void*)
+	{
+		const IPrimaryScreen::MotionInfo* info =
+			static_cast<const IPrimaryScreen::MotionInfo*>(event.getData());
+		if (info->m_x <= m_last) {
+			m_inOrder = false;
+		}
+		m_last = info->m_x;
+		m_maxLatency = std::max(m_maxLatency,
+							ARCH->time() - m_captured[info->m_x]);
+		++m_received;
+		if (info->m_x == m_expected - 1) {
+			m_events.raiseQuitEvent();
+		}
+	}
+
+	static const double	s_loadTime;
+
+	TestEventQueue		m_events;
+	Event::Type			m_loadType;
+	double				m_loadTime;
+	ScriptedInputCapture
+						m_capture;
+	std::map<SInt32, double>
+						m_captured;
+	std::vector<InputRecord::EType>
+						m_edges;
+	int					m_received;
+	int					m_expected;
+	SInt32				m_last;
+	bool				m_inOrder;
+	double				m_maxLatency;
+};
+
+const double InputCaptureLoadTests::s_loadTime = 0.005;
+
+TEST_F(InputCaptureLoadTests, capture_mainThreadLoaded_latencyBounded)
+{
+	// two seconds of work on the main thread against half a second of
+	// motion.  dispatched in arrival order the last motion would wait
+	// for nearly all of it.
+	for (int i = 0; i < 400; ++i) {
+		m_events.addEvent(Event(m_loadType, this));
+	}
+	m_expected = 50;
+	m_capture.script(m_expected, 0.01);
+	m_capture.start();
+
+	m_events.initQuitTimeout(10);
+	m_events.loop();
+	m_events.cleanupQuitTimeout();
+
+	ASSERT_EQ(m_expected, m_received);
+	EXPECT_TRUE(m_inOrder);
+	EXPECT_EQ(0, m_capture.getDropped());
+
+	// a motion waits for the load handler that's running when it's
+	// captured plus the occasional one let through so bulk events
+	// aren't starved
+	RecordProperty("max_latency_ms", static_cast<int>(1000.0 * m_maxLatency));
+	EXPECT_LT(m_maxLatency, 0.1);
+}
+
+TEST_F(InputCaptureLoadTests, capture_mainThreadStalled_buttonEdgesKept)
+{
+	// the main thread stalls for a second while motion arrives at about
+	// 1000Hz, far more than the ring holds
+	m_loadTime = 1.0;
+	m_events.addEvent(Event(m_loadType, this));
+	m_expected = 300;
+	m_capture.script(m_expected, 0.001);
+	m_capture.scriptButton(100, 200);
+	m_capture.start();
+
+	m_events.initQuitTimeout(10);
+	m_events.loop();
+	m_events.cleanupQuitTimeout();
+
+	EXPECT_EQ(m_expected - 1, m_last);
+	EXPECT_TRUE(m_inOrder);
+	EXPECT_LT(0, m_capture.getDropped());
+	ASSERT_EQ(2, m_edges.size());
+	EXPECT_EQ(InputRecord::kButtonDown, m_edges[0]);
+	EXPECT_EQ(InputRecord::kButtonUp, m_edges[1]);
+}
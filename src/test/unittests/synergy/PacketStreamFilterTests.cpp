@@ -0,0 +1,317 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/PacketStreamFilter.h"
+#include "synergy/protocol_types.h"
+#include "test/mock/io/MockStream.h"
+#include "test/global/TestEventQueue.h"
+#include "base/String.h"
+
+#include "test/global/gtest.h"
+
+#include <vector>
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+// serves reads from a string
+class PacketData {
+public:
+	UInt32				read(void* buffer, UInt32 n)
+	{
+		if (n > m_input.size()) {
+			n = static_cast<UInt32>(m_input.size());
+		}
+		memcpy(buffer, m_input.data(), n);
+		m_input.erase(0, n);
+		return n;
+	}
+
+	static String		packet(const String& payload)
+	{
+		return length(static_cast<UInt32>(payload.size())) + payload;
+	}
+
+	static String		length(UInt32 n)
+	{
+		String s;
+		s += static_cast<char>((n >> 24) & 0xff);
+		s += static_cast<char>((n >> 16) & 0xff);
+		s += static_cast<char>((n >>  8) & 0xff);
+		s += static_cast<char>( n        & 0xff);
+		return s;
+	}
+
+public:
+	String				m_input;
+};
+
+// keeps the events the filter sends to its owner
+class RecordingEventQueue : public TestEventQueue {
+public:
+	virtual void		addEvent(const Event& event) { m_added.push_back(event); }
+
+public:
+	std::vector<Event>	m_added;
+};
+
+// deterministic pseudo-random numbers for the fuzz tests
+class FuzzRandom {
+public:
+	FuzzRandom(UInt32 seed) : m_state(seed) { }
+
+	UInt32				next(UInt32 n)
+	{
+		m_state = m_state * 1103515245 + 12345;
+		return ((m_state >> 8) & 0xffffff) % n;
+	}
+
+private:
+	UInt32				m_state;
+};
+
+class PacketStreamFilterTests : public ::testing::Test {
+public:
+	PacketStreamFilterTests() :
+		m_stream(new NiceMock<MockStream>),
+		m_filter(NULL)
+	{
+		ON_CALL(*m_stream, getEventTarget()).WillByDefault(Return(m_stream));
+		ON_CALL(*m_stream, read(_, _)).WillByDefault(Invoke(&m_data, &PacketData::read));
+		m_filter = new PacketStreamFilter(&m_events, m_stream, false);
+	}
+
+	~PacketStreamFilterTests()
+	{
+		delete m_filter;
+		delete m_stream;
+	}
+
+	void				receive(const String& data)
+	{
+		m_data.m_input += data;
+		m_events.dispatchEvent(Event(m_events.forIStream().inputReady(), m_stream));
+	}
+
+	// read every complete packet
+	std::vector<String>	readPackets()
+	{
+		std::vector<String> packets;
+		while (m_filter->isReady()) {
+			String packet(m_filter->getSize(), '\0');
+			UInt32 n = m_filter->read(&packet[0], m_filter->getSize());
+			packets.push_back(packet.substr(0, n));
+		}
+		return packets;
+	}
+
+	bool				isInputShutdown()
+	{
+		bool shutdown = false;
+		for (size_t i = 0; i < m_events.m_added.size(); ++i) {
+			const Event& event = m_events.m_added[i];
+			shutdown |= (event.getType() == m_events.forIStream().inputShutdown() &&
+						 event.getTarget() == m_filter->getEventTarget());
+		}
+		m_events.m_added.clear();
+		return shutdown;
+	}
+
+public:
+	RecordingEventQueue	m_events;
+	PacketData			m_data;
+	NiceMock<MockStream>*	m_stream;
+	PacketStreamFilter*	m_filter;
+};
+
+TEST_F(PacketStreamFilterTests, read_splitPacket_readyOnlyWhenComplete)
+{
+	String data = PacketData::packet("DKDN0123456789");
+	for (size_t i = 0; i + 1 < data.size(); ++i) {
+		receive(data.substr(i, 1));
+		EXPECT_FALSE(m_filter->isReady());
+		EXPECT_EQ(0, m_filter->getSize());
+	}
+	receive(data.substr(data.size() - 1));
+
+	std::vector<String> packets = readPackets();
+	ASSERT_EQ(1, packets.size());
+	EXPECT_EQ("DKDN0123456789", packets[0]);
+}
+
+TEST_F(PacketStreamFilterTests, read_coalescedPackets_readsEachInTurn)
+{
+	receive(PacketData::packet("CNOP") + PacketData::packet("") +
+			PacketData::packet("DMMV1234") + PacketData::packet("CALV") +
+			PacketData::length(8) + "DM");
+
+	std::vector<String> packets = readPackets();
+	ASSERT_EQ(3, packets.size());
+	EXPECT_EQ("CNOP", packets[0]);
+	EXPECT_EQ("DMMV1234", packets[1]);
+	EXPECT_EQ("CALV", packets[2]);
+
+	receive("MV5678");
+	packets = readPackets();
+	ASSERT_EQ(1, packets.size());
+	EXPECT_EQ("DMMV5678", packets[0]);
+}
+
+TEST_F(PacketStreamFilterTests, read_partialReads_consumePacketInPieces)
+{
+	receive(PacketData::packet("DKDN0123") + PacketData::packet("CNOP"));
+
+	char buffer[4];
+	EXPECT_EQ(8, m_filter->getSize());
+	EXPECT_EQ(4, m_filter->read(buffer, 4));
+	EXPECT_EQ("DKDN", String(buffer, 4));
+	EXPECT_EQ(4, m_filter->getSize());
+	EXPECT_EQ(4, m_filter->read(buffer, 100));
+	EXPECT_EQ("0123", String(buffer, 4));
+	EXPECT_EQ(4, m_filter->read(buffer, 4));
+	EXPECT_EQ("CNOP", String(buffer, 4));
+	EXPECT_FALSE(m_filter->isReady());
+}
+
+TEST_F(PacketStreamFilterTests, read_hugeLength_rejectedWithoutBuffering)
+{
+	receive(PacketData::length(0x7fffffff) + String(100000, 'x'));
+
+	EXPECT_TRUE(isInputShutdown());
+	EXPECT_FALSE(m_filter->isReady());
+
+	// the rest of what the peer sends is dropped
+	EXPECT_TRUE(m_data.m_input.empty());
+	receive(PacketData::packet("CNOP"));
+	EXPECT_FALSE(m_filter->isReady());
+}
+
+TEST_F(PacketStreamFilterTests, read_longPacketForCode_limitDependsOnCode)
+{
+	String payload(kMaxPacketLength, 'x');
+
+	// clipboard data may be long
+	receive(PacketData::packet("DCLP" + payload));
+	std::vector<String> packets = readPackets();
+	ASSERT_EQ(1, packets.size());
+	EXPECT_EQ(kMaxPacketLength + 4, packets[0].size());
+	EXPECT_FALSE(isInputShutdown());
+
+	// key presses may not
+	receive(PacketData::packet("DKDN" + payload));
+	EXPECT_TRUE(readPackets().empty());
+	EXPECT_TRUE(isInputShutdown());
+}
+
+TEST_F(PacketStreamFilterTests, setMaxPacketLength_default_appliesToOtherCodes)
+{
+	m_filter->setMaxPacketLength(NULL, 8);
+	m_filter->setMaxPacketLength("DMMV", 12);
+	EXPECT_EQ(8, m_filter->getMaxPacketLength(NULL));
+	EXPECT_EQ(8, m_filter->getMaxPacketLength("CNOP"));
+	EXPECT_EQ(12, m_filter->getMaxPacketLength("DMMV"));
+
+	receive(PacketData::packet("DMMV01234567"));
+	EXPECT_EQ(1, readPackets().size());
+
+	// packets too short to have a code get the default
+	receive(PacketData::packet("DMM"));
+	EXPECT_EQ(1, readPackets().size());
+	EXPECT_FALSE(isInputShutdown());
+
+	// over DMMV's own limit even though it's under the default
+	receive(PacketData::packet("DMMV0123456789"));
+	EXPECT_TRUE(readPackets().empty());
+	EXPECT_TRUE(isInputShutdown());
+}
+
+TEST_F(PacketStreamFilterTests, read_fuzzedSplits_packetsIntact)
+{
+	FuzzRandom random(1);
+	for (int round = 0; round < 20; ++round) {
+		// a random stream of packets
+		std::vector<String> expected;
+		String data;
+		for (int i = 0; i < 50; ++i) {
+			String payload(random.next(3000) + 1, '\0');
+			for (size_t j = 0; j < payload.size(); ++j) {
+				payload[j] = static_cast<char>(random.next(256));
+			}
+			payload.replace(0, 4, "DMMV", std::min<size_t>(4, payload.size()));
+			expected.push_back(payload);
+			data += PacketData::packet(payload);
+		}
+
+		// delivered in random pieces
+		std::vector<String> packets;
+		while (!data.empty()) {
+			size_t n = std::min<size_t>(random.next(5000) + 1, data.size());
+			receive(data.substr(0, n));
+			data.erase(0, n);
+
+			std::vector<String> more = readPackets();
+			packets.insert(packets.end(), more.begin(), more.end());
+		}
+
+		ASSERT_EQ(expected.size(), packets.size());
+		for (size_t i = 0; i < expected.size(); ++i) {
+			ASSERT_EQ(expected[i], packets[i]) << "round " << round << " packet " << i;
+		}
+	}
+	EXPECT_FALSE(isInputShutdown());
+}
+
+TEST_F(PacketStreamFilterTests, read_fuzzedBytes_neverExceedsLimit)
+{
+	// a fresh filter each round
+	delete m_filter;
+	m_filter = NULL;
+
+	// the fuzzed bytes are mostly zero so packets often have this code
+	static const char kZeroCode[4] = { 0, 0, 0, 0 };
+
+	FuzzRandom random(2);
+	for (int round = 0; round < 200; ++round) {
+		PacketStreamFilter filter(&m_events, m_stream, false);
+		filter.setMaxPacketLength(NULL, 32);
+		filter.setMaxPacketLength(kZeroCode, 8);
+		m_filter = &filter;
+
+		for (int i = 0; i < 20; ++i) {
+			String data(random.next(64) + 1, '\0');
+			for (size_t j = 0; j < data.size(); ++j) {
+				// mostly zero and small bytes so lengths are often near
+				// the limits and some packets get through
+				UInt32 kind = random.next(8);
+				data[j] = static_cast<char>(kind < 5 ? 0 :
+							(kind < 7 ? random.next(40) : random.next(256)));
+			}
+			receive(data);
+			std::vector<String> packets = readPackets();
+			for (size_t j = 0; j < packets.size(); ++j) {
+				const String& packet = packets[j];
+				UInt32 limit = filter.getMaxPacketLength(
+								packet.size() < 4 ? NULL : packet.data());
+				EXPECT_GE(limit, packet.size());
+			}
+		}
+		isInputShutdown();
+		m_filter = NULL;
+	}
+}
@@ -0,0 +1,180 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/ProtocolUtil.h"
+#include "synergy/protocol_types.h"
+#include "io/IStream.h"
+#include "base/Stopwatch.h"
+#include "base/String.h"
+
+#include "test/global/gtest.h"
+
+#include <cstring>
+#include <vector>
+
+// serves one frame, either lent in place or through read()
+class FrameStream : public synergy::IStream {
+public:
+	FrameStream(const String& frame, bool lend) :
+		m_frame(frame), m_used(0), m_lend(lend), m_reads(0) { }
+
+	virtual void		close() { }
+	virtual UInt32		read(void* buffer, UInt32 n)
+	{
+		++m_reads;
+		n = std::min(n, getSize());
+		if (buffer != NULL) {
+			memcpy(buffer, m_frame.data() + m_used, n);
+		}
+		m_used += n;
+		return n;
+	}
+	virtual void		write(const void*, UInt32) { }
+	virtual void		flush() { }
+	virtual void		shutdownInput() { }
+	virtual void		shutdownOutput() { }
+	virtual const UInt8*	lendFrame(UInt32& size)
+	{
+		size = getSize();
+		if (!m_lend || size == 0) {
+			return NULL;
+		}
+		return reinterpret_cast<const UInt8*>(m_frame.data()) + m_used;
+	}
+	virtual void		releaseFrame(UInt32 n) { m_used += n; }
+	virtual void*		getEventTarget() const { return NULL; }
+	virtual bool		isReady() const { return getSize() != 0; }
+	virtual UInt32		getSize() const
+	{
+		return static_cast<UInt32>(m_frame.size()) - m_used;
+	}
+
+	void				reset() { m_used = 0; }
+
+public:
+	String				m_frame;
+	UInt32				m_used;
+	bool				m_lend;
+	int					m_reads;
+};
+
+static String
+mouseMove(SInt16 x, SInt16 y)
+{
+	String frame("DMMV");
+	frame += static_cast<char>((x >> 8) & 0xff);
+	frame += static_cast<char>( x       & 0xff);
+	frame += static_cast<char>((y >> 8) & 0xff);
+	frame += static_cast<char>( y       & 0xff);
+	return frame;
+}
+
+TEST(ProtocolUtilTests, readf_lentFrame_decodedWithoutReads)
+{
+	FrameStream stream(mouseMove(300, -2), true);
+
+	UInt8 code[4];
+	ASSERT_EQ(4, ProtocolUtil::readCode(&stream, code));
+	EXPECT_EQ(0, memcmp(code, kMsgDMouseMove, 4));
+
+	SInt16 x, y;
+	EXPECT_TRUE(ProtocolUtil::readf(&stream, kMsgDMouseMove + 4, &x, &y));
+	EXPECT_EQ(300, x);
+	EXPECT_EQ(-2, y);
+	EXPECT_EQ(0, stream.m_reads);
+	EXPECT_EQ(0, stream.getSize());
+}
+
+TEST(ProtocolUtilTests, readf_unframedStream_readsEachField)
+{
+	FrameStream stream(mouseMove(300, -2), false);
+
+	UInt8 code[4];
+	ASSERT_EQ(4, ProtocolUtil::readCode(&stream, code));
+
+	SInt16 x, y;
+	EXPECT_TRUE(ProtocolUtil::readf(&stream, kMsgDMouseMove + 4, &x, &y));
+	EXPECT_EQ(300, x);
+	EXPECT_EQ(-2, y);
+	EXPECT_LT(1, stream.m_reads);
+}
+
+TEST(ProtocolUtilTests, readf_lentFrameWithStringAndVector_decoded)
+{
+	String data("xyz");
+	std::vector<UInt16> list;
+	list.push_back(1);
+	list.push_back(0xabcd);
+
+	String frame;
+	frame += String("\0\0\0\3xyz", 7);
+	frame += String("\0\0\0\2\0\1\xab\xcd", 8);
+	FrameStream stream(frame, true);
+
+	String s;
+	std::vector<UInt16> v;
+	EXPECT_TRUE(ProtocolUtil::readf(&stream, "%s%2I", &s, &v));
+	EXPECT_EQ(data, s);
+	EXPECT_EQ(list, v);
+	EXPECT_EQ(0, stream.m_reads);
+}
+
+TEST(ProtocolUtilTests, readf_lentFrameTooShort_failsAndReleasesWhatWasRead)
+{
+	FrameStream stream(String("\0\1\0", 3), true);
+
+	SInt16 x, y;
+	EXPECT_FALSE(ProtocolUtil::readf(&stream, "%2i%2i", &x, &y));
+	EXPECT_EQ(1, stream.getSize());
+}
+
+TEST(ProtocolUtilTests, readf_lentFrameMismatch_fails)
+{
+	FrameStream stream(mouseMove(1, 2), true);
+
+	SInt16 x, y;
+	EXPECT_FALSE(ProtocolUtil::readf(&stream, kMsgDMouseRelMove, &x, &y));
+}
+
+// compares decoding mouse moves in place with decoding them through
+// read().  the rates are recorded in the test results.
+TEST(ProtocolUtilTests, readf_mouseMoves_messagesPerSecond)
+{
+	const int kMessages = 20000;
+	FrameStream framed(mouseMove(123, 456), true);
+	FrameStream unframed(mouseMove(123, 456), false);
+
+	double rates[2];
+	FrameStream* streams[2] = { &unframed, &framed };
+	for (int i = 0; i < 2; ++i) {
+		FrameStream& stream = *streams[i];
+		Stopwatch timer;
+		for (int n = 0; n < kMessages; ++n) {
+			stream.reset();
+			UInt8 code[4];
+			SInt16 x, y;
+			ProtocolUtil::readCode(&stream, code);
+			ASSERT_TRUE(ProtocolUtil::readf(&stream, kMsgDMouseMove + 4, &x, &y));
+			ASSERT_EQ(123, x);
+			ASSERT_EQ(456, y);
+		}
+		rates[i] = kMessages / std::max(timer.getTime(), 1.0e-6);
+	}
+
+	RecordProperty("readMessagesPerSecond", static_cast<int>(rates[0]));
+	RecordProperty("frameMessagesPerSecond", static_cast<int>(rates[1]));
+}
@@ -64,3 +64,32 @@ TEST(ServerArgsParsingTests, parseServerArgs_configArg_setConfigFile)
 
 	EXPECT_EQ("mock_configFile", serverArgs.m_configFile);
 }
+
+TEST(ServerArgsParsingTests, parseServerArgs_socketThreadsArg_setSocketThreads)
+{
+	NiceMock<MockArgParser> argParser;
+	ON_CALL(argParser, parseGenericArgs(_, _, _)).WillByDefault(Invoke(server_stubParseGenericArgs));
+	ON_CALL(argParser, checkUnexpectedArgs()).WillByDefault(Invoke(server_stubCheckUnexpectedArgs));
+	ServerArgs serverArgs;
+	const int argc = 3;
+	const char* kSocketThreadsCmd[argc] = { "stub", "--socket-threads", "4" };
+
+	argParser.parseServerArgs(serverArgs, argc, kSocketThreadsCmd);
+
+	EXPECT_EQ(4, serverArgs.m_socketThreads);
+}
+
+TEST(ServerArgsParsingTests, parseServerArgs_configCacheArg_setConfigCache)
+{
+	NiceMock<MockArgParser> argParser;
+	ON_CALL(argParser, parseGenericArgs(_, _, _)).WillByDefault(Invoke(server_stubParseGenericArgs));
+	ON_CALL(argParser, checkUnexpectedArgs()).WillByDefault(Invoke(server_stubCheckUnexpectedArgs));
+	ServerArgs serverArgs;
+	const int argc = 2;
+	const char* kConfigCacheCmd[argc] = { "stub", "--config-cache" };
+
+	EXPECT_FALSE(serverArgs.m_configCache);
+	argParser.parseServerArgs(serverArgs, argc, kConfigCacheCmd);
+
+	EXPECT_TRUE(serverArgs.m_configCache);
+}